@@ -1,8 +1,13 @@
 TEMPLATE = subdirs
 
-SUBDIRS = common PlanesWidget PlanesGraphicsScene \
-    PlanesQML
+SUBDIRS = common planescore PlanesWidget PlanesGraphicsScene \
+    PlanesQML tools tests
 
+planescore.subdir = common/planescore
+
+common.depends = planescore
 PlanesWidget.depends = common
 PlanesGraphicsScene.depends = common
+tools.depends = planescore
+tests.depends = planescore
 
@@ -12,6 +12,8 @@ void ComputerBoard::gridSquareClicked(int row, int col)
 {
     if (m_CurStage != GameStages::Game)
         return;
+    if (m_ComputerThinking)
+        return;
     if (row < m_PaddingEditingBoard || col < m_PaddingEditingBoard)
         return;
     if (row >= m_Grid.getRowNo() + m_PaddingEditingBoard)
@@ -19,7 +21,7 @@ void ComputerBoard::gridSquareClicked(int row, int col)
     if (col >= m_Grid.getColNo() + m_PaddingEditingBoard)
         return;
 
-    QPoint qp(col - m_PaddingEditingBoard, row - m_PaddingEditingBoard);
+    GridPoint qp(col - m_PaddingEditingBoard, row - m_PaddingEditingBoard);
     GuessPoint::Type tp = m_Grid.getGuessResult(qp);
 
     qDebug() << "Guess " << tp;
@@ -33,8 +35,6 @@ void ComputerBoard::gridSquareClicked(int row, int col)
     if(m_GuessList.indexOf(gp)==-1)
     {
         m_GuessList.append(gp);
-        //to not let the user draw while the computer is thinking
-//        m_currentMode = Editor;
         emit guessMade(gp);
         hidePlanes();
         displayPlanes();
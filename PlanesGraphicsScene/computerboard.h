@@ -21,9 +21,19 @@ public slots:
      * row, col - the coordinates of the grid square where it was clicked
      */
     void gridSquareClicked(int row, int col);
+    /*
+     * The computer started or finished computing its move.
+     * Clicks are ignored while the computer is thinking.
+     */
+    inline void setComputerThinking(bool isThinking) {
+        m_ComputerThinking = isThinking;
+    }
 
 signals:
     void guessMade(const GuessPoint& gp);
+
+private:
+    bool m_ComputerThinking = false;
 };
 
 #endif // COMPUTERBOARD_H
@@ -4,6 +4,7 @@
 
 #include <QDebug>
 #include <QPropertyAnimation>
+#include <QPoint>
 
 ///@todo: to add destructor
 GenericBoard::GenericBoard(PlaneGrid& grid, int squareWidth) : m_Grid(grid), m_SquareWidth(squareWidth)
@@ -95,14 +96,14 @@ void GenericBoard::displayGuesses() {
 
 void GenericBoard::showPlane(const Plane &pl, const QColor& color)
 {
-    QPoint head = pl.head();
+    GridPoint head = pl.head();
     auto headGridSquareIndex = std::make_pair(head.y() + m_PaddingEditingBoard, head.x() + m_PaddingEditingBoard);
     m_SceneItems[headGridSquareIndex]->setType(GridSquare::Type::PlaneHead);
     PlanePointIterator ppi(pl);
     ///ignore the plane head
     ppi.next();
     while (ppi.hasNext()) {
-        QPoint pt = ppi.next();
+        GridPoint pt = ppi.next();
         auto pointGridSquareIndex = std::make_pair(pt.y() + m_PaddingEditingBoard, pt.x() + m_PaddingEditingBoard);
         m_SceneItems[pointGridSquareIndex]->setType(GridSquare::Type::Plane);
         m_SceneItems[pointGridSquareIndex]->setColor(color);
@@ -111,14 +112,14 @@ void GenericBoard::showPlane(const Plane &pl, const QColor& color)
 
 void GenericBoard::showSelectedPlane(const Plane &pl)
 {
-    QPoint head = pl.head();
+    GridPoint head = pl.head();
     auto headGridSquareIndex = std::make_pair(head.y() + m_PaddingEditingBoard, head.x() + m_PaddingEditingBoard);
     m_SceneItems[headGridSquareIndex]->setSelected(true);
     PlanePointIterator ppi(pl);
     ///ignore the plane head
     ppi.next();
     while (ppi.hasNext()) {
-        QPoint pt = ppi.next();
+        GridPoint pt = ppi.next();
         auto pointGridSquareIndex = std::make_pair(pt.y() + m_PaddingEditingBoard, pt.x() + m_PaddingEditingBoard);
         m_SceneItems[pointGridSquareIndex]->setSelected(true);
     }
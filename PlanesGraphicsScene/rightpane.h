@@ -40,6 +40,13 @@ public slots:
 
     void startNewGame();
 
+    /**
+     * @brief Block mouse click events in the computer board while the computer is thinking.
+     */
+    inline void computerThinking(bool isThinking) {
+        m_ComputerBoard->setComputerThinking(isThinking);
+    }
+
 signals:
     void planePositionNotValid(bool);
     void showComputerMove(const GuessPoint&);
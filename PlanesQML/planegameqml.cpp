@@ -12,6 +12,7 @@ PlaneGameQML::PlaneGameQML()
     connect(mRound, SIGNAL(computerMoveGenerated(const GuessPoint&)), this, SIGNAL(computerMoveGenerated(const GuessPoint&)));
     connect(mRound, SIGNAL(statsUpdated(const GameStatistics&)), this, SLOT(statsUpdated(const GameStatistics&)));
     connect(mRound, SIGNAL(roundEnds(bool)), this, SIGNAL(roundEnds(bool)));
+    connect(mRound, SIGNAL(computerThinking(bool)), this, SLOT(computerThinking(bool)));
     mRound->play();
 
 }
@@ -28,6 +29,11 @@ void PlaneGameQML::statsUpdated(const GameStatistics& stats) {
 void PlaneGameQML::startNewGame() {
     mRound->play();
 }
+
+void PlaneGameQML::computerThinking(bool isThinking) {
+    m_ComputerThinking = isThinking;
+    emit computerThinkingChanged();
+}
 ///controls for editing the player's board in the first round of the game
 //OK - connect(m_LeftPane, SIGNAL(selectPlaneClicked(bool)), m_RightPane, SLOT(selectPlaneClicked(bool)));
 //OK - connect(m_LeftPane, SIGNAL(rotatePlaneClicked(bool)), m_RightPane, SLOT(rotatePlaneClicked(bool)));
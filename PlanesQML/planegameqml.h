@@ -26,6 +26,7 @@ public:
     Q_INVOKABLE inline int getComputerWins() { return m_Stats.m_computerWins; }
 
     Q_INVOKABLE void startNewGame();
+    Q_INVOKABLE inline bool isComputerThinking() { return m_ComputerThinking; }
 
     inline PlaneGrid* playerGrid() { return mPlanesModel->playerGrid(); }
     inline PlaneGrid* computerGrid() { return mPlanesModel->computerGrid(); }
@@ -35,9 +36,11 @@ signals:
     void computerMoveGenerated(const GuessPoint& gp);    
     void updateStats();
     void roundEnds(bool isPlayerWinner);
+    void computerThinkingChanged();
 
 public slots:
     void statsUpdated(const GameStatistics& stats);
+    void computerThinking(bool isThinking);
 
 private:
     //The model object
@@ -46,6 +49,8 @@ private:
     PlaneRound* mRound;
 
     GameStatistics m_Stats;
+    //whether the computer is computing its move
+    bool m_ComputerThinking = false;
 };
 
 #endif // PLANEGAMEQML_H
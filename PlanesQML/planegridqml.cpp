@@ -139,6 +139,9 @@ void PlaneGridQML::computerBoardClick(int index) {
 
     if (m_CurStage != GameStages::Game)
         return;
+    //to not let the user draw while the computer is thinking
+    if (m_PlaneGame->isComputerThinking())
+        return;
 
     beginResetModel();
     ///@todo: see method data() above
@@ -152,7 +155,7 @@ void PlaneGridQML::computerBoardClick(int index) {
     if (col >= m_PlaneGrid->getColNo() + m_Padding)
         return;
 
-    QPoint qp(row - m_Padding, col - m_Padding);
+    GridPoint qp(row - m_Padding, col - m_Padding);
     GuessPoint::Type tp = m_PlaneGrid->getGuessResult(qp);
 
     qDebug() << "Guess " << tp;
@@ -167,8 +170,6 @@ void PlaneGridQML::computerBoardClick(int index) {
     {
         m_GuessList.append(gp);
         m_GuessMap[std::make_pair(qp.x(), qp.y())] = tp;
-        //to not let the user draw while the computer is thinking
-//        m_currentMode = Editor;
         emit guessMade(gp);
     }
     endResetModel();
@@ -8,6 +8,7 @@
 #include <QDebug>
 #include <QColor>
 #include <QAbstractListModel>
+#include <QPoint>
 #include "planegrid.h"
 #include "planegameqml.h"
 
@@ -27,7 +28,8 @@ public:
     }
 
     Q_INVOKABLE QPoint getPlanePoint(int idx) const {
-        return m_PlaneGrid->getPlanePoint(idx);
+        GridPoint qp = m_PlaneGrid->getPlanePoint(idx);
+        return QPoint(qp.x(), qp.y());
     }
 
     QColor getPlanePointColor(int idx, bool& isPlaneHead) const;
@@ -67,7 +67,7 @@ void DebugRenderArea::drawScores(QPainter *painter) const
         {
             Plane pl(i,j,m_orient);
             int idx = m_logic->mapPlaneToIndex(pl);
-            const int *values = m_logic->getChoicesArray();
+            const ChoiceMap& values = m_logic->getChoiceMap();
             if(values[idx]==0)
                 fillGridRect(i,j,QString("Yellow"),painter);
             if(values[idx]>0)
@@ -82,13 +82,15 @@ void DebugRenderArea::drawScores(QPainter *painter) const
 //draws the guesses made until this moment and highlights the last guess made
 void DebugRenderArea::drawGuesses(QPainter *painter) const
 {
-    QList <GuessPoint> list = m_logic->getListGuesses();
-    if(!list.isEmpty())
+    const ArenaVector<GuessPoint>& list = m_logic->getListGuesses();
+    if(!list.empty())
     {
-        GuessPoint gp = list.last();
+        GuessPoint gp = list.back();
         fillGridRect(gp.m_row, gp.m_col,"Blue", painter);
     }
-    QList <GuessPoint> elist = m_logic->getExtendedListGuesses();
+    QList <GuessPoint> elist;
+    for(unsigned int i = 0; i < m_logic->getExtendedListGuesses().size(); i++)
+        elist.append(m_logic->getExtendedListGuesses().at(i));
     BaseRenderArea::drawGuesses(elist,painter);
 
 }
@@ -0,0 +1,182 @@
+#include "batchengine.h"
+#include "choicekernels.h"
+#include "plane.h"
+#include "planestencils.h"
+#include <algorithm>
+#include <cstdint>
+
+namespace {
+
+//the number of arrays with one element per game
+const int GameArrayNo = 5;
+//the size of the lines of the caches
+const int CacheLineSize = 64;
+
+//the first element of a storage that is aligned on 32 bytes
+template<class T>
+T* alignedData(std::vector<T>& storage)
+{
+    std::uintptr_t address = reinterpret_cast<std::uintptr_t>(storage.data());
+    std::uintptr_t aligned = (address + 31) & ~static_cast<std::uintptr_t>(31);
+    return storage.data() + (aligned - address) / sizeof(T);
+}
+
+}
+
+//constructor
+//the storages have room for aligning the data
+BatchEngine::BatchEngine(int rowNo, int colNo, int planeNo, int gameNo, uint64_t seed):
+    m_rowNo(rowNo),
+    m_colNo(colNo),
+    m_planeNo(planeNo),
+    m_gameNo(gameNo)
+{
+    const int alignedNo = (gameNo + ChoiceKernels::BatchAlignment - 1) / ChoiceKernels::BatchAlignment * ChoiceKernels::BatchAlignment;
+    m_tileWidth = std::min(alignedNo, static_cast<int>(TileGameNo));
+    m_gameStride = (alignedNo + m_tileWidth - 1) / m_tileWidth * m_tileWidth;
+
+    const PlaneStencils& stencils = PlaneStencils::forGrid(rowNo, colNo);
+    const int pointNo = rowNo * colNo;
+    std::vector<int> rows(stencils.planePositionNo(), -1);
+    for (int orient = 0; orient < 4; orient++)
+        for (int point = 0; point < pointNo && pointNo <= MaxPointNo; point++)
+            if (stencils.isValid(point * 4 + orient)) {
+                rows[point * 4 + orient] = static_cast<int>(m_positions.size());
+                m_positions.push_back(point * 4 + orient);
+            }
+
+    for (int point = 0; point < pointNo && pointNo <= MaxPointNo; point++) {
+        m_headStart.push_back(static_cast<int>(m_heads.size()));
+        m_coverStart.push_back(static_cast<int>(m_covers.size()));
+        for (int orient = 0; orient < 4; orient++)
+            if (rows[point * 4 + orient] != -1)
+                m_heads.push_back(rows[point * 4 + orient]);
+        for (const int* cover = stencils.coversBegin(point); cover != stencils.coversEnd(point); ++cover)
+            if (rows[*cover] != -1)
+                m_covers.push_back(rows[*cover]);
+    }
+    m_headStart.push_back(static_cast<int>(m_heads.size()));
+    m_coverStart.push_back(static_cast<int>(m_covers.size()));
+
+    m_scoreStorage.resize(m_positions.size() * m_gameStride + 8);
+    m_scores = alignedData(m_scoreStorage);
+
+    m_gameStorage.resize(GameArrayNo * m_gameStride + 8);
+    int16_t* gameData = alignedData(m_gameStorage);
+    int16_t** arrays[GameArrayNo] = { &m_maxScores, &m_counts, &m_nth, &m_found, &m_choices };
+    for (int i = 0; i < GameArrayNo; i++)
+        *arrays[i] = gameData + i * m_gameStride;
+
+    m_moveNos.resize(gameNo);
+    m_deadNos.resize(gameNo);
+    m_randoms.resize(gameNo);
+    reset(seed);
+}
+
+//starts all the games again
+//the columns after the last game stay empty
+void BatchEngine::reset(uint64_t seed)
+{
+    std::fill(m_scores, m_scores + m_positions.size() * m_gameStride, 0);
+    std::fill(m_maxScores, m_maxScores + m_gameStride, -1);
+    std::fill(m_choices, m_choices + m_gameStride, -1);
+    for (int game = 0; game < m_gameNo; game++)
+        resetGame(game, seed + game);
+}
+
+//starts one game again
+//all the positions have the score 0, the first move is any of them; the
+//column of the game is cleared at its first guess, when its tile is in the cache
+void BatchEngine::resetGame(int game, uint64_t seed)
+{
+    const int positionNo = static_cast<int>(m_positions.size());
+    m_maxScores[game] = positionNo > 0 ? 0 : -1;
+    m_counts[game] = positionNo;
+    m_moveNos[game] = 0;
+    m_deadNos[game] = 0;
+    m_randoms[game] = RandomGenerator(seed);
+    m_choices[game] = positionNo > 0 ? m_randoms[game].generate(positionNo) : -1;
+}
+
+//gives the moves chosen for each game
+void BatchEngine::chooseMoves(int* points) const
+{
+    for (int game = 0; game < m_gameNo; game++)
+        points[game] = (isFinished(game) || m_choices[game] == -1) ? -1 : m_positions[m_choices[game]] / 4;
+}
+
+//applies one guess per game
+//the guesses of the games of a tile are applied, then the highest scores
+//are counted and the next moves are found while the tile is in the cache
+//the tiles without a game taking a guess are skipped
+void BatchEngine::addGuesses(const int* points, const GuessPoint::Type* results)
+{
+    const ChoiceKernels& kernels = ChoiceKernels::active();
+    const int positionNo = static_cast<int>(m_positions.size());
+    const int lineNo = positionNo * m_tileWidth * static_cast<int>(sizeof(int16_t)) / CacheLineSize;
+    for (int first = 0; first < m_gameNo; first += m_tileWidth) {
+        const int last = std::min(first + m_tileWidth, m_gameNo);
+        //the next tile is brought to the cache a part for each game, the
+        //prefetches are spread so that they do not wait for each other
+        const char* next = last < m_gameNo ? reinterpret_cast<const char*>(tile(last)) : nullptr;
+        bool isTaken = false;
+        for (int game = first; game < last; game++) {
+            const int part = game - first;
+            for (int line = part * lineNo / m_tileWidth; next && line < (part + 1) * lineNo / m_tileWidth; line++)
+                __builtin_prefetch(next + line * CacheLineSize, 1, 2);
+            //nth -1 is never reached, the position of the game is -1
+            m_nth[game] = -1;
+            if (points[game] == -1 || isFinished(game))
+                continue;
+
+            isTaken = true;
+            m_choices[game] = -1;
+            addGuess(game, points[game], results[game]);
+        }
+        if (!isTaken)
+            continue;
+
+        const int16_t* scores = tile(first);
+        kernels.m_maxCountBatch(scores, positionNo, m_tileWidth, m_tileWidth, m_maxScores + first, m_counts + first);
+        for (int game = first; game < last; game++)
+            if (points[game] != -1 && !isFinished(game) && m_maxScores[game] >= 0)
+                m_nth[game] = m_randoms[game].generate(m_counts[game]);
+        kernels.m_findNthBatch(scores, positionNo, m_tileWidth, m_tileWidth, m_maxScores + first, m_nth + first, m_found + first);
+        for (int game = first; game < last; game++)
+            if (m_nth[game] != -1)
+                m_choices[game] = m_found[game];
+    }
+}
+
+//the positions with the head on the point are guessed, the valid positions
+//covering it are made impossible by a miss and incremented by a hit
+void BatchEngine::addGuess(int game, int point, GuessPoint::Type result)
+{
+    int16_t* column = tile(game) + game % m_tileWidth;
+    if (m_moveNos[game] == 0)
+        for (int i = 0; i < static_cast<int>(m_positions.size()); i++)
+            column[i * m_tileWidth] = 0;
+    m_moveNos[game]++;
+    if (result == GuessPoint::Dead)
+        m_deadNos[game]++;
+
+    for (int i = m_headStart[point]; i < m_headStart[point + 1]; i++)
+        column[m_heads[i] * m_tileWidth] = -2;
+
+    //without branches, the scores of the covers are not predictable
+    const int isHit = result == GuessPoint::Hit ? 1 : 0;
+    for (int i = m_coverStart[point]; i < m_coverStart[point + 1]; i++) {
+        int16_t& score = column[m_covers[i] * m_tileWidth];
+        const int updated = isHit ? score + 1 : -1;
+        score = score >= 0 ? updated : score;
+    }
+}
+
+//the number of finished games
+int BatchEngine::finishedNo() const
+{
+    int finished = 0;
+    for (int game = 0; game < m_gameNo; game++)
+        finished += isFinished(game);
+    return finished;
+}
@@ -0,0 +1,130 @@
+#ifndef BATCHENGINE_H
+#define BATCHENGINE_H
+
+#include "guesspoint.h"
+#include "plane.h"
+#include <cstdint>
+#include <vector>
+
+//Plays many games of the computer at once, in lockstep.
+//Each game keeps the choice map of ComputerLogic and chooses its moves like
+//the find head mode: a random plane position with the highest score.
+//The state of all the games is kept as structures of arrays: the scores form
+//a table with one row per valid plane position and one column per game, and
+//the other data of the games are arrays with one element per game, so there
+//is no object and no memory allocation per game.
+//
+//A step takes one guess per game. A guess changes only the positions
+//covering its point, which are updated one by one from the stencils of the
+//grid, as ChoiceMap does. The passes over all the positions, the highest
+//scores and the choice of the next moves, are made for many games at once
+//by the batch kernels of ChoiceKernels.
+//
+//The scores have 16 bits and the table is stored in tiles of TileGameNo
+//games: the rows of a tile are contiguous, a tile of a 10x10 grid takes
+//21KB. A step visits each tile once, updates it and chooses the next moves
+//of its games while it is in the cache, and the next tile is prefetched
+//meanwhile, so that the cost per game grows little with the size of the
+//batch (tools/batchbench measures it).
+//
+//Each game draws its moves from its own generator, seeded when the game is
+//started, so the moves of a game do not depend on the other games of the
+//batch nor on the order in which they are processed.
+//
+//The head data and the propagation engine of ComputerLogic follow each game
+//on its own path and are not part of the batch; the batch engine is meant
+//for evaluation runs over large numbers of games. A finished game can be
+//started again with resetGame() while the others go on.
+//The grid can have at most 128 points.
+class BatchEngine
+{
+public:
+    //the largest grid supported
+    static const int MaxPointNo = 128;
+    //the number of games of a tile of the table
+    static const int TileGameNo = 64;
+
+private:
+    int m_rowNo;
+    int m_colNo;
+    int m_planeNo;
+    int m_gameNo;
+    //the number of games of the tiles, TileGameNo or less for a small batch;
+    //a multiple of ChoiceKernels::BatchAlignment
+    int m_tileWidth;
+    //the number of columns of the table, gameNo rounded up to the tile width
+    int m_gameStride;
+
+    //the plane positions that are inside the grid, in the order of the
+    //lanes of ChoiceMap so that ties are broken in the same way
+    std::vector<int> m_positions;
+    //for each point the rows of the positions having their head on it and
+    //the rows of the positions covering it, m_headStart and m_coverStart
+    //have one more element than the number of points
+    std::vector<int> m_headStart;
+    std::vector<int> m_heads;
+    std::vector<int> m_coverStart;
+    std::vector<int> m_covers;
+
+    //the tiles one after the other, a tile has one row of m_tileWidth
+    //scores for each position; aligned on 32 bytes
+    std::vector<int16_t> m_scoreStorage;
+    int16_t* m_scores;
+
+    //the arrays with one element per game, aligned on 32 bytes
+    std::vector<int16_t> m_gameStorage;
+    //the highest score of each game and the number of positions having it
+    int16_t* m_maxScores;
+    int16_t* m_counts;
+    //work arrays of the choice of the next moves
+    int16_t* m_nth;
+    int16_t* m_found;
+    //the next move of each game, as a row of the table, or -1
+    int16_t* m_choices;
+    //the number of moves and of heads found
+    std::vector<int> m_moveNos;
+    std::vector<int> m_deadNos;
+    //the generator of each game
+    std::vector<RandomGenerator> m_randoms;
+
+public:
+    //the games are started as with reset(seed)
+    BatchEngine(int rowNo, int colNo, int planeNo, int gameNo, uint64_t seed = 0);
+
+    int getRowNo() const { return m_rowNo; }
+    int getColNo() const { return m_colNo; }
+    int getPlaneNo() const { return m_planeNo; }
+    int gameNo() const { return m_gameNo; }
+
+    //starts all the games again, game i with the seed seed + i
+    void reset(uint64_t seed);
+    //starts one game again with its own seed
+    void resetGame(int game, uint64_t seed);
+
+    //gives the next guess of each game, as col * rowNo + row
+    //the point of a finished game, or a game without a possible position, is -1
+    //the guesses are chosen when the games start and by addGuesses()
+    void chooseMoves(int* points) const;
+    //applies one guess per game and chooses the next guess of the games that
+    //took one; games with the point -1 are left as they are
+    //the game ends when all the heads are found
+    void addGuesses(const int* points, const GuessPoint::Type* results);
+
+    //whether all the heads of a game were found
+    bool isFinished(int game) const { return m_deadNos[game] == m_planeNo; }
+    //the number of moves of a game
+    int moveNo(int game) const { return m_moveNos[game]; }
+    //the number of finished games
+    int finishedNo() const;
+
+private:
+    //the first score of the tile of a game
+    int16_t* tile(int game) const { return m_scores + (game / m_tileWidth) * m_tileWidth * static_cast<int>(m_positions.size()); }
+    //applies a guess to the column of one game
+    void addGuess(int game, int point, GuessPoint::Type result);
+
+    BatchEngine(const BatchEngine&) = delete;
+    BatchEngine& operator=(const BatchEngine&) = delete;
+};
+
+#endif // BATCHENGINE_H
@@ -0,0 +1,168 @@
+#include "boardpool.h"
+#include "planegridcore.h"
+#include <chrono>
+
+namespace {
+
+//the producer gives up after this number of boards failing the checks in
+//a row, the geometry cannot hold the planes
+const int MaxRejectedInRow = 1000;
+
+int roundToPowerOfTwo(int value)
+{
+    int power = 1;
+    while (power < value)
+        power *= 2;
+    return power;
+}
+
+}
+
+//constructor
+//the generator of the producer is seeded from the shared generator
+BoardPool::BoardPool(int rowNo, int colNo, int planeNo, int capacity):
+    m_rowNo(rowNo),
+    m_colNo(colNo),
+    m_planeNo(planeNo),
+    m_capacity(roundToPowerOfTwo(capacity < 2 ? 2 : capacity)),
+    m_slots(new Slot[m_capacity]),
+    m_head(0),
+    m_tail(0),
+    m_taken(0),
+    m_missed(0),
+    m_produced(0),
+    m_rejected(0),
+    m_refills(0),
+    m_stopping(false)
+{
+    for (int i = 0; i < m_capacity; i++)
+        m_slots[i].m_sequence.store(i, std::memory_order_relaxed);
+
+    //a pool that cannot hold the boards stays empty
+    if (m_planeNo <= 0 || m_planeNo > MaxPlaneNo || m_rowNo <= 0 || m_colNo <= 0)
+        return;
+    const uint64_t seed = (static_cast<uint64_t>(Plane::generateRandomNumber(1 << 30)) << 30) | Plane::generateRandomNumber(1 << 30);
+    m_thread = std::thread([this, seed]() {
+        RandomGenerator random(seed);
+        RandomScope scope(random);
+        produce();
+    });
+}
+
+//stops the producer
+BoardPool::~BoardPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+    m_condition.notify_one();
+    if (m_thread.joinable())
+        m_thread.join();
+}
+
+//the consumers move the head with a compare-and-swap on the slot whose
+//board is ready, then give the slot back to the producer
+bool BoardPool::take(PackedPlane* planes)
+{
+    uint64_t position = m_head.load(std::memory_order_relaxed);
+    for (;;) {
+        Slot& slot = m_slots[position & (m_capacity - 1)];
+        const uint64_t sequence = slot.m_sequence.load(std::memory_order_acquire);
+        const int64_t difference = static_cast<int64_t>(sequence - (position + 1));
+        if (difference == 0) {
+            if (m_head.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+                break;
+        } else if (difference < 0) {
+            m_missed.fetch_add(1, std::memory_order_relaxed);
+            m_condition.notify_one();
+            return false;
+        } else {
+            position = m_head.load(std::memory_order_relaxed);
+        }
+    }
+
+    Slot& slot = m_slots[position & (m_capacity - 1)];
+    for (int i = 0; i < m_planeNo; i++)
+        planes[i] = slot.m_planes[i];
+    slot.m_sequence.store(position + m_capacity, std::memory_order_release);
+    m_taken.fetch_add(1, std::memory_order_relaxed);
+
+    //wakes the producer when the pool is half empty
+    if (occupancy() <= m_capacity / 2)
+        m_condition.notify_one();
+    return true;
+}
+
+//puts a board in the next slot if the consumers gave it back
+bool BoardPool::put(const PackedPlane* planes)
+{
+    const uint64_t position = m_tail.load(std::memory_order_relaxed);
+    Slot& slot = m_slots[position & (m_capacity - 1)];
+    if (slot.m_sequence.load(std::memory_order_acquire) != position)
+        return false;
+
+    for (int i = 0; i < m_planeNo; i++)
+        slot.m_planes[i] = planes[i];
+    slot.m_sequence.store(position + 1, std::memory_order_release);
+    m_tail.store(position + 1, std::memory_order_relaxed);
+    return true;
+}
+
+//the boards ready to be taken
+int BoardPool::occupancy() const
+{
+    const uint64_t tail = m_tail.load(std::memory_order_relaxed);
+    const uint64_t head = m_head.load(std::memory_order_relaxed);
+    return tail > head ? static_cast<int>(tail - head) : 0;
+}
+
+BoardPool::Metrics BoardPool::metrics() const
+{
+    Metrics metrics;
+    metrics.m_capacity = m_capacity;
+    metrics.m_occupancy = occupancy();
+    metrics.m_taken = m_taken.load(std::memory_order_relaxed);
+    metrics.m_missed = m_missed.load(std::memory_order_relaxed);
+    metrics.m_produced = m_produced.load(std::memory_order_relaxed);
+    metrics.m_rejected = m_rejected.load(std::memory_order_relaxed);
+    metrics.m_refills = m_refills.load(std::memory_order_relaxed);
+    return metrics;
+}
+
+//fills the ring, then sleeps until it is half empty
+//the consumers may wake it without the mutex, a missed wake up only delays
+//the refill by the timeout of the wait
+void BoardPool::produce()
+{
+    PlaneGridCore grid(m_rowNo, m_colNo, m_planeNo, true);
+    PackedPlane planes[MaxPlaneNo];
+    int rejectedInRow = 0;
+
+    while (!m_stopping) {
+        m_refills.fetch_add(1, std::memory_order_relaxed);
+        while (!m_stopping && occupancy() < m_capacity) {
+            grid.initGrid();
+            if (grid.getPlaneListSize() != m_planeNo || grid.doPlanesOverlap() || grid.isPlaneOutsideGrid()) {
+                m_rejected.fetch_add(1, std::memory_order_relaxed);
+                if (++rejectedInRow == MaxRejectedInRow)
+                    return;
+                continue;
+            }
+            rejectedInRow = 0;
+
+            for (int i = 0; i < m_planeNo; i++) {
+                Plane plane;
+                grid.getPlane(i, plane);
+                planes[i] = PackedPlane(plane, m_rowNo);
+            }
+            if (!put(planes))
+                break;
+            m_produced.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        std::unique_lock<std::mutex> lock(m_mutex);
+        while (!m_stopping && occupancy() > m_capacity / 2)
+            m_condition.wait_for(lock, std::chrono::milliseconds(20));
+    }
+}
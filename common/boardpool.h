@@ -0,0 +1,115 @@
+#ifndef BOARDPOOL_H
+#define BOARDPOOL_H
+
+#include "packedtypes.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+//Boards generated in advance for one geometry, so that a round starts
+//without placing the planes: PlaneGridCore::initGrid() takes a board from
+//the pool when one is set and places the planes itself only when the pool
+//is empty.
+//
+//A thread of the pool generates the boards with PlaneGridCore and checks
+//them (all the planes placed, inside the grid, without overlap) before it
+//puts them in a bounded ring. The ring is lock-free: the producer and the
+//consumers meet on the sequence number of each slot (the bounded queue of
+//D. Vyukov, with one producer), so take() never waits and costs one
+//compare-and-swap and the copy of the planes. When the ring is full the
+//producer sleeps until it is half empty: each refill makes half of the
+//boards at once.
+//
+//The boards are drawn with a generator of the pool, not with the generator
+//of the game: the seed of a round no longer gives its boards, they are
+//recorded with the round (see ReplayLog and GameSession::saveState()).
+class BoardPool
+{
+public:
+    //the largest number of planes of a board
+    static const int MaxPlaneNo = 32;
+
+    struct Metrics
+    {
+        int m_capacity;
+        //the boards ready to be taken
+        int m_occupancy;
+        //the boards taken and the calls that found the pool empty
+        uint64_t m_taken;
+        uint64_t m_missed;
+        //the boards generated and the boards that failed the checks
+        uint64_t m_produced;
+        uint64_t m_rejected;
+        //the times the producer woke up to fill the pool
+        uint64_t m_refills;
+    };
+
+private:
+    struct Slot
+    {
+        //pos + 1 when the board of pos can be taken, pos + capacity when
+        //the slot can receive the board of pos + capacity
+        std::atomic<uint64_t> m_sequence;
+        PackedPlane m_planes[MaxPlaneNo];
+    };
+
+    const int m_rowNo;
+    const int m_colNo;
+    const int m_planeNo;
+    //a power of two
+    const int m_capacity;
+    std::unique_ptr<Slot[]> m_slots;
+
+    //the next board to take, moved by the consumers, and the next board to
+    //put, moved by the producer; they are kept on different cache lines
+    char m_padding0[64];
+    std::atomic<uint64_t> m_head;
+    char m_padding1[64];
+    std::atomic<uint64_t> m_tail;
+    char m_padding2[64];
+
+    std::atomic<uint64_t> m_taken;
+    std::atomic<uint64_t> m_missed;
+    std::atomic<uint64_t> m_produced;
+    std::atomic<uint64_t> m_rejected;
+    std::atomic<uint64_t> m_refills;
+
+    //the producer sleeps on the condition while the pool is more than half full
+    std::mutex m_mutex;
+    std::condition_variable m_condition;
+    std::atomic<bool> m_stopping;
+    std::thread m_thread;
+
+public:
+    //starts the producer; the capacity is rounded up to a power of two
+    BoardPool(int rowNo, int colNo, int planeNo, int capacity = 256);
+    //stops the producer
+    ~BoardPool();
+
+    int getRowNo() const { return m_rowNo; }
+    int getColNo() const { return m_colNo; }
+    int getPlaneNo() const { return m_planeNo; }
+
+    //copies the planes of a board to planes, getPlaneNo() of them
+    //returns false at once if the pool is empty; can be called from any thread
+    bool take(PackedPlane* planes);
+
+    //the boards ready to be taken
+    int occupancy() const;
+    Metrics metrics() const;
+
+private:
+    //the loop of the producer
+    void produce();
+    //puts a board in the ring, only called by the producer
+    //returns false if the ring is full
+    bool put(const PackedPlane* planes);
+
+    BoardPool(const BoardPool&) = delete;
+    BoardPool& operator=(const BoardPool&) = delete;
+};
+
+#endif // BOARDPOOL_H
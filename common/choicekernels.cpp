@@ -0,0 +1,833 @@
+#include "choicekernels.h"
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define CHOICEKERNELS_X86
+#include <immintrin.h>
+#endif
+
+namespace {
+
+//scalar versions, used on every processor
+
+void incrementValidScalar(int* data, const int* indices, int indexNo)
+{
+    for (int i = 0; i < indexNo; i++) {
+        int& value = data[indices[i]];
+        value += (value >= 0);
+    }
+}
+
+void invalidateValidScalar(int* data, const int* indices, int indexNo)
+{
+    for (int i = 0; i < indexNo; i++) {
+        int& value = data[indices[i]];
+        if (value >= 0)
+            value = -1;
+    }
+}
+
+int maxCountScalar(const int* data, int size, int& count)
+{
+    int maxValue = data[0];
+    count = 0;
+    for (int i = 0; i < size; i++) {
+        if (data[i] > maxValue) {
+            maxValue = data[i];
+            count = 0;
+        }
+        count += (data[i] == maxValue);
+    }
+    return maxValue;
+}
+
+int countEqualScalar(const int* data, int size, int value)
+{
+    int count = 0;
+    for (int i = 0; i < size; i++)
+        count += (data[i] == value);
+    return count;
+}
+
+int findNthScalar(const int* data, int size, int value, int nth)
+{
+    for (int i = 0; i < size; i++) {
+        if (data[i] != value)
+            continue;
+        if (nth == 0)
+            return i;
+        nth--;
+    }
+    return -1;
+}
+
+int filterRecordsScalar(const uint64_t* records, const int* indices, int indexNo,
+                        const uint64_t* clearMask, const uint64_t* setMask, int* survivors)
+{
+    int survivorNo = 0;
+    for (int i = 0; i < indexNo; i++) {
+        const int index = indices ? indices[i] : i;
+        const uint64_t* record = records + index * ChoiceKernels::RecordWords;
+        bool kept = true;
+        for (int w = 0; w < ChoiceKernels::RecordWords; w++)
+            kept = kept && (record[w] & clearMask[w]) == 0 && (record[w] & setMask[w]) == setMask[w];
+        survivors[survivorNo] = index;
+        survivorNo += kept;
+    }
+    return survivorNo;
+}
+
+void maxCountBatchScalar(const int16_t* scores, int positionNo, int gameNo, int gameStride, int16_t* maxScores,
+                         int16_t* counts)
+{
+    for (int game = 0; game < gameNo; game++) {
+        maxScores[game] = scores[game];
+        counts[game] = 0;
+    }
+
+    for (int position = 0; position < positionNo; position++) {
+        const int16_t* row = scores + position * gameStride;
+        for (int game = 0; game < gameNo; game++) {
+            if (row[game] > maxScores[game]) {
+                maxScores[game] = row[game];
+                counts[game] = 0;
+            }
+            counts[game] += (row[game] == maxScores[game]);
+        }
+    }
+}
+
+void findNthBatchScalar(const int16_t* scores, int positionNo, int gameNo, int gameStride, const int16_t* values,
+                        const int16_t* nth, int16_t* positions)
+{
+    for (int game = 0; game < gameNo; game++) {
+        positions[game] = -1;
+        int seen = 0;
+        for (int position = 0; position < positionNo; position++) {
+            if (scores[position * gameStride + game] != values[game])
+                continue;
+            if (seen++ == nth[game]) {
+                positions[game] = position;
+                break;
+            }
+        }
+    }
+}
+
+int sumEqualScalar(const int* keys, const int* values, int size, int key, int64_t& sum)
+{
+    int count = 0;
+    sum = 0;
+    for (int i = 0; i < size; i++) {
+        const int equal = (keys[i] == key);
+        count += equal;
+        sum += equal ? values[i] : 0;
+    }
+    return count;
+}
+
+void outcomeProbabilitiesScalar(const float* headWeights, const float* bodyWeights, int size, float scale,
+                                float* pDead, float* pHit)
+{
+    for (int i = 0; i < size; i++) {
+        const float dead = std::min(headWeights[i] * scale, 1.0f);
+        pHit[i] = std::min(bodyWeights[i] * scale, 1.0f - dead);
+        pDead[i] = dead;
+    }
+}
+
+//the logarithm of the information kernels, the one of the Cephes library:
+//x = m * 2^e with m in [sqrt(1/2), sqrt(2)) and log(m) a polynomial in m - 1;
+//the vector versions make the same operations in the same order, so that
+//they round the same way
+const float SqrtHalf = 0.707106781186547524f;
+const float LogPolynomial[] = { 7.0376836292e-2f, -1.1514610310e-1f, 1.1676998740e-1f, -1.2420140846e-1f,
+                                1.4249322787e-1f, -1.6668057665e-1f, 2.0000714765e-1f, -2.4999993993e-1f,
+                                3.3333331174e-1f };
+//log(2) in two parts, the first one exact in a few bits
+const float LogTwoLow = -2.12194440e-4f;
+const float LogTwoHigh = 0.693359375f;
+//the smallest probability whose logarithm is taken; below it the
+//exponent of the number is not that of its bits
+const float MinProbability = std::numeric_limits<float>::min();
+//the marks of the guessed points
+const int GuessedMark = -2;
+
+float logarithmScalar(float x)
+{
+    uint32_t bits;
+    std::memcpy(&bits, &x, sizeof(bits));
+    int exponent = static_cast<int>(bits >> 23) - 126;
+    bits = (bits & 0x007fffff) | 0x3f000000;
+    float m;
+    std::memcpy(&m, &bits, sizeof(m));
+
+    const bool isSmall = m < SqrtHalf;
+    exponent -= isSmall;
+    m = (m + (isSmall ? m : 0.0f)) - 1.0f;
+    const float e = static_cast<float>(exponent);
+
+    const float z = m * m;
+    float y = LogPolynomial[0];
+    for (int k = 1; k < 9; k++)
+        y = y * m + LogPolynomial[k];
+    y = (y * m) * z;
+    y = y + e * LogTwoLow;
+    y = y + z * -0.5f;
+    float result = m + y;
+    return result + e * LogTwoHigh;
+}
+
+//p * log(p), 0 when p is not positive
+float entropyTermScalar(float p)
+{
+    return p > 0.0f ? p * logarithmScalar(std::max(p, MinProbability)) : 0.0f;
+}
+
+float informationScoreScalar(float pDead, float pHit, float deadBonus)
+{
+    const float pMiss = (1.0f - pDead) - pHit;
+    float score = deadBonus * pDead;
+    score = score - entropyTermScalar(pDead);
+    score = score - entropyTermScalar(pHit);
+    return score - entropyTermScalar(pMiss);
+}
+
+//the first unmarked point with the largest score, the scores being written
+int bestScoreScalar(const float* scores, const int* marks, int size)
+{
+    int best = -1;
+    for (int i = 0; i < size; i++)
+        if (marks[i] != GuessedMark && (best < 0 || scores[i] > scores[best]))
+            best = i;
+    return best;
+}
+
+int informationScoresScalar(const float* pDead, const float* pHit, const int* marks, int size, float deadBonus,
+                            float* scores)
+{
+    for (int i = 0; i < size; i++)
+        scores[i] = informationScoreScalar(pDead[i], pHit[i], deadBonus);
+    return bestScoreScalar(scores, marks, size);
+}
+
+const ChoiceKernels ScalarKernels = {
+    "scalar", incrementValidScalar, invalidateValidScalar, maxCountScalar, countEqualScalar, findNthScalar,
+    filterRecordsScalar, maxCountBatchScalar, findNthBatchScalar, sumEqualScalar, outcomeProbabilitiesScalar,
+    informationScoresScalar
+};
+
+#ifdef CHOICEKERNELS_X86
+
+//the position of the nth set bit of a comparison mask
+int nthBit(int mask, int nth)
+{
+    for (int i = 0; i < nth; i++)
+        mask &= mask - 1;
+    return __builtin_ctz(mask);
+}
+
+//SSE4.1 versions, four elements at a time
+//there is no gather instruction, the stencil updates stay scalar;
+//there is no variable shift either, the batch updates stay scalar
+
+__attribute__((target("sse4.1")))
+int countEqualSse(const int* data, int size, int value)
+{
+    const __m128i valueVector = _mm_set1_epi32(value);
+    int count = 0;
+    for (int i = 0; i < size; i += 4) {
+        __m128i equal = _mm_cmpeq_epi32(_mm_load_si128(reinterpret_cast<const __m128i*>(data + i)), valueVector);
+        count += __builtin_popcount(_mm_movemask_ps(_mm_castsi128_ps(equal)));
+    }
+    return count;
+}
+
+__attribute__((target("sse4.1")))
+int maxCountSse(const int* data, int size, int& count)
+{
+    __m128i maxVector = _mm_load_si128(reinterpret_cast<const __m128i*>(data));
+    for (int i = 4; i < size; i += 4)
+        maxVector = _mm_max_epi32(maxVector, _mm_load_si128(reinterpret_cast<const __m128i*>(data + i)));
+    maxVector = _mm_max_epi32(maxVector, _mm_shuffle_epi32(maxVector, _MM_SHUFFLE(1, 0, 3, 2)));
+    maxVector = _mm_max_epi32(maxVector, _mm_shuffle_epi32(maxVector, _MM_SHUFFLE(2, 3, 0, 1)));
+    int maxValue = _mm_cvtsi128_si32(maxVector);
+
+    count = countEqualSse(data, size, maxValue);
+    return maxValue;
+}
+
+__attribute__((target("sse4.1")))
+int findNthSse(const int* data, int size, int value, int nth)
+{
+    const __m128i valueVector = _mm_set1_epi32(value);
+    for (int i = 0; i < size; i += 4) {
+        __m128i equal = _mm_cmpeq_epi32(_mm_load_si128(reinterpret_cast<const __m128i*>(data + i)), valueVector);
+        int mask = _mm_movemask_ps(_mm_castsi128_ps(equal));
+        int found = __builtin_popcount(mask);
+        if (nth < found)
+            return i + nthBit(mask, nth);
+        nth -= found;
+    }
+    return -1;
+}
+
+//a record is two vectors, tested with ptest
+__attribute__((target("sse4.1")))
+int filterRecordsSse(const uint64_t* records, const int* indices, int indexNo,
+                     const uint64_t* clearMask, const uint64_t* setMask, int* survivors)
+{
+    const __m128i clear0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(clearMask));
+    const __m128i clear1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(clearMask + 2));
+    const __m128i set0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(setMask));
+    const __m128i set1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(setMask + 2));
+
+    int survivorNo = 0;
+    for (int i = 0; i < indexNo; i++) {
+        const int index = indices ? indices[i] : i;
+        const __m128i* record = reinterpret_cast<const __m128i*>(records + index * ChoiceKernels::RecordWords);
+        const __m128i record0 = _mm_load_si128(record);
+        const __m128i record1 = _mm_load_si128(record + 1);
+        survivors[survivorNo] = index;
+        survivorNo += _mm_testz_si128(record0, clear0) & _mm_testz_si128(record1, clear1) &
+                      _mm_testc_si128(record0, set0) & _mm_testc_si128(record1, set1);
+    }
+    return survivorNo;
+}
+
+//the running maximum and count of eight games
+__attribute__((target("sse4.1")))
+void maxCountBatchSse(const int16_t* scores, int positionNo, int gameNo, int gameStride, int16_t* maxScores,
+                      int16_t* counts)
+{
+    const __m128i one = _mm_set1_epi16(1);
+    for (int game = 0; game < gameNo; game += 8) {
+        __m128i maxVector = _mm_load_si128(reinterpret_cast<const __m128i*>(scores + game));
+        __m128i countVector = _mm_setzero_si128();
+        for (int position = 0; position < positionNo; position++) {
+            const __m128i score = _mm_load_si128(reinterpret_cast<const __m128i*>(scores + position * gameStride + game));
+            const __m128i greater = _mm_cmpgt_epi16(score, maxVector);
+            maxVector = _mm_max_epi16(maxVector, score);
+            countVector = _mm_andnot_si128(greater, countVector);
+            countVector = _mm_add_epi16(countVector, _mm_and_si128(_mm_cmpeq_epi16(score, maxVector), one));
+        }
+        _mm_store_si128(reinterpret_cast<__m128i*>(maxScores + game), maxVector);
+        _mm_store_si128(reinterpret_cast<__m128i*>(counts + game), countVector);
+    }
+}
+
+//the selected values are widened to 64 bits before they are added
+__attribute__((target("sse4.1")))
+int sumEqualSse(const int* keys, const int* values, int size, int key, int64_t& sum)
+{
+    const __m128i keyVector = _mm_set1_epi32(key);
+    __m128i sumVector = _mm_setzero_si128();
+    int count = 0;
+    int i = 0;
+    for (; i + 4 <= size; i += 4) {
+        const __m128i equal = _mm_cmpeq_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(keys + i)), keyVector);
+        const __m128i selected = _mm_and_si128(equal, _mm_loadu_si128(reinterpret_cast<const __m128i*>(values + i)));
+        sumVector = _mm_add_epi64(sumVector, _mm_cvtepi32_epi64(selected));
+        sumVector = _mm_add_epi64(sumVector, _mm_cvtepi32_epi64(_mm_unpackhi_epi64(selected, selected)));
+        count += __builtin_popcount(_mm_movemask_ps(_mm_castsi128_ps(equal)));
+    }
+    alignas(16) int64_t lanes[2];
+    _mm_store_si128(reinterpret_cast<__m128i*>(lanes), sumVector);
+    int64_t rest = 0;
+    count += sumEqualScalar(keys + i, values + i, size - i, key, rest);
+    sum = lanes[0] + lanes[1] + rest;
+    return count;
+}
+
+__attribute__((target("sse4.1")))
+void outcomeProbabilitiesSse(const float* headWeights, const float* bodyWeights, int size, float scale,
+                             float* pDead, float* pHit)
+{
+    const __m128 scaleVector = _mm_set1_ps(scale);
+    const __m128 one = _mm_set1_ps(1.0f);
+    int i = 0;
+    for (; i + 4 <= size; i += 4) {
+        const __m128 dead = _mm_min_ps(_mm_mul_ps(_mm_loadu_ps(headWeights + i), scaleVector), one);
+        const __m128 hit = _mm_min_ps(_mm_mul_ps(_mm_loadu_ps(bodyWeights + i), scaleVector), _mm_sub_ps(one, dead));
+        _mm_storeu_ps(pHit + i, hit);
+        _mm_storeu_ps(pDead + i, dead);
+    }
+    outcomeProbabilitiesScalar(headWeights + i, bodyWeights + i, size - i, scale, pDead + i, pHit + i);
+}
+
+//the operations of logarithmScalar(), four numbers at a time
+//the helpers of the information kernels are inlined, a call per vector costs
+//as much as the vector operations
+__attribute__((target("sse4.1"), always_inline))
+inline __m128 logarithmSse(__m128 x)
+{
+    const __m128i bits = _mm_castps_si128(x);
+    __m128i exponent = _mm_sub_epi32(_mm_srli_epi32(bits, 23), _mm_set1_epi32(126));
+    __m128 m = _mm_castsi128_ps(_mm_or_si128(_mm_and_si128(bits, _mm_set1_epi32(0x007fffff)), _mm_set1_epi32(0x3f000000)));
+
+    //the all ones mask of the small mantissas is -1
+    const __m128 isSmall = _mm_cmplt_ps(m, _mm_set1_ps(SqrtHalf));
+    exponent = _mm_add_epi32(exponent, _mm_castps_si128(isSmall));
+    m = _mm_sub_ps(_mm_add_ps(m, _mm_and_ps(m, isSmall)), _mm_set1_ps(1.0f));
+    const __m128 e = _mm_cvtepi32_ps(exponent);
+
+    const __m128 z = _mm_mul_ps(m, m);
+    __m128 y = _mm_set1_ps(LogPolynomial[0]);
+    for (int k = 1; k < 9; k++)
+        y = _mm_add_ps(_mm_mul_ps(y, m), _mm_set1_ps(LogPolynomial[k]));
+    y = _mm_mul_ps(_mm_mul_ps(y, m), z);
+    y = _mm_add_ps(y, _mm_mul_ps(e, _mm_set1_ps(LogTwoLow)));
+    y = _mm_add_ps(y, _mm_mul_ps(z, _mm_set1_ps(-0.5f)));
+    const __m128 result = _mm_add_ps(m, y);
+    return _mm_add_ps(result, _mm_mul_ps(e, _mm_set1_ps(LogTwoHigh)));
+}
+
+__attribute__((target("sse4.1"), always_inline))
+inline __m128 entropyTermSse(__m128 p)
+{
+    const __m128 term = _mm_mul_ps(p, logarithmSse(_mm_max_ps(p, _mm_set1_ps(MinProbability))));
+    return _mm_and_ps(term, _mm_cmpgt_ps(p, _mm_setzero_ps()));
+}
+
+//the scores of four points, their largest value among the unmarked points
+//goes to bestVector
+__attribute__((target("sse4.1"), always_inline))
+inline __m128 informationScoreSse(__m128 dead, __m128 hit, __m128i marks, float deadBonus, __m128& bestVector)
+{
+    const __m128 miss = _mm_sub_ps(_mm_sub_ps(_mm_set1_ps(1.0f), dead), hit);
+    __m128 score = _mm_mul_ps(_mm_set1_ps(deadBonus), dead);
+    score = _mm_sub_ps(score, entropyTermSse(dead));
+    score = _mm_sub_ps(score, entropyTermSse(hit));
+    score = _mm_sub_ps(score, entropyTermSse(miss));
+
+    const __m128 isGuessed = _mm_castsi128_ps(_mm_cmpeq_epi32(marks, _mm_set1_epi32(GuessedMark)));
+    bestVector = _mm_max_ps(bestVector, _mm_blendv_ps(score, _mm_set1_ps(-1.0f), isGuessed));
+    return score;
+}
+
+//the scores are written, their largest value among the unmarked points is
+//kept and its first point is searched again at the end; the last points
+//are copied to a vector padded with marked points
+__attribute__((target("sse4.1")))
+int informationScoresSse(const float* pDead, const float* pHit, const int* marks, int size, float deadBonus,
+                         float* scores)
+{
+    __m128 bestVector = _mm_set1_ps(-1.0f);
+    int i = 0;
+    for (; i + 4 <= size; i += 4) {
+        const __m128 score = informationScoreSse(_mm_loadu_ps(pDead + i), _mm_loadu_ps(pHit + i),
+                                                 _mm_loadu_si128(reinterpret_cast<const __m128i*>(marks + i)),
+                                                 deadBonus, bestVector);
+        _mm_storeu_ps(scores + i, score);
+    }
+    if (i < size) {
+        alignas(16) float dead[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+        alignas(16) float hit[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+        alignas(16) int lastMarks[4] = { GuessedMark, GuessedMark, GuessedMark, GuessedMark };
+        alignas(16) float lastScores[4];
+        std::copy(pDead + i, pDead + size, dead);
+        std::copy(pHit + i, pHit + size, hit);
+        std::copy(marks + i, marks + size, lastMarks);
+        const __m128 score = informationScoreSse(_mm_load_ps(dead), _mm_load_ps(hit),
+                                                 _mm_load_si128(reinterpret_cast<const __m128i*>(lastMarks)),
+                                                 deadBonus, bestVector);
+        _mm_store_ps(lastScores, score);
+        std::copy(lastScores, lastScores + (size - i), scores + i);
+    }
+    bestVector = _mm_max_ps(bestVector, _mm_shuffle_ps(bestVector, bestVector, _MM_SHUFFLE(1, 0, 3, 2)));
+    bestVector = _mm_max_ps(bestVector, _mm_shuffle_ps(bestVector, bestVector, _MM_SHUFFLE(2, 3, 0, 1)));
+    const float bestScore = _mm_cvtss_f32(bestVector);
+
+    if (bestScore < 0.0f)
+        return -1;
+    for (i = 0; i < size; i++)
+        if (marks[i] != GuessedMark && scores[i] == bestScore)
+            return i;
+    return -1;
+}
+
+const ChoiceKernels SseKernels = {
+    "sse4.1", incrementValidScalar, invalidateValidScalar, maxCountSse, countEqualSse, findNthSse,
+    filterRecordsSse, maxCountBatchSse, findNthBatchScalar, sumEqualSse, outcomeProbabilitiesSse,
+    informationScoresSse
+};
+
+//AVX2 versions, eight elements at a time
+//the stencil updates gather eight elements, compute them together
+//and write them back one by one as there is no scatter instruction
+
+__attribute__((target("avx2")))
+void incrementValidAvx2(int* data, const int* indices, int indexNo)
+{
+    alignas(32) int values[8];
+    const __m256i minusOne = _mm256_set1_epi32(-1);
+    int i = 0;
+    for (; i + 8 <= indexNo; i += 8) {
+        __m256i idx = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(indices + i));
+        __m256i v = _mm256_i32gather_epi32(data, idx, 4);
+        //subtracting the all ones mask of the valid elements adds one to them
+        v = _mm256_sub_epi32(v, _mm256_cmpgt_epi32(v, minusOne));
+        _mm256_store_si256(reinterpret_cast<__m256i*>(values), v);
+        for (int k = 0; k < 8; k++)
+            data[indices[i + k]] = values[k];
+    }
+    incrementValidScalar(data, indices + i, indexNo - i);
+}
+
+__attribute__((target("avx2")))
+void invalidateValidAvx2(int* data, const int* indices, int indexNo)
+{
+    alignas(32) int values[8];
+    const __m256i minusOne = _mm256_set1_epi32(-1);
+    int i = 0;
+    for (; i + 8 <= indexNo; i += 8) {
+        __m256i idx = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(indices + i));
+        __m256i v = _mm256_i32gather_epi32(data, idx, 4);
+        //or-ing the all ones mask of the valid elements makes them -1
+        v = _mm256_or_si256(v, _mm256_cmpgt_epi32(v, minusOne));
+        _mm256_store_si256(reinterpret_cast<__m256i*>(values), v);
+        for (int k = 0; k < 8; k++)
+            data[indices[i + k]] = values[k];
+    }
+    invalidateValidScalar(data, indices + i, indexNo - i);
+}
+
+__attribute__((target("avx2")))
+int countEqualAvx2(const int* data, int size, int value)
+{
+    const __m256i valueVector = _mm256_set1_epi32(value);
+    int count = 0;
+    for (int i = 0; i < size; i += 8) {
+        __m256i equal = _mm256_cmpeq_epi32(_mm256_load_si256(reinterpret_cast<const __m256i*>(data + i)), valueVector);
+        count += __builtin_popcount(_mm256_movemask_ps(_mm256_castsi256_ps(equal)));
+    }
+    return count;
+}
+
+__attribute__((target("avx2")))
+int maxCountAvx2(const int* data, int size, int& count)
+{
+    __m256i maxVector = _mm256_load_si256(reinterpret_cast<const __m256i*>(data));
+    for (int i = 8; i < size; i += 8)
+        maxVector = _mm256_max_epi32(maxVector, _mm256_load_si256(reinterpret_cast<const __m256i*>(data + i)));
+    __m128i half = _mm_max_epi32(_mm256_castsi256_si128(maxVector), _mm256_extracti128_si256(maxVector, 1));
+    half = _mm_max_epi32(half, _mm_shuffle_epi32(half, _MM_SHUFFLE(1, 0, 3, 2)));
+    half = _mm_max_epi32(half, _mm_shuffle_epi32(half, _MM_SHUFFLE(2, 3, 0, 1)));
+    int maxValue = _mm_cvtsi128_si32(half);
+
+    count = countEqualAvx2(data, size, maxValue);
+    return maxValue;
+}
+
+__attribute__((target("avx2")))
+int findNthAvx2(const int* data, int size, int value, int nth)
+{
+    const __m256i valueVector = _mm256_set1_epi32(value);
+    for (int i = 0; i < size; i += 8) {
+        __m256i equal = _mm256_cmpeq_epi32(_mm256_load_si256(reinterpret_cast<const __m256i*>(data + i)), valueVector);
+        int mask = _mm256_movemask_ps(_mm256_castsi256_ps(equal));
+        int found = __builtin_popcount(mask);
+        if (nth < found)
+            return i + nthBit(mask, nth);
+        nth -= found;
+    }
+    return -1;
+}
+
+//a record is one vector
+__attribute__((target("avx2")))
+int filterRecordsAvx2(const uint64_t* records, const int* indices, int indexNo,
+                      const uint64_t* clearMask, const uint64_t* setMask, int* survivors)
+{
+    const __m256i clear = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(clearMask));
+    const __m256i set = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(setMask));
+
+    int survivorNo = 0;
+    for (int i = 0; i < indexNo; i++) {
+        const int index = indices ? indices[i] : i;
+        const __m256i record = _mm256_load_si256(reinterpret_cast<const __m256i*>(records + index * ChoiceKernels::RecordWords));
+        survivors[survivorNo] = index;
+        survivorNo += _mm256_testz_si256(record, clear) & _mm256_testc_si256(record, set);
+    }
+    return survivorNo;
+}
+
+//the running maximum and count of VectorNo times sixteen games; the vectors
+//are independent, their latencies overlap
+template<int VectorNo>
+__attribute__((target("avx2")))
+void maxCountBlockAvx2(const int16_t* scores, int positionNo, int gameStride, int16_t* maxScores, int16_t* counts)
+{
+    const __m256i one = _mm256_set1_epi16(1);
+    __m256i maxVectors[VectorNo];
+    __m256i countVectors[VectorNo];
+#pragma GCC unroll 4
+    for (int v = 0; v < VectorNo; v++) {
+        maxVectors[v] = _mm256_load_si256(reinterpret_cast<const __m256i*>(scores + v * 16));
+        countVectors[v] = _mm256_setzero_si256();
+    }
+    for (int position = 0; position < positionNo; position++) {
+        const int16_t* row = scores + position * gameStride;
+#pragma GCC unroll 4
+        for (int v = 0; v < VectorNo; v++) {
+            const __m256i score = _mm256_load_si256(reinterpret_cast<const __m256i*>(row + v * 16));
+            const __m256i greater = _mm256_cmpgt_epi16(score, maxVectors[v]);
+            maxVectors[v] = _mm256_max_epi16(maxVectors[v], score);
+            countVectors[v] = _mm256_andnot_si256(greater, countVectors[v]);
+            countVectors[v] = _mm256_add_epi16(countVectors[v], _mm256_and_si256(_mm256_cmpeq_epi16(score, maxVectors[v]), one));
+        }
+    }
+#pragma GCC unroll 4
+    for (int v = 0; v < VectorNo; v++) {
+        _mm256_store_si256(reinterpret_cast<__m256i*>(maxScores + v * 16), maxVectors[v]);
+        _mm256_store_si256(reinterpret_cast<__m256i*>(counts + v * 16), countVectors[v]);
+    }
+}
+
+//sixty four games at a time, then sixteen
+__attribute__((target("avx2")))
+void maxCountBatchAvx2(const int16_t* scores, int positionNo, int gameNo, int gameStride, int16_t* maxScores,
+                       int16_t* counts)
+{
+    int game = 0;
+    for (; game + 64 <= gameNo; game += 64)
+        maxCountBlockAvx2<4>(scores + game, positionNo, gameStride, maxScores + game, counts + game);
+    for (; game < gameNo; game += 16)
+        maxCountBlockAvx2<1>(scores + game, positionNo, gameStride, maxScores + game, counts + game);
+}
+
+//the positions with the value are counted for VectorNo times sixteen games,
+//the position is taken when the count reaches nth
+template<int VectorNo>
+__attribute__((target("avx2")))
+void findNthBlockAvx2(const int16_t* scores, int positionNo, int gameStride, const int16_t* values, const int16_t* nth,
+                      int16_t* positions)
+{
+    const __m256i one = _mm256_set1_epi16(1);
+    __m256i valueVectors[VectorNo];
+    __m256i wantedVectors[VectorNo];
+    __m256i seenVectors[VectorNo];
+    __m256i foundVectors[VectorNo];
+#pragma GCC unroll 4
+    for (int v = 0; v < VectorNo; v++) {
+        valueVectors[v] = _mm256_load_si256(reinterpret_cast<const __m256i*>(values + v * 16));
+        wantedVectors[v] = _mm256_load_si256(reinterpret_cast<const __m256i*>(nth + v * 16));
+        seenVectors[v] = _mm256_setzero_si256();
+        foundVectors[v] = _mm256_set1_epi16(-1);
+    }
+    for (int position = 0; position < positionNo; position++) {
+        const int16_t* row = scores + position * gameStride;
+        const __m256i positionVector = _mm256_set1_epi16(static_cast<short>(position));
+#pragma GCC unroll 4
+        for (int v = 0; v < VectorNo; v++) {
+            const __m256i score = _mm256_load_si256(reinterpret_cast<const __m256i*>(row + v * 16));
+            const __m256i equal = _mm256_cmpeq_epi16(score, valueVectors[v]);
+            const __m256i take = _mm256_and_si256(equal, _mm256_cmpeq_epi16(seenVectors[v], wantedVectors[v]));
+            foundVectors[v] = _mm256_blendv_epi8(foundVectors[v], positionVector, take);
+            seenVectors[v] = _mm256_add_epi16(seenVectors[v], _mm256_and_si256(equal, one));
+        }
+    }
+#pragma GCC unroll 4
+    for (int v = 0; v < VectorNo; v++)
+        _mm256_store_si256(reinterpret_cast<__m256i*>(positions + v * 16), foundVectors[v]);
+}
+
+__attribute__((target("avx2")))
+void findNthBatchAvx2(const int16_t* scores, int positionNo, int gameNo, int gameStride, const int16_t* values,
+                      const int16_t* nth, int16_t* positions)
+{
+    int game = 0;
+    for (; game + 64 <= gameNo; game += 64)
+        findNthBlockAvx2<4>(scores + game, positionNo, gameStride, values + game, nth + game, positions + game);
+    for (; game < gameNo; game += 16)
+        findNthBlockAvx2<1>(scores + game, positionNo, gameStride, values + game, nth + game, positions + game);
+}
+
+__attribute__((target("avx2")))
+int sumEqualAvx2(const int* keys, const int* values, int size, int key, int64_t& sum)
+{
+    const __m256i keyVector = _mm256_set1_epi32(key);
+    __m256i sumVector = _mm256_setzero_si256();
+    int count = 0;
+    int i = 0;
+    for (; i + 8 <= size; i += 8) {
+        const __m256i equal = _mm256_cmpeq_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(keys + i)), keyVector);
+        const __m256i selected = _mm256_and_si256(equal, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(values + i)));
+        sumVector = _mm256_add_epi64(sumVector, _mm256_cvtepi32_epi64(_mm256_castsi256_si128(selected)));
+        sumVector = _mm256_add_epi64(sumVector, _mm256_cvtepi32_epi64(_mm256_extracti128_si256(selected, 1)));
+        count += __builtin_popcount(_mm256_movemask_ps(_mm256_castsi256_ps(equal)));
+    }
+    alignas(32) int64_t lanes[4];
+    _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), sumVector);
+    int64_t rest = 0;
+    count += sumEqualScalar(keys + i, values + i, size - i, key, rest);
+    sum = lanes[0] + lanes[1] + lanes[2] + lanes[3] + rest;
+    return count;
+}
+
+__attribute__((target("avx2")))
+void outcomeProbabilitiesAvx2(const float* headWeights, const float* bodyWeights, int size, float scale,
+                              float* pDead, float* pHit)
+{
+    const __m256 scaleVector = _mm256_set1_ps(scale);
+    const __m256 one = _mm256_set1_ps(1.0f);
+    int i = 0;
+    for (; i + 8 <= size; i += 8) {
+        const __m256 dead = _mm256_min_ps(_mm256_mul_ps(_mm256_loadu_ps(headWeights + i), scaleVector), one);
+        const __m256 hit = _mm256_min_ps(_mm256_mul_ps(_mm256_loadu_ps(bodyWeights + i), scaleVector),
+                                         _mm256_sub_ps(one, dead));
+        _mm256_storeu_ps(pHit + i, hit);
+        _mm256_storeu_ps(pDead + i, dead);
+    }
+    outcomeProbabilitiesScalar(headWeights + i, bodyWeights + i, size - i, scale, pDead + i, pHit + i);
+}
+
+//the operations of logarithmScalar(), eight numbers at a time
+//there are no fused multiply-adds, they would round differently
+__attribute__((target("avx2"), always_inline))
+inline __m256 logarithmAvx2(__m256 x)
+{
+    const __m256i bits = _mm256_castps_si256(x);
+    __m256i exponent = _mm256_sub_epi32(_mm256_srli_epi32(bits, 23), _mm256_set1_epi32(126));
+    __m256 m = _mm256_castsi256_ps(_mm256_or_si256(_mm256_and_si256(bits, _mm256_set1_epi32(0x007fffff)),
+                                                   _mm256_set1_epi32(0x3f000000)));
+
+    const __m256 isSmall = _mm256_cmp_ps(m, _mm256_set1_ps(SqrtHalf), _CMP_LT_OQ);
+    exponent = _mm256_add_epi32(exponent, _mm256_castps_si256(isSmall));
+    m = _mm256_sub_ps(_mm256_add_ps(m, _mm256_and_ps(m, isSmall)), _mm256_set1_ps(1.0f));
+    const __m256 e = _mm256_cvtepi32_ps(exponent);
+
+    const __m256 z = _mm256_mul_ps(m, m);
+    __m256 y = _mm256_set1_ps(LogPolynomial[0]);
+    for (int k = 1; k < 9; k++)
+        y = _mm256_add_ps(_mm256_mul_ps(y, m), _mm256_set1_ps(LogPolynomial[k]));
+    y = _mm256_mul_ps(_mm256_mul_ps(y, m), z);
+    y = _mm256_add_ps(y, _mm256_mul_ps(e, _mm256_set1_ps(LogTwoLow)));
+    y = _mm256_add_ps(y, _mm256_mul_ps(z, _mm256_set1_ps(-0.5f)));
+    const __m256 result = _mm256_add_ps(m, y);
+    return _mm256_add_ps(result, _mm256_mul_ps(e, _mm256_set1_ps(LogTwoHigh)));
+}
+
+__attribute__((target("avx2"), always_inline))
+inline __m256 entropyTermAvx2(__m256 p)
+{
+    const __m256 term = _mm256_mul_ps(p, logarithmAvx2(_mm256_max_ps(p, _mm256_set1_ps(MinProbability))));
+    return _mm256_and_ps(term, _mm256_cmp_ps(p, _mm256_setzero_ps(), _CMP_GT_OQ));
+}
+
+__attribute__((target("avx2"), always_inline))
+inline __m256 informationScoreAvx2(__m256 dead, __m256 hit, __m256i marks, float deadBonus, __m256& bestVector)
+{
+    const __m256 miss = _mm256_sub_ps(_mm256_sub_ps(_mm256_set1_ps(1.0f), dead), hit);
+    __m256 score = _mm256_mul_ps(_mm256_set1_ps(deadBonus), dead);
+    score = _mm256_sub_ps(score, entropyTermAvx2(dead));
+    score = _mm256_sub_ps(score, entropyTermAvx2(hit));
+    score = _mm256_sub_ps(score, entropyTermAvx2(miss));
+
+    const __m256 isGuessed = _mm256_castsi256_ps(_mm256_cmpeq_epi32(marks, _mm256_set1_epi32(GuessedMark)));
+    bestVector = _mm256_max_ps(bestVector, _mm256_blendv_ps(score, _mm256_set1_ps(-1.0f), isGuessed));
+    return score;
+}
+
+__attribute__((target("avx2")))
+int informationScoresAvx2(const float* pDead, const float* pHit, const int* marks, int size, float deadBonus,
+                          float* scores)
+{
+    __m256 bestVector = _mm256_set1_ps(-1.0f);
+    int i = 0;
+    for (; i + 8 <= size; i += 8) {
+        const __m256 score = informationScoreAvx2(_mm256_loadu_ps(pDead + i), _mm256_loadu_ps(pHit + i),
+                                                  _mm256_loadu_si256(reinterpret_cast<const __m256i*>(marks + i)),
+                                                  deadBonus, bestVector);
+        _mm256_storeu_ps(scores + i, score);
+    }
+    if (i < size) {
+        alignas(32) float dead[8] = { 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f };
+        alignas(32) float hit[8] = { 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f };
+        alignas(32) int lastMarks[8] = { GuessedMark, GuessedMark, GuessedMark, GuessedMark,
+                                         GuessedMark, GuessedMark, GuessedMark, GuessedMark };
+        alignas(32) float lastScores[8];
+        std::copy(pDead + i, pDead + size, dead);
+        std::copy(pHit + i, pHit + size, hit);
+        std::copy(marks + i, marks + size, lastMarks);
+        const __m256 score = informationScoreAvx2(_mm256_load_ps(dead), _mm256_load_ps(hit),
+                                                  _mm256_load_si256(reinterpret_cast<const __m256i*>(lastMarks)),
+                                                  deadBonus, bestVector);
+        _mm256_store_ps(lastScores, score);
+        std::copy(lastScores, lastScores + (size - i), scores + i);
+    }
+    __m128 half = _mm_max_ps(_mm256_castps256_ps128(bestVector), _mm256_extractf128_ps(bestVector, 1));
+    half = _mm_max_ps(half, _mm_shuffle_ps(half, half, _MM_SHUFFLE(1, 0, 3, 2)));
+    half = _mm_max_ps(half, _mm_shuffle_ps(half, half, _MM_SHUFFLE(2, 3, 0, 1)));
+    const float bestScore = _mm_cvtss_f32(half);
+
+    if (bestScore < 0.0f)
+        return -1;
+    for (i = 0; i < size; i++)
+        if (marks[i] != GuessedMark && scores[i] == bestScore)
+            return i;
+    return -1;
+}
+
+const ChoiceKernels Avx2Kernels = {
+    "avx2", incrementValidAvx2, invalidateValidAvx2, maxCountAvx2, countEqualAvx2, findNthAvx2,
+    filterRecordsAvx2, maxCountBatchAvx2, findNthBatchAvx2, sumEqualAvx2, outcomeProbabilitiesAvx2,
+    informationScoresAvx2
+};
+
+#endif
+
+//the best kernels for the processor
+const ChoiceKernels* bestKernels()
+{
+#ifdef CHOICEKERNELS_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+        return &Avx2Kernels;
+    if (__builtin_cpu_supports("sse4.1"))
+        return &SseKernels;
+#endif
+    return &ScalarKernels;
+}
+
+const ChoiceKernels*& activeKernels()
+{
+    static const ChoiceKernels* kernels = bestKernels();
+    return kernels;
+}
+
+}
+
+//the kernels used by the program
+const ChoiceKernels& ChoiceKernels::active()
+{
+    return *activeKernels();
+}
+
+//the kernels for an instruction set
+const ChoiceKernels* ChoiceKernels::forName(const char* name)
+{
+    if (std::strcmp(name, ScalarKernels.m_name) == 0)
+        return &ScalarKernels;
+#ifdef CHOICEKERNELS_X86
+    __builtin_cpu_init();
+    if (std::strcmp(name, SseKernels.m_name) == 0 && __builtin_cpu_supports("sse4.1"))
+        return &SseKernels;
+    if (std::strcmp(name, Avx2Kernels.m_name) == 0 && __builtin_cpu_supports("avx2"))
+        return &Avx2Kernels;
+#endif
+    return nullptr;
+}
+
+//changes the kernels used by the program
+bool ChoiceKernels::select(const char* name)
+{
+    const ChoiceKernels* kernels = forName(name);
+    if (kernels == nullptr)
+        return false;
+
+    activeKernels() = kernels;
+    return true;
+}
@@ -0,0 +1,93 @@
+#ifndef CHOICEKERNELS_H
+#define CHOICEKERNELS_H
+
+#include <cstdint>
+
+//The loops of the computer's logic over the lanes of a ChoiceMap,
+//over the records of a ConfigurationDatabase, over the games of a BatchEngine,
+//over the columns of a StatisticsStore and over the grid points scored by
+//the information gain mode.
+//Each loop has a scalar version and, on x86 with GCC or Clang, SSE4.1 and
+//AVX2 versions; the best version the processor supports is chosen when the
+//program starts. All versions give the same results.
+//
+//The data arrays are aligned on 32 bytes and their size is a multiple of
+//PlaneStencils::LaneAlignment, so the vector loops have no remainder.
+//The configuration records are aligned on 32 bytes as well.
+struct ChoiceKernels
+{
+    //the 64 bit words of a configuration record: the points covered by the
+    //planes and the heads, 128 bits each
+    static const int RecordWords = 4;
+    //the number of games the batch kernels take at a time
+    static const int BatchAlignment = 16;
+
+    //name of the instruction set: "scalar", "sse4.1" or "avx2"
+    const char* m_name;
+
+    //adds one to the elements at the given indices that are not negative
+    //the indices must be different from each other
+    void (*m_incrementValid)(int* data, const int* indices, int indexNo);
+    //sets to -1 the elements at the given indices that are not negative
+    void (*m_invalidateValid)(int* data, const int* indices, int indexNo);
+    //returns the largest element and the number of elements equal to it
+    int (*m_maxCount)(const int* data, int size, int& count);
+    //returns the number of elements equal to value
+    int (*m_countEqual)(const int* data, int size, int value);
+    //returns the index of the element equal to value that is preceded by nth such
+    //elements, or -1 if there are not so many
+    int (*m_findNth)(const int* data, int size, int value, int nth);
+    //keeps the records having none of the bits of clearMask and all the bits of setMask
+    //the records tested are those at the given indices, or the first indexNo records
+    //if indices is nullptr; writes the indices of the records kept to survivors,
+    //which may be the same array as indices, and returns their number
+    int (*m_filterRecords)(const uint64_t* records, const int* indices, int indexNo,
+                           const uint64_t* clearMask, const uint64_t* setMask, int* survivors);
+
+    //the batch kernels work on 16 bit scores with one row per plane position
+    //and one column per game, the rows are gameStride apart; they go over the
+    //first gameNo columns, so that a block of games can be given with the
+    //arrays offset to its first game; gameNo and gameStride are multiples of
+    //BatchAlignment
+
+    //the largest score of each game and the number of positions having it
+    void (*m_maxCountBatch)(const int16_t* scores, int positionNo, int gameNo, int gameStride, int16_t* maxScores,
+                            int16_t* counts);
+    //for each game the position with the score values[game] preceded by
+    //nth[game] such positions, or -1 if there are not so many
+    void (*m_findNthBatch)(const int16_t* scores, int positionNo, int gameNo, int gameStride, const int16_t* values,
+                           const int16_t* nth, int16_t* positions);
+
+    //the aggregate kernel works on columns read from files: the arrays need
+    //no alignment and size can be any number
+
+    //returns the number of elements of keys equal to key and writes to sum
+    //the sum of the elements of values at their positions
+    int (*m_sumEqual)(const int* keys, const int* values, int size, int key, int64_t& sum);
+
+    //the information kernels work on one element per grid point: the arrays
+    //need no alignment and size can be any number
+
+    //writes pDead = min(1, headWeights * scale) and pHit = min(1 - pDead, bodyWeights * scale);
+    //pDead and pHit may be the same arrays as headWeights and bodyWeights
+    void (*m_outcomeProbabilities)(const float* headWeights, const float* bodyWeights, int size, float scale,
+                                   float* pDead, float* pHit);
+    //writes the information score of each point: deadBonus * pDead plus the
+    //entropy of the dead, hit and miss results; the logarithm is a polynomial
+    //that all the versions compute with the same operations
+    //returns the first point with the largest score among those whose element
+    //of marks is not -2, or -1 if there is none; scores may be the same array as pDead
+    int (*m_informationScores)(const float* pDead, const float* pHit, const int* marks, int size, float deadBonus,
+                               float* scores);
+
+    //the kernels used by the program
+    static const ChoiceKernels& active();
+    //the kernels for an instruction set; returns nullptr if the name is unknown
+    //or the processor does not support the instruction set
+    static const ChoiceKernels* forName(const char* name);
+    //changes the kernels used by the program, returns false if they are not available
+    //meant for benchmarks; must not be called while games are played
+    static bool select(const char* name);
+};
+
+#endif // CHOICEKERNELS_H
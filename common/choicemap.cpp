@@ -0,0 +1,113 @@
+#include "choicemap.h"
+#include "choicekernels.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+//constructor
+//the storage has room for aligning the lanes
+ChoiceMap::ChoiceMap(const PlaneStencils& stencils):
+    m_stencils(stencils),
+    m_storage(stencils.laneSize() + PlaneStencils::LaneAlignment)
+{
+    std::uintptr_t address = reinterpret_cast<std::uintptr_t>(m_storage.data());
+    std::uintptr_t aligned = (address + 31) & ~static_cast<std::uintptr_t>(31);
+    m_data = m_storage.data() + (aligned - address) / sizeof(int);
+    reset();
+}
+
+//the scores of the beginning of a game
+void ChoiceMap::reset()
+{
+    std::memcpy(m_data, m_stencils.laneBaseline(), laneSize() * sizeof(int));
+}
+
+//copies the scores of another map
+void ChoiceMap::assign(const ChoiceMap& other)
+{
+    if (other.laneSize() != laneSize())
+        return;
+    std::memcpy(m_data, other.m_data, laneSize() * sizeof(int));
+}
+
+//writes the four lanes one after the other
+void ChoiceMap::saveState(SnapshotWriter& writer) const
+{
+    const int pointNo = m_stencils.pointNo();
+    int8_t scores[256];
+    for (int lane = 0; lane < 4; lane++) {
+        const int* data = m_data + lane * laneStride();
+        for (int start = 0; start < pointNo; start += 256) {
+            const int n = std::min(256, pointNo - start);
+            for (int i = 0; i < n; i++)
+                scores[i] = static_cast<int8_t>(data[start + i]);
+            writer.writeArray(scores, n);
+        }
+    }
+}
+
+//the padding of the lanes is never changed, it keeps its -1
+bool ChoiceMap::restoreState(SnapshotReader& reader)
+{
+    const int pointNo = m_stencils.pointNo();
+    const int8_t* scores = reinterpret_cast<const int8_t*>(reader.data());
+    if (!reader.skip(4 * pointNo))
+        return false;
+    for (int lane = 0; lane < 4; lane++) {
+        int* data = m_data + lane * laneStride();
+        for (int i = 0; i < pointNo; i++)
+            data[i] = scores[lane * pointNo + i];
+    }
+    return true;
+}
+
+//marks the four plane positions with the head on the point as guessed
+void ChoiceMap::markGuessed(int point)
+{
+    const int stride = laneStride();
+    for (int i = 0; i < 4; i++)
+        m_data[i * stride + point] = -2;
+}
+
+//makes a plane position impossible if it is not guessed
+void ChoiceMap::invalidate(int position)
+{
+    int& value = m_data[m_stencils.toLane(position)];
+    if (value >= 0)
+        value = -1;
+}
+
+//increments the scores of the valid positions covering a point
+void ChoiceMap::incrementCovers(int point)
+{
+    const int* begin = m_stencils.laneCoversBegin(point);
+    ChoiceKernels::active().m_incrementValid(m_data, begin, static_cast<int>(m_stencils.laneCoversEnd(point) - begin));
+}
+
+//makes impossible the valid positions covering a point
+void ChoiceMap::invalidateCovers(int point)
+{
+    const int* begin = m_stencils.laneCoversBegin(point);
+    ChoiceKernels::active().m_invalidateValid(m_data, begin, static_cast<int>(m_stencils.laneCoversEnd(point) - begin));
+}
+
+//the largest score and the number of positions having it
+//the padding is -1 and is counted when no position is possible
+int ChoiceMap::maxScore(int& count) const
+{
+    return ChoiceKernels::active().m_maxCount(m_data, laneSize(), count);
+}
+
+//the number of positions with the given score
+//the padding is -1 and is counted for -1
+int ChoiceMap::count(int score) const
+{
+    return ChoiceKernels::active().m_countEqual(m_data, laneSize(), score);
+}
+
+//the plane position with the given score preceded by nth such positions
+int ChoiceMap::findNth(int score, int nth) const
+{
+    int lane = ChoiceKernels::active().m_findNth(m_data, laneSize(), score, nth);
+    return lane == -1 ? -1 : m_stencils.fromLane(lane);
+}
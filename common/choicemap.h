@@ -0,0 +1,71 @@
+#ifndef CHOICEMAP_H
+#define CHOICEMAP_H
+
+#include "planestencils.h"
+#include "snapshotstream.h"
+#include <vector>
+
+//The scores of the plane positions used by the computer's logic.
+//The values have the meaning described for ComputerLogic:
+//-2 for positions whose head was guessed, -1 for impossible positions,
+//and otherwise the number of hits supporting the position.
+//
+//The scores are kept in lanes, one for each orientation, in the order of the
+//grid points (see PlaneStencils). The lanes are aligned and padded with -1 so
+//that the loops over the whole map and along the influence stencils run in
+//the vector kernels of ChoiceKernels.
+//Positions are given to the public functions with the numbering of
+//ComputerLogic::mapPlaneToIndex unless the name says lane.
+class ChoiceMap
+{
+    const PlaneStencils& m_stencils;
+    //the storage; m_data is its first element aligned on 32 bytes
+    std::vector<int> m_storage;
+    int* m_data;
+
+public:
+    explicit ChoiceMap(const PlaneStencils& stencils);
+
+    //the scores of the beginning of a game
+    void reset();
+    //copies the scores of another map for the same grid size
+    void assign(const ChoiceMap& other);
+    //writes the scores of the lanes without the padding, one byte each:
+    //the scores are at least -2 and at most the number of points of a plane
+    void saveState(SnapshotWriter& writer) const;
+    //reads the scores written by saveState() for the same grid size
+    bool restoreState(SnapshotReader& reader);
+
+    //the score of a plane position
+    int operator[](int position) const { return m_data[m_stencils.toLane(position)]; }
+    //whether a guess has been made at a grid point
+    bool isGuessed(int point) const { return m_data[point] == -2; }
+
+    //marks the four plane positions with the head on the point as guessed
+    void markGuessed(int point);
+    //makes a plane position impossible if it is not guessed
+    void invalidate(int position);
+    //increments the scores of the valid positions covering a point
+    void incrementCovers(int point);
+    //makes impossible the valid positions covering a point
+    void invalidateCovers(int point);
+
+    //the largest score and the number of positions having it
+    int maxScore(int& count) const;
+    //the number of positions with the given score
+    int count(int score) const;
+    //the plane position with the given score that is preceded by nth
+    //such positions in lane order, or -1; the score must not be negative
+    int findNth(int score, int nth) const;
+
+    //the lanes, laneSize() elements
+    const int* lanes() const { return m_data; }
+    int laneSize() const { return m_stencils.laneSize(); }
+    int laneStride() const { return m_stencils.laneStride(); }
+
+private:
+    ChoiceMap(const ChoiceMap&) = delete;
+    ChoiceMap& operator=(const ChoiceMap&) = delete;
+};
+
+#endif // CHOICEMAP_H
@@ -1,20 +1,19 @@
 TEMPLATE = lib
 
-SOURCES += plane.cpp \
-    computerlogic.cpp \
-    planegrid.cpp \
+INCLUDEPATH += $$PWD
+DEPENDPATH += $$PWD
+
+#the game logic, from the headless library
+win32:CONFIG(release, debug|release): LIBS += -L$$OUT_PWD/planescore/release/ -lplanescore
+else:win32:CONFIG(debug, debug|release): LIBS += -L$$OUT_PWD/planescore/debug/ -lplanescore
+else:unix: LIBS += -L$$OUT_PWD/planescore/ -lplanescore -lpthread
+
+#the Qt classes on top of the game logic
+SOURCES += planegrid.cpp \
     planesmodel.cpp \
-    guesspoint.cpp \
-    planeiterators.cpp \
-    gamestatistics.cpp \
-    planeround.cpp
-HEADERS += plane.h \
-    computerlogic.h \
-    listiterator.h \
-    planegrid.h \
+    planeround.cpp \
+    computermoveworker.cpp
+HEADERS += planegrid.h \
     planesmodel.h \
-    guesspoint.h \
-    planeiterators.h \
-    gamestatistics.h \
-    planeround.h
-
+    planeround.h \
+    computermoveworker.h
@@ -1,54 +1,60 @@
 #include "computerlogic.h"
-#include <QDebug>
+#include "strategypolicies.h"
+#include "expertsearch.h"
+#include "endgamesolver.h"
+#include "choicekernels.h"
 #include <algorithm>
-#include <QPoint>
+#include <cmath>
 
 //default constructor
 PlaneOrientationData::PlaneOrientationData()
 {
-    m_plane = Plane(0, 0, (Plane::Orientation)0);
+    m_plane = 0;
     m_discarded = true;
-    m_pointsNotTested.clear();
+    m_pointsNotTestedNo = 0;
 }
 
 //useful constructor
-PlaneOrientationData::PlaneOrientationData(const Plane& pl, bool isDiscarded):
-    m_plane(pl),
-    m_discarded(isDiscarded)
+PlaneOrientationData::PlaneOrientationData(const PlaneStencils& stencils, PlaneId plane):
+    m_plane(plane),
+    m_discarded(!stencils.isValid(plane)),
+    m_pointsNotTestedNo(0)
 {
-    PlanePointIterator ppi(m_plane);
+    if(m_discarded)
+        return;
 
     //all points of the plane besides the head are not tested yet
-    ppi.next();
-
-    while(ppi.hasNext())
-    {
-        m_pointsNotTested.append(ppi.next());
-    }
+    const CellId* footprint = stencils.footprint(plane);
+    for(int k = 1; k < PlaneStencils::PlanePointsNo; k++)
+        m_pointsNotTested[m_pointsNotTestedNo++] = footprint[k];
 }
 
 //copy constructor
 PlaneOrientationData::PlaneOrientationData(const PlaneOrientationData& pod):
     m_plane(pod.m_plane),
     m_discarded(pod.m_discarded),
-    m_pointsNotTested(pod.m_pointsNotTested) {
+    m_pointsNotTestedNo(pod.m_pointsNotTestedNo) {
+    for(int i = 0; i < m_pointsNotTestedNo; i++)
+        m_pointsNotTested[i] = pod.m_pointsNotTested[i];
 }
 //assignment operator
 void PlaneOrientationData::operator=(const PlaneOrientationData &pod)
 {
     m_plane = pod.m_plane;
     m_discarded = pod.m_discarded;
-    m_pointsNotTested = pod.m_pointsNotTested;
+    m_pointsNotTestedNo = pod.m_pointsNotTestedNo;
+    for(int i = 0; i < m_pointsNotTestedNo; i++)
+        m_pointsNotTested[i] = pod.m_pointsNotTested[i];
 }
 
-void PlaneOrientationData::update(const GuessPoint &gp)
+void PlaneOrientationData::update(CellId cell, GuessPoint::Type type)
 {
     //if plane is discarded return
     if(m_discarded)
         return;
 
     //find the guess point in the list of points not tested
-    int idx = m_pointsNotTested.indexOf(QPoint(gp.m_row, gp.m_col));
+    int idx = indexOfPointNotTested(cell);
 
     //if point not found return
     if(idx == -1)
@@ -56,55 +62,60 @@ void PlaneOrientationData::update(const GuessPoint &gp)
 
     //if point found
     //if dead and idx = 0 remove the head from the list of untested points
-    if(gp.m_type == GuessPoint::Dead && idx == 0)
+    if(type == GuessPoint::Dead && idx == 0)
     {
-        m_pointsNotTested.removeAt(idx);
+        removePointNotTested(idx);
         return ;
     }
 
     //if miss or dead discard plane
-    if(gp.m_type == GuessPoint::Miss || gp.m_type == GuessPoint::Dead)
+    if(type == GuessPoint::Miss || type == GuessPoint::Dead)
         m_discarded = true;
 
     //if hit take point out of the list of points not tested
-    if(gp.m_type == GuessPoint::Hit)
-        m_pointsNotTested.removeAt(idx);
+    if(type == GuessPoint::Hit)
+        removePointNotTested(idx);
 }
 
 //checks to see that all points on the plane were tested
 bool PlaneOrientationData::areAllPointsChecked()
 {
-    return (m_pointsNotTested.size() == 0);
+    return (m_pointsNotTestedNo == 0);
+}
+
+//finds the position of a point in the list of points not tested
+int PlaneOrientationData::indexOfPointNotTested(CellId cell) const
+{
+    for(int i = 0; i < m_pointsNotTestedNo; i++)
+        if(m_pointsNotTested[i] == cell)
+            return i;
+    return -1;
+}
+
+//removes a point from the list of points not tested
+//the order of the remaining points is kept
+void PlaneOrientationData::removePointNotTested(int idx)
+{
+    for(int i = idx; i < m_pointsNotTestedNo - 1; i++)
+        m_pointsNotTested[i] = m_pointsNotTested[i + 1];
+    m_pointsNotTestedNo--;
 }
 
 //constructs the head data structure
-//m_row and m_col give the size of the grid
-//m_headRow and m_headCol
-//are the positions of the planes head
+//m_head is the position of the planes head
 //m_correctOrient is the orientation of the plane
-HeadData::HeadData(int row, int col, int headRow, int headCol):
-    m_row(row),
-    m_col(col),
-    m_headRow(headRow),
-    m_headCol(headCol),
+//the orientations for which the plane is not inside the grid are discarded
+HeadData::HeadData(const PlaneStencils& stencils, CellId head):
+    m_head(head),
     m_correctOrient(-1)
 {
-
+    //create the four planes for each head position
     for(int i = 0;i < 4; i++)
-    {
-        Plane pl(m_headRow, m_headCol, (Plane::Orientation)i);
-        //create the four planes for each head position
-        m_options[i] = PlaneOrientationData(pl, false);
-
-        if(!pl.isPositionValid(m_row, m_col))
-            m_options[i].m_discarded = true;
-    }
-    //check which of the four possible orientation is a valid position
-    //for the invalid positions mark that orientation as discarded
+        m_options[i] = PlaneOrientationData(stencils, PlaneStencils::planeId(m_head, i));
 }
 
 //update a head data structure with a guess
-bool HeadData::update(const GuessPoint& gp)
+bool HeadData::update(CellId cell, GuessPoint::Type type)
 {
     //if the head data is already conclusive ignore
     if(m_correctOrient != -1)
@@ -112,8 +123,28 @@ bool HeadData::update(const GuessPoint& gp)
 
     //update the four plane positions with this new data
     for(int i = 0;i < 4; i++)
-        m_options[i].update(gp);
+        m_options[i].update(cell, type);
+
+    return decideOrientation();
+}
+
+//discards the orientations that are not in the mask
+bool HeadData::restrictOrientations(int mask)
+{
+    //if the head data is already conclusive ignore
+    if(m_correctOrient != -1)
+        return true;
+
+    for(int i = 0;i < 4; i++)
+        if(!(mask & (1 << i)))
+            m_options[i].m_discarded = true;
+
+    return decideOrientation();
+}
 
+//decides the orientation of the plane if the data is conclusive
+bool HeadData::decideOrientation()
+{
     //verify if we checked all points of a plane
     for(int i = 0;i < 4; i++)
     {
@@ -151,18 +182,42 @@ ComputerLogic::ComputerLogic(int row, int col, int planeno):
     m_row(row),
     m_col(col),
     maxChoiceNo(row * col * 4),
-    m_planeNo(planeno)
+    m_planeNo(planeno),
+    m_guessedPlaneList(ArenaAllocator<Plane>(&m_arena)),
+    m_headDataList(ArenaAllocator<HeadData>(&m_arena)),
+    m_guessesList(ArenaAllocator<GuessPoint>(&m_arena)),
+    m_extendedGuessesList(ArenaAllocator<GuessPoint>(&m_arena)),
+    m_stencils(PlaneStencils::forGrid(row, col)),
+    m_choices(m_stencils),
+    m_propagator(m_stencils, planeno),
+    m_headWeights(row * col),
+    m_bodyWeights(row * col),
+    m_cancelRequested(false)
 {
-    //creates the tables of choices
-    m_choices = new int[maxChoiceNo];
-    m_zero_choices = new int[maxChoiceNo/4];
-
     //initializes the table of choices and the head data
     reset();
 
-    //initializes the iterator that generates all the planes that pass
-    //through (0,0)
-    m_pipi.reset();
+    registerDefaultStrategies();
+}
+
+//registers the default strategies
+//the strategy objects have no state and are shared by all ComputerLogic objects
+//registering them again replaces the entries in place, without allocating
+void ComputerLogic::registerDefaultStrategies()
+{
+    static const std::shared_ptr<const ComputerStrategy> classic(new ClassicStrategy());
+    static const std::shared_ptr<const ComputerStrategy> head(new PolicyStrategy<FindHeadPolicy>());
+    static const std::shared_ptr<const ComputerStrategy> position(new PolicyStrategy<FindPositionPolicy>());
+    static const std::shared_ptr<const ComputerStrategy> random(new PolicyStrategy<RandomPolicy>());
+    static const std::shared_ptr<const ComputerStrategy> information(new PolicyStrategy<InformationGainPolicy>());
+    static const std::shared_ptr<const ComputerStrategy> expert(new ExpertSearch());
+
+    m_strategies.registerStrategy("classic", classic, 1);
+    m_strategies.registerStrategy("head", head, 0);
+    m_strategies.registerStrategy("position", position, 0);
+    m_strategies.registerStrategy("random", random, 0);
+    m_strategies.registerStrategy("information", information, 0);
+    m_strategies.registerStrategy("expert", expert, 0);
 }
 
 //selects all the possible plane positions that are valid within the given grid
@@ -170,163 +225,290 @@ void ComputerLogic::reset()
 {
     //initializes -1 for impossible choice (invalid plane position)
     //with 0 for possible choice
-    for(int i = 0;i < maxChoiceNo; i++)
-    {
-        Plane pl = mapIndexToPlane(i);
-        if(pl.isPositionValid(m_row, m_col))
-            m_choices[i] = 0;
-        else
-            m_choices[i] = -1;
-    }
+    m_choices.reset();
+    m_propagator.reset();
+    m_configurationFilter.reset();
 
     //clears various lists in the computerlogic object
-    m_guessedPlaneList.clear();
-    //m_guessedHeadList.clear();
-    m_guessesList.clear();
-    m_extendedGuessesList.clear();
-    m_headDataList.clear();
+    resetLists();
+
+    m_cancelRequested = false;
+}
+
+//copies the state of the game from another object
+//the strategies, the opening book and the cancel request are not copied
+bool ComputerLogic::assignState(const ComputerLogic& other)
+{
+    if(other.m_row != m_row || other.m_col != m_col || other.m_planeNo != m_planeNo)
+        return false;
+
+    m_choices.assign(other.m_choices);
+    m_propagator.assign(other.m_propagator);
+    m_guessedPlaneList.assign(other.m_guessedPlaneList.begin(), other.m_guessedPlaneList.end());
+    m_headDataList.assign(other.m_headDataList.begin(), other.m_headDataList.end());
+    m_guessesList.assign(other.m_guessesList.begin(), other.m_guessesList.end());
+    m_extendedGuessesList.assign(other.m_extendedGuessesList.begin(), other.m_extendedGuessesList.end());
+
+    //with another database the guesses are filtered again
+    if(!m_configurationFilter.assign(other.m_configurationFilter)) {
+        m_configurationFilter.reset();
+        for(unsigned int i = 0; i < m_guessesList.size(); i++)
+            m_configurationFilter.addGuess(m_guessesList[i]);
+    }
+    return true;
+}
+
+//the grid and the number of planes are not written, the owner of the
+//snapshot keeps them; the values are read back into the same lists
+void ComputerLogic::saveState(SnapshotWriter& writer) const
+{
+    m_choices.saveState(writer);
+    m_propagator.saveState(writer);
+
+    writer.write(static_cast<uint16_t>(m_guessedPlaneList.size()));
+    for(unsigned int i = 0; i < m_guessedPlaneList.size(); i++)
+        writer.write(static_cast<uint16_t>(PackedPlane(m_guessedPlaneList[i], m_row).id()));
+
+    writer.write(static_cast<uint16_t>(m_headDataList.size()));
+    for(unsigned int i = 0; i < m_headDataList.size(); i++) {
+        const HeadData& hd = m_headDataList[i];
+        writer.write(static_cast<uint16_t>(hd.m_head));
+        writer.write(static_cast<int8_t>(hd.m_correctOrient));
+        for(int k = 0; k < 4; k++) {
+            const PlaneOrientationData& pod = hd.m_options[k];
+            writer.write(static_cast<uint8_t>(pod.m_discarded ? 1 : 0));
+            writer.write(static_cast<uint8_t>(pod.m_pointsNotTestedNo));
+            for(int j = 0; j < pod.m_pointsNotTestedNo; j++)
+                writer.write(static_cast<uint16_t>(pod.m_pointsNotTested[j]));
+        }
+    }
+
+    saveGuesses(writer, m_guessesList);
+    saveGuesses(writer, m_extendedGuessesList);
 }
 
-//destructor
-ComputerLogic::~ComputerLogic()
+//the configuration filter is given the guesses again, it applies them
+//when the survivors are needed
+bool ComputerLogic::restoreState(SnapshotReader& reader)
 {
-    //deletes the object containing the choices
-    delete [] m_choices;
-    delete [] m_zero_choices;
+    reset();
+    const int pointNo = m_row * m_col;
+
+    m_choices.restoreState(reader);
+    m_propagator.restoreState(reader);
+
+    const int planeNo = reader.readCount(m_planeNo);
+    for(int i = 0; i < planeNo && !reader.hasError(); i++) {
+        const int id = reader.read<uint16_t>();
+        if(id >= maxChoiceNo || !m_stencils.isValid(id)) {
+            reader.setError();
+            break;
+        }
+        m_guessedPlaneList.push_back(m_stencils.toPlane(id));
+    }
+
+    const int headNo = reader.readCount(pointNo);
+    for(int i = 0; i < headNo && !reader.hasError(); i++) {
+        const int head = reader.read<uint16_t>();
+        const int correctOrient = reader.read<int8_t>();
+        if(head >= pointNo || correctOrient < -1 || correctOrient > 3) {
+            reader.setError();
+            break;
+        }
+        HeadData hd(m_stencils, head);
+        hd.m_correctOrient = correctOrient;
+        for(int k = 0; k < 4; k++) {
+            PlaneOrientationData& pod = hd.m_options[k];
+            pod.m_discarded = reader.read<uint8_t>() != 0;
+            pod.m_pointsNotTestedNo = reader.read<uint8_t>();
+            if(pod.m_pointsNotTestedNo > PlaneOrientationData::MaxPointsNotTested) {
+                pod.m_pointsNotTestedNo = 0;
+                reader.setError();
+            }
+            //the points are cells of the grid, they are turned into points later
+            for(int j = 0; j < pod.m_pointsNotTestedNo; j++) {
+                const int cell = reader.read<uint16_t>();
+                if(cell >= pointNo) {
+                    reader.setError();
+                    break;
+                }
+                pod.m_pointsNotTested[j] = cell;
+            }
+        }
+        m_headDataList.push_back(hd);
+    }
+
+    restoreGuesses(reader, m_guessesList);
+    restoreGuesses(reader, m_extendedGuessesList);
+
+    if(reader.hasError()) {
+        reset();
+        return false;
+    }
+
+    for(unsigned int i = 0; i < m_guessesList.size(); i++)
+        m_configurationFilter.addGuess(m_guessesList[i]);
+    return true;
+}
+
+//writes the number of guesses and their codes
+void ComputerLogic::saveGuesses(SnapshotWriter& writer, const ArenaVector<GuessPoint>& guesses) const
+{
+    writer.write(static_cast<uint16_t>(guesses.size()));
+    for(unsigned int i = 0; i < guesses.size(); i++)
+        writer.write(static_cast<uint16_t>(PackedGuess(guesses[i], m_row).code()));
+}
+
+//a list has at most one guess for each point of the grid
+bool ComputerLogic::restoreGuesses(SnapshotReader& reader, ArenaVector<GuessPoint>& guesses)
+{
+    const int guessNo = reader.readCount(m_row * m_col);
+    for(int i = 0; i < guessNo && !reader.hasError(); i++) {
+        PackedGuess pg = PackedGuess::fromCode(reader.read<uint16_t>());
+        if(pg.cell() >= m_row * m_col || pg.type() > GuessPoint::Dead) {
+            reader.setError();
+            break;
+        }
+        guesses.push_back(pg.toGuessPoint(m_row));
+    }
+    return !reader.hasError();
+}
+
+//empties the lists, gives back their memory to the arena in one step
+//and reserves the space needed for a game
+//a game has at most one guess for each point of the grid
+//and one head data for each plane
+void ComputerLogic::resetLists()
+{
+    detachArenaVector(m_guessedPlaneList);
+    detachArenaVector(m_headDataList);
+    detachArenaVector(m_guessesList);
+    detachArenaVector(m_extendedGuessesList);
+    m_arena.release();
+
+    m_guessedPlaneList.reserve(m_planeNo);
+    m_headDataList.reserve(m_planeNo);
+    m_guessesList.reserve(m_row * m_col);
+    m_extendedGuessesList.reserve(m_row * m_col);
 }
 
 //computes the position in the m_choices array of a given plane
 int ComputerLogic::mapPlaneToIndex(const Plane& pl) const
 {
-    int temp = (pl.col() * m_row + pl.row()) * 4 + (int)pl.orientation();
-    return temp;
+    return m_stencils.planeId(pl);
 }
 
 //computes the plane corresponding to a given position in the choices array
 Plane ComputerLogic::mapIndexToPlane(int idx) const
 {
-    Plane::Orientation o = (Plane::Orientation)(idx % 4);
-    int temp = idx / 4;
-
-    int row = temp % m_row;
-    int col = temp / m_row;
-
-    return Plane(row, col, o);
+    return m_stencils.toPlane(idx);
 }
 
 //computes the plane head position corresponding for a given position in the choices array
-QPoint ComputerLogic::mapIndexToQPoint(int idx) const
+GridPoint ComputerLogic::mapIndexToQPoint(int idx) const
 {
-    int temp = idx / 4;
-
-    int row = temp % m_row;
-    int col = temp / m_row;
-
-    return QPoint(row, col);
+    return m_stencils.cellPoint(PlaneStencils::headCell(idx));
 }
 
 //chooses the next point
-bool ComputerLogic::makeChoice(QPoint& qp) const
+//only the strategy drawn from the registry is evaluated
+bool ComputerLogic::makeChoice(GridPoint& qp) const
 {
-    //based on the 3 strategies of choice choses 3 possible moves
-    QPoint qp1, qp2, qp3;
+    if(makeChoiceOpeningBook(qp))
+        return true;
 
-    bool test1 = makeChoiceFindHeadMode(qp1);
-    bool test2 = makeChoiceFindPositionMode(qp2);
-    bool test3 = makeChoiceRandomMode(qp3);
+    if(makeChoiceEndgame(qp))
+        return true;
+
+    return m_strategies.choose(*this, qp);
+}
 
-    //if there are no more choices to be tested return false
-    if(!test1)
+//chooses the optimal move when one head is left to find
+bool ComputerLogic::makeChoiceEndgame(GridPoint& qp) const
+{
+    int point = 0;
+    if(!EndgameSolver::choose(*this, point))
         return false;
 
-    //generates a random number smaller than 10
-    int idx = Plane::generateRandomNumber(10);
+    qp = m_stencils.cellPoint(point);
+    return true;
+}
 
-    //various random strategies for making a choice
-    if(test2 && test3) {
-        if(idx<6) {
-            qp = qp1;
-            return true;
-        }
+//sets the opening book
+bool ComputerLogic::setOpeningBook(std::shared_ptr<const OpeningBook> book)
+{
+    if(book && !book->matches(m_row, m_col, m_planeNo))
+        return false;
 
-        if(idx<9) {
-            qp = qp2;
-            return true;
-        }
+    m_openingBook = book;
+    return true;
+}
 
-        qp = qp3;
-        return true;
-    }
+//sets the database of all the placements of the planes
+//the guesses already made are filtered when the survivors are first needed
+bool ComputerLogic::setConfigurationDatabase(std::shared_ptr<const ConfigurationDatabase> database)
+{
+    if(database && !database->matches(m_row, m_col, m_planeNo))
+        return false;
 
-    if(!test2 && test3) {
-        if(idx<7) {
-            qp = qp1;
-            return true;
-        }
+    m_configurationFilter.setDatabase(database, m_row, m_col);
+    for(unsigned int i = 0; i < m_guessesList.size(); i++)
+        m_configurationFilter.addGuess(m_guessesList[i]);
+    return true;
+}
 
-        qp = qp3;
-        return true;
-    }
+//looks up the current list of guesses in the opening book
+bool ComputerLogic::makeChoiceOpeningBook(GridPoint& qp) const
+{
+    if(!m_openingBook)
+        return false;
 
-    if(test2 && !test3) {
-        if(idx<7) {
-            qp = qp1;
-            return true;
-        }
+    int guessNo = static_cast<int>(m_guessesList.size());
+    if(guessNo >= m_openingBook->maxDepth())
+        return false;
 
-        qp = qp2;
-        return true;
-    }
+    int point = 0;
+    if(!m_openingBook->lookup(OpeningBook::hashGuesses(m_guessesList.data(), guessNo, m_row), point))
+        return false;
 
-    if(!test2 && !test3) {
-        qp = qp1;
-        return true;
-    }
+    //protects against a book that does not fit the current game
+    if(point < 0 || point >= m_row * m_col || m_choices.isGuessed(point))
+        return false;
 
-    return false;
+    qp = mapIndexToQPoint(point * 4);
+    return true;
 }
 
 
 //choses the most likely point to be a head's plane on the players grid
 
-bool ComputerLogic::makeChoiceFindHeadMode(QPoint& qp) const
+bool ComputerLogic::makeChoiceFindHeadMode(GridPoint& qp) const
 {
-    QList<int> maxPos;
-
-    //computes the point on the m_choices table
-    //which has the highest value
-    int maxidx = 0;
-    maxPos.clear();
-
-    for(int i = 1;i < maxChoiceNo; i++)
-    {
-        if(m_choices[i] == m_choices[maxidx])
-            maxPos.append(i);
-
-        if(m_choices[i] > m_choices[maxidx])
-        {
-            maxidx = i;
-            maxPos.clear();
-            maxPos.append(i);
-        }
-    }
+    //computes the highest value on the m_choices table
+    //and the number of points with this value
+    int maxNo = 0;
+    int maxValue = m_choices.maxScore(maxNo);
 
     //if all the choices are impossible returns false
-    if(m_choices[maxidx] == -1)
+    if(maxValue < 0)
         return false;
 
     //choses randomly a point with the maximum probability
-    int idx = Plane::generateRandomNumber(maxPos.size());
+    //the points with the maximum value are not stored
+    //instead the chosen one is searched for in a second pass
+    int idx = m_choices.findNth(maxValue, Plane::generateRandomNumber(maxNo));
+    if(idx == -1)
+        return false;
 
     //converts the choice into a plane's head position
-     qp=mapIndexToQPoint(maxPos.at(idx));
+    qp = mapIndexToQPoint(idx);
     return true;
 }
 
 
 //after finding one or more heads the computer tries to
 //determine the real position of the found plane
-bool ComputerLogic::makeChoiceFindPositionMode(QPoint& qp) const
+bool ComputerLogic::makeChoiceFindPositionMode(GridPoint& qp) const
 {
     //chose randomly a head data from the list
     //and choose randomly an orientation which is not discarded
@@ -338,7 +520,7 @@ bool ComputerLogic::makeChoiceFindPositionMode(QPoint& qp) const
 
     //choses a random plane head from the list of heads
     int idx = Plane::generateRandomNumber(m_headDataList.size());
-    HeadData hd=m_headDataList.at(idx);
+    const HeadData& hd = m_headDataList.at(idx);
 
     //find the orientation that has the most not tested points
     //and is not discarded
@@ -347,11 +529,11 @@ bool ComputerLogic::makeChoiceFindPositionMode(QPoint& qp) const
     int good_orientation = -1;
     for(int i = 0;i < 4; i++)
     {
-        PlaneOrientationData pod = hd.m_options[i];
+        const PlaneOrientationData& pod = hd.m_options[i];
 
         if(!pod.m_discarded) {
-            if(pod.m_pointsNotTested.size()>max_not_tested) {
-                max_not_tested = pod.m_pointsNotTested.size();
+            if(pod.m_pointsNotTestedNo > max_not_tested) {
+                max_not_tested = pod.m_pointsNotTestedNo;
                 good_orientation = i;
             }
         }
@@ -363,44 +545,153 @@ bool ComputerLogic::makeChoiceFindPositionMode(QPoint& qp) const
         return false;
 
     //choose randomly a point from the points not tested in the chosen orientation
-    idx = Plane::generateRandomNumber(hd.m_options[good_orientation].m_pointsNotTested.size());
+    idx = Plane::generateRandomNumber(hd.m_options[good_orientation].m_pointsNotTestedNo);
 
-    qp = hd.m_options[good_orientation].m_pointsNotTested.at(idx);
+    qp = m_stencils.cellPoint(hd.m_options[good_orientation].m_pointsNotTested[idx]);
 
     return true;
 }
 
 //computer choses a point about which has no
 //positive or negative data
-bool ComputerLogic::makeChoiceRandomMode(QPoint& qp) const
+bool ComputerLogic::makeChoiceRandomMode(GridPoint& qp) const
 {
     //find a random point which has zero score in the choice map
-    int idx = Plane::generateRandomNumber(maxChoiceNo);
+    //all the points with zero score are equally likely
+    int zeroNo = m_choices.count(0);
+    if(zeroNo == 0)
+        return false;
+
+    int idx = m_choices.findNth(0, Plane::generateRandomNumber(zeroNo));
+    if(idx == -1)
+        return false;
+
+    qp = mapIndexToQPoint(idx);
+    return true;
+}
+
+bool ComputerLogic::skipChoiceRandomMode() const
+{
+    //the draw is kept so that the next choices do not change,
+    //the second pass over the choice map is not needed
+    int zeroNo = m_choices.count(0);
+    if(zeroNo == 0)
+        return false;
 
-    //starting from the point next to the point selected
-    int count = (idx+1) % maxChoiceNo;
+    Plane::generateRandomNumber(zeroNo);
+    return true;
+}
 
-   //if it corresponds to a point with a choice of 0
-    //choose this point
-    while(count != idx)
+//the weight of a plane position with the given score in the choice map
+//each hit supporting the position multiplies its weight by HitWeight;
+//with a weight of one plus the score the positions supported by hits were
+//found about half as likely as they are
+float ComputerLogic::candidateWeight(int score)
+{
+    //chosen by simulation on 10x10 grids with 3 planes
+    const float HitWeight = 2.5f;
+    const int TableSize = 32;
+
+    static const std::vector<float> weights = [=]() {
+        std::vector<float> table(TableSize);
+        for(int i = 0; i < TableSize; i++)
+            table[i] = std::pow(HitWeight, static_cast<float>(i));
+        return table;
+    }();
+
+    return weights[std::min(score, TableSize - 1)];
+}
+
+//computes for each grid point the probabilities that a guess there is
+//a dead or a hit
+//every plane position that is still possible is a candidate
+//with the weight given by candidateWeight()
+//the probabilities are the weights of the candidates having the point as head
+//or on the body, scaled so that they add to the number of planes left
+//returns the number of planes whose head was not found,
+//or 0 if there are none or no candidate is left
+int ComputerLogic::computeOutcomeProbabilities(float* pDead, float* pHit) const
+{
+    //number of planes whose head was not found
+    int planesLeft = m_planeNo - static_cast<int>(m_guessedPlaneList.size()) - static_cast<int>(m_headDataList.size());
+    if(planesLeft <= 0)
+        return 0;
+
+    //the exact probabilities from the placements agreeing with the guesses
+    if(m_configurationFilter.computeProbabilities(pDead, pHit))
+        return planesLeft;
+
+    const int pointNo = m_row * m_col;
+    std::fill(m_headWeights.begin(), m_headWeights.end(), 0.0f);
+    std::fill(m_bodyWeights.begin(), m_bodyWeights.end(), 0.0f);
+
+    //accumulates the weights of the candidates on their footprints
+    //the choices are read lane by lane
+    const int* lanes = m_choices.lanes();
+    float totalWeight = 0.0f;
+    for(int orient = 0; orient < 4; orient++)
     {
-        if(m_choices[count] == 0) {
-            qp = mapIndexToQPoint(count);
-            return true;
+        const int* lane = lanes + orient * m_choices.laneStride();
+        for(int point = 0; point < pointNo; point++)
+        {
+            if(lane[point] < 0)
+                continue;
+
+            float weight = candidateWeight(lane[point]);
+            const int* footprint = m_stencils.footprint(point * 4 + orient);
+            totalWeight += weight;
+            m_headWeights[footprint[0]] += weight;
+            for(int k = 1; k < PlaneStencils::PlanePointsNo; k++)
+                m_bodyWeights[footprint[k]] += weight;
         }
-        //if the point does not correspond to a zero choice
-        //move to the next point
-        count = (count+1) % maxChoiceNo;
     }
-    //loop until all the points in the m_choices table have been tested
 
-    return false;
+    if(totalWeight == 0.0f)
+        return 0;
+
+    const float scale = planesLeft / totalWeight;
+    ChoiceKernels::active().m_outcomeProbabilities(m_headWeights.data(), m_bodyWeights.data(), pointNo, scale,
+                                                   pDead, pHit);
+    return planesLeft;
+}
+
+//the score of a point in the information gain mode: the entropy of the result
+//plus the probability of a dead result weighted by DeadBonus
+//because finding heads is the goal of the game; without it the most
+//informative points are rarely heads and games get twice as long
+//the guessed points are marked in the first lane of the choice map
+int ComputerLogic::computeInformationScores(const float* pDead, const float* pHit, float* scores) const
+{
+    //chosen by simulation on 10x10 grids with 3 planes
+    const float DeadBonus = 3.0f;
+
+    return ChoiceKernels::active().m_informationScores(pDead, pHit, m_choices.lanes(), m_row * m_col, DeadBonus,
+                                                        scores);
+}
+
+//choses the point whose result tells the most about the planes not yet found
+//for each point not guessed the probabilities of the three results are computed
+//and the point with the best information score is chosen
+bool ComputerLogic::makeChoiceMaxInformationMode(GridPoint& qp) const
+{
+    //the probabilities and then the scores are computed in place of the weights
+    float* pDead = m_headWeights.data();
+    float* pHit = m_bodyWeights.data();
+    if(computeOutcomeProbabilities(pDead, pHit) == 0)
+        return false;
+
+    int bestPoint = computeInformationScores(pDead, pHit, pDead);
+    if(bestPoint == -1)
+        return false;
+
+    qp = mapIndexToQPoint(bestPoint * 4);
+    return true;
 }
 
 //checks whether if the computer has guessed everything
 bool ComputerLogic::areAllGuessed() const
 {
-    return (m_guessedPlaneList.size() >= m_planeNo);
+    return (static_cast<int>(m_guessedPlaneList.size()) >= m_planeNo);
 }
 
 //new info is added the choices are updated
@@ -410,8 +701,9 @@ bool ComputerLogic::areAllGuessed() const
 void ComputerLogic::addData(const GuessPoint& gp)
 {
     //add to list of guesses
-    m_guessesList.append(gp);
-    m_extendedGuessesList.append(gp);
+    m_guessesList.push_back(gp);
+    m_extendedGuessesList.push_back(gp);
+    m_configurationFilter.addGuess(gp);
 
     //updates the info in the array of choices
     updateChoiceMap(gp);
@@ -419,11 +711,55 @@ void ComputerLogic::addData(const GuessPoint& gp)
     //updates the head data
     updateHeadData(gp);
 
-    //checks all head data to see if any plane positions were confirmed
-    QMutableListIterator<HeadData> qmli(m_headDataList);
+    //infers what follows from the new guess together with the earlier ones
+    //and checks all head data to see if any plane positions were confirmed
+    m_propagator.addGuess(gp);
+    propagateInferences();
+}
+
+//runs the propagation engine until no more facts are found
+//a plane confirmed by the head data is given back to the engine
+//which can then infer more
+void ComputerLogic::propagateInferences()
+{
+    do {
+        m_propagator.propagate(m_choices);
+        applyInferences();
+        confirmPlanes();
+    } while(m_propagator.hasWork());
+}
+
+//applies the facts found by the propagation engine
+//the inferred points are treated as extended guesses: they are marked as
+//guessed in the choice map so that they are not chosen and the head data
+//are updated with them
+void ComputerLogic::applyInferences()
+{
+    m_inferences.clear();
+    m_propagator.takeInferences(m_inferences);
+
+    for(unsigned int i = 0; i < m_inferences.size(); i++) {
+        const GuessPoint& gp = m_inferences[i];
+        const CellId cell = m_stencils.cellId(gp.m_row, gp.m_col);
+        m_choices.markGuessed(cell);
+        if(std::find(m_extendedGuessesList.begin(), m_extendedGuessesList.end(), gp) == m_extendedGuessesList.end())
+            m_extendedGuessesList.push_back(gp);
+        for(unsigned int j = 0; j < m_headDataList.size(); j++)
+            m_headDataList[j].update(cell, gp.m_type);
+    }
 
-    while(qmli.hasNext()) {
-        HeadData hd = qmli.next();
+    //the orientations that the engine found impossible
+    for(unsigned int i = 0; i < m_headDataList.size(); i++) {
+        HeadData& hd = m_headDataList[i];
+        hd.restrictOrientations(m_propagator.orientationMask(hd.m_head));
+    }
+}
+
+//moves the head data with a decided orientation to the list of found planes
+void ComputerLogic::confirmPlanes()
+{
+    for(unsigned int i = 0; i < m_headDataList.size(); ) {
+        const HeadData& hd = m_headDataList[i];
 
         //if we decided upon an orientation
         //update the choice map
@@ -431,161 +767,123 @@ void ComputerLogic::addData(const GuessPoint& gp)
         //append to the list of found planes
         if(hd.m_correctOrient != -1)
         {
-            Plane pl(hd.m_headRow, hd.m_headCol, (Plane::Orientation)hd.m_correctOrient);
-            updateChoiceMapPlaneData(pl);
-            m_guessedPlaneList.append(pl);
-            qmli.remove();
+            const PlaneId plane = PlaneStencils::planeId(hd.m_head, hd.m_correctOrient);
+            updateChoiceMapPlaneData(plane);
+            m_guessedPlaneList.push_back(m_stencils.toPlane(plane));
+            m_propagator.confirmPlane(hd.m_head, hd.m_correctOrient);
+            m_headDataList.erase(m_headDataList.begin() + i);
+        } else {
+            i++;
         }
     }
-
 }
 
 //updates the computer choices
 void ComputerLogic::updateChoiceMap(const GuessPoint& gp) {
 
+    updateChoiceMap(m_stencils.cellId(gp.m_row, gp.m_col), gp.m_type);
+}
+
+//updates the computer choices with a guess at a cell
+void ComputerLogic::updateChoiceMap(CellId cell, GuessPoint::Type type) {
+
     //marks all the 4 positions in the choice map as guessed -2
-    for(int i = 0;i < 4; i++) {
-        Plane plane(gp.m_row, gp.m_col, (Plane::Orientation)i);
-        int idx = mapPlaneToIndex(plane);
-        m_choices[idx] = -2;
-    }
+    m_choices.markGuessed(cell);
 
-    if(gp.m_type == GuessPoint::Dead)
-        updateChoiceMapDeadInfo(gp.m_row, gp.m_col);
+    if(type == GuessPoint::Dead)
+        updateChoiceMapDeadInfo(cell);
 
-    if(gp.m_type == GuessPoint::Hit)
-        updateChoiceMapHitInfo(gp.m_row, gp.m_col);
+    if(type == GuessPoint::Hit)
+        updateChoiceMapHitInfo(cell);
 
-    if(gp.m_type == GuessPoint::Miss)
-        updateChoiceMapMissInfo(gp.m_row, gp.m_col);
+    if(type == GuessPoint::Miss)
+        updateChoiceMapMissInfo(cell);
 }
 
-void ComputerLogic::updateChoiceMapPlaneData(const Plane& pl)
+void ComputerLogic::updateChoiceMapPlaneData(PlaneId plane)
 {
     //interprets a plane as a list of miss guesses
     //updates the choice map with this list of guesses
     //and appends the guesses to the list of guesses
-    PlanePointIterator ppi(pl);
-
     //not to treat the head of the plane
-    ppi.next();
-
-    while(ppi.hasNext()) {
-        QPoint qp = ppi.next();
-        GuessPoint gp(qp.x(), qp.y(), GuessPoint::Miss);
-        updateChoiceMap(gp);
-        m_extendedGuessesList.removeOne(gp);
-        m_extendedGuessesList.append(gp);
+    const CellId* footprint = m_stencils.footprint(plane);
+    for(int k = 1; k < PlaneStencils::PlanePointsNo; k++) {
+        const CellId cell = footprint[k];
+        GuessPoint gp(m_stencils.cellRow(cell), m_stencils.cellCol(cell), GuessPoint::Miss);
+        updateChoiceMap(cell, GuessPoint::Miss);
+        ArenaVector<GuessPoint>::iterator it = std::find(m_extendedGuessesList.begin(), m_extendedGuessesList.end(), gp);
+        if(it != m_extendedGuessesList.end())
+            m_extendedGuessesList.erase(it);
+        m_extendedGuessesList.push_back(gp);
     }
 }
 
 //updates the choices with info about a dead guess
-void ComputerLogic::updateChoiceMapDeadInfo(int row, int col)
+void ComputerLogic::updateChoiceMapDeadInfo(CellId cell)
 {
     //do nothing as everything is done in the updateHeadData function
     //the decision to chose a plane is made in the
     //updateHeadData function
-    updateChoiceMapMissInfo(row, col);
+    updateChoiceMapMissInfo(cell);
 }
 
 //updates the choices with info about a hit guess
-void ComputerLogic::updateChoiceMapHitInfo(int row,int col)
+void ComputerLogic::updateChoiceMapHitInfo(CellId cell)
 {
     //for all the plane positions that are valid and that contain the
     //current position increment their score
-
-    m_pipi.reset();
-
-    while(m_pipi.hasNext()) {
-        //obtain index for position that includes QPoint(row,col)
-        Plane pl = m_pipi.next();
-        QPoint qp(row, col);
-        //add current position to the index to obtain a plane option
-        pl = pl + qp;
-
-        //if choice is not valid continue to the next position
-        if(!pl.isPositionValid(m_row, m_col))
-            continue;
-
-        //position is valid; check first that it has not
-        //being marked as invalid and that increase its score
-
-        int idx = mapPlaneToIndex(pl);
-        if(m_choices[idx] >= 0)
-            m_choices[idx]++;
-    }
+    //if they have not been marked as invalid
+    m_choices.incrementCovers(cell);
 }
 
 //updates the choices with info about a miss guess
-void ComputerLogic::updateChoiceMapMissInfo(int row, int col)
+void ComputerLogic::updateChoiceMapMissInfo(CellId cell)
 {
-
     //discard all plane positions that contain this point
-    m_pipi.reset();
-
-    while(m_pipi.hasNext())
-    {
-        //obtain index for position that includes QPoint(row,col)
-        Plane pl = m_pipi.next();
-        QPoint qp(row, col);
-        //add current position to the index to obtain a plane option
-        pl = pl + qp;
-
-        //if choice is not valid continue to the next position
-        if(!pl.isPositionValid(m_row, m_col))
-            continue;
-
-        //position is valid; because it includes a miss
-        //it must be taken out from the list of choice
-
-        int idx = mapPlaneToIndex(pl);
-        if(m_choices[idx] >= 0)
-            m_choices[idx] = -1;
-    }
+    //because they include a miss
+    m_choices.invalidateCovers(cell);
 }
 
 //updates the head data with a new guess
 void ComputerLogic::updateHeadData(const GuessPoint& gp)
 {
-    //build a list iterator that allows the modification of data
-    QMutableListIterator<HeadData> qmli(m_headDataList);
+    const CellId cell = m_stencils.cellId(gp.m_row, gp.m_col);
 
     //updates the head data with the found guess point
-    while(qmli.hasNext()) {
-        HeadData hd = qmli.next();
-        hd.update(gp);
-        qmli.setValue(hd);
-    }
+    for(unsigned int i = 0; i < m_headDataList.size(); i++)
+        m_headDataList[i].update(cell, gp.m_type);
 
     //if the guess point is a head  add a new head data
     //which contains all the knowledge gathered until now
     if(gp.isDead())
     {
         //create a new head data structure
-        HeadData hd(m_row, m_col, gp.m_row, gp.m_col);
+        HeadData hd(m_stencils, cell);
 
         //update the head data with all the history of guesses
-        for(int i = 0;i < m_extendedGuessesList.size(); i++)
-            hd.update(m_extendedGuessesList.at(i));
+        for(unsigned int i = 0;i < m_extendedGuessesList.size(); i++) {
+            const GuessPoint& egp = m_extendedGuessesList[i];
+            hd.update(m_stencils.cellId(egp.m_row, egp.m_col), egp.m_type);
+        }
 
         //append the head data in the list of heads
-        m_headDataList.append(hd);
+        m_headDataList.push_back(hd);
     }
 }
 
 //Calculate the number of choice points influenced by a point
-int ComputerLogic::noPointsInfluenced(const QPoint& qp)
+//uses the precomputed influence stencil of the point
+int ComputerLogic::noPointsInfluenced(const GridPoint& qp)
 {
     //checks to see if the point belongs already to a guess
     //or if it cannot be a viable choice
     //when this happens returns -1
     bool point_not_good = true;
+    const CellId point = m_stencils.cellId(qp);
 
     for(int i = 0;i < 4; i++)
     {
-        Plane pl(qp, (Plane::Orientation)i);
-        int idx = mapPlaneToIndex(pl);
-        if(m_choices[idx] >= 0) {
+        if(m_choices[PlaneStencils::planeId(point, i)] >= 0) {
             point_not_good = false;
             break;
         }
@@ -596,53 +894,42 @@ int ComputerLogic::noPointsInfluenced(const QPoint& qp)
 
     int count = 0;
 
-    //get the planes intersecting the point
-    PlaneIntersectingPointIterator pipi(qp);
-
-    while(pipi.hasNext()) {
-        //for each plane
-        Plane pl = pipi.next();
+    //the planes intersecting the point
+    for(const int* it = m_stencils.coversBegin(point); it != m_stencils.coversEnd(point); ++it)
+    {
         //ignore if it's head is in the initial point
-        if(pl.head() == qp)
+        if(PlaneStencils::headCell(*it) == point)
             continue;
 
-        //find the index of the point
-        int idx = mapPlaneToIndex(pl);
-
-        if(m_choices[idx] >= 0)
+        if(m_choices[*it] >= 0)
             count++;
     }
 
     return count;
 }
 
-//equals operator: copies the choices array and the guesses list from the ComputerLogic object
+//equals operator: copies the state of the game from the ComputerLogic object
+//and keeps its guesses to play them again
 void RevertComputerLogic::operator=(const ComputerLogic& cl)
 {
-    if(m_row!=cl.getRowNo() && m_col!=cl.getRowNo())
+    if(m_row != cl.getRowNo() || m_col != cl.getColNo())
         return;
 
-    const int* choices = cl.getChoicesArray();
-
-    for(int i = 0;i < maxChoiceNo; i++)
-        m_choices[i] = choices[i];
-
-    m_guessesList.clear();
-    m_guessesList = cl.getListGuesses();
-
-    m_extendedGuessesList.clear();
-    m_extendedGuessesList = cl.getExtendedListGuesses();
+    //the choices, the propagation engine, the head data and the lists of guesses
+    if(!assignState(cl))
+        return;
 
     m_playList.clear();
-    m_playList = cl.getListGuesses();
+    m_playList.reserve(cl.getListGuesses().size());
+    for(unsigned int i = 0; i < cl.getListGuesses().size(); i++)
+        m_playList.push_back(PackedGuess(cl.getListGuesses()[i], m_row));
 
-    m_pos = m_playList.size()-1;
+    m_pos = static_cast<int>(m_playList.size()) - 1;
 }
 
 //constructor
 RevertComputerLogic::RevertComputerLogic(int row, int col, int planeno):
     ComputerLogic(row, col, planeno), m_pos(0) {
-    m_playList.clear();
 }
 
 
@@ -664,7 +951,7 @@ void RevertComputerLogic::revert(int n)
     //play the strategy forwards
     for(int i = 0;i <= nsteps; i++)
     {
-        addData(m_playList.at(i));
+        addData(m_playList.at(i).toGuessPoint(m_row));
     }
     m_pos = nsteps;
 }
@@ -672,10 +959,10 @@ void RevertComputerLogic::revert(int n)
 //plays the computer strategy forward
 void RevertComputerLogic::next()
 {
-    if(m_pos >= m_playList.size() - 1)
+    if(m_pos >= static_cast<int>(m_playList.size()) - 1)
         return;
 
-    addData(m_playList.at(m_pos + 1));
+    addData(m_playList.at(m_pos + 1).toGuessPoint(m_row));
     m_pos++;
 }
 
@@ -4,7 +4,18 @@
 #include "plane.h"
 #include "guesspoint.h"
 #include "planeiterators.h"
-#include <QPoint>
+#include "gamearena.h"
+#include "choicemap.h"
+#include "planepropagator.h"
+#include "planestencils.h"
+#include "computerstrategy.h"
+#include "openingbook.h"
+#include "configurationfilter.h"
+#include "gridpoint.h"
+#include "packedtypes.h"
+#include "snapshotstream.h"
+#include <atomic>
+#include <vector>
 
 
 //The computer is trying to guess where the player's planes are
@@ -23,21 +34,27 @@
 
 struct PlaneOrientationData
 {
+    //number of points on a plane besides the head
+    static const int MaxPointsNotTested = 9;
 
     //the position of the plane
-    Plane m_plane;
+    PlaneId m_plane;
 
     //whether this orientation was discarded
     bool m_discarded;
     //points on this plane that were not tested
     //if m_discarded is false it means that all the
     //tested points were hits
-    QList<QPoint> m_pointsNotTested;
+    //the points are kept inside the structure
+    //so that the head data does not allocate memory
+    CellId m_pointsNotTested[MaxPointsNotTested];
+    int m_pointsNotTestedNo;
 
     //default constructor
     PlaneOrientationData();
     //another constructor
-    PlaneOrientationData(const Plane& pl, bool isDiscarded);
+    //a position outside of the grid is discarded
+    PlaneOrientationData(const PlaneStencils& stencils, PlaneId plane);
     //copy constructor
     PlaneOrientationData(const PlaneOrientationData& pod);
     //equals operator
@@ -45,19 +62,23 @@ struct PlaneOrientationData
 
     //update the info about this plane with another guess point
     //a guess point is a pair (position, guess result)
-    void update(const GuessPoint& gp);
+    void update(CellId cell, GuessPoint::Type type);
     //verifies if all the points in the current orientation were already checked
     bool areAllPointsChecked();
+
+private:
+    //position of a point in the list of points not tested or -1
+    int indexOfPointNotTested(CellId cell) const;
+    //removes a point from the list of points not tested keeping the order
+    void removePointNotTested(int idx);
 };
 
 //This structure keeps the information about the position of the head of the planes
 
 struct HeadData
 {
-    //size of the grid
-    int m_row, m_col;
     //position of the head
-    int m_headRow, m_headCol;
+    CellId m_head;
     //the correct plane orientation if decided
     int m_correctOrient;
 
@@ -65,10 +86,17 @@ struct HeadData
     //statistics about the 4 positions with this head
     PlaneOrientationData m_options[4];
 
-    HeadData(int row, int col, int headRow, int headCol);
+    HeadData(const PlaneStencils& stencils, CellId head);
     //update the current data with a guess
     //return true if a plane is confirmed
-    bool update(const GuessPoint& gp);
+    bool update(CellId cell, GuessPoint::Type type);
+    //discards the orientations that are not in the mask, bit i for orientation i
+    //return true if a plane is confirmed
+    bool restrictOrientations(int mask);
+
+private:
+    //decides the orientation if only one is left or one has all its points hit
+    bool decideOrientation();
 };
 
 
@@ -85,47 +113,81 @@ protected:
     //number of planes that need to be guessed
     int m_planeNo;
 
+    //the memory for the lists below
+    //it is released in one step when the object is reset
+    GameArena m_arena;
+
     //list of already guessed planes
-    QList<Plane> m_guessedPlaneList;
+    ArenaVector<Plane> m_guessedPlaneList;
 
     //list of guessed plane heads for which the plane is not found
-    //QList <QPoint> m_guessedHeadList;
+    //QList <GridPoint> m_guessedHeadList;
 
     //list of available data for each head in m_guessHeadList
-    QList<HeadData> m_headDataList;
+    ArenaVector<HeadData> m_headDataList;
 
     //list of guesses made until this moment
-    QList<GuessPoint> m_guessesList;
+    ArenaVector<GuessPoint> m_guessesList;
     //list of extended guesses; when the position of a plane is decided
     //all the points on this plane are considered as misses
-    QList<GuessPoint> m_extendedGuessesList;
+    ArenaVector<GuessPoint> m_extendedGuessesList;
+
+    //the precomputed plane footprints and influence stencils for this grid size
+    const PlaneStencils& m_stencils;
 
     //the list of choices
     //choice -2 means that a guess has already been made
     //choice is -1 means that plane position is there impossible
     //choice 0 means no data about the choice is available
     //choice = k means that k data exist that support this choice
-    int* m_choices;
-
-    //array keeping the number of points with positive m_choice influenced by a given point
-    //contains:
-    //-1 when a guess has been made at this point, the position is impossible, or there is already data about this point
-    //a positive number showing how many points are influenced by this point
-    int* m_zero_choices;
-
-    //put here so that we calculate the list of indices only once
-    //this iterator gives all the planes that intersect the
-    //point (0,0) on the grid
-    PlaneIntersectingPointIterator m_pipi;
+    ChoiceMap m_choices;
+
+    //infers facts from the guesses taking all the heads and planes into account
+    PlanePropagator m_propagator;
+    //the facts inferred after the last guess
+    std::vector<GuessPoint> m_inferences;
+
+    //the strategies used to choose a move and their mixing weights
+    StrategyRegistry m_strategies;
+    //precomputed moves for the beginning of the game, consulted before the strategies
+    std::shared_ptr<const OpeningBook> m_openingBook;
+    //the placements of the planes agreeing with the guesses, when a database is set
+    //it gives the exact probabilities of the results used by the information gain mode
+    mutable ConfigurationFilter m_configurationFilter;
+    //work arrays of the information gain mode, one element per grid point
+    //weights of the remaining plane positions having the head on the point
+    //and the body on the point
+    mutable std::vector<float> m_headWeights;
+    mutable std::vector<float> m_bodyWeights;
+
+    //set from another thread when the current computation is no longer needed
+    //expensive strategies check it and return early
+    std::atomic<bool> m_cancelRequested;
 
 public:
     ComputerLogic(int row, int col, int planeno);
-    ~ComputerLogic();
     //restores the list of choices
     void reset();
-    //returns the plane choice with the highest score and true
-    //or false if there are no more valid choices
-    bool makeChoice(QPoint& qp) const;
+    //gives the default strategies their default weights again; the tables
+    //and the lists keep their memory, used when the object is recycled
+    void resetStrategies() { registerDefaultStrategies(); }
+    //copies the state of the game from another object for the same grid,
+    //used to make the snapshots of a search; the opening book and the
+    //configuration database of this object are kept
+    //returns false if the other object is for another grid or number of planes
+    bool assignState(const ComputerLogic& other);
+    //writes the state of the game: the choices, the propagation engine,
+    //the head data and the lists of guesses and found planes;
+    //the strategies, the opening book and the configuration database are
+    //settings of the object and are not written
+    void saveState(SnapshotWriter& writer) const;
+    //reads the state written by saveState() for the same grid and number of planes,
+    //without replaying the guesses; on an error the object is reset
+    bool restoreState(SnapshotReader& reader);
+    //chooses the next move from the opening book, the endgame solver
+    //or one of the registered strategies
+    //returns false if there are no more valid choices
+    bool makeChoice(GridPoint& qp) const;
     //new info is added the choices are updated
     void addData(const GuessPoint& gp);
     //tests whether all plane positions are guessed
@@ -137,41 +199,107 @@ public:
     //gets the number of planes
     int getPlaneNo() const { return m_planeNo; }
     //gets the list of guesses
-    const QList<GuessPoint>&  getListGuesses() const { return m_guessesList; }
-    const QList<GuessPoint>& getExtendedListGuesses() const { return m_extendedGuessesList; }
+    const ArenaVector<GuessPoint>& getListGuesses() const { return m_guessesList; }
+    const ArenaVector<GuessPoint>& getExtendedListGuesses() const { return m_extendedGuessesList; }
+    //gets the memory arena holding the state of the current game
+    const GameArena& arena() const { return m_arena; }
     //gets the choices
-    const int* getChoicesArray() const { return m_choices; }
+    const ChoiceMap& getChoiceMap() const { return m_choices; }
+    //the geometry tables of the grid: the conversions between ids and points and the footprints
+    const PlaneStencils& stencils() const { return m_stencils; }
     //computes the position in the m_choices array of a given plane
     int mapPlaneToIndex(const Plane& pl) const;
+    //the strategies used by makeChoice() and their mixing weights
+    //registered by default: "classic" (weight 1), the mix of head, position and random
+    //in proportion 6/3/1, and "head", "position", "random", "information", "expert" (weight 0)
+    StrategyRegistry& strategies() { return m_strategies; }
+    const StrategyRegistry& strategies() const { return m_strategies; }
+    //sets the opening book, an empty pointer disables it
+    //returns false and keeps the old book if the book is for another geometry
+    bool setOpeningBook(std::shared_ptr<const OpeningBook> book);
+    //sets the database of all the placements of the planes, an empty pointer disables it
+    //returns false and keeps the old database if the database is for another geometry
+    bool setConfigurationDatabase(std::shared_ptr<const ConfigurationDatabase> database);
+    //asks a running makeChoice() to return as soon as possible
+    //the request is cleared by reset() or clearCancel()
+    void requestCancel() { m_cancelRequested = true; }
+    //lets the next makeChoice() run to the end after a cancelled one
+    void clearCancel() { m_cancelRequested = false; }
+    bool isCancelRequested() const { return m_cancelRequested; }
+
+    //the basic strategies, used by the policies in strategypolicies.h
+    //make choice in find head mode
+    bool makeChoiceFindHeadMode(GridPoint& qp) const;
+    //make choice in find plane position mode
+    bool makeChoiceFindPositionMode(GridPoint& qp) const;
+    //make a random choice
+    bool makeChoiceRandomMode(GridPoint& qp) const;
+    //draws the random number of makeChoiceRandomMode() without looking for the point
+    //returns whether it would have found one
+    bool skipChoiceRandomMode() const;
+    //make the choice with the maximum expected information gain
+    bool makeChoiceMaxInformationMode(GridPoint& qp) const;
+
+    //computes for each grid point the probabilities of a dead and a hit result,
+    //the arrays have one element per grid point; they are exact when a
+    //configuration database is set
+    //returns the number of planes whose head was not found, 0 if none is left
+    //uses work arrays of the object, it must not be called by two threads at once
+    int computeOutcomeProbabilities(float* pDead, float* pHit) const;
+    //writes the score of each grid point in the information gain mode from the
+    //probabilities of computeOutcomeProbabilities(); scores may be the same array as pDead
+    //returns the point not guessed with the best score, -1 if all are guessed
+    int computeInformationScores(const float* pDead, const float* pHit, float* scores) const;
+    //the weight of a plane position with the given score in the probability model
+    static float candidateWeight(int score);
+    //gets the propagation engine
+    const PlanePropagator& propagator() const { return m_propagator; }
+    //whether a guess was made at a grid point, or the point is known
+    bool isPointGuessed(int point) const { return m_choices.isGuessed(point); }
 
 private:
     //computes the plane corresponding to a given position in the choices array
     Plane mapIndexToPlane(int idx) const;
-    //computes the QPoint corresponding to the head of the plane corresponding to the idx
-    QPoint mapIndexToQPoint(int idx) const;
-    //make choice in find head mode
-    bool makeChoiceFindHeadMode(QPoint& qp) const;
-    //make choice in find plane position mode
-    bool makeChoiceFindPositionMode(QPoint& qp) const;
-    //make a random choice
-    bool makeChoiceRandomMode(QPoint& qp) const;
+    //computes the GridPoint corresponding to the head of the plane corresponding to the idx
+    GridPoint mapIndexToQPoint(int idx) const;
+    //registers the default strategies
+    void registerDefaultStrategies();
+    //takes the move from the opening book if the current guesses are in the book
+    bool makeChoiceOpeningBook(GridPoint& qp) const;
+    //takes the optimal move of the endgame solver if one head is left to find
+    //and the guesses leave few enough placements of the planes
+    bool makeChoiceEndgame(GridPoint& qp) const;
+
+    //gives back the memory of the current game and prepares the lists for a new one
+    void resetLists();
+    //writes and reads a list of guesses as PackedGuess codes
+    void saveGuesses(SnapshotWriter& writer, const ArenaVector<GuessPoint>& guesses) const;
+    bool restoreGuesses(SnapshotReader& reader, ArenaVector<GuessPoint>& guesses);
 
     //updates the head data
     void updateHeadData(const GuessPoint& gp);
+    //runs the propagation engine until no more facts are found
+    //and applies them to the choice map and the head data
+    void propagateInferences();
+    //applies to the choice map and the head data the facts found by the propagation engine
+    void applyInferences();
+    //moves the head data with a decided orientation to the list of found planes
+    void confirmPlanes();
 
     //update the map of choices
     void updateChoiceMap(const GuessPoint& gp);
+    void updateChoiceMap(CellId cell, GuessPoint::Type type);
     //updates the choices with info about a dead guess
-    void updateChoiceMapDeadInfo(int row, int col);
+    void updateChoiceMapDeadInfo(CellId cell);
     //updates the choices with info about a hit guess
-    void updateChoiceMapHitInfo(int row, int col);
+    void updateChoiceMapHitInfo(CellId cell);
     //updates the choices with info about a miss guess
-    void updateChoiceMapMissInfo(int row, int col);
+    void updateChoiceMapMissInfo(CellId cell);
     //updates the choices with the info about a found plane
-    void updateChoiceMapPlaneData(const Plane& pl);
+    void updateChoiceMapPlaneData(PlaneId plane);
 
     //Calculate the number of choice points influenced by a point
-    int noPointsInfluenced(const QPoint& qp);
+    int noPointsInfluenced(const GridPoint& qp);
 };
 
 
@@ -179,7 +307,8 @@ private:
 class RevertComputerLogic: public ComputerLogic
 {
     //the list of guess points
-    QList<GuessPoint> m_playList;
+    //it is not kept in the arena because it survives the reset in revert()
+    std::vector<PackedGuess> m_playList;
     //the current position in the list of guess points
     int m_pos;
 
@@ -195,7 +324,7 @@ public:
     void next();
 
     bool hasPrev() { return m_pos >= 0; }
-    bool hasNext() { return m_pos < m_playList.size() - 1; }
+    bool hasNext() { return m_pos < static_cast<int>(m_playList.size()) - 1; }
 };
 
 #endif // COMPUTERLOGIC_H
@@ -0,0 +1,36 @@
+#include "computermoveworker.h"
+#include <QMutexLocker>
+
+//constructor
+ComputerMoveWorker::ComputerMoveWorker(ComputerLogic* logic, QMutex* logicMutex, const QAtomicInt* currentRequest):
+    m_logic(logic),
+    m_logicMutex(logicMutex),
+    m_currentRequest(currentRequest)
+{
+}
+
+//computes a move with the computer's strategy
+//requests cancelled while they were waiting in the queue are skipped
+void ComputerMoveWorker::computeMove(int request)
+{
+    if (request != m_currentRequest->load())
+        return;
+
+    QMutexLocker locker(m_logicMutex);
+
+    //the round might have been reset while waiting for the lock
+    if (request != m_currentRequest->load())
+        return;
+
+    GridPoint qp;
+    const bool found = m_logic->makeChoice(qp);
+
+    //a cancelled computation is not reported
+    if (request != m_currentRequest->load())
+        return;
+
+    if (found)
+        emit moveComputed(request, QPoint(qp.x(), qp.y()));
+    else
+        emit moveNotFound(request);
+}
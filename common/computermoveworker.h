@@ -0,0 +1,41 @@
+#ifndef COMPUTERMOVEWORKER_H
+#define COMPUTERMOVEWORKER_H
+
+#include "computerlogic.h"
+#include <QAtomicInt>
+#include <QMutex>
+#include <QObject>
+#include <QPoint>
+
+//computes the computer's moves on a worker thread
+//so that an expensive strategy does not block the user interface
+//the object lives in the worker thread of a PlaneRound
+//and communicates with it only through queued signals
+class ComputerMoveWorker: public QObject
+{
+    Q_OBJECT
+
+    //the computer's strategy
+    ComputerLogic* m_logic;
+    //protects the computer logic against a reset during a computation
+    QMutex* m_logicMutex;
+    //the number of the request that is currently awaited by the round
+    //requests with another number were cancelled
+    const QAtomicInt* m_currentRequest;
+
+public:
+    //constructor
+    ComputerMoveWorker(ComputerLogic* logic, QMutex* logicMutex, const QAtomicInt* currentRequest);
+
+public slots:
+    //computes a move for the request with the given number
+    void computeMove(int request);
+
+signals:
+    //signals that a move was computed for the request with the given number
+    void moveComputed(int request, QPoint qp);
+    //signals that the strategy found no move for the request with the given number
+    void moveNotFound(int request);
+};
+
+#endif // COMPUTERMOVEWORKER_H
@@ -0,0 +1,100 @@
+#include "computerstrategy.h"
+#include "plane.h"
+
+//adds a strategy to the registry
+//a strategy with the same name is replaced
+void StrategyRegistry::registerStrategy(const std::string& name, std::shared_ptr<const ComputerStrategy> strategy, int weight)
+{
+    int idx = find(name);
+    if (idx != -1) {
+        m_entries[idx].m_strategy = strategy;
+        m_entries[idx].m_weight = weight;
+        return;
+    }
+
+    Entry entry;
+    entry.m_name = name;
+    entry.m_strategy = strategy;
+    entry.m_weight = weight;
+    m_entries.push_back(entry);
+}
+
+//changes the mixing weight of a strategy
+bool StrategyRegistry::setWeight(const std::string& name, int weight)
+{
+    int idx = find(name);
+    if (idx == -1)
+        return false;
+
+    m_entries[idx].m_weight = weight < 0 ? 0 : weight;
+    return true;
+}
+
+//makes the given strategy the only one that is used
+bool StrategyRegistry::selectOnly(const std::string& name)
+{
+    if (find(name) == -1)
+        return false;
+
+    for (unsigned int i = 0; i < m_entries.size(); i++)
+        m_entries[i].m_weight = (m_entries[i].m_name == name) ? 1 : 0;
+    return true;
+}
+
+//returns the mixing weight of a strategy
+int StrategyRegistry::weight(const std::string& name) const
+{
+    int idx = find(name);
+    return idx == -1 ? -1 : m_entries[idx].m_weight;
+}
+
+//returns the names of the registered strategies
+std::vector<std::string> StrategyRegistry::names() const
+{
+    std::vector<std::string> toReturn;
+    for (unsigned int i = 0; i < m_entries.size(); i++)
+        toReturn.push_back(m_entries[i].m_name);
+    return toReturn;
+}
+
+//the strategy used for most moves
+int StrategyRegistry::mainStrategy() const
+{
+    int idx = -1;
+    for (unsigned int i = 0; i < m_entries.size(); i++)
+        if (idx == -1 || m_entries[i].m_weight > m_entries[idx].m_weight)
+            idx = static_cast<int>(i);
+    return idx;
+}
+
+//draws a strategy by weight and evaluates only this one
+bool StrategyRegistry::choose(const ComputerLogic& logic, GridPoint& qp) const
+{
+    if (m_entries.empty())
+        return false;
+
+    int totalWeight = 0;
+    for (unsigned int i = 0; i < m_entries.size(); i++)
+        totalWeight += m_entries[i].m_weight;
+
+    //without weights the first strategy is used
+    if (totalWeight <= 0)
+        return m_entries[0].m_strategy->choose(logic, qp);
+
+    int idx = 0;
+    int draw = Plane::generateRandomNumber(totalWeight);
+    while (draw >= m_entries[idx].m_weight) {
+        draw -= m_entries[idx].m_weight;
+        idx++;
+    }
+    return m_entries[idx].m_strategy->choose(logic, qp);
+}
+
+//finds a strategy by name
+int StrategyRegistry::find(const std::string& name) const
+{
+    for (unsigned int i = 0; i < m_entries.size(); i++)
+        if (m_entries[i].m_name == name)
+            return static_cast<int>(i);
+    return -1;
+}
@@ -0,0 +1,60 @@
+#ifndef COMPUTERSTRATEGY_H
+#define COMPUTERSTRATEGY_H
+
+#include "gridpoint.h"
+#include <memory>
+#include <string>
+#include <vector>
+
+class ComputerLogic;
+
+//interface of a way of choosing the computer's next move
+class ComputerStrategy
+{
+public:
+    virtual ~ComputerStrategy() {}
+    //chooses the next move from the knowledge kept in the computer logic
+    //returns false when the strategy has no move to propose
+    virtual bool choose(const ComputerLogic& logic, GridPoint& qp) const = 0;
+};
+
+//a list of named strategies with mixing weights
+//for each move one strategy is drawn with a probability proportional to its weight
+//and only this strategy is evaluated; when it has no move there is none
+class StrategyRegistry
+{
+    struct Entry
+    {
+        std::string m_name;
+        std::shared_ptr<const ComputerStrategy> m_strategy;
+        int m_weight;
+    };
+
+    std::vector<Entry> m_entries;
+
+public:
+    //adds a strategy or replaces the strategy with the same name
+    void registerStrategy(const std::string& name, std::shared_ptr<const ComputerStrategy> strategy, int weight);
+    //changes the weight of a strategy, returns false if there is no strategy with this name
+    bool setWeight(const std::string& name, int weight);
+    //sets the weight of the given strategy to 1 and of all the others to 0
+    bool selectOnly(const std::string& name);
+    //returns the weight of a strategy or -1 if there is no strategy with this name
+    int weight(const std::string& name) const;
+    //the names of the registered strategies
+    std::vector<std::string> names() const;
+    //the position in names() of the strategy with the largest weight,
+    //the first one when several have it, or -1 if there is no strategy
+    int mainStrategy() const;
+
+    //chooses a move with one of the strategies, returns false when the
+    //drawn strategy has no move; the first registered strategy is used
+    //when no strategy has a positive weight
+    bool choose(const ComputerLogic& logic, GridPoint& qp) const;
+
+private:
+    //the position of a strategy in the list or -1
+    int find(const std::string& name) const;
+};
+
+#endif // COMPUTERSTRATEGY_H
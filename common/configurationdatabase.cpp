@@ -0,0 +1,156 @@
+#include "configurationdatabase.h"
+#include "planestencils.h"
+#include <cstdio>
+#include <map>
+#include <mutex>
+#include <sstream>
+
+namespace {
+
+//the masks of the plane positions of a grid
+struct PositionMasks
+{
+    uint64_t m_occupied[2];
+    uint64_t m_head[2];
+};
+
+//adds the planes from the given position on, keeping the positions in ascending
+//order so that each set of planes is enumerated once
+void addPlanes(const std::vector<PositionMasks>& positions, unsigned int first, int planesLeft,
+               ConfigurationDatabase::Record& record, std::vector<ConfigurationDatabase::Record>& records)
+{
+    if (planesLeft == 0) {
+        records.push_back(record);
+        return;
+    }
+
+    for (unsigned int i = first; i < positions.size(); i++) {
+        const PositionMasks& position = positions[i];
+        if ((record.m_occupied[0] & position.m_occupied[0]) || (record.m_occupied[1] & position.m_occupied[1]))
+            continue;
+
+        ConfigurationDatabase::Record next = record;
+        for (int w = 0; w < 2; w++) {
+            next.m_occupied[w] |= position.m_occupied[w];
+            next.m_heads[w] |= position.m_head[w];
+        }
+        addPlanes(positions, i + 1, planesLeft - 1, next, records);
+    }
+}
+
+}
+
+//constructor
+ConfigurationDatabase::ConfigurationDatabase():
+    m_header(nullptr),
+    m_records(nullptr)
+{
+}
+
+//maps a database file
+//the databases already opened are remembered for as long as somebody uses them
+std::shared_ptr<const ConfigurationDatabase> ConfigurationDatabase::open(const std::string& path)
+{
+    static std::mutex mutex;
+    static std::map<std::string, std::weak_ptr<const ConfigurationDatabase> > databases;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    std::shared_ptr<const ConfigurationDatabase> database = databases[path].lock();
+    if (database)
+        return database;
+
+    std::shared_ptr<ConfigurationDatabase> newDatabase(new ConfigurationDatabase());
+    if (!newDatabase->load(path))
+        return std::shared_ptr<const ConfigurationDatabase>();
+
+    databases[path] = newDatabase;
+    return newDatabase;
+}
+
+//maps a file and checks that it is a database
+bool ConfigurationDatabase::load(const std::string& path)
+{
+    static_assert(sizeof(Header) == 32 && sizeof(Record) == 32, "records must stay aligned on 32 bytes");
+
+    if (!m_file.open(path))
+        return false;
+
+    if (m_file.size() < sizeof(Header))
+        return false;
+
+    const Header* header = reinterpret_cast<const Header*>(m_file.data());
+    if (header->m_magic != Magic || header->m_version != Version)
+        return false;
+
+    if (m_file.size() < sizeof(Header) + header->m_configurationNo * sizeof(Record))
+        return false;
+
+    m_header = header;
+    m_records = reinterpret_cast<const Record*>(m_file.data() + sizeof(Header));
+    return true;
+}
+
+//writes a database file
+bool ConfigurationDatabase::write(const std::string& path, int rowNo, int colNo, int planeNo, const std::vector<Record>& records)
+{
+    Header header;
+    header.m_magic = Magic;
+    header.m_version = Version;
+    header.m_rowNo = static_cast<uint16_t>(rowNo);
+    header.m_colNo = static_cast<uint16_t>(colNo);
+    header.m_planeNo = static_cast<uint16_t>(planeNo);
+    header.m_reserved = 0;
+    header.m_configurationNo = static_cast<uint32_t>(records.size());
+    header.m_reserved2 = 0;
+    header.m_reserved3 = 0;
+
+    FILE* file = std::fopen(path.c_str(), "wb");
+    if (file == nullptr)
+        return false;
+
+    bool ok = std::fwrite(&header, sizeof(header), 1, file) == 1;
+    if (ok && !records.empty())
+        ok = std::fwrite(records.data(), sizeof(Record), records.size(), file) == records.size();
+
+    return std::fclose(file) == 0 && ok;
+}
+
+//the usual file name of the database for a geometry, e.g. planes_10x10_3.configs
+std::string ConfigurationDatabase::defaultFileName(int rowNo, int colNo, int planeNo)
+{
+    std::ostringstream name;
+    name << "planes_" << rowNo << "x" << colNo << "_" << planeNo << ".configs";
+    return name.str();
+}
+
+//enumerates all the placements of the planes on a grid
+bool ConfigurationDatabase::enumerate(int rowNo, int colNo, int planeNo, std::vector<Record>& records)
+{
+    if (rowNo * colNo > MaxPointNo)
+        return false;
+
+    const PlaneStencils& stencils = PlaneStencils::forGrid(rowNo, colNo);
+    std::vector<PositionMasks> positions;
+    for (int position = 0; position < stencils.planePositionNo(); position++) {
+        if (!stencils.isValid(position))
+            continue;
+
+        PositionMasks masks = {};
+        const int* footprint = stencils.footprint(position);
+        for (int k = 0; k < PlaneStencils::PlanePointsNo; k++)
+            masks.m_occupied[footprint[k] / 64] |= uint64_t(1) << (footprint[k] % 64);
+        masks.m_head[footprint[0] / 64] |= uint64_t(1) << (footprint[0] % 64);
+        positions.push_back(masks);
+    }
+
+    Record empty = {};
+    records.clear();
+    addPlanes(positions, 0, planeNo, empty, records);
+    return true;
+}
+
+//whether the database was built for the given geometry
+bool ConfigurationDatabase::matches(int rowNo, int colNo, int planeNo) const
+{
+    return m_header->m_rowNo == rowNo && m_header->m_colNo == colNo && m_header->m_planeNo == planeNo;
+}
@@ -0,0 +1,80 @@
+#ifndef CONFIGURATIONDATABASE_H
+#define CONFIGURATIONDATABASE_H
+
+#include "mappedfile.h"
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+//All the placements of the planes on one grid geometry.
+//A configuration is stored as two bit masks over the grid points,
+//bit col * rowNo + row: the points covered by the planes and their heads.
+//Each mask has 128 bits, so the database is limited to grids of 128 points.
+//The file is built offline (see tools/configurationdbbuilder) and
+//memory-mapped; ConfigurationFilter keeps the configurations agreeing
+//with the guesses of a game.
+//
+//File layout, in the byte order of the machine that built it:
+//  Header                          32 bytes
+//  Record records[configurationNo] 32 bytes each, aligned on 32 bytes
+class ConfigurationDatabase
+{
+public:
+    //"PLCD"
+    static const uint32_t Magic = 0x44434c50;
+    static const uint32_t Version = 1;
+    //the largest grid a record can describe
+    static const int MaxPointNo = 128;
+
+    struct Header
+    {
+        uint32_t m_magic;
+        uint32_t m_version;
+        uint16_t m_rowNo;
+        uint16_t m_colNo;
+        uint16_t m_planeNo;
+        uint16_t m_reserved;
+        uint32_t m_configurationNo;
+        uint32_t m_reserved2;
+        uint64_t m_reserved3;
+    };
+
+    //a configuration, in the layout expected by ChoiceKernels::m_filterRecords
+    struct Record
+    {
+        uint64_t m_occupied[2];
+        uint64_t m_heads[2];
+    };
+
+private:
+    MappedFile m_file;
+    const Header* m_header;
+    const Record* m_records;
+
+public:
+    ConfigurationDatabase();
+
+    //maps a database file
+    //databases are shared: opening the same file twice gives the same object
+    //returns an empty pointer if the file is missing or invalid
+    static std::shared_ptr<const ConfigurationDatabase> open(const std::string& path);
+    //writes a database file, returns false if it cannot be written
+    static bool write(const std::string& path, int rowNo, int colNo, int planeNo, const std::vector<Record>& records);
+    //the usual file name of the database for a geometry, e.g. planes_10x10_3.configs
+    static std::string defaultFileName(int rowNo, int colNo, int planeNo);
+    //enumerates all the placements of the planes on a grid
+    //returns false if the grid has more than MaxPointNo points
+    static bool enumerate(int rowNo, int colNo, int planeNo, std::vector<Record>& records);
+
+    //whether the database was built for the given geometry
+    bool matches(int rowNo, int colNo, int planeNo) const;
+    int configurationNo() const { return static_cast<int>(m_header->m_configurationNo); }
+    const Record* records() const { return m_records; }
+
+private:
+    //maps a file and checks that it is a database
+    bool load(const std::string& path);
+};
+
+#endif // CONFIGURATIONDATABASE_H
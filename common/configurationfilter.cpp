@@ -0,0 +1,141 @@
+#include "configurationfilter.h"
+#include <algorithm>
+
+//constructor
+ConfigurationFilter::ConfigurationFilter():
+    m_rowNo(0),
+    m_pointNo(0),
+    m_all(true),
+    m_pending(false)
+{
+    std::fill(m_clearMask, m_clearMask + ChoiceKernels::RecordWords, 0);
+    std::fill(m_setMask, m_setMask + ChoiceKernels::RecordWords, 0);
+}
+
+//uses a database
+void ConfigurationFilter::setDatabase(std::shared_ptr<const ConfigurationDatabase> database, int rowNo, int colNo)
+{
+    m_database = database;
+    m_rowNo = rowNo;
+    m_pointNo = rowNo * colNo;
+    m_survivors.clear();
+    m_survivors.shrink_to_fit();
+    reset();
+}
+
+//forgets the guesses
+//the list of survivors keeps its capacity for the next game
+void ConfigurationFilter::reset()
+{
+    m_survivors.clear();
+    m_all = true;
+    m_pending = false;
+    std::fill(m_clearMask, m_clearMask + ChoiceKernels::RecordWords, 0);
+    std::fill(m_setMask, m_setMask + ChoiceKernels::RecordWords, 0);
+}
+
+//copies the survivors of another filter using the same database
+bool ConfigurationFilter::assign(const ConfigurationFilter& other)
+{
+    if(m_database != other.m_database)
+        return false;
+
+    m_rowNo = other.m_rowNo;
+    m_pointNo = other.m_pointNo;
+    m_survivors = other.m_survivors;
+    m_all = other.m_all;
+    m_pending = other.m_pending;
+    std::copy(other.m_clearMask, other.m_clearMask + ChoiceKernels::RecordWords, m_clearMask);
+    std::copy(other.m_setMask, other.m_setMask + ChoiceKernels::RecordWords, m_setMask);
+    return true;
+}
+
+//records a guess
+//the words of a record are the covered points followed by the heads
+void ConfigurationFilter::addGuess(const GuessPoint& gp)
+{
+    if(!m_database)
+        return;
+
+    const int point = gp.m_col * m_rowNo + gp.m_row;
+    const int word = point / 64;
+    const uint64_t bit = uint64_t(1) << (point % 64);
+    const int occupiedWord = word;
+    const int headWord = 2 + word;
+
+    if(gp.isMiss()) {
+        m_clearMask[occupiedWord] |= bit;
+        m_clearMask[headWord] |= bit;
+    } else if(gp.isHit()) {
+        m_setMask[occupiedWord] |= bit;
+        m_clearMask[headWord] |= bit;
+    } else {
+        m_setMask[occupiedWord] |= bit;
+        m_setMask[headWord] |= bit;
+    }
+    m_pending = true;
+}
+
+//the number of configurations agreeing with the guesses
+int ConfigurationFilter::survivorNo()
+{
+    if(!m_database)
+        return 0;
+
+    applyPending();
+    return m_all ? m_database->configurationNo() : static_cast<int>(m_survivors.size());
+}
+
+//computes for each grid point the probabilities of a dead and a hit result
+//each configuration adds one to the counters of its covered points and heads
+bool ConfigurationFilter::computeProbabilities(float* pDead, float* pHit)
+{
+    const int configurationNo = survivorNo();
+    if(configurationNo == 0)
+        return false;
+
+    const int pointNo = ConfigurationDatabase::MaxPointNo;
+    m_headCounts.assign(pointNo, 0);
+    m_coverCounts.assign(pointNo, 0);
+
+    const ConfigurationDatabase::Record* records = m_database->records();
+    for(int i = 0; i < configurationNo; i++) {
+        const ConfigurationDatabase::Record& record = records[m_all ? i : m_survivors[i]];
+        for(int w = 0; w < 2; w++) {
+            for(uint64_t bits = record.m_occupied[w]; bits != 0; bits &= bits - 1)
+                m_coverCounts[w * 64 + __builtin_ctzll(bits)]++;
+            for(uint64_t bits = record.m_heads[w]; bits != 0; bits &= bits - 1)
+                m_headCounts[w * 64 + __builtin_ctzll(bits)]++;
+        }
+    }
+
+    const float scale = 1.0f / configurationNo;
+    for(int point = 0; point < m_pointNo; point++) {
+        pDead[point] = m_headCounts[point] * scale;
+        pHit[point] = (m_coverCounts[point] - m_headCounts[point]) * scale;
+    }
+    return true;
+}
+
+//applies the pending guesses to the survivors
+//the first pass goes over the whole database, the next ones over the survivors
+void ConfigurationFilter::applyPending()
+{
+    if(!m_pending)
+        return;
+
+    const ChoiceKernels& kernels = ChoiceKernels::active();
+    const uint64_t* records = reinterpret_cast<const uint64_t*>(m_database->records());
+    if(m_all) {
+        m_survivors.resize(m_database->configurationNo());
+        int survivorNo = kernels.m_filterRecords(records, nullptr, m_database->configurationNo(), m_clearMask, m_setMask, m_survivors.data());
+        m_survivors.resize(survivorNo);
+        m_all = false;
+    } else {
+        int survivorNo = kernels.m_filterRecords(records, m_survivors.data(), static_cast<int>(m_survivors.size()), m_clearMask, m_setMask, m_survivors.data());
+        m_survivors.resize(survivorNo);
+    }
+
+    //the guesses applied are kept in the masks, testing them again changes nothing
+    m_pending = false;
+}
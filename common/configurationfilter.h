@@ -0,0 +1,70 @@
+#ifndef CONFIGURATIONFILTER_H
+#define CONFIGURATIONFILTER_H
+
+#include "configurationdatabase.h"
+#include "choicekernels.h"
+#include "guesspoint.h"
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+//Keeps the configurations of a ConfigurationDatabase that agree with the
+//guesses of a game. The survivors are kept as a list of indices between moves.
+//A guess only adds bits to two masks: the bits that must be clear (the covered
+//points for a miss, the heads for a miss or a hit) and the bits that must be set
+//(the covered points for a hit or a dead, the heads for a dead). The masks are
+//applied with the record kernels when the survivors are needed, so that several
+//guesses cost one pass over the survivors.
+//
+//With the survivors the probabilities of the results at each point are exact:
+//they are counted in one pass instead of being estimated from the choice map.
+class ConfigurationFilter
+{
+    std::shared_ptr<const ConfigurationDatabase> m_database;
+    int m_rowNo;
+    int m_pointNo;
+
+    //the indices of the configurations agreeing with the guesses already applied
+    std::vector<int> m_survivors;
+    //whether no guess was applied yet; m_survivors is not used then
+    bool m_all;
+    //the masks of all the guesses
+    uint64_t m_clearMask[ChoiceKernels::RecordWords];
+    uint64_t m_setMask[ChoiceKernels::RecordWords];
+    //whether some guesses were not applied to the survivors yet
+    bool m_pending;
+
+    //work arrays of computeProbabilities(), one element per grid point
+    std::vector<int> m_headCounts;
+    std::vector<int> m_coverCounts;
+
+public:
+    ConfigurationFilter();
+
+    //uses a database for a grid and forgets the guesses
+    //an empty pointer disables the filter
+    void setDatabase(std::shared_ptr<const ConfigurationDatabase> database, int rowNo, int colNo);
+    const std::shared_ptr<const ConfigurationDatabase>& database() const { return m_database; }
+    bool isEnabled() const { return m_database != nullptr; }
+
+    //forgets the guesses
+    void reset();
+    //copies the survivors of another filter using the same database
+    //returns false and changes nothing if the databases are different
+    bool assign(const ConfigurationFilter& other);
+    //records a guess; nothing is done if the filter is disabled
+    void addGuess(const GuessPoint& gp);
+
+    //the number of configurations agreeing with the guesses, 0 if the filter is disabled
+    int survivorNo();
+    //computes for each grid point the probabilities of a dead and a hit result,
+    //the arrays have one element per grid point
+    //returns false if the filter is disabled or no configuration agrees with the guesses
+    bool computeProbabilities(float* pDead, float* pHit);
+
+private:
+    //applies the pending guesses to the survivors
+    void applyPending();
+};
+
+#endif // CONFIGURATIONFILTER_H
@@ -0,0 +1,379 @@
+#include "endgamesolver.h"
+#include "computerlogic.h"
+#include <algorithm>
+#include <climits>
+#include <mutex>
+
+namespace {
+
+//the cache is cleared when it has this number of moves
+const std::size_t MaxCacheSize = 1 << 16;
+//the search is given up when it has memoized this number of subsets
+const int MaxNodeNo = 2048;
+//a point without a guess
+const uint8_t NotGuessed = 0xff;
+
+std::mutex& cacheMutex()
+{
+    static std::mutex mutex;
+    return mutex;
+}
+
+//the moves of the decision trees, keyed by the set of hypotheses
+std::unordered_map<std::string, int>& cache()
+{
+    static std::unordered_map<std::string, int> moves;
+    return moves;
+}
+
+int countBits(uint64_t set)
+{
+    return __builtin_popcountll(set);
+}
+
+}
+
+//chooses the optimal move for the guesses of the logic
+//most moves are made with more than one head left, they are
+//told apart before any memory is allocated
+bool EndgameSolver::choose(const ComputerLogic& logic, int& point)
+{
+    const ArenaVector<GuessPoint>& guesses = logic.getListGuesses();
+    int deadNo = 0;
+    for(unsigned int i = 0; i < guesses.size(); i++)
+        deadNo += guesses[i].isDead();
+    if(deadNo != logic.getPlaneNo() - 1)
+        return false;
+
+    EndgameSolver solver(logic);
+    if(!solver.enumerate(logic) || solver.m_hypotheses.empty())
+        return false;
+
+    const int hypothesisNo = static_cast<int>(solver.m_hypotheses.size());
+    if(hypothesisNo == 1) {
+        point = solver.m_hypotheses[0].m_positions[0].headCell();
+        return true;
+    }
+
+    solver.computeMasks(logic);
+    const uint64_t all = hypothesisNo == 64 ? ~uint64_t(0) : (uint64_t(1) << hypothesisNo) - 1;
+    const std::string allKey = solver.key(all);
+    {
+        std::lock_guard<std::mutex> lock(cacheMutex());
+        std::unordered_map<std::string, int>::const_iterator it = cache().find(allKey);
+        if(it != cache().end()) {
+            point = it->second;
+            return true;
+        }
+    }
+
+    Memo memo;
+    Node root = solver.solve(all, memo);
+    if(root.m_point == -1)
+        return false;
+
+    {
+        std::lock_guard<std::mutex> lock(cacheMutex());
+        if(cache().size() >= MaxCacheSize)
+            cache().clear();
+        solver.cacheTree(all, memo);
+    }
+
+    point = root.m_point;
+    return true;
+}
+
+//forgets the cached moves
+void EndgameSolver::clearCache()
+{
+    std::lock_guard<std::mutex> lock(cacheMutex());
+    cache().clear();
+}
+
+//constructor
+EndgameSolver::EndgameSolver(const ComputerLogic& logic):
+    m_rowNo(logic.getRowNo()),
+    m_colNo(logic.getColNo()),
+    m_planeNo(logic.getPlaneNo())
+{
+}
+
+//enumerates the hypotheses
+//the found heads are taken in the order of their points and the positions
+//in ascending order, so the same set of hypotheses is always in the same order
+bool EndgameSolver::enumerate(const ComputerLogic& logic)
+{
+    const int pointNo = m_rowNo * m_colNo;
+    const PlaneStencils& stencils = PlaneStencils::forGrid(m_rowNo, m_colNo);
+    const ArenaVector<GuessPoint>& guesses = logic.getListGuesses();
+
+    std::vector<uint8_t> results(pointNo, NotGuessed);
+    std::vector<int> heads;
+    std::vector<int> hits;
+    for(unsigned int i = 0; i < guesses.size(); i++) {
+        CellId point = stencils.cellId(guesses[i].m_row, guesses[i].m_col);
+        results[point] = static_cast<uint8_t>(guesses[i].m_type);
+        if(guesses[i].isDead())
+            heads.push_back(point);
+        else if(guesses[i].isHit())
+            hits.push_back(point);
+    }
+
+    if(static_cast<int>(heads.size()) != m_planeNo - 1)
+        return false;
+    std::sort(heads.begin(), heads.end());
+
+    //the orientations possible for each found head
+    std::vector<std::vector<int> > orientations(heads.size());
+    for(unsigned int i = 0; i < heads.size(); i++) {
+        int mask = logic.propagator().orientationMask(heads[i]);
+        for(int orient = 0; orient < 4; orient++)
+            if(mask & (1 << orient))
+                orientations[i].push_back(heads[i] * 4 + orient);
+        if(orientations[i].empty())
+            return false;
+    }
+
+    std::vector<int> positions;
+    const ChoiceMap& choices = logic.getChoiceMap();
+    for(int position = 0; position < stencils.planePositionNo(); position++)
+        if(choices[position] >= 0)
+            positions.push_back(position);
+
+    //goes through the combinations of orientations of the found heads
+    std::vector<unsigned int> combination(heads.size(), 0);
+    std::vector<uint8_t> occupied(pointNo);
+    std::vector<int> unexplained;
+    while(true) {
+        std::fill(occupied.begin(), occupied.end(), 0);
+        bool ok = true;
+        for(unsigned int i = 0; i < heads.size() && ok; i++) {
+            const int* footprint = stencils.footprint(orientations[i][combination[i]]);
+            for(int k = 0; k < PlaneStencils::PlanePointsNo && ok; k++) {
+                ok = !occupied[footprint[k]] && results[footprint[k]] != GuessPoint::Miss;
+                occupied[footprint[k]] = 1;
+            }
+        }
+
+        //the hits the last plane must explain
+        unexplained.clear();
+        for(unsigned int i = 0; i < hits.size() && ok; i++)
+            if(!occupied[hits[i]])
+                unexplained.push_back(hits[i]);
+
+        for(unsigned int j = 0; j < positions.size() && ok; j++) {
+            const int* footprint = stencils.footprint(positions[j]);
+            bool possible = results[footprint[0]] == NotGuessed;
+            for(int k = 0; k < PlaneStencils::PlanePointsNo && possible; k++)
+                possible = !occupied[footprint[k]] && results[footprint[k]] != GuessPoint::Miss;
+            for(unsigned int i = 0; i < unexplained.size() && possible; i++)
+                possible = std::find(footprint + 1, footprint + PlaneStencils::PlanePointsNo, unexplained[i]) != footprint + PlaneStencils::PlanePointsNo;
+            if(!possible)
+                continue;
+
+            if(static_cast<int>(m_hypotheses.size()) == MaxHypothesisNo)
+                return false;
+
+            Hypothesis hypothesis;
+            hypothesis.m_positions.push_back(PackedPlane::fromId(positions[j]));
+            for(unsigned int i = 0; i < heads.size(); i++)
+                hypothesis.m_positions.push_back(PackedPlane::fromId(orientations[i][combination[i]]));
+            m_hypotheses.push_back(hypothesis);
+        }
+
+        //the next combination
+        unsigned int i = 0;
+        while(i < heads.size() && ++combination[i] == orientations[i].size())
+            combination[i++] = 0;
+        if(i == heads.size())
+            break;
+    }
+
+    return true;
+}
+
+//computes the result masks of the points
+void EndgameSolver::computeMasks(const ComputerLogic& logic)
+{
+    const int pointNo = m_rowNo * m_colNo;
+    const PlaneStencils& stencils = PlaneStencils::forGrid(m_rowNo, m_colNo);
+
+    std::vector<uint64_t> hitMasks(pointNo, 0);
+    std::vector<uint64_t> deadMasks(pointNo, 0);
+    for(unsigned int h = 0; h < m_hypotheses.size(); h++) {
+        const uint64_t bit = uint64_t(1) << h;
+        const std::vector<PackedPlane>& positions = m_hypotheses[h].m_positions;
+        deadMasks[positions[0].headCell()] |= bit;
+        for(unsigned int i = 0; i < positions.size(); i++) {
+            const int* footprint = stencils.footprint(positions[i].id());
+            for(int k = 1; k < PlaneStencils::PlanePointsNo; k++)
+                hitMasks[footprint[k]] |= bit;
+        }
+    }
+
+    for(int point = 0; point < pointNo; point++) {
+        if(logic.isPointGuessed(point) || (hitMasks[point] | deadMasks[point]) == 0)
+            continue;
+        m_points.push_back(point);
+        m_hitMasks.push_back(hitMasks[point]);
+        m_deadMasks.push_back(deadMasks[point]);
+    }
+
+    for(int point = 0; point < pointNo; point++)
+        if(deadMasks[point] != 0)
+            m_headMasks.push_back(deadMasks[point]);
+}
+
+//a lower bound of the cost of a subset
+//a move ends the hypotheses of at most one head and a decision tree has at
+//most 2^(d-1) moves at depth d, so at best the largest groups of hypotheses
+//with the same head end first, one group at depth 1, two at depth 2 and so on
+int EndgameSolver::lowerBound(uint64_t set) const
+{
+    if((set & (set - 1)) == 0)
+        return set == 0 ? 0 : 1;
+
+    //the sizes of the groups, sorted by insertion, there are few of them
+    int sizes[MaxHypothesisNo];
+    int groupNo = 0;
+    for(unsigned int i = 0; i < m_headMasks.size(); i++) {
+        const uint64_t group = set & m_headMasks[i];
+        if(group == 0)
+            continue;
+        const int size = countBits(group);
+        int j = groupNo++;
+        for(; j > 0 && sizes[j - 1] < size; j--)
+            sizes[j] = sizes[j - 1];
+        sizes[j] = size;
+    }
+
+    int bound = 0;
+    int depth = 1;
+    int slotsLeft = 1;
+    for(int i = 0; i < groupNo; i++) {
+        if(slotsLeft == 0) {
+            depth++;
+            slotsLeft = 1 << (depth - 1);
+        }
+        bound += depth * sizes[i];
+        slotsLeft--;
+    }
+    return bound;
+}
+
+//the cost and the best move of a subset with more than one hypothesis
+//the moves are tried in the order of their lower bounds, the search of a
+//move stops as soon as its cost reaches the best cost
+EndgameSolver::Node EndgameSolver::solve(uint64_t set, Memo& memo) const
+{
+    Memo::const_iterator it = memo.find(set);
+    if(it != memo.end())
+        return it->second;
+
+    Node best;
+    best.m_cost = INT_MAX;
+    best.m_point = -1;
+    if(static_cast<int>(memo.size()) >= MaxNodeNo)
+        return best;
+
+    const int hypothesisNo = countBits(set);
+    std::vector<Move> moves;
+    moves.reserve(m_points.size());
+    for(unsigned int i = 0; i < m_points.size(); i++) {
+        Move move;
+        move.m_dead = set & m_deadMasks[i];
+        move.m_hit = set & m_hitMasks[i];
+        const uint64_t miss = set & ~(move.m_dead | move.m_hit);
+
+        //the move gives no information
+        if(move.m_dead == 0 && (move.m_hit == set || miss == set))
+            continue;
+
+        move.m_bound = hypothesisNo + lowerBound(move.m_hit) + lowerBound(miss);
+        move.m_index = static_cast<int>(i);
+        moves.push_back(move);
+    }
+    std::sort(moves.begin(), moves.end());
+
+    for(unsigned int j = 0; j < moves.size() && moves[j].m_bound < best.m_cost; j++) {
+        const Move& move = moves[j];
+        //the moves splitting the subset in the same way are equivalent
+        if(j > 0 && move.m_hit == moves[j - 1].m_hit && move.m_dead == moves[j - 1].m_dead)
+            continue;
+
+        const uint64_t miss = set & ~(move.m_dead | move.m_hit);
+        const int hitNo = countBits(move.m_hit);
+        const int missNo = countBits(miss);
+
+        int cost = hypothesisNo + hitNo + missNo;
+        if(hitNo > 1) {
+            Node node = solve(move.m_hit, memo);
+            if(node.m_point == -1)
+                return node;
+            cost += node.m_cost - hitNo;
+        }
+        if(cost >= best.m_cost)
+            continue;
+
+        if(missNo > 1) {
+            Node node = solve(miss, memo);
+            if(node.m_point == -1)
+                return node;
+            cost += node.m_cost - missNo;
+        }
+        if(cost >= best.m_cost)
+            continue;
+
+        best.m_cost = cost;
+        best.m_point = m_points[move.m_index];
+    }
+
+    memo[set] = best;
+    return best;
+}
+
+//caches the moves of the decision tree starting at a subset
+//the subsets with one hypothesis are not cached, their move is the head
+void EndgameSolver::cacheTree(uint64_t set, const Memo& memo) const
+{
+    if(countBits(set) < 2)
+        return;
+
+    Memo::const_iterator it = memo.find(set);
+    if(it == memo.end() || it->second.m_point == -1)
+        return;
+
+    const int point = it->second.m_point;
+    cache()[key(set)] = point;
+
+    const int i = static_cast<int>(std::lower_bound(m_points.begin(), m_points.end(), point) - m_points.begin());
+    const uint64_t dead = set & m_deadMasks[i];
+    const uint64_t hit = set & m_hitMasks[i];
+    cacheTree(hit, memo);
+    cacheTree(set & ~(dead | hit), memo);
+}
+
+//the key of a subset in the cache: the geometry followed by the plane
+//positions of the hypotheses, two bytes each
+std::string EndgameSolver::key(uint64_t set) const
+{
+    std::string result;
+    result.reserve(6 + countBits(set) * m_planeNo * 2);
+
+    const int header[3] = { m_rowNo, m_colNo, m_planeNo };
+    for(int i = 0; i < 3; i++) {
+        result.push_back(static_cast<char>(header[i] & 0xff));
+        result.push_back(static_cast<char>(header[i] >> 8));
+    }
+
+    for(unsigned int h = 0; h < m_hypotheses.size(); h++) {
+        if(!(set & (uint64_t(1) << h)))
+            continue;
+        const std::vector<PackedPlane>& positions = m_hypotheses[h].m_positions;
+        for(unsigned int i = 0; i < positions.size(); i++) {
+            result.push_back(static_cast<char>(positions[i].id() & 0xff));
+            result.push_back(static_cast<char>(positions[i].id() >> 8));
+        }
+    }
+    return result;
+}
@@ -0,0 +1,113 @@
+#ifndef ENDGAMESOLVER_H
+#define ENDGAMESOLVER_H
+
+#include "packedtypes.h"
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+class ComputerLogic;
+
+//Finds the optimal moves when the head of only one plane is left to find.
+//
+//A hypothesis is a placement of the planes agreeing with all the guesses:
+//an orientation for each found head and a position for the last plane.
+//All hypotheses are equally likely. A guess splits them by its result and
+//the game ends when the last head is guessed. The solver searches the
+//decision tree with the smallest expected number of moves; for a set S of
+//hypotheses the cost is
+//  C(S) = 1 if S has one hypothesis (its head is guessed)
+//  C(S) = min over the points p of |S| + C(S hit at p) + C(S missed at p)
+//the sum over the hypotheses of the number of moves needed to find the head.
+//Subsets are kept as bit masks and memoized during a search.
+//
+//The moves of the optimal tree are cached across games and across the
+//ComputerLogic objects, keyed by the set of hypotheses, so that the later
+//moves of an endgame and the endgames met again are not searched again.
+class EndgameSolver
+{
+public:
+    //the solver is used only up to this number of hypotheses
+    static const int MaxHypothesisNo = 32;
+
+private:
+    //a hypothesis: the positions of all the planes, the last plane first
+    struct Hypothesis
+    {
+        std::vector<PackedPlane> m_positions;
+    };
+
+    //a memoized subset of hypotheses
+    struct Node
+    {
+        //the sum of the moves needed for the hypotheses of the subset
+        int m_cost;
+        //the best move
+        int m_point;
+    };
+    typedef std::unordered_map<uint64_t, Node> Memo;
+
+    //a move tried for a subset
+    struct Move
+    {
+        //the lower bound of the cost of the subset with this move
+        int m_bound;
+        //the hypotheses with a hit and a dead result
+        uint64_t m_hit;
+        uint64_t m_dead;
+        //the index of the point in m_points
+        int m_index;
+
+        //by bound, then grouping the equivalent moves
+        bool operator<(const Move& other) const
+        {
+            if(m_bound != other.m_bound)
+                return m_bound < other.m_bound;
+            if(m_hit != other.m_hit)
+                return m_hit < other.m_hit;
+            if(m_dead != other.m_dead)
+                return m_dead < other.m_dead;
+            return m_index < other.m_index;
+        }
+    };
+
+    int m_rowNo;
+    int m_colNo;
+    int m_planeNo;
+    std::vector<Hypothesis> m_hypotheses;
+    //the points not guessed yet where the hypotheses do not all give a miss
+    std::vector<int> m_points;
+    //for each point of m_points the hypotheses with a hit and with a dead result there
+    std::vector<uint64_t> m_hitMasks;
+    std::vector<uint64_t> m_deadMasks;
+    //the hypotheses with the same last head, for each head
+    std::vector<uint64_t> m_headMasks;
+
+public:
+    //chooses the optimal move for the guesses of the logic, as col * rowNo + row
+    //returns false if more than one head is left to find, there are too many
+    //hypotheses or the guesses contradict each other
+    static bool choose(const ComputerLogic& logic, int& point);
+    //forgets the cached moves
+    static void clearCache();
+
+private:
+    EndgameSolver(const ComputerLogic& logic);
+
+    //enumerates the hypotheses, returns false if there are more than MaxHypothesisNo
+    bool enumerate(const ComputerLogic& logic);
+    //computes the result masks of the points not guessed yet
+    void computeMasks(const ComputerLogic& logic);
+    //a lower bound of the cost of a subset
+    int lowerBound(uint64_t set) const;
+    //the cost and the best move of a subset with more than one hypothesis
+    //the move is -1 if the search became too large
+    Node solve(uint64_t set, Memo& memo) const;
+    //caches the moves of the decision tree starting at a subset
+    void cacheTree(uint64_t set, const Memo& memo) const;
+    //the key of a subset in the cache
+    std::string key(uint64_t set) const;
+};
+
+#endif // ENDGAMESOLVER_H
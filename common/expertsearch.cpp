@@ -0,0 +1,418 @@
+#include "expertsearch.h"
+#include "computerlogic.h"
+#include "threadpool.h"
+#include <algorithm>
+#include <future>
+#include <memory>
+#include <utility>
+
+namespace {
+
+//the largest number of candidates at a level
+const int MaxCandidateNo = 16;
+//the attempts made to draw one board
+const int MaxDrawAttempts = 2000;
+
+//a logic for the grid of a state, created again when the grid changes
+ComputerLogic& logicFor(std::unique_ptr<ComputerLogic>& logic, const ComputerLogic& state)
+{
+    if(!logic || logic->getRowNo() != state.getRowNo() || logic->getColNo() != state.getColNo() ||
+       logic->getPlaneNo() != state.getPlaneNo())
+        logic.reset(new ComputerLogic(state.getRowNo(), state.getColNo(), state.getPlaneNo()));
+    return *logic;
+}
+
+}
+
+//the logics and the boards of one thread
+//they are kept from one search to the next
+struct ExpertSearch::Workspace
+{
+    //the states of the levels of the search, the root first
+    std::vector<std::unique_ptr<ComputerLogic> > m_levels;
+    //the logic playing the games to the end
+    std::unique_ptr<ComputerLogic> m_scratch;
+    //the boards drawn at the root
+    std::vector<Board> m_boards;
+    //the found heads with their possible orientations and the positions
+    //of the other planes, from which the boards are drawn
+    std::vector<int> m_heads;
+    std::vector<int> m_orientations;
+    std::vector<int> m_positions;
+
+    //the logic of a level, holding a copy of a state
+    ComputerLogic& level(int idx, const ComputerLogic& state)
+    {
+        if(static_cast<int>(m_levels.size()) <= idx)
+            m_levels.resize(idx + 1);
+        ComputerLogic& logic = logicFor(m_levels[idx], state);
+        logic.assignState(state);
+        return logic;
+    }
+
+    //the logic playing the games to the end on the grid of a state
+    ComputerLogic& scratch(const ComputerLogic& state) { return logicFor(m_scratch, state); }
+
+    //the workspace of the calling thread
+    static Workspace& local()
+    {
+        static thread_local Workspace workspace;
+        return workspace;
+    }
+};
+
+//the settings of the expert level
+ExpertSearch::Settings ExpertSearch::defaultSettings()
+{
+    Settings settings;
+    settings.m_depth = 1;
+    settings.m_candidateNo = 5;
+    settings.m_boardNo = 40;
+    settings.m_nodeBudget = 2000;
+    settings.m_timeBudgetMs = 50;
+    return settings;
+}
+
+//takes one node
+bool ExpertSearch::Budget::take()
+{
+    return m_nodesLeft.fetch_sub(1) > 0 && !m_logic->isCancelRequested() &&
+           std::chrono::steady_clock::now() < m_deadline;
+}
+
+//constructor
+ExpertSearch::ExpertSearch(const Settings& settings):
+    m_settings(settings)
+{
+    m_settings.m_candidateNo = std::max(1, std::min(m_settings.m_candidateNo, MaxCandidateNo));
+    m_settings.m_depth = std::max(1, m_settings.m_depth);
+    m_settings.m_boardNo = std::max(1, m_settings.m_boardNo);
+}
+
+//searches the best move
+//each candidate of the root is searched by a task of the thread pool
+bool ExpertSearch::choose(const ComputerLogic& logic, GridPoint& qp) const
+{
+    //the root is a copy, the tasks must not use the object of the game
+    Workspace& workspace = Workspace::local();
+    const ComputerLogic& root = workspace.level(0, logic);
+
+    if(headsLeft(root) == 0)
+        return logic.makeChoiceMaxInformationMode(qp);
+
+    int candidates[MaxCandidateNo];
+    int candidateNo = selectCandidates(root, candidates);
+    if(candidateNo == 0)
+        return false;
+    if(candidateNo == 1) {
+        qp = logic.stencils().cellPoint(candidates[0]);
+        return true;
+    }
+
+    //the boards are drawn with the random number generator of the game
+    //so that games can be replayed
+    std::mt19937 random(Plane::generateRandomNumber(1 << 30));
+    BoardList boardList;
+    drawBoards(root, random, workspace, boardList);
+
+    if(boardList.empty())
+        return logic.makeChoiceMaxInformationMode(qp);
+
+    Budget budget;
+    budget.m_nodesLeft = m_settings.m_nodeBudget;
+    budget.m_deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(m_settings.m_timeBudgetMs);
+    budget.m_logic = &logic;
+
+    //the tasks search below the root with the workspaces of their threads
+    const int depthLeft = m_settings.m_depth - 1;
+    std::vector<std::future<float> > values;
+    for(int i = 0; i < candidateNo; i++) {
+        int point = candidates[i];
+        values.push_back(ThreadPool::shared().submit([this, &root, point, &boardList, depthLeft, &budget]() {
+            return guessValue(root, 0, point, boardList, depthLeft, Workspace::local(), budget);
+        }));
+    }
+
+    //the candidates are sorted, the first one wins the ties
+    int bestPoint = candidates[0];
+    float bestValue = values[0].get();
+    for(int i = 1; i < candidateNo; i++) {
+        float value = values[i].get();
+        if(value < bestValue) {
+            bestValue = value;
+            bestPoint = candidates[i];
+        }
+    }
+
+    qp = logic.stencils().cellPoint(bestPoint);
+    return true;
+}
+
+//measures a point against the candidates of a state
+//the point is searched like the candidates, on the same boards
+bool ExpertSearch::evaluate(const ComputerLogic& logic, int point, std::mt19937& random, Evaluation& evaluation) const
+{
+    Workspace& workspace = Workspace::local();
+    const ComputerLogic& root = workspace.level(0, logic);
+
+    if(headsLeft(root) == 0)
+        return false;
+
+    int candidates[MaxCandidateNo + 1];
+    int candidateNo = selectCandidates(root, candidates);
+    if(candidateNo == 0)
+        return false;
+
+    const bool isKnown = root.isPointGuessed(point);
+    if(!isKnown && std::find(candidates, candidates + candidateNo, point) == candidates + candidateNo)
+        candidates[candidateNo++] = point;
+
+    BoardList boardList;
+    drawBoards(root, random, workspace, boardList);
+
+    if(boardList.empty())
+        return false;
+
+    Budget budget;
+    budget.m_nodesLeft = m_settings.m_nodeBudget;
+    budget.m_deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(m_settings.m_timeBudgetMs);
+    budget.m_logic = &logic;
+
+    evaluation.m_bestPoint = candidates[0];
+    evaluation.m_bestValue = 0.0f;
+    evaluation.m_value = 0.0f;
+    for(int i = 0; i < candidateNo; i++) {
+        float value = guessValue(root, 0, candidates[i], boardList, m_settings.m_depth - 1, workspace, budget);
+        if(i == 0 || value < evaluation.m_bestValue) {
+            evaluation.m_bestValue = value;
+            evaluation.m_bestPoint = candidates[i];
+        }
+        if(candidates[i] == point)
+            evaluation.m_value = value;
+    }
+
+    //guessing a known point changes nothing
+    if(isKnown)
+        evaluation.m_value = evaluation.m_bestValue + 1.0f;
+    return true;
+}
+
+//the expected number of moves left in the state of a level
+float ExpertSearch::stateValue(const ComputerLogic& state, int level, const BoardList& boards, int depthLeft,
+                               Workspace& workspace, Budget& budget) const
+{
+    if(headsLeft(state) == 0)
+        return 0.0f;
+
+    if(depthLeft == 0)
+        return leafValue(state, boards, workspace, budget);
+
+    int candidates[MaxCandidateNo];
+    int candidateNo = selectCandidates(state, candidates);
+    if(candidateNo == 0)
+        return leafValue(state, boards, workspace, budget);
+
+    float bestValue = guessValue(state, level, candidates[0], boards, depthLeft - 1, workspace, budget);
+    for(int i = 1; i < candidateNo; i++)
+        bestValue = std::min(bestValue, guessValue(state, level, candidates[i], boards, depthLeft - 1, workspace, budget));
+    return bestValue;
+}
+
+//the expected number of moves left when guessing a point
+//the boards are split by the result of the guess; the share of the
+//boards going to a result is its probability
+float ExpertSearch::guessValue(const ComputerLogic& state, int level, int point, const BoardList& boards, int depthLeft,
+                               Workspace& workspace, Budget& budget) const
+{
+    BoardList branches[3];
+    for(unsigned int i = 0; i < boards.size(); i++)
+        branches[(*boards[i])[point]].push_back(boards[i]);
+
+    const bool lastHead = headsLeft(state) == 1;
+    float value = 1.0f;
+    for(int result = GuessPoint::Miss; result <= GuessPoint::Dead; result++) {
+        if(branches[result].empty())
+            continue;
+
+        //finding the last head ends the game
+        if(result == GuessPoint::Dead && lastHead)
+            continue;
+
+        float probability = static_cast<float>(branches[result].size()) / boards.size();
+        const ComputerLogic& child = childState(state, level, point, result, workspace);
+        value += probability * stateValue(child, level + 1, branches[result], depthLeft, workspace, budget);
+    }
+    return value;
+}
+
+//the average number of moves the information gain mode needs to end the games
+//at least one game is played even when the budget is used up
+float ExpertSearch::leafValue(const ComputerLogic& state, const BoardList& boards,
+                              Workspace& workspace, Budget& budget) const
+{
+    ComputerLogic& scratch = workspace.scratch(state);
+    int moveNo = playToEnd(state, *boards[0], scratch);
+    int gameNo = 1;
+    for(unsigned int i = 1; i < boards.size() && budget.take(); i++) {
+        moveNo += playToEnd(state, *boards[i], scratch);
+        gameNo++;
+    }
+    return static_cast<float>(moveNo) / gameNo;
+}
+
+//the number of moves the information gain mode needs to end the game on a board
+int ExpertSearch::playToEnd(const ComputerLogic& state, const Board& board, ComputerLogic& scratch) const
+{
+    const int rowNo = state.getRowNo();
+    const int pointNo = rowNo * state.getColNo();
+
+    scratch.assignState(state);
+    int deadsLeft = headsLeft(state);
+    int moveNo = 0;
+    while(deadsLeft > 0 && moveNo < pointNo) {
+        GridPoint qp;
+        if(!scratch.makeChoiceMaxInformationMode(qp))
+            return pointNo;
+
+        CellId point = state.stencils().cellId(qp);
+        GuessPoint::Type result = static_cast<GuessPoint::Type>(board[point]);
+        scratch.addData(GuessPoint(qp.x(), qp.y(), result));
+        moveNo++;
+        if(result == GuessPoint::Dead)
+            deadsLeft--;
+    }
+    return moveNo;
+}
+
+//the state after a guess
+//the child is copied from its parent into the logic of the next level, the
+//search being depth first the state that was there is no longer needed
+const ComputerLogic& ExpertSearch::childState(const ComputerLogic& state, int level, int point, int result,
+                                              Workspace& workspace) const
+{
+    ComputerLogic& child = workspace.level(level + 1, state);
+    child.addData(GuessPoint(point % state.getRowNo(), point / state.getRowNo(), static_cast<GuessPoint::Type>(result)));
+    return child;
+}
+
+//the best candidates of a state, sorted by information score
+int ExpertSearch::selectCandidates(const ComputerLogic& state, int* candidates) const
+{
+    const int pointNo = state.getRowNo() * state.getColNo();
+    std::vector<float> pDead(pointNo), pHit(pointNo);
+    if(state.computeOutcomeProbabilities(pDead.data(), pHit.data()) == 0)
+        return 0;
+
+    //the scores are computed in place of the probabilities of a dead
+    state.computeInformationScores(pDead.data(), pHit.data(), pDead.data());
+    std::vector<std::pair<float, int> > scores;
+    scores.reserve(pointNo);
+    for(int point = 0; point < pointNo; point++)
+        if(!state.isPointGuessed(point))
+            scores.push_back(std::make_pair(-pDead[point], point));
+
+    int candidateNo = std::min(m_settings.m_candidateNo, static_cast<int>(scores.size()));
+    std::partial_sort(scores.begin(), scores.begin() + candidateNo, scores.end());
+    for(int i = 0; i < candidateNo; i++)
+        candidates[i] = scores[i].second;
+    return candidateNo;
+}
+
+//draws the boards of a search into the workspace
+//the planes they are drawn from are listed once for all the boards
+void ExpertSearch::drawBoards(const ComputerLogic& state, std::mt19937& random, Workspace& workspace,
+                              BoardList& boardList) const
+{
+    const PlaneStencils& stencils = state.stencils();
+    const ArenaVector<GuessPoint>& guesses = state.getListGuesses();
+    const ChoiceMap& choices = state.getChoiceMap();
+
+    //the found heads with their possible orientations
+    workspace.m_heads.clear();
+    workspace.m_orientations.clear();
+    for(unsigned int i = 0; i < guesses.size(); i++) {
+        if(!guesses[i].isDead())
+            continue;
+        CellId point = stencils.cellId(guesses[i].m_row, guesses[i].m_col);
+        int mask = state.propagator().orientationMask(point);
+        if(mask == 0)
+            return;
+        workspace.m_heads.push_back(point);
+        workspace.m_orientations.push_back(mask);
+    }
+
+    workspace.m_positions.clear();
+    for(int position = 0; position < stencils.planePositionNo(); position++)
+        if(choices[position] >= 0)
+            workspace.m_positions.push_back(position);
+
+    if(state.getPlaneNo() > static_cast<int>(workspace.m_heads.size()) && workspace.m_positions.empty())
+        return;
+
+    //the boards keep their memory from one search to the next
+    if(static_cast<int>(workspace.m_boards.size()) < m_settings.m_boardNo)
+        workspace.m_boards.resize(m_settings.m_boardNo);
+    for(int i = 0; i < m_settings.m_boardNo; i++)
+        if(drawBoard(state, random, workspace, workspace.m_boards[i]))
+            boardList.push_back(&workspace.m_boards[i]);
+}
+
+//draws a placement of the planes that agrees with the guesses of the state
+//the found heads get one of their possible orientations and the other planes
+//one of the possible positions of the choice map, all with the same probability;
+//placements with overlapping planes or not giving the results of the guesses
+//are rejected, so that all the placements that agree are equally likely
+bool ExpertSearch::drawBoard(const ComputerLogic& state, std::mt19937& random, Workspace& workspace, Board& board)
+{
+    const int pointNo = state.getRowNo() * state.getColNo();
+    const PlaneStencils& stencils = state.stencils();
+    const ArenaVector<GuessPoint>& guesses = state.getListGuesses();
+    const std::vector<int>& heads = workspace.m_heads;
+    const std::vector<int>& orientations = workspace.m_orientations;
+    const std::vector<int>& positions = workspace.m_positions;
+
+    const int headNo = static_cast<int>(heads.size());
+    const int planeNo = state.getPlaneNo();
+    for(int attempt = 0; attempt < MaxDrawAttempts; attempt++) {
+        board.assign(pointNo, GuessPoint::Miss);
+        bool ok = true;
+
+        for(int i = 0; i < planeNo && ok; i++) {
+            int position;
+            if(i < headNo) {
+                int orient;
+                do {
+                    orient = random() % 4;
+                } while(!(orientations[i] & (1 << orient)));
+                position = heads[i] * 4 + orient;
+            } else {
+                position = positions[random() % positions.size()];
+            }
+
+            const int* footprint = stencils.footprint(position);
+            for(int k = 0; k < PlaneStencils::PlanePointsNo && ok; k++) {
+                ok = board[footprint[k]] == GuessPoint::Miss;
+                board[footprint[k]] = static_cast<uint8_t>(k == 0 ? GuessPoint::Dead : GuessPoint::Hit);
+            }
+        }
+
+        for(unsigned int i = 0; i < guesses.size() && ok; i++)
+            ok = board[stencils.cellId(guesses[i].m_row, guesses[i].m_col)] == guesses[i].m_type;
+
+        if(ok)
+            return true;
+    }
+
+    return false;
+}
+
+//the number of heads that are not found
+int ExpertSearch::headsLeft(const ComputerLogic& state)
+{
+    const ArenaVector<GuessPoint>& guesses = state.getListGuesses();
+    int deadNo = 0;
+    for(unsigned int i = 0; i < guesses.size(); i++)
+        if(guesses[i].isDead())
+            deadNo++;
+    return state.getPlaneNo() - deadNo;
+}
@@ -0,0 +1,131 @@
+#ifndef EXPERTSEARCH_H
+#define EXPERTSEARCH_H
+
+#include "computerstrategy.h"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+class ComputerLogic;
+
+//The strategy of the expert level: a depth-limited expectimax search.
+//The value of a state is the expected number of moves left until all the
+//heads are found. At each level the candidates are the points with the best
+//information score; the value of a guess is one move plus the values of the
+//states after a miss, a hit and a dead result weighted by their probabilities.
+//
+//The probabilities come from boards drawn at the root among all the placements
+//of the planes that agree with the guesses: a guess sends each board to the
+//branch of its result. At the leaves the value is the average number of moves
+//the information gain mode needs to finish the game on the boards of the leaf.
+//All the candidates are measured on the same boards, so that the differences
+//between them are not hidden by the differences between the boards.
+//
+//The candidates at the root are searched in parallel on the shared thread pool.
+//The search is depth first, so each thread keeps one ComputerLogic per level
+//and one for the games played to the end, and reuses them with assignState()
+//from one search to the next; the root and the boards drawn for it are read
+//by all the threads.
+//The search stops when the node budget or the time budget is used up or when
+//the computation is cancelled; the leaves not yet measured use the boards
+//measured so far.
+class ExpertSearch: public ComputerStrategy
+{
+public:
+    struct Settings
+    {
+        //number of own moves searched before the leaves, including the move chosen
+        int m_depth;
+        //number of candidate points at each level
+        int m_candidateNo;
+        //number of boards drawn at the root
+        int m_boardNo;
+        //maximum number of states and games played to the end
+        int m_nodeBudget;
+        //maximum duration of the search in milliseconds
+        int m_timeBudgetMs;
+    };
+
+    //the values of a played point and of the best candidate of a state,
+    //as expected numbers of moves left, this one included
+    struct Evaluation
+    {
+        int m_bestPoint;
+        float m_bestValue;
+        float m_value;
+    };
+
+    //the settings of the expert level, tuned for 10x10 grids with 3 planes
+    static Settings defaultSettings();
+
+private:
+    //the result of a guess at each grid point, as GuessPoint::Type
+    typedef std::vector<uint8_t> Board;
+    typedef std::vector<const Board*> BoardList;
+    //the logics and the boards of one thread
+    struct Workspace;
+
+    //the limits of one search, shared by the threads
+    struct Budget
+    {
+        std::atomic<int> m_nodesLeft;
+        std::chrono::steady_clock::time_point m_deadline;
+        //the object asked for the move, checked for cancellation
+        const ComputerLogic* m_logic;
+
+        //takes one node, returns false if the search must stop
+        bool take();
+    };
+
+    Settings m_settings;
+
+public:
+    explicit ExpertSearch(const Settings& settings = defaultSettings());
+
+    const Settings& settings() const { return m_settings; }
+
+    //searches the best move
+    //returns false if there is no move; falls back to the information gain mode
+    //when there is nothing to search
+    bool choose(const ComputerLogic& logic, GridPoint& qp) const override;
+
+    //measures a point against the candidates of a state for the analysis of
+    //played games, on the calling thread and with boards drawn with random;
+    //a point whose result is known is worth one move more than the best one
+    //returns false if no head is left or no board agrees with the guesses
+    bool evaluate(const ComputerLogic& logic, int point, std::mt19937& random, Evaluation& evaluation) const;
+
+private:
+    //the expected number of moves left in the state of a level
+    float stateValue(const ComputerLogic& state, int level, const BoardList& boards, int depthLeft,
+                     Workspace& workspace, Budget& budget) const;
+    //the expected number of moves left when guessing a point
+    float guessValue(const ComputerLogic& state, int level, int point, const BoardList& boards, int depthLeft,
+                     Workspace& workspace, Budget& budget) const;
+    //the average number of moves the information gain mode needs to end the games
+    float leafValue(const ComputerLogic& state, const BoardList& boards,
+                    Workspace& workspace, Budget& budget) const;
+    //the number of moves the information gain mode needs to end the game on a board
+    int playToEnd(const ComputerLogic& state, const Board& board, ComputerLogic& scratch) const;
+    //the state after a guess, kept by the workspace at the next level
+    const ComputerLogic& childState(const ComputerLogic& state, int level, int point, int result,
+                                    Workspace& workspace) const;
+
+    //the best candidates of a state, sorted by information score
+    //returns the number of candidates
+    int selectCandidates(const ComputerLogic& state, int* candidates) const;
+    //draws the boards of a search into the workspace
+    //the boards for which no placement was found are left out of the list
+    void drawBoards(const ComputerLogic& state, std::mt19937& random, Workspace& workspace,
+                    BoardList& boardList) const;
+    //draws a placement of the planes listed in the workspace that agrees with
+    //the guesses of the state
+    //returns false if none was found after a number of attempts
+    static bool drawBoard(const ComputerLogic& state, std::mt19937& random, Workspace& workspace, Board& board);
+    //the number of heads that are not found
+    static int headsLeft(const ComputerLogic& state);
+};
+
+#endif // EXPERTSEARCH_H
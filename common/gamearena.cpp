@@ -0,0 +1,99 @@
+#include "gamearena.h"
+#include <cstdint>
+#include <new>
+#include <sstream>
+
+//constructor
+//blockSize is the size of the blocks requested from the system allocator
+GameArena::GameArena(std::size_t blockSize):
+    m_blockSize(blockSize),
+    m_currentBlock(0),
+    m_offset(0),
+    m_allocationNo(0),
+    m_totalAllocationNo(0),
+    m_bytesUsed(0),
+    m_peakBytesUsed(0),
+    m_systemAllocationNo(0),
+    m_releaseNo(0)
+{
+}
+
+//destructor
+GameArena::~GameArena()
+{
+    for (std::size_t i = 0; i < m_blocks.size(); i++)
+        ::operator delete(m_blocks[i].m_data);
+}
+
+//returns a memory area of the given size and alignment
+void* GameArena::allocate(std::size_t size, std::size_t alignment)
+{
+    if (size == 0)
+        size = 1;
+
+    //searches the first block, starting with the current one,
+    //in which the requested area fits
+    while (m_currentBlock < m_blocks.size()) {
+        const Block& block = m_blocks[m_currentBlock];
+        std::uintptr_t start = reinterpret_cast<std::uintptr_t>(block.m_data) + m_offset;
+        std::size_t padding = (alignment - start % alignment) % alignment;
+
+        if (m_offset + padding + size <= block.m_size) {
+            void* toReturn = block.m_data + m_offset + padding;
+            m_offset += padding + size;
+            m_bytesUsed += padding + size;
+            if (m_bytesUsed > m_peakBytesUsed)
+                m_peakBytesUsed = m_bytesUsed;
+            m_allocationNo++;
+            m_totalAllocationNo++;
+            return toReturn;
+        }
+
+        //the rest of this block is lost until the next release
+        m_currentBlock++;
+        m_offset = 0;
+    }
+
+    //no block is large enough
+    //blocks from operator new are aligned for all fundamental types
+    addBlock(size + alignment);
+    return allocate(size, alignment);
+}
+
+//gives back all the memory in one step
+//the blocks are kept so that the next game does not call the system allocator
+void GameArena::release()
+{
+    m_currentBlock = 0;
+    m_offset = 0;
+    m_allocationNo = 0;
+    m_bytesUsed = 0;
+    m_releaseNo++;
+}
+
+//gets a new block from the system allocator
+void GameArena::addBlock(std::size_t size)
+{
+    Block block;
+    block.m_size = size > m_blockSize ? size : m_blockSize;
+    block.m_data = static_cast<char*>(::operator new(block.m_size));
+    m_blocks.push_back(block);
+    m_systemAllocationNo++;
+
+    m_currentBlock = m_blocks.size() - 1;
+    m_offset = 0;
+}
+
+//builds a report with the allocation statistics
+std::string GameArena::report() const
+{
+    std::ostringstream out;
+    out << "allocations: " << m_allocationNo
+        << " (total " << m_totalAllocationNo << ")"
+        << ", bytes: " << m_bytesUsed
+        << " (peak " << m_peakBytesUsed << ")"
+        << ", blocks: " << m_blocks.size()
+        << ", system allocations: " << m_systemAllocationNo
+        << ", releases: " << m_releaseNo;
+    return out.str();
+}
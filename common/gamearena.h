@@ -0,0 +1,115 @@
+#ifndef GAMEARENA_H
+#define GAMEARENA_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+//A bump allocator that holds the per game state
+//of the engine, of the grids and of the round.
+//Memory is taken from large blocks, individual deallocations
+//are ignored and everything is given back in one step with release().
+//The blocks are kept between games, so that after the first game
+//no more calls to the system allocator are made.
+//An arena is not shared between objects or threads.
+class GameArena
+{
+    //a block of memory from which allocations are made
+    struct Block
+    {
+        char* m_data;
+        std::size_t m_size;
+    };
+
+    //size of a regular block
+    std::size_t m_blockSize;
+    //the list of blocks obtained from the system allocator
+    std::vector<Block> m_blocks;
+    //the block from which allocations are currently made
+    std::size_t m_currentBlock;
+    //the first free byte in the current block
+    std::size_t m_offset;
+
+    //statistics
+    //allocations since the last release
+    std::size_t m_allocationNo;
+    //allocations since the arena was built
+    std::size_t m_totalAllocationNo;
+    //bytes handed out since the last release
+    std::size_t m_bytesUsed;
+    //maximum of m_bytesUsed over all games
+    std::size_t m_peakBytesUsed;
+    //number of calls to the system allocator
+    std::size_t m_systemAllocationNo;
+    //number of releases
+    std::size_t m_releaseNo;
+
+public:
+    explicit GameArena(std::size_t blockSize = 16384);
+    ~GameArena();
+
+    //returns a memory area of the given size and alignment
+    void* allocate(std::size_t size, std::size_t alignment);
+    //gives back all the memory in one step, keeps the blocks for reuse
+    void release();
+
+    //statistics
+    std::size_t allocationNo() const { return m_allocationNo; }
+    std::size_t totalAllocationNo() const { return m_totalAllocationNo; }
+    std::size_t bytesUsed() const { return m_bytesUsed; }
+    std::size_t peakBytesUsed() const { return m_peakBytesUsed; }
+    std::size_t systemAllocationNo() const { return m_systemAllocationNo; }
+    std::size_t releaseNo() const { return m_releaseNo; }
+    std::size_t blockNo() const { return m_blocks.size(); }
+    //a one line report with the allocation statistics
+    std::string report() const;
+
+private:
+    GameArena(const GameArena&) = delete;
+    GameArena& operator=(const GameArena&) = delete;
+
+    //gets a new block that can hold at least size bytes
+    void addBlock(std::size_t size);
+};
+
+//standard allocator drawing memory from a GameArena
+template <class T>
+class ArenaAllocator
+{
+    template <class U> friend class ArenaAllocator;
+    GameArena* m_arena;
+
+public:
+    typedef T value_type;
+
+    explicit ArenaAllocator(GameArena* arena): m_arena(arena) {}
+    template <class U>
+    ArenaAllocator(const ArenaAllocator<U>& other): m_arena(other.m_arena) {}
+
+    T* allocate(std::size_t n) {
+        return static_cast<T*>(m_arena->allocate(n * sizeof(T), alignof(T)));
+    }
+    //memory is given back when the arena is released
+    void deallocate(T*, std::size_t) {}
+
+    GameArena* arena() const { return m_arena; }
+
+    template <class U>
+    bool operator==(const ArenaAllocator<U>& other) const { return m_arena == other.m_arena; }
+    template <class U>
+    bool operator!=(const ArenaAllocator<U>& other) const { return m_arena != other.m_arena; }
+};
+
+//contiguous list whose storage lives in a GameArena
+template <class T>
+using ArenaVector = std::vector<T, ArenaAllocator<T> >;
+
+//empties a list and detaches it from the arena storage
+//must be called for every list before the arena is released
+template <class T>
+void detachArenaVector(ArenaVector<T>& list)
+{
+    ArenaVector<T>(list.get_allocator()).swap(list);
+}
+
+#endif // GAMEARENA_H
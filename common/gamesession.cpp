@@ -0,0 +1,252 @@
+#include "gamesession.h"
+
+//constructor
+//the lists of guesses have room for a guess on every point
+//the generator is seeded from the shared generator (see Plane::seedRandomGenerator())
+GameSession::GameSession(int rowNo, int colNo, int planeNo):
+    m_playerGrid(rowNo, colNo, planeNo, false),
+    m_computerGrid(rowNo, colNo, planeNo, true),
+    m_logic(rowNo, colNo, planeNo),
+    m_random((static_cast<uint64_t>(Plane::generateRandomNumber(1 << 30)) << 30) | Plane::generateRandomNumber(1 << 30)),
+    m_roundSeed(m_random.state()),
+    m_isComputerFirst(false),
+    m_isFinished(true),
+    m_isComputerWinner(false),
+    m_spectators(nullptr)
+{
+    m_playerGuesses.reserve(rowNo * colNo);
+    m_computerGuesses.reserve(rowNo * colNo);
+    m_isPlayerGuessed.assign(rowNo * colNo, false);
+}
+
+//starts a new round
+void GameSession::start(bool isComputerFirst)
+{
+    m_roundSeed = m_random.state();
+    RandomScope scope(m_random);
+    m_isComputerFirst = isComputerFirst;
+    m_isFinished = false;
+    m_isComputerWinner = false;
+
+    m_playerGuesses.clear();
+    m_computerGuesses.clear();
+    m_isPlayerGuessed.assign(m_isPlayerGuessed.size(), false);
+    m_stats.reset();
+    m_logic.reset();
+
+    m_playerGrid.initGrid();
+    m_computerGrid.initGrid();
+    if (m_spectators)
+        m_spectators->roundStarted(getRowNo(), getColNo(), getPlaneNo(), m_isComputerFirst, m_stats);
+}
+
+//returns the session to the state of a new one without allocating
+void GameSession::recycle()
+{
+    m_random.setState((static_cast<uint64_t>(Plane::generateRandomNumber(1 << 30)) << 30) | Plane::generateRandomNumber(1 << 30));
+    m_roundSeed = m_random.state();
+    m_isComputerFirst = false;
+    m_isFinished = true;
+    m_isComputerWinner = false;
+    m_spectators = nullptr;
+
+    m_playerGuesses.clear();
+    m_computerGuesses.clear();
+    m_isPlayerGuessed.assign(m_isPlayerGuessed.size(), false);
+    m_stats.reset();
+    m_stats.resetScore();
+    m_logic.reset();
+    m_logic.resetStrategies();
+
+    m_playerGrid.resetGrid();
+    m_computerGrid.resetGrid();
+}
+
+//the boards are taken in start()
+bool GameSession::setBoardPool(BoardPool* pool)
+{
+    return m_playerGrid.setBoardPool(pool) && m_computerGrid.setBoardPool(pool);
+}
+
+//a round in progress is sent at once
+void GameSession::setSpectatorStream(SpectatorStream* stream)
+{
+    m_spectators = stream;
+    if (m_spectators && (!m_playerGuesses.empty() || !m_computerGuesses.empty() || !m_isFinished))
+        publishKeyframe();
+}
+
+//the computer chooses a move and guesses on the player's grid
+bool GameSession::playComputerMove(GuessPoint& gp)
+{
+    if (m_isFinished)
+        return false;
+
+    RandomScope scope(m_random);
+    GridPoint qp;
+    if (!m_logic.makeChoice(qp))
+        return false;
+
+    gp = GuessPoint(qp.x(), qp.y(), m_playerGrid.getGuessResult(qp));
+    m_logic.addData(gp);
+    m_computerGuesses.push_back(PackedGuess(gp, getRowNo()));
+    m_stats.updateStats(gp, true);
+    if (m_spectators)
+        m_spectators->guessMade(gp, true, m_stats);
+    return true;
+}
+
+//a guess of the player on the computer's grid
+//a cell is guessed once, the dead results count the heads found
+bool GameSession::playPlayerGuess(int row, int col, GuessPoint& gp)
+{
+    if (m_isFinished || row < 0 || row >= getRowNo() || col < 0 || col >= getColNo())
+        return false;
+    const int cell = col * getRowNo() + row;
+    if (m_isPlayerGuessed[cell])
+        return false;
+
+    m_isPlayerGuessed[cell] = true;
+    gp = GuessPoint(row, col, m_computerGrid.getGuessResult(GridPoint(row, col)));
+    m_playerGuesses.push_back(PackedGuess(gp, getRowNo()));
+    m_stats.updateStats(gp, false);
+    if (m_spectators)
+        m_spectators->guessMade(gp, false, m_stats);
+    return true;
+}
+
+//checks whether the round has ended, as PlaneRound::endStep()
+bool GameSession::endStep()
+{
+    if (m_isFinished)
+        return true;
+
+    bool computerFinished = deadNo(m_computerGuesses) >= m_playerGrid.getPlaneNo();
+    bool playerFinished = deadNo(m_playerGuesses) >= m_computerGrid.getPlaneNo();
+    if (!computerFinished && !playerFinished)
+        return false;
+
+    m_isFinished = true;
+    m_isComputerWinner = computerFinished && !playerFinished;
+    m_stats.updateWins(m_isComputerWinner);
+    if (m_spectators)
+        m_spectators->roundEnded(m_isComputerWinner, m_stats);
+    return true;
+}
+
+//counts the dead results in a list of guesses
+int GameSession::deadNo(const std::vector<PackedGuess>& guesses)
+{
+    int count = 0;
+    for (unsigned int i = 0; i < guesses.size(); i++)
+        if (guesses[i].isDead())
+            count++;
+    return count;
+}
+
+//the flags of the round in one byte: computer first, finished, computer winner
+void GameSession::saveState(SnapshotWriter& writer) const
+{
+    writer.write(static_cast<uint16_t>(getRowNo()));
+    writer.write(static_cast<uint16_t>(getColNo()));
+    writer.write(static_cast<uint16_t>(getPlaneNo()));
+    writer.write(static_cast<uint8_t>((m_isComputerFirst ? 1 : 0) | (m_isFinished ? 2 : 0) | (m_isComputerWinner ? 4 : 0)));
+    writer.write(m_random.state());
+    writer.write(m_roundSeed);
+    m_stats.saveState(writer);
+
+    m_playerGrid.saveState(writer);
+    m_computerGrid.saveState(writer);
+    saveGuesses(writer, m_playerGuesses);
+    saveGuesses(writer, m_computerGuesses);
+    m_logic.saveState(writer);
+}
+
+bool GameSession::restoreState(SnapshotReader& reader)
+{
+    const int rowNo = reader.read<uint16_t>();
+    const int colNo = reader.read<uint16_t>();
+    const int planeNo = reader.read<uint16_t>();
+    if (rowNo != getRowNo() || colNo != getColNo() || planeNo != getPlaneNo())
+        reader.setError();
+
+    const int flags = reader.read<uint8_t>();
+    m_isComputerFirst = (flags & 1) != 0;
+    m_isFinished = (flags & 2) != 0;
+    m_isComputerWinner = (flags & 4) != 0;
+    m_random.setState(reader.read<uint64_t>());
+    m_roundSeed = reader.read<uint64_t>();
+    m_stats.restoreState(reader);
+
+    m_playerGuesses.clear();
+    m_computerGuesses.clear();
+    std::vector<bool> isComputerGuessed;
+    bool ok = !reader.hasError() &&
+            m_playerGrid.restoreState(reader) &&
+            m_computerGrid.restoreState(reader) &&
+            restoreGuesses(reader, m_playerGuesses, m_isPlayerGuessed) &&
+            restoreGuesses(reader, m_computerGuesses, isComputerGuessed) &&
+            m_logic.restoreState(reader);
+
+    if (!ok) {
+        m_isFinished = true;
+        m_playerGuesses.clear();
+        m_computerGuesses.clear();
+        m_isPlayerGuessed.assign(m_isPlayerGuessed.size(), false);
+        m_playerGrid.resetGrid();
+        m_computerGrid.resetGrid();
+        m_logic.reset();
+    } else if (m_spectators) {
+        publishKeyframe();
+    }
+    return ok;
+}
+
+//the geometry is the first 6 bytes
+bool GameSession::readGeometry(const uint8_t* data, std::size_t size, int& rowNo, int& colNo, int& planeNo)
+{
+    SnapshotReader reader(data, size);
+    rowNo = reader.read<uint16_t>();
+    colNo = reader.read<uint16_t>();
+    planeNo = reader.read<uint16_t>();
+    return !reader.hasError() && rowNo > 0 && colNo > 0 && planeNo > 0;
+}
+
+//the number of guesses and their codes
+void GameSession::saveGuesses(SnapshotWriter& writer, const std::vector<PackedGuess>& guesses)
+{
+    writer.write(static_cast<uint16_t>(guesses.size()));
+    for (unsigned int i = 0; i < guesses.size(); i++)
+        writer.write(static_cast<uint16_t>(guesses[i].code()));
+}
+
+//a list has at most one guess for each point of the grid
+bool GameSession::restoreGuesses(SnapshotReader& reader, std::vector<PackedGuess>& guesses, std::vector<bool>& isGuessed) const
+{
+    const int pointNo = getRowNo() * getColNo();
+    isGuessed.assign(pointNo, false);
+    const int guessNo = reader.readCount(pointNo);
+    for (int i = 0; i < guessNo && !reader.hasError(); i++) {
+        PackedGuess pg = PackedGuess::fromCode(reader.read<uint16_t>());
+        if (pg.cell() >= pointNo || pg.type() > GuessPoint::Dead || isGuessed[pg.cell()]) {
+            reader.setError();
+            break;
+        }
+        isGuessed[pg.cell()] = true;
+        guesses.push_back(pg);
+    }
+    return !reader.hasError();
+}
+
+//the boards are rebuilt from the lists of guesses
+void GameSession::publishKeyframe()
+{
+    m_spectators->beginRound(getRowNo(), getColNo(), getPlaneNo(), m_isComputerFirst);
+    for (unsigned int i = 0; i < m_computerGuesses.size(); i++)
+        m_spectators->addGuess(m_computerGuesses[i].toGuessPoint(getRowNo()), true);
+    for (unsigned int i = 0; i < m_playerGuesses.size(); i++)
+        m_spectators->addGuess(m_playerGuesses[i].toGuessPoint(getRowNo()), false);
+    if (m_isFinished)
+        m_spectators->endRound(m_isComputerWinner);
+    m_spectators->publishKeyframe(m_stats);
+}
@@ -0,0 +1,118 @@
+#ifndef GAMESESSION_H
+#define GAMESESSION_H
+
+#include "planegridcore.h"
+#include "computerlogic.h"
+#include "gamestatistics.h"
+#include "packedtypes.h"
+#include "guesspoint.h"
+#include "snapshotstream.h"
+#include "spectatorstream.h"
+#include <vector>
+
+//One round of the game without the GUI, driven by calls instead of signals:
+//the player's grid, the computer's grid, the computer logic, the guesses of
+//both sides and the statistics. The rules are those of PlaneRound.
+//The grids and the logic are members, so a session is one object that is
+//allocated once and reused for the following rounds; start() does not
+//allocate memory after the first round.
+class GameSession
+{
+    //the player's grid, guessed by the computer
+    PlaneGridCore m_playerGrid;
+    //the computer's grid, guessed by the player
+    PlaneGridCore m_computerGrid;
+    ComputerLogic m_logic;
+    GameStatistics m_stats;
+    //the generator used for placing the planes and by the computer's strategies
+    RandomGenerator m_random;
+    //the state of the generator when the round started, it gives the same
+    //boards and the same computer moves again; with a board pool the boards
+    //come from the pool and only the moves are given again
+    uint64_t m_roundSeed;
+
+    //the guesses of both sides in the order they were made
+    std::vector<PackedGuess> m_playerGuesses;
+    std::vector<PackedGuess> m_computerGuesses;
+    //for each cell of the computer's grid, whether the player guessed it
+    std::vector<bool> m_isPlayerGuessed;
+
+    //whether the computer makes the first move of each step
+    bool m_isComputerFirst;
+    //whether the round has ended
+    bool m_isFinished;
+    bool m_isComputerWinner;
+    //the spectators of the session, not owned
+    SpectatorStream* m_spectators;
+
+public:
+    GameSession(int rowNo, int colNo, int planeNo);
+
+    int getRowNo() const { return m_playerGrid.getRowNo(); }
+    int getColNo() const { return m_playerGrid.getColNo(); }
+    int getPlaneNo() const { return m_playerGrid.getPlaneNo(); }
+
+    //starts a new round: places the planes of both grids at random
+    //and resets the computer logic; the score is kept
+    void start(bool isComputerFirst);
+    //returns the session to the state of a new one: no round, no score, the
+    //default strategies, no spectators and a generator seeded again from the
+    //shared generator; the memory, the tables and the board pool are kept
+    //the cost is proportional to the size of the grid, used by an ObjectPool
+    void recycle();
+    //both grids take their planes from the pool while it has boards
+    //returns false if the pool is not for the geometry of the session
+    bool setBoardPool(BoardPool* pool);
+    //the stream receives the start, the guesses and the end of the rounds
+    //and a keyframe of the round in progress; nullptr for none
+    void setSpectatorStream(SpectatorStream* stream);
+
+    //the computer chooses a move and guesses on the player's grid
+    //returns false if the round has ended or the computer has no move
+    bool playComputerMove(GuessPoint& gp);
+    //a guess of the player on the computer's grid
+    //returns false if the point is outside the grid or was already guessed,
+    //or if the round has ended
+    bool playPlayerGuess(int row, int col, GuessPoint& gp);
+    //checks whether the round has ended after a complete step
+    //(one move of each side) and updates the score if it has
+    bool endStep();
+
+    bool isComputerFirst() const { return m_isComputerFirst; }
+    bool isFinished() const { return m_isFinished; }
+    bool isComputerWinner() const { return m_isComputerWinner; }
+
+    const PlaneGridCore& playerGrid() const { return m_playerGrid; }
+    const PlaneGridCore& computerGrid() const { return m_computerGrid; }
+    const ComputerLogic& logic() const { return m_logic; }
+    ComputerLogic& logic() { return m_logic; }
+    const GameStatistics& stats() const { return m_stats; }
+    const std::vector<PackedGuess>& playerGuesses() const { return m_playerGuesses; }
+    const std::vector<PackedGuess>& computerGuesses() const { return m_computerGuesses; }
+    RandomGenerator& random() { return m_random; }
+    uint64_t roundSeed() const { return m_roundSeed; }
+
+    //writes the session: the geometry, the state of the round, the score,
+    //the state of the random generator, the grids, the guesses and the computer logic
+    void saveState(SnapshotWriter& writer) const;
+    //reads a session written by saveState() for the same geometry; the round
+    //goes on from where it was saved without replaying the moves
+    //on an error the session is left without a round
+    bool restoreState(SnapshotReader& reader);
+    //reads the geometry at the start of a saved session
+    static bool readGeometry(const uint8_t* data, std::size_t size, int& rowNo, int& colNo, int& planeNo);
+
+private:
+    //counts the dead results in a list of guesses
+    static int deadNo(const std::vector<PackedGuess>& guesses);
+    //writes and reads a list of guesses, isGuessed gets the cells of the list
+    static void saveGuesses(SnapshotWriter& writer, const std::vector<PackedGuess>& guesses);
+    bool restoreGuesses(SnapshotReader& reader, std::vector<PackedGuess>& guesses, std::vector<bool>& isGuessed) const;
+    //sends the round in progress to the spectators as a keyframe
+    void publishKeyframe();
+
+    GameSession(const GameSession&) = delete;
+    GameSession& operator=(const GameSession&) = delete;
+};
+
+#endif // GAMESESSION_H
@@ -4,6 +4,12 @@
 GameStatistics::GameStatistics()
 {
     reset();
+    resetScore();
+}
+
+//resets the number of wins of both sides
+void GameStatistics::resetScore()
+{
     m_computerWins = 0;
     m_playerWins = 0;
 }
@@ -51,3 +57,23 @@ void GameStatistics::updateWins(bool isComputerWinner)
     else
         m_playerWins++;
 }
+
+//writes the fields as 32 bit integers
+void GameStatistics::saveState(SnapshotWriter& writer) const
+{
+    const int fields[] = { m_playerMoves, m_playerHits, m_playerDead, m_playerMisses,
+                           m_computerMoves, m_computerHits, m_computerDead, m_computerMisses,
+                           m_playerWins, m_computerWins };
+    for (int i = 0; i < 10; i++)
+        writer.write(static_cast<int32_t>(fields[i]));
+}
+
+bool GameStatistics::restoreState(SnapshotReader& reader)
+{
+    int* fields[] = { &m_playerMoves, &m_playerHits, &m_playerDead, &m_playerMisses,
+                      &m_computerMoves, &m_computerHits, &m_computerDead, &m_computerMisses,
+                      &m_playerWins, &m_computerWins };
+    for (int i = 0; i < 10; i++)
+        *fields[i] = reader.read<int32_t>();
+    return !reader.hasError();
+}
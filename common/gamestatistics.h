@@ -2,6 +2,7 @@
 #define GAMESTATISTICS_H
 
 #include "guesspoint.h"
+#include "snapshotstream.h"
 
 //keeps track of the moves, hits, dead, and misses of both the player and the computer
 struct GameStatistics
@@ -23,10 +24,15 @@ struct GameStatistics
     GameStatistics();
     //resets the fields related to one round of the game
     void reset();
+    //resets the score
+    void resetScore();
     //updates the statistics for one round with one guess
     void updateStats(const GuessPoint& gp, bool isComputer);
     //adds to the score
     void updateWins(bool isComputerWinner);
+    //writes and reads the fields in declaration order
+    void saveState(SnapshotWriter& writer) const;
+    bool restoreState(SnapshotReader& reader);
 };
 
 #endif // GAMESTATISTICS_H
@@ -0,0 +1,34 @@
+#ifndef GRIDPOINT_H
+#define GRIDPOINT_H
+
+//The point type of the game logic.
+//A small point class with the part of the interface of QPoint that the
+//logic uses, so that the planes core library needs only the standard
+//library. The Qt classes link that same library: they use GridPoint for
+//the points they exchange with the logic and build a QPoint where Qt
+//needs one.
+
+class GridPoint
+{
+    int m_x;
+    int m_y;
+
+public:
+    GridPoint(): m_x(0), m_y(0) {}
+    GridPoint(int x, int y): m_x(x), m_y(y) {}
+
+    int x() const { return m_x; }
+    int y() const { return m_y; }
+    void setX(int x) { m_x = x; }
+    void setY(int y) { m_y = y; }
+
+    GridPoint& operator+=(const GridPoint& other) { m_x += other.m_x; m_y += other.m_y; return *this; }
+    GridPoint& operator-=(const GridPoint& other) { m_x -= other.m_x; m_y -= other.m_y; return *this; }
+
+    friend GridPoint operator+(const GridPoint& p1, const GridPoint& p2) { return GridPoint(p1.m_x + p2.m_x, p1.m_y + p2.m_y); }
+    friend GridPoint operator-(const GridPoint& p1, const GridPoint& p2) { return GridPoint(p1.m_x - p2.m_x, p1.m_y - p2.m_y); }
+    friend bool operator==(const GridPoint& p1, const GridPoint& p2) { return p1.m_x == p2.m_x && p1.m_y == p2.m_y; }
+    friend bool operator!=(const GridPoint& p1, const GridPoint& p2) { return !(p1 == p2); }
+};
+
+#endif // GRIDPOINT_H
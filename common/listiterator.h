@@ -1,17 +1,18 @@
 #ifndef LISTITERATOR_H
 #define LISTITERATOR_H
 
-#include <QList>
+#include "smallvector.h"
 
 namespace MyIterator
 {
-//defines an iterator over a QList
+//defines an iterator over a list
+//the list is contiguous and keeps up to N elements without allocating memory
 
-template <class T>
+template <class T, int N>
 class ListIterator
 {
 protected:
-    QList<T> m_internalList;
+    SmallVector<T, N> m_internalList;
     int m_idx;
 
 public:
@@ -28,8 +29,8 @@ public:
     int itemNo() const;
 };
 
-template <class T>
-ListIterator<T>::ListIterator()
+template <class T, int N>
+ListIterator<T, N>::ListIterator()
 {
     //generates the list of points
     m_internalList.clear();
@@ -38,30 +39,30 @@ ListIterator<T>::ListIterator()
 
 }
 
-template <class T>
-void ListIterator<T>::reset()
+template <class T, int N>
+void ListIterator<T, N>::reset()
 {
     m_idx = -1;
 }
 
 //during a point iteration checks to see if there is a next point
-template <class T>
-bool ListIterator<T>::hasNext() const
+template <class T, int N>
+bool ListIterator<T, N>::hasNext() const
 {
 
     return (m_idx < m_internalList.size() - 1);
 }
 
 //during an iteration returns the next point
-template <class T>
-const T& ListIterator<T>::next()
+template <class T, int N>
+const T& ListIterator<T, N>::next()
 {
     return  m_internalList[++m_idx];
 }
 
 //returns number of points on the plane
-template <class T>
-int ListIterator<T>::itemNo() const
+template <class T, int N>
+int ListIterator<T, N>::itemNo() const
 {
     return m_internalList.size();
 }
@@ -0,0 +1,121 @@
+#include "mappedfile.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+//constructor
+MappedFile::MappedFile():
+    m_data(nullptr),
+    m_size(0)
+#ifdef _WIN32
+    , m_file(INVALID_HANDLE_VALUE),
+    m_mapping(nullptr)
+#else
+    , m_fd(-1)
+#endif
+{
+}
+
+//destructor
+MappedFile::~MappedFile()
+{
+    close();
+}
+
+#ifdef _WIN32
+
+//maps the file with the Windows API
+bool MappedFile::open(const std::string& path)
+{
+    close();
+
+    m_file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (m_file == INVALID_HANDLE_VALUE)
+        return false;
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(m_file, &size) || size.QuadPart == 0) {
+        close();
+        return false;
+    }
+
+    m_mapping = CreateFileMappingA(m_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (m_mapping == nullptr) {
+        close();
+        return false;
+    }
+
+    m_data = static_cast<const unsigned char*>(MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0));
+    if (m_data == nullptr) {
+        close();
+        return false;
+    }
+
+    m_size = static_cast<std::size_t>(size.QuadPart);
+    return true;
+}
+
+//unmaps the file
+void MappedFile::close()
+{
+    if (m_data != nullptr)
+        UnmapViewOfFile(m_data);
+    if (m_mapping != nullptr)
+        CloseHandle(m_mapping);
+    if (m_file != INVALID_HANDLE_VALUE)
+        CloseHandle(m_file);
+
+    m_data = nullptr;
+    m_size = 0;
+    m_mapping = nullptr;
+    m_file = INVALID_HANDLE_VALUE;
+}
+
+#else
+
+//maps the file with mmap
+bool MappedFile::open(const std::string& path)
+{
+    close();
+
+    m_fd = ::open(path.c_str(), O_RDONLY);
+    if (m_fd == -1)
+        return false;
+
+    struct stat st;
+    if (fstat(m_fd, &st) != 0 || st.st_size == 0) {
+        close();
+        return false;
+    }
+
+    void* data = mmap(nullptr, static_cast<std::size_t>(st.st_size), PROT_READ, MAP_SHARED, m_fd, 0);
+    if (data == MAP_FAILED) {
+        close();
+        return false;
+    }
+
+    m_data = static_cast<const unsigned char*>(data);
+    m_size = static_cast<std::size_t>(st.st_size);
+    return true;
+}
+
+//unmaps the file
+void MappedFile::close()
+{
+    if (m_data != nullptr)
+        munmap(const_cast<unsigned char*>(m_data), m_size);
+    if (m_fd != -1)
+        ::close(m_fd);
+
+    m_data = nullptr;
+    m_size = 0;
+    m_fd = -1;
+}
+
+#endif
@@ -0,0 +1,39 @@
+#ifndef MAPPEDFILE_H
+#define MAPPEDFILE_H
+
+#include <cstddef>
+#include <string>
+
+//a file mapped read-only into memory
+//the pages are loaded by the operating system when they are first used
+//so opening a large file costs almost nothing
+class MappedFile
+{
+    const unsigned char* m_data;
+    std::size_t m_size;
+#ifdef _WIN32
+    void* m_file;
+    void* m_mapping;
+#else
+    int m_fd;
+#endif
+
+public:
+    MappedFile();
+    ~MappedFile();
+
+    //maps the file, returns false if it cannot be opened or is empty
+    bool open(const std::string& path);
+    //unmaps the file
+    void close();
+
+    bool isOpen() const { return m_data != nullptr; }
+    const unsigned char* data() const { return m_data; }
+    std::size_t size() const { return m_size; }
+
+private:
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+};
+
+#endif // MAPPEDFILE_H
@@ -0,0 +1,113 @@
+#ifndef OBJECTPOOL_H
+#define OBJECTPOOL_H
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+//Keeps objects that are expensive to build for reuse: a session of the
+//server, a model of the game. acquire() returns an object kept by the pool
+//or a new one made by the factory; release() gives an object back, which is
+//returned to the state of a new one with its recycle() method and kept with
+//its memory and its tables, so that sessions opened and closed in turn do
+//not allocate once the pool holds enough of them.
+//The factory makes objects of one geometry: a program uses a pool for each.
+//The objects are recycled outside of the lock; acquire() and release() can
+//be called from any thread.
+template <class T>
+class ObjectPool
+{
+public:
+    typedef std::function<T*()> Factory;
+
+    struct Metrics
+    {
+        //the objects made by the factory and the objects given again
+        uint64_t m_created;
+        uint64_t m_reused;
+        //the objects released beyond the capacity, they are deleted
+        uint64_t m_dropped;
+        //the objects kept by the pool
+        int m_idle;
+    };
+
+private:
+    Factory m_factory;
+    const int m_capacity;
+    mutable std::mutex m_mutex;
+    //has room for the capacity, keeping an object does not allocate
+    std::vector<std::unique_ptr<T> > m_idle;
+    uint64_t m_created;
+    uint64_t m_reused;
+    uint64_t m_dropped;
+
+public:
+    //keeps at most capacity objects
+    ObjectPool(Factory factory, int capacity):
+        m_factory(factory),
+        m_capacity(capacity > 0 ? capacity : 1),
+        m_created(0),
+        m_reused(0),
+        m_dropped(0)
+    {
+        m_idle.reserve(m_capacity);
+    }
+
+    //makes objects in advance, up to the capacity
+    void reserve(int objectNo)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        while (static_cast<int>(m_idle.size()) < objectNo && static_cast<int>(m_idle.size()) < m_capacity) {
+            m_idle.push_back(std::unique_ptr<T>(m_factory()));
+            m_created++;
+        }
+    }
+
+    //an object in the state of a new one
+    std::unique_ptr<T> acquire()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (!m_idle.empty()) {
+                std::unique_ptr<T> object(std::move(m_idle.back()));
+                m_idle.pop_back();
+                m_reused++;
+                return object;
+            }
+            m_created++;
+        }
+        return std::unique_ptr<T>(m_factory());
+    }
+
+    //recycles an object and keeps it, or deletes it if the pool is full
+    void release(std::unique_ptr<T> object)
+    {
+        if (!object)
+            return;
+        object->recycle();
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (static_cast<int>(m_idle.size()) < m_capacity)
+            m_idle.push_back(std::move(object));
+        else
+            m_dropped++;
+    }
+
+    Metrics metrics() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        Metrics metrics;
+        metrics.m_created = m_created;
+        metrics.m_reused = m_reused;
+        metrics.m_dropped = m_dropped;
+        metrics.m_idle = static_cast<int>(m_idle.size());
+        return metrics;
+    }
+
+private:
+    ObjectPool(const ObjectPool&) = delete;
+    ObjectPool& operator=(const ObjectPool&) = delete;
+};
+
+#endif // OBJECTPOOL_H
@@ -0,0 +1,148 @@
+#include "openingbook.h"
+#include "packedtypes.h"
+#include <algorithm>
+#include <cstdio>
+#include <map>
+#include <mutex>
+#include <sstream>
+
+//constructor
+OpeningBook::OpeningBook():
+    m_header(nullptr),
+    m_keys(nullptr),
+    m_points(nullptr)
+{
+}
+
+//maps a book file
+//the books already opened are remembered for as long as somebody uses them
+std::shared_ptr<const OpeningBook> OpeningBook::open(const std::string& path)
+{
+    static std::mutex mutex;
+    static std::map<std::string, std::weak_ptr<const OpeningBook> > books;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    std::shared_ptr<const OpeningBook> book = books[path].lock();
+    if (book)
+        return book;
+
+    std::shared_ptr<OpeningBook> newBook(new OpeningBook());
+    if (!newBook->load(path))
+        return std::shared_ptr<const OpeningBook>();
+
+    books[path] = newBook;
+    return newBook;
+}
+
+//maps a file and checks that it is a book
+bool OpeningBook::load(const std::string& path)
+{
+    if (!m_file.open(path))
+        return false;
+
+    if (m_file.size() < sizeof(Header))
+        return false;
+
+    const Header* header = reinterpret_cast<const Header*>(m_file.data());
+    if (header->m_magic != Magic || header->m_version != Version)
+        return false;
+
+    std::size_t expectedSize = sizeof(Header) + header->m_entryNo * (sizeof(uint64_t) + sizeof(uint16_t));
+    if (m_file.size() < expectedSize)
+        return false;
+
+    m_header = header;
+    m_keys = reinterpret_cast<const uint64_t*>(m_file.data() + sizeof(Header));
+    m_points = reinterpret_cast<const uint16_t*>(m_file.data() + sizeof(Header) + header->m_entryNo * sizeof(uint64_t));
+    return true;
+}
+
+//writes a book file
+bool OpeningBook::write(const std::string& path, int rowNo, int colNo, int planeNo, int maxDepth, std::vector<Entry> entries)
+{
+    std::sort(entries.begin(), entries.end(), [](const Entry& e1, const Entry& e2) { return e1.m_key < e2.m_key; });
+
+    Header header;
+    header.m_magic = Magic;
+    header.m_version = Version;
+    header.m_rowNo = static_cast<uint16_t>(rowNo);
+    header.m_colNo = static_cast<uint16_t>(colNo);
+    header.m_planeNo = static_cast<uint16_t>(planeNo);
+    header.m_maxDepth = static_cast<uint16_t>(maxDepth);
+    header.m_entryNo = static_cast<uint32_t>(entries.size());
+    header.m_reserved = 0;
+
+    std::vector<uint64_t> keys(entries.size());
+    std::vector<uint16_t> points(entries.size());
+    for (unsigned int i = 0; i < entries.size(); i++) {
+        keys[i] = entries[i].m_key;
+        points[i] = entries[i].m_point;
+    }
+
+    FILE* file = std::fopen(path.c_str(), "wb");
+    if (file == nullptr)
+        return false;
+
+    bool ok = std::fwrite(&header, sizeof(header), 1, file) == 1;
+    if (ok && !entries.empty()) {
+        ok = std::fwrite(keys.data(), sizeof(uint64_t), keys.size(), file) == keys.size() &&
+             std::fwrite(points.data(), sizeof(uint16_t), points.size(), file) == points.size();
+    }
+
+    return std::fclose(file) == 0 && ok;
+}
+
+//the usual file name of the book for a geometry, e.g. planes_10x10_3.book
+std::string OpeningBook::defaultFileName(int rowNo, int colNo, int planeNo)
+{
+    std::ostringstream name;
+    name << "planes_" << rowNo << "x" << colNo << "_" << planeNo << ".book";
+    return name.str();
+}
+
+//canonical hash of a set of guesses
+//each guess is encoded on 16 bits as a PackedGuess,
+//the codes are sorted and hashed with 64 bit FNV-1a
+uint64_t OpeningBook::hashGuesses(const GuessPoint* guesses, int guessNo, int rowNo)
+{
+    //openings are short, longer histories are hashed from a heap copy
+    const int MaxStackGuesses = 32;
+    uint16_t stackCodes[MaxStackGuesses];
+    std::vector<uint16_t> heapCodes;
+    uint16_t* codes = stackCodes;
+    if (guessNo > MaxStackGuesses) {
+        heapCodes.resize(guessNo);
+        codes = heapCodes.data();
+    }
+
+    for (int i = 0; i < guessNo; i++)
+        codes[i] = static_cast<uint16_t>(PackedGuess(guesses[i], rowNo).code());
+    std::sort(codes, codes + guessNo);
+
+    uint64_t hash = 14695981039346656037ULL;
+    for (int i = 0; i < guessNo; i++) {
+        hash ^= codes[i] & 0xff;
+        hash *= 1099511628211ULL;
+        hash ^= codes[i] >> 8;
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+//whether the book was built for the given geometry
+bool OpeningBook::matches(int rowNo, int colNo, int planeNo) const
+{
+    return m_header->m_rowNo == rowNo && m_header->m_colNo == colNo && m_header->m_planeNo == planeNo;
+}
+
+//binary search of the key
+bool OpeningBook::lookup(uint64_t key, int& point) const
+{
+    const uint64_t* end = m_keys + m_header->m_entryNo;
+    const uint64_t* it = std::lower_bound(m_keys, end, key);
+    if (it == end || *it != key)
+        return false;
+
+    point = m_points[it - m_keys];
+    return true;
+}
@@ -0,0 +1,82 @@
+#ifndef OPENINGBOOK_H
+#define OPENINGBOOK_H
+
+#include "guesspoint.h"
+#include "mappedfile.h"
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+//Precomputed computer moves for the first moves of a game on one grid geometry.
+//The moves are keyed by a hash of the set of guesses made so far, so that
+//the same guesses made in another order give the same move.
+//The file is built offline (see tools/openingbookbuilder) and memory-mapped;
+//a lookup is a binary search in the sorted array of keys.
+//
+//File layout, in the byte order of the machine that built it:
+//  Header
+//  uint64_t keys[entryNo]    sorted ascending
+//  uint16_t points[entryNo]  the move for each key, as col * rowNo + row
+class OpeningBook
+{
+public:
+    //"PLOB"
+    static const uint32_t Magic = 0x424f4c50;
+    static const uint32_t Version = 1;
+
+    struct Header
+    {
+        uint32_t m_magic;
+        uint32_t m_version;
+        uint16_t m_rowNo;
+        uint16_t m_colNo;
+        uint16_t m_planeNo;
+        //the book contains moves for histories up to this number of guesses
+        uint16_t m_maxDepth;
+        uint32_t m_entryNo;
+        uint32_t m_reserved;
+    };
+
+    //a position of the book
+    struct Entry
+    {
+        uint64_t m_key;
+        uint16_t m_point;
+    };
+
+private:
+    MappedFile m_file;
+    const Header* m_header;
+    const uint64_t* m_keys;
+    const uint16_t* m_points;
+
+public:
+    OpeningBook();
+
+    //maps a book file
+    //books are shared: opening the same file twice gives the same object
+    //returns an empty pointer if the file is missing or invalid
+    static std::shared_ptr<const OpeningBook> open(const std::string& path);
+    //writes a book file, the entries do not need to be sorted
+    static bool write(const std::string& path, int rowNo, int colNo, int planeNo, int maxDepth, std::vector<Entry> entries);
+    //the usual name of the book for a geometry
+    static std::string defaultFileName(int rowNo, int colNo, int planeNo);
+
+    //canonical hash of a list of guesses: the guesses are sorted by grid point
+    //so that the order in which they were made does not matter
+    static uint64_t hashGuesses(const GuessPoint* guesses, int guessNo, int rowNo);
+
+    //whether the book was built for the given geometry
+    bool matches(int rowNo, int colNo, int planeNo) const;
+    int maxDepth() const { return m_header->m_maxDepth; }
+    int entryNo() const { return static_cast<int>(m_header->m_entryNo); }
+    //finds the move for a history hash; point is col * rowNo + row
+    bool lookup(uint64_t key, int& point) const;
+
+private:
+    //maps and validates a file
+    bool load(const std::string& path);
+};
+
+#endif // OPENINGBOOK_H
@@ -0,0 +1,76 @@
+#ifndef PACKEDTYPES_H
+#define PACKEDTYPES_H
+
+#include "plane.h"
+#include "guesspoint.h"
+#include <cstdint>
+
+//Compact forms of Plane and GuessPoint for the lists that are kept in bulk
+//(move histories, files, sets of candidates).
+//Both use the integer ids of PlaneStencils: the cell of a point is
+//col * rowNo + row, a plane is stored as headCell * 4 + orientation and
+//a guess as cell * 4 + result. The number of rows of the grid is needed
+//to convert them back; grids up to 16383 points can be described.
+
+//a plane position in 16 bits
+class PackedPlane
+{
+    uint16_t m_value;
+
+public:
+    PackedPlane(): m_value(0) {}
+    PackedPlane(const Plane& pl, int rowNo):
+        m_value(static_cast<uint16_t>((pl.col() * rowNo + pl.row()) * 4 + pl.orientation())) {}
+
+    //the packed value, equal to the PlaneId of the position
+    int id() const { return m_value; }
+    static PackedPlane fromId(int id) { PackedPlane pp; pp.m_value = static_cast<uint16_t>(id); return pp; }
+
+    int headCell() const { return m_value >> 2; }
+    Plane::Orientation orientation() const { return static_cast<Plane::Orientation>(m_value & 3); }
+    Plane toPlane(int rowNo) const
+    {
+        return Plane(headCell() % rowNo, headCell() / rowNo, orientation());
+    }
+
+    bool operator==(const PackedPlane& other) const { return m_value == other.m_value; }
+    bool operator!=(const PackedPlane& other) const { return m_value != other.m_value; }
+    bool operator<(const PackedPlane& other) const { return m_value < other.m_value; }
+};
+
+//a guess and its result in 16 bits
+class PackedGuess
+{
+    uint16_t m_value;
+
+public:
+    PackedGuess(): m_value(0) {}
+    PackedGuess(const GuessPoint& gp, int rowNo):
+        m_value(static_cast<uint16_t>((gp.m_col * rowNo + gp.m_row) * 4 + gp.m_type)) {}
+    PackedGuess(int cell, GuessPoint::Type type):
+        m_value(static_cast<uint16_t>(cell * 4 + type)) {}
+
+    //the packed value, used as the code of the guess in the opening book hashes
+    int code() const { return m_value; }
+    static PackedGuess fromCode(int code) { PackedGuess pg; pg.m_value = static_cast<uint16_t>(code); return pg; }
+
+    int cell() const { return m_value >> 2; }
+    GuessPoint::Type type() const { return static_cast<GuessPoint::Type>(m_value & 3); }
+    GuessPoint toGuessPoint(int rowNo) const
+    {
+        return GuessPoint(cell() % rowNo, cell() / rowNo, type());
+    }
+
+    bool isDead() const { return type() == GuessPoint::Dead; }
+    bool isHit() const { return type() == GuessPoint::Hit; }
+    bool isMiss() const { return type() == GuessPoint::Miss; }
+
+    bool operator==(const PackedGuess& other) const { return m_value == other.m_value; }
+    bool operator!=(const PackedGuess& other) const { return m_value != other.m_value; }
+    bool operator<(const PackedGuess& other) const { return m_value < other.m_value; }
+};
+
+static_assert(sizeof(PackedPlane) == 2, "PackedPlane must fit in 16 bits");
+static_assert(sizeof(PackedGuess) == 2, "PackedGuess must fit in 16 bits");
+
+#endif // PACKEDTYPES_H
@@ -1,8 +1,7 @@
 #include "plane.h"
 #include "planeiterators.h"
-#include <QPoint>
-#include <QString>
-#include <QDebug>
+#include <chrono>
+#include <cstdlib>
 
 //Various constructors
 Plane::Plane() {
@@ -17,7 +16,7 @@ Plane::Plane(int row, int col, Orientation orient) {
     m_orient = orient;
 }
 
-Plane::Plane(const QPoint& qp, Orientation orient) {
+Plane::Plane(const GridPoint& qp, Orientation orient) {
     m_row = qp.x();
     m_col = qp.y();
     m_orient = orient;
@@ -28,13 +27,6 @@ bool Plane::operator==(const Plane& pl1) const {
     return ((pl1.m_row == m_row) && (pl1.m_col == m_col) && (pl1.m_orient == m_orient));
 }
 
-//assignment operator
-void Plane::operator=(const Plane& pl1) {
-    m_row = pl1.m_row;
-    m_col = pl1.m_col;
-    m_orient = pl1.m_orient;
-}
-
 //Clockwise 90 degrees rotation of the plane
 void Plane::rotate() {
     switch(m_orient)
@@ -59,12 +51,12 @@ void Plane::rotate() {
 //checks to see if a plane contains a certain point
 //uses a PlanePointIterator which enumerates
 //all the points on the plane
-bool Plane::containsPoint(const QPoint& qp) const {
+bool Plane::containsPoint(const GridPoint& qp) const {
     PlanePointIterator ppi(*this);
 
     while(ppi.hasNext())
     {
-        QPoint qp1 = ppi.next();
+        GridPoint qp1 = ppi.next();
         if(qp == qp1)
             return true;
     }
@@ -80,7 +72,7 @@ bool Plane::isPositionValid(int row, int col) const {
 
     while(ppi.hasNext())
     {
-        QPoint qp = ppi.next();
+        GridPoint qp = ppi.next();
         if(qp.x()<0 || qp.x()>=row)
             return false;
         if(qp.y()<0 || qp.y()>=col)
@@ -90,9 +82,15 @@ bool Plane::isPositionValid(int row, int col) const {
     return true;
 }
 
+//the generator used by generateRandomNumber() on each thread, if any
+static thread_local RandomGenerator* threadGenerator = nullptr;
+
 //utility function
 //generates a random number
 int Plane::generateRandomNumber(int valmax) {
+    if (threadGenerator)
+        return threadGenerator->generate(valmax);
+
     double rnd = rand()/ static_cast<double>(RAND_MAX);
     if (rnd==1.0)
         rnd = 0.5;
@@ -101,16 +99,49 @@ int Plane::generateRandomNumber(int valmax) {
     return val;
 }
 
+//initializes the generator of random numbers with the current time
+void Plane::seedRandomGenerator()
+{
+    const long long ms = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+    srand(static_cast<unsigned int>(ms));
+}
+
+//the 32 high bits of the next value are scaled to the range
+int RandomGenerator::generate(int valmax)
+{
+    m_state += 0x9e3779b97f4a7c15ULL;
+    uint64_t z = m_state;
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    z ^= z >> 31;
+    if (valmax <= 0)
+        return 0;
+    return static_cast<int>(((z >> 32) * static_cast<uint64_t>(valmax)) >> 32);
+}
+
+//installs the generator for the thread
+RandomScope::RandomScope(RandomGenerator& generator):
+    m_previous(threadGenerator)
+{
+    threadGenerator = &generator;
+}
+
+//puts back the generator of the enclosing scope
+RandomScope::~RandomScope()
+{
+    threadGenerator = m_previous;
+}
+
 //constructs a string representation of a plane
 //used for debugging purposes
-QString Plane::toString() const
+std::string Plane::toString() const
 {
-    QString toReturn = "";
+    std::string toReturn = "";
 
     toReturn += "Plane head: ";
-    toReturn += QString::number(m_row);
+    toReturn += std::to_string(m_row);
     toReturn += "-";
-    toReturn += QString::number(m_col);
+    toReturn += std::to_string(m_col);
     toReturn += " oriented: ";
 
     switch(m_orient)
@@ -148,6 +179,6 @@ void Plane::translateWhenHeadPosValid(int offsetX, int offsetY, int row, int col
 }
 
 //implements plane translation
-Plane Plane::operator+(const QPoint& qp) {
+Plane Plane::operator+(const GridPoint& qp) {
     return Plane(this->m_row + qp.x(), this->m_col + qp.y(), this->m_orient);
 }
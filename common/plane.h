@@ -1,9 +1,10 @@
 #ifndef PLANE_H
 #define PLANE_H
 
-#include <QList>
-#include <QPoint>
+#include "gridpoint.h"
 #include "listiterator.h"
+#include <cstdint>
+#include <string>
 
 //Describes a plane on a grid
 
@@ -24,7 +25,7 @@ public:
     //Various constructors
     Plane();
     Plane(int row, int col, Orientation orient);
-    Plane(const QPoint& qp, Orientation orient);
+    Plane(const GridPoint& qp, Orientation orient);
 
     //setter and getters
     //gives the planes orientation
@@ -37,15 +38,13 @@ public:
     void col(int col) { m_col = col; }
     void orientation(Orientation orient) { m_orient = orient; }
     //gives the coordinates of the plane head
-    QPoint head() const { return QPoint(m_row, m_col); }
+    GridPoint head() const { return GridPoint(m_row, m_col); }
 
     //operators
     //compares two planes
     bool operator==(const Plane& pl1) const;
-    //equals operator
-    void operator=(const Plane& pl1);
-    //translates a plane by a QPoint
-    Plane operator+(const QPoint& qp);
+    //translates a plane by a GridPoint
+    Plane operator+(const GridPoint& qp);
 
     //geometrical transformations
     //clockwise rotation of planes
@@ -55,16 +54,51 @@ public:
     void translateWhenHeadPosValid(int offsetX, int offsetY, int row, int col);
 
     //other utility functions
-    //tests whether a QPoint is a planes head
-    bool isHead(const QPoint& qp) const { return qp == head(); }
+    //tests whether a GridPoint is a planes head
+    bool isHead(const GridPoint& qp) const { return qp == head(); }
     //checks if a certain point on the grid is on the plane
-    bool containsPoint(const QPoint& qp) const;
+    bool containsPoint(const GridPoint& qp) const;
     //returns whether a plane position is valid (the plane is completely contained inside the grid) in a grid with row and col
     bool isPositionValid(int row, int col) const;
     //generates a random number from 0 and valmax-1
+    //with the generator of the RandomScope of the thread if there is one, otherwise with rand()
     static int generateRandomNumber(int valmax);
+    //initializes the generator of random numbers with the current time
+    static void seedRandomGenerator();
     //displays the plane
-    QString toString() const;
+    std::string toString() const;
+};
+
+//A generator of random numbers whose state is a single value, so that it can
+//be saved with a game and restored (splitmix64).
+class RandomGenerator
+{
+    uint64_t m_state;
+
+public:
+    explicit RandomGenerator(uint64_t seed = 0): m_state(seed) {}
+
+    //a number from 0 to valmax-1
+    int generate(int valmax);
+
+    uint64_t state() const { return m_state; }
+    void setState(uint64_t state) { m_state = state; }
+};
+
+//Makes Plane::generateRandomNumber() use a generator on the current thread
+//while the scope is alive. A game session draws its numbers from its own
+//generator this way, without passing it through the grids and the strategies.
+class RandomScope
+{
+    RandomGenerator* m_previous;
+
+public:
+    explicit RandomScope(RandomGenerator& generator);
+    ~RandomScope();
+
+private:
+    RandomScope(const RandomScope&) = delete;
+    RandomScope& operator=(const RandomScope&) = delete;
 };
 
 
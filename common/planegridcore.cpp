@@ -0,0 +1,444 @@
+#include "planegridcore.h"
+#include "boardpool.h"
+#include "planeiterators.h"
+#include <algorithm>
+#include <cstdlib>
+
+PlaneGridCore::PlaneGridCore(int row, int col, int planesNo, bool isComputer):
+    m_rowNo(row),
+    m_colNo(col),
+    m_planeNo(planesNo),
+    m_isComputer(isComputer),
+    m_planeList(ArenaAllocator<Plane>(&m_arena)),
+    m_listPlanePoints(ArenaAllocator<GridPoint>(&m_arena)),
+    m_stencils(PlaneStencils::forGrid(row, col)),
+    m_cellPointIndices(row * col, -1),
+    m_listPlanePointsAnnotations(ArenaAllocator<int>(&m_arena))
+{
+    resetGrid();
+}
+
+//adds planes to the grid
+void PlaneGridCore::initGrid()
+{
+    resetGrid();
+
+    if (!initGridFromPool())
+        initGridByAutomaticGeneration();
+    if (!m_isComputer)
+        notifyInitPlayerGrid();
+    //compute list of plane points - needed for the guessing process
+    computePlanePointsList(true);
+}
+
+//the pool must have the geometry of the grid
+bool PlaneGridCore::setBoardPool(BoardPool* pool)
+{
+    if (pool != nullptr && (pool->getRowNo() != m_rowNo || pool->getColNo() != m_colNo || pool->getPlaneNo() != m_planeNo))
+        return false;
+    m_boardPool = pool;
+    return true;
+}
+
+//the boards of the pool were checked when they were generated
+bool PlaneGridCore::initGridFromPool()
+{
+    PackedPlane planes[BoardPool::MaxPlaneNo];
+    if (m_boardPool == nullptr || !m_boardPool->take(planes))
+        return false;
+
+    for (int i = 0; i < m_planeNo; i++)
+        m_planeList.push_back(planes[i].toPlane(m_rowNo));
+    return true;
+}
+
+//randomly generates grid with planes
+//the candidates are the plane positions inside the grid, a position is kept
+//while none of its cells is covered by the planes already placed
+bool PlaneGridCore::initGridByAutomaticGeneration()
+{
+    int count = 0;
+    //the lists are taken from the arena as well
+    //they are given back when the grid is reset
+    ArenaVector<PlaneId> listPossiblePositions((ArenaAllocator<PlaneId>(&m_arena)));
+    listPossiblePositions.reserve(m_rowNo * m_colNo * 4);
+    ArenaVector<char> occupied(m_rowNo * m_colNo, 0, ArenaAllocator<char>(&m_arena));
+
+    //build a list of all possible positions
+    //enum Orientation {NorthSouth=0, SouthNorth=1, WestEast=2, EastWest=3};
+    for(int i = 0; i < m_rowNo; i++)
+        for(int j = 0; j < m_colNo; j++)
+            for(int k = 0;k < 4; k++)
+            {
+                PlaneId plane = PlaneStencils::planeId(m_stencils.cellId(i, j), k);
+                if(m_stencils.isValid(plane))
+                    listPossiblePositions.push_back(plane);
+            }
+
+    while(count < m_planeNo)
+    {
+        //elimintate all positions that intersect the already created planes
+        //the positions that are kept are moved to the front of the list
+        unsigned int kept = 0;
+        for(unsigned int i = 0; i < listPossiblePositions.size(); i++)
+        {
+            const CellId* footprint = m_stencils.footprint(listPossiblePositions[i]);
+            bool noIntersection = true;
+            for(int k = 0; k < PlaneStencils::PlanePointsNo && noIntersection; k++)
+                noIntersection = !occupied[footprint[k]];
+            if(noIntersection)
+                listPossiblePositions[kept++] = listPossiblePositions[i];
+        }
+        listPossiblePositions.resize(kept);
+
+        //if no positions are left in the list return false
+        if(listPossiblePositions.size() == 0)
+            return false;
+
+        //from the positions that are left in the list
+        //choose a random one
+        int pos = Plane::generateRandomNumber(listPossiblePositions.size());
+
+        PlaneId plane = listPossiblePositions[pos];
+        //save the selected plane
+        if(savePlane(m_stencils.toPlane(plane)))
+        {
+            const CellId* footprint = m_stencils.footprint(plane);
+            for(int k = 0; k < PlaneStencils::PlanePointsNo; k++)
+                occupied[footprint[k]] = 1;
+            count++;
+        }
+    } //while
+    return true;
+}
+
+//generate a plane at a random grid position
+Plane PlaneGridCore::generateRandomPlane() const
+{
+    GridPoint qp = generateRandomGridPosition();
+    Plane::Orientation orient = generateRandomPlaneOrientation();
+    return Plane(qp, orient);
+}
+
+//generates a random position on the grid
+GridPoint PlaneGridCore::generateRandomGridPosition() const
+{
+
+    int idx = Plane::generateRandomNumber(m_rowNo * m_colNo);
+
+    return GridPoint(idx % m_rowNo,idx / m_rowNo);
+}
+
+//generates a random plane orientation
+Plane::Orientation PlaneGridCore::generateRandomPlaneOrientation() const
+{
+int idx = Plane::generateRandomNumber(4);
+    switch(idx)
+    {
+    case 0: return Plane::NorthSouth;
+    case 1: return Plane::SouthNorth;
+    case 2: return Plane::EastWest;
+    case 3: return Plane::WestEast;
+    default: return Plane::NorthSouth;
+    }
+}
+
+//let's the user generate his own planes
+void PlaneGridCore::initGridByUserInteraction() const
+{
+    notifyInitPlayerGrid();
+}
+
+//returns whether a point is head of a plane or not
+bool PlaneGridCore::isPointHead(int row, int col) const
+{
+    if(searchPlane(row, col)!=-1)
+        return true;
+    else return false;
+}
+
+//returns whether a point is on a plane or not
+//and additionally the index position where the point occurs
+//in the list of planes
+//the points inside the grid are found with the cell table
+bool PlaneGridCore::isPointOnPlane(int row, int col, int& idx) const
+{
+    if(m_stencils.isCellInGrid(row, col)) {
+        idx = m_cellPointIndices[m_stencils.cellId(row, col)];
+        return (idx >= 0);
+    }
+
+    ArenaVector<GridPoint>::const_iterator it = std::find(m_listPlanePoints.begin(), m_listPlanePoints.end(), GridPoint(row, col));
+    idx = (it == m_listPlanePoints.end()) ? -1 : static_cast<int>(it - m_listPlanePoints.begin());
+    return (idx >= 0);
+}
+
+//computes all the points on a plane
+//and returns false if planes intersect and true otherwise
+//also detects if a plane lies outside of the grid
+//also marks to which plane does the point belong and wether is a plane head or not
+bool PlaneGridCore::computePlanePointsList(bool sendSignal)
+{
+    for(unsigned int i = 0; i < m_listPlanePoints.size(); i++) {
+        const GridPoint& qp = m_listPlanePoints[i];
+        if(m_stencils.isCellInGrid(qp.x(), qp.y()))
+            m_cellPointIndices[m_stencils.cellId(qp)] = -1;
+    }
+    m_listPlanePoints.clear();
+    m_listPlanePointsAnnotations.clear();
+    bool returnValue = true;
+
+    m_PlaneOutsideGrid = false;
+    for(unsigned int i = 0; i < m_planeList.size(); i++)
+    {
+        Plane pl = m_planeList.at(i);
+        PlanePointIterator ppi(pl);
+        bool isHead = true;
+
+        while(ppi.hasNext())
+        {
+            GridPoint qp = ppi.next();
+            if (!isPointInGrid(qp))
+                m_PlaneOutsideGrid = true;
+            ///compute the point's annotation
+            int annotation = generateAnnotation(i, isHead);
+            int idx = 0;
+            if(!isPointOnPlane(qp.x(), qp.y(), idx)) {
+                if(m_stencils.isCellInGrid(qp.x(), qp.y()))
+                    m_cellPointIndices[m_stencils.cellId(qp)] = static_cast<int>(m_listPlanePoints.size());
+                m_listPlanePoints.push_back(qp);
+                m_listPlanePointsAnnotations.push_back(annotation);
+            } else {
+                returnValue = false;
+                m_listPlanePointsAnnotations[idx] |= annotation;
+            }
+            isHead = false;
+        }
+    }
+
+    m_PlanesOverlap = !returnValue;
+    if (sendSignal)
+        notifyPlanesPointsChanged();
+    return returnValue;
+}
+
+//searches a plane in the list of planes
+int PlaneGridCore::searchPlane(const Plane& pl) const
+{
+    ArenaVector<Plane>::const_iterator it = std::find(m_planeList.begin(), m_planeList.end(), pl);
+    return (it == m_planeList.end()) ? -1 : static_cast<int>(it - m_planeList.begin());
+}
+
+//searches a plane with the head at a given position on the grid in the list of planes
+int PlaneGridCore::searchPlane(int row, int col) const
+{
+    for(unsigned int i = 0; i < m_planeList.size(); i++)
+    {
+        const Plane& plane = m_planeList.at(i);
+
+        if((plane.row() == row) && (plane.col() == col))
+            return i;
+    }
+
+    return -1;
+}
+
+//saves a plane
+bool PlaneGridCore::savePlane(const Plane& pl)
+{
+    //to check if plane is already in list
+    if(searchPlane(pl) == -1)
+    {
+        //append to plane list
+        m_planeList.push_back(pl);
+
+        return true;
+    }
+    return false;
+}
+
+//removes the plane at a given position in the list of planes
+bool PlaneGridCore::removePlane(int idx, Plane &pl)
+{
+    if(idx < 0 || idx >= getPlaneListSize())
+        return false;
+
+     pl = m_planeList.at(idx);
+     //remove the plane from the list of planes
+     m_planeList.erase(m_planeList.begin() + idx);
+     return true;
+}
+
+//resets the plane grid
+void PlaneGridCore::resetGrid()
+{
+    resetLists();
+    notifyPlanesPointsChanged();
+    //m_guessPointList.clear();
+}
+
+//empties the lists and gives back their memory to the arena in one step
+//a grid has 10 points for each plane
+void PlaneGridCore::resetLists()
+{
+    for(unsigned int i = 0; i < m_listPlanePoints.size(); i++) {
+        const GridPoint& qp = m_listPlanePoints[i];
+        if(m_stencils.isCellInGrid(qp.x(), qp.y()))
+            m_cellPointIndices[m_stencils.cellId(qp)] = -1;
+    }
+    detachArenaVector(m_planeList);
+    detachArenaVector(m_listPlanePoints);
+    detachArenaVector(m_listPlanePointsAnnotations);
+    m_arena.release();
+
+    m_planeList.reserve(m_planeNo);
+    m_listPlanePoints.reserve(m_planeNo * 10);
+    m_listPlanePointsAnnotations.reserve(m_planeNo * 10);
+}
+
+//a plane that the user is moving can be partly outside of the grid,
+//so the planes are written with signed coordinates
+void PlaneGridCore::saveState(SnapshotWriter& writer) const
+{
+    writer.write(static_cast<uint16_t>(m_planeList.size()));
+    for(unsigned int i = 0; i < m_planeList.size(); i++) {
+        const Plane& pl = m_planeList[i];
+        writer.write(static_cast<int16_t>(pl.row()));
+        writer.write(static_cast<int16_t>(pl.col()));
+        writer.write(static_cast<uint8_t>(pl.orientation()));
+    }
+}
+
+bool PlaneGridCore::restoreState(SnapshotReader& reader)
+{
+    resetGrid();
+    const int planeNo = reader.readCount(m_planeNo);
+    for(int i = 0; i < planeNo && !reader.hasError(); i++) {
+        const int row = reader.read<int16_t>();
+        const int col = reader.read<int16_t>();
+        const int orient = reader.read<uint8_t>();
+        if(orient > 3) {
+            reader.setError();
+            break;
+        }
+        savePlane(Plane(row, col, static_cast<Plane::Orientation>(orient)));
+    }
+
+    if(reader.hasError()) {
+        resetGrid();
+        return false;
+    }
+    computePlanePointsList(true);
+    return true;
+}
+
+//returns the size of the plane list
+int PlaneGridCore::getPlaneListSize() const
+{
+    return static_cast<int>(m_planeList.size());
+}
+
+//gets the plane at a given position in the list of planes
+bool PlaneGridCore::getPlane(int pos, Plane& pl) const
+{
+    if(pos < 0 || pos >= getPlaneListSize())
+        return false;
+
+    pl = m_planeList.at(pos);
+    return true;
+}
+
+bool PlaneGridCore::rotatePlane(int idx)
+{
+    if (idx < 0 || idx >= getPlaneListSize())
+        return false;
+    Plane& pl = m_planeList[idx];
+    pl.rotate();
+    ///@todo: don't know how this will work when the plane comes out of the grid
+    computePlanePointsList(true);
+    return true;
+}
+
+bool PlaneGridCore::movePlaneUpwards(int idx)
+{
+    if (idx < 0 || idx >= getPlaneListSize())
+        return false;
+    Plane& pl = m_planeList[idx];
+    pl.translateWhenHeadPosValid(0, -1, m_rowNo, m_colNo);
+    computePlanePointsList(true);
+    return true;
+}
+
+bool PlaneGridCore::movePlaneDownwards(int idx)
+{
+    if (idx < 0 || idx >= getPlaneListSize())
+        return false;
+    Plane& pl = m_planeList[idx];
+    pl.translateWhenHeadPosValid(0, 1, m_rowNo, m_colNo);
+    computePlanePointsList(true);
+    return true;
+}
+
+bool PlaneGridCore::movePlaneLeft(int idx)
+{
+    if (idx < 0 || idx >= getPlaneListSize())
+        return false;
+    Plane& pl = m_planeList[idx];
+    pl.translateWhenHeadPosValid(-1, 0, m_rowNo, m_colNo);
+    computePlanePointsList(true);
+    return true;
+}
+
+bool PlaneGridCore::movePlaneRight(int idx)
+{
+    if (idx < 0 || idx >= getPlaneListSize())
+        return false;
+    Plane& pl = m_planeList[idx];
+    pl.translateWhenHeadPosValid(1, 0, m_rowNo, m_colNo);
+    computePlanePointsList(true);
+    return true;
+}
+
+//for a given GridPoint checks to what type of point it corresponds in the grid
+//a point inside the grid is looked up in the cell table, the heads have the odd
+//bits of the annotation
+GuessPoint::Type PlaneGridCore::getGuessResult(const GridPoint& qp) const
+{
+    if(m_stencils.isCellInGrid(qp.x(), qp.y())) {
+        int idx = m_cellPointIndices[m_stencils.cellId(qp)];
+        if(idx == -1)
+            return GuessPoint::Miss;
+        return (m_listPlanePointsAnnotations[idx] & 0x2AAAAAAA) ? GuessPoint::Dead : GuessPoint::Hit;
+    }
+
+    if(isPointHead(qp.x(), qp.y()))
+        return GuessPoint::Dead;
+
+    int idx = 0;
+    if(isPointOnPlane(qp.x(), qp.y(), idx))
+        return GuessPoint::Hit;
+
+    return GuessPoint::Miss;
+}
+
+int PlaneGridCore::generateAnnotation(int planeNo, bool isHead) {
+    int annotation = 1;
+    int bitsShifted = 2 * planeNo;
+    if (isHead)
+        bitsShifted++;
+    annotation = annotation << bitsShifted;
+    return annotation;
+}
+
+std::vector<int> PlaneGridCore::decodeAnnotation(int annotation) const {
+    std::vector<int> retVal;
+    for (int i = 0; i < m_planeNo; ++i) {
+        int mask1 = 0x1 << (2 * i);
+        int mask2 = 0x2 << (2 * i);
+        if (mask1 & annotation)
+            retVal.push_back(i);
+        if (mask2 & annotation)
+            retVal.push_back(-i - 1);
+    }
+    return retVal;
+}
@@ -2,7 +2,7 @@
 
 //constructor
 PlanePointIterator::PlanePointIterator(const Plane& pl):
-    MyIterator::ListIterator<QPoint>(),
+    MyIterator::ListIterator<GridPoint, 10>(),
     m_plane(pl)
 {
     generateList();
@@ -12,17 +12,17 @@ PlanePointIterator::PlanePointIterator(const Plane& pl):
 void PlanePointIterator::generateList()
 {
 
-    const QPoint pointsNorthSouth[] = {QPoint(0, 0), QPoint(0, 1), QPoint(-1, 1), QPoint(1, 1), QPoint(-2, 1), QPoint(2, 1), QPoint(0, 2),
-                                   QPoint(0, 3), QPoint(-1, 3), QPoint(1, 3)};
+    const GridPoint pointsNorthSouth[] = {GridPoint(0, 0), GridPoint(0, 1), GridPoint(-1, 1), GridPoint(1, 1), GridPoint(-2, 1), GridPoint(2, 1), GridPoint(0, 2),
+                                   GridPoint(0, 3), GridPoint(-1, 3), GridPoint(1, 3)};
 
-    const QPoint pointsSouthNorth[] = {QPoint(0, 0), QPoint(0, -1), QPoint(-1, -1), QPoint(1, -1), QPoint(-2, -1), QPoint(2, -1), QPoint(0, -2),
-                                   QPoint(0, -3), QPoint(-1, -3), QPoint(1, -3)};
+    const GridPoint pointsSouthNorth[] = {GridPoint(0, 0), GridPoint(0, -1), GridPoint(-1, -1), GridPoint(1, -1), GridPoint(-2, -1), GridPoint(2, -1), GridPoint(0, -2),
+                                   GridPoint(0, -3), GridPoint(-1, -3), GridPoint(1, -3)};
 
-    const QPoint pointsEastWest[] = {QPoint(0, 0), QPoint(1, 0), QPoint(1, -1), QPoint(1, 1), QPoint(1, -2), QPoint(1, 2), QPoint(2, 0),
-                                 QPoint(3, 0), QPoint(3, -1), QPoint(3, 1)};
+    const GridPoint pointsEastWest[] = {GridPoint(0, 0), GridPoint(1, 0), GridPoint(1, -1), GridPoint(1, 1), GridPoint(1, -2), GridPoint(1, 2), GridPoint(2, 0),
+                                 GridPoint(3, 0), GridPoint(3, -1), GridPoint(3, 1)};
 
-    const QPoint pointsWestEast[] = {QPoint(0, 0), QPoint(-1, 0), QPoint(-1, -1), QPoint(-1, 1), QPoint(-1, -2), QPoint(-1, 2), QPoint(-2, 0),
-                                 QPoint(-3, 0), QPoint(-3, 1), QPoint(-3, -1)};
+    const GridPoint pointsWestEast[] = {GridPoint(0, 0), GridPoint(-1, 0), GridPoint(-1, -1), GridPoint(-1, 1), GridPoint(-1, -2), GridPoint(-1, 2), GridPoint(-2, 0),
+                                 GridPoint(-3, 0), GridPoint(-3, 1), GridPoint(-3, -1)};
 
     const int size = 10;
     for(int i = 0; i < size; ++i)
@@ -30,16 +30,16 @@ void PlanePointIterator::generateList()
         switch(m_plane.orientation())
         {
             case Plane::NorthSouth:
-                m_internalList << pointsNorthSouth[i] + m_plane.head();
+                m_internalList.push_back(pointsNorthSouth[i] + m_plane.head());
                 break;
             case Plane::SouthNorth:
-                m_internalList << pointsSouthNorth[i] + m_plane.head();
+                m_internalList.push_back(pointsSouthNorth[i] + m_plane.head());
                 break;
             case Plane::WestEast:
-                m_internalList << pointsWestEast[i] + m_plane.head();
+                m_internalList.push_back(pointsWestEast[i] + m_plane.head());
                 break;
             case Plane::EastWest:
-                m_internalList << pointsEastWest[i] + m_plane.head();
+                m_internalList.push_back(pointsEastWest[i] + m_plane.head());
                 break;
             default:
                 ;
@@ -49,8 +49,8 @@ void PlanePointIterator::generateList()
 
 //constructor for the iterator giving all the planes
 //passing through the point (0,0)
-PlaneIntersectingPointIterator::PlaneIntersectingPointIterator(const QPoint& qp):
-    MyIterator::ListIterator<Plane>(),
+PlaneIntersectingPointIterator::PlaneIntersectingPointIterator(const GridPoint& qp):
+    MyIterator::ListIterator<Plane, 40>(),
     m_point(qp)
 {
     //generates the list of planes
@@ -63,32 +63,20 @@ void PlaneIntersectingPointIterator::generateList()
     m_internalList.clear();
 
     //build a list of all possible positions that can possibly contain the (0,0) point
+    //and keep those that contain it
     //enum Orientation {NorthSouth=0, SouthNorth=1, WestEast=2, EastWest=3};
     for(int i = -5 + m_point.x(); i < 6 + m_point.x(); i++)
         for(int j = -5 + m_point.y(); j < 6 + m_point.y(); j++)
             for(int k = 0; k < 4; k++)
             {
                 Plane pl(i, j, (Plane::Orientation)k);
-                m_internalList.append(pl);
+                if(pl.containsPoint(m_point))
+                    m_internalList.push_back(pl);
             }
-
-    QMutableListIterator<Plane> i(m_internalList);
-
-    //elimintate all positions that do not contain (0,0)
-    while(i.hasNext())
-    {
-        Plane pl = i.next();
-
-        if(!pl.containsPoint(m_point))
-        {
-            i.remove();
-            continue;
-        }
-    }
 }
 
-PointInfluenceIterator::PointInfluenceIterator(const QPoint& qp):
-    MyIterator::ListIterator<QPoint>(),
+PointInfluenceIterator::PointInfluenceIterator(const GridPoint& qp):
+    MyIterator::ListIterator<GridPoint, 40>(),
     m_point(qp)
 {
     generateList();
@@ -98,11 +86,11 @@ void PointInfluenceIterator::generateList()
 {
     m_internalList.clear();
 
-    //searches in a range around the selected QPoint
+    //searches in a range around the selected GridPoint
     for(int i = -10 + m_point.x(); i < 10 + m_point.y(); i++)
         for(int j = -10 + m_point.y(); j < 10 + m_point.y(); j++)
         {
-            QPoint qp(i, j);
+            GridPoint qp(i, j);
             //generates all planes intersecting the point
             PlaneIntersectingPointIterator pipi(qp);
 
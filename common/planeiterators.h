@@ -4,7 +4,7 @@
 #include "plane.h"
 
 //iterates over the points that make a plane
-class PlanePointIterator : public ListIterator<QPoint>
+class PlanePointIterator : public ListIterator<GridPoint, 10>
 {
     Plane m_plane;
 public:
@@ -15,13 +15,14 @@ private:
 };
 
 //lists the relatives positions of all planes that pass through the point (0,0)
-class PlaneIntersectingPointIterator: public ListIterator<Plane>
+//there are at most 40 of them: 10 points of a plane in 4 orientations
+class PlaneIntersectingPointIterator: public ListIterator<Plane, 40>
 {
-    QPoint m_point;
+    GridPoint m_point;
 
 public:
-    //constructor taking a QPoint
-    PlaneIntersectingPointIterator(const QPoint& qp = QPoint(0,0));
+    //constructor taking a GridPoint
+    PlaneIntersectingPointIterator(const GridPoint& qp = GridPoint(0,0));
 
 private:
     //generates list of plane indexes that pass through (0,0)
@@ -29,13 +30,14 @@ private:
 };
 
 //lists the points that can influence the value of a point
-class PointInfluenceIterator: ListIterator<QPoint>
+//they are the points of the planes with the head on the point, at most 40
+class PointInfluenceIterator: ListIterator<GridPoint, 40>
 {
-    QPoint m_point;
+    GridPoint m_point;
 
 public:
     //constructor
-    PointInfluenceIterator(const QPoint& qp = QPoint(0,0));
+    PointInfluenceIterator(const GridPoint& qp = GridPoint(0,0));
 
 private:
     //generates the list points influencing the point (0,0)
@@ -0,0 +1,490 @@
+#include "planepropagator.h"
+#include <algorithm>
+
+//constructor
+PlanePropagator::PlanePropagator(const PlaneStencils& stencils, int planeNo):
+    m_stencils(stencils),
+    m_planeNo(planeNo),
+    m_hitsChanged(false)
+{
+    reset();
+}
+
+//forgets everything
+void PlanePropagator::reset()
+{
+    const int pointNo = m_stencils.pointNo();
+    m_domains.assign(pointNo, Unknown);
+    m_owners.assign(pointNo, -1);
+    m_headOfPoint.assign(pointNo, -1);
+    m_pointQueued.assign(pointNo, 0);
+    m_heads.clear();
+    m_headQueued.clear();
+    m_hits.clear();
+    m_pointQueue.clear();
+    m_headQueue.clear();
+    m_inferences.clear();
+    m_hitsChanged = false;
+}
+
+//copies the state of another engine
+//the vectors keep their capacity so that copying does not allocate after the first time
+void PlanePropagator::assign(const PlanePropagator& other)
+{
+    m_planeNo = other.m_planeNo;
+    m_domains = other.m_domains;
+    m_owners = other.m_owners;
+    m_headOfPoint = other.m_headOfPoint;
+    m_heads = other.m_heads;
+    m_hits = other.m_hits;
+    m_pointQueue = other.m_pointQueue;
+    m_pointQueued = other.m_pointQueued;
+    m_headQueue = other.m_headQueue;
+    m_headQueued = other.m_headQueued;
+    m_hitsChanged = other.m_hitsChanged;
+    m_inferences = other.m_inferences;
+}
+
+//the points are written on 16 bits
+void PlanePropagator::saveState(SnapshotWriter& writer) const
+{
+    const int pointNo = m_stencils.pointNo();
+    writer.writeArray(m_domains.data(), pointNo);
+    int16_t owners[256];
+    for (int start = 0; start < pointNo; start += 256) {
+        const int n = std::min(256, pointNo - start);
+        for (int i = 0; i < n; i++)
+            owners[i] = static_cast<int16_t>(m_owners[start + i]);
+        writer.writeArray(owners, n);
+    }
+
+    writer.write(static_cast<uint16_t>(m_heads.size()));
+    for (unsigned int i = 0; i < m_heads.size(); i++) {
+        writer.write(static_cast<uint16_t>(m_heads[i].m_point));
+        writer.write(static_cast<uint8_t>(m_heads[i].m_mask));
+        writer.write(static_cast<uint8_t>(m_heads[i].m_processedMask));
+    }
+
+    const std::vector<int>* lists[] = { &m_hits, &m_pointQueue, &m_headQueue };
+    for (int k = 0; k < 3; k++) {
+        writer.write(static_cast<uint16_t>(lists[k]->size()));
+        for (unsigned int i = 0; i < lists[k]->size(); i++)
+            writer.write(static_cast<uint16_t>((*lists[k])[i]));
+    }
+    writer.write(static_cast<uint8_t>(m_hitsChanged ? 1 : 0));
+
+    writer.write(static_cast<uint16_t>(m_inferences.size()));
+    for (unsigned int i = 0; i < m_inferences.size(); i++) {
+        writer.write(static_cast<uint16_t>(m_stencils.cellId(m_inferences[i].m_row, m_inferences[i].m_col)));
+        writer.write(static_cast<uint8_t>(m_inferences[i].m_type));
+    }
+}
+
+//the values are checked against the grid so that a damaged snapshot
+//cannot make the engine read outside of its tables
+bool PlanePropagator::restoreState(SnapshotReader& reader)
+{
+    reset();
+    const int pointNo = m_stencils.pointNo();
+    reader.readArray(m_domains.data(), pointNo);
+    int16_t owners[256];
+    for (int start = 0; start < pointNo && !reader.hasError(); start += 256) {
+        const int n = std::min(256, pointNo - start);
+        reader.readArray(owners, n);
+        for (int i = 0; i < n; i++) {
+            m_owners[start + i] = owners[i];
+            if (owners[i] < -1 || owners[i] >= pointNo)
+                reader.setError();
+        }
+    }
+
+    const int headNo = reader.readCount(pointNo);
+    for (int i = 0; i < headNo && !reader.hasError(); i++) {
+        FoundHead head;
+        head.m_point = reader.read<uint16_t>();
+        head.m_mask = reader.read<uint8_t>();
+        head.m_processedMask = reader.read<uint8_t>();
+        if (head.m_point >= pointNo || m_headOfPoint[head.m_point] != -1) {
+            reader.setError();
+            break;
+        }
+        m_headOfPoint[head.m_point] = static_cast<int>(m_heads.size());
+        m_heads.push_back(head);
+        m_headQueued.push_back(0);
+    }
+
+    std::vector<int>* lists[] = { &m_hits, &m_pointQueue, &m_headQueue };
+    const int limits[] = { pointNo, pointNo, headNo };
+    for (int k = 0; k < 3 && !reader.hasError(); k++) {
+        const int n = reader.readCount(limits[k]);
+        for (int i = 0; i < n; i++) {
+            const int value = reader.read<uint16_t>();
+            if (value >= limits[k])
+                reader.setError();
+            lists[k]->push_back(value);
+        }
+    }
+    for (unsigned int i = 0; i < m_pointQueue.size() && !reader.hasError(); i++)
+        m_pointQueued[m_pointQueue[i]] = 1;
+    for (unsigned int i = 0; i < m_headQueue.size() && !reader.hasError(); i++)
+        m_headQueued[m_headQueue[i]] = 1;
+    m_hitsChanged = reader.read<uint8_t>() != 0;
+
+    const int inferenceNo = reader.readCount(pointNo);
+    for (int i = 0; i < inferenceNo && !reader.hasError(); i++) {
+        const int point = reader.read<uint16_t>();
+        const int type = reader.read<uint8_t>();
+        if (point >= pointNo || type > GuessPoint::Dead) {
+            reader.setError();
+            break;
+        }
+        m_inferences.push_back(toGuessPoint(point, static_cast<GuessPoint::Type>(type)));
+    }
+
+    if (reader.hasError()) {
+        reset();
+        return false;
+    }
+    return true;
+}
+
+//records a guess
+void PlanePropagator::addGuess(const GuessPoint& gp)
+{
+    const CellId point = m_stencils.cellId(gp.m_row, gp.m_col);
+
+    if (gp.isMiss()) {
+        restrictDomain(point, Empty);
+        return;
+    }
+
+    if (gp.isHit()) {
+        restrictDomain(point, Body);
+        if (m_owners[point] == -1)
+            m_hits.push_back(point);
+        m_hitsChanged = true;
+        return;
+    }
+
+    restrictDomain(point, Head);
+    if (m_headOfPoint[point] != -1)
+        return;
+
+    //the orientations inside the grid whose body can be there
+    FoundHead head;
+    head.m_point = point;
+    head.m_mask = 0;
+    for (int orient = 0; orient < 4; orient++) {
+        int position = point * 4 + orient;
+        if (!m_stencils.isValid(position))
+            continue;
+
+        bool possible = true;
+        const int* footprint = m_stencils.footprint(position);
+        for (int k = 1; k < PlaneStencils::PlanePointsNo && possible; k++)
+            possible = (m_domains[footprint[k]] & Body) != 0 && m_owners[footprint[k]] == -1;
+        if (possible)
+            head.m_mask |= 1 << orient;
+    }
+    head.m_processedMask = 0xf;
+
+    m_headOfPoint[point] = static_cast<int>(m_heads.size());
+    m_heads.push_back(head);
+    m_headQueued.push_back(0);
+    pushHead(static_cast<int>(m_heads.size()) - 1);
+    m_hitsChanged = true;
+}
+
+//records the orientation of a plane decided elsewhere
+void PlanePropagator::confirmPlane(int headPoint, int orient)
+{
+    int head = m_headOfPoint[headPoint];
+    if (head != -1)
+        restrictHead(head, 1 << orient);
+}
+
+//processes the work queue until nothing changes
+//the points are processed before the heads because they only remove orientations
+void PlanePropagator::propagate(ChoiceMap& choices)
+{
+    while (true) {
+        while (!m_pointQueue.empty() || !m_headQueue.empty()) {
+            if (!m_pointQueue.empty()) {
+                int point = m_pointQueue.back();
+                m_pointQueue.pop_back();
+                m_pointQueued[point] = 0;
+                processPoint(choices, point);
+            } else {
+                int head = m_headQueue.back();
+                m_headQueue.pop_back();
+                m_headQueued[head] = 0;
+                processHead(choices, head);
+            }
+        }
+
+        if (!m_hitsChanged)
+            break;
+
+        m_hitsChanged = false;
+        for (unsigned int i = 0; i < m_hits.size(); i++)
+            checkHit(choices, m_hits[i]);
+        checkPlanesLeft(choices);
+    }
+}
+
+//the orientations still possible for a found head
+int PlanePropagator::orientationMask(int headPoint) const
+{
+    int head = m_headOfPoint[headPoint];
+    return head == -1 ? 0 : m_heads[head].m_mask;
+}
+
+//gives the points found to be hits or misses since the last call
+void PlanePropagator::takeInferences(std::vector<GuessPoint>& inferences)
+{
+    inferences.insert(inferences.end(), m_inferences.begin(), m_inferences.end());
+    m_inferences.clear();
+}
+
+void PlanePropagator::pushPoint(int point)
+{
+    if (m_pointQueued[point])
+        return;
+    m_pointQueued[point] = 1;
+    m_pointQueue.push_back(point);
+}
+
+void PlanePropagator::pushHead(int head)
+{
+    if (m_headQueued[head])
+        return;
+    m_headQueued[head] = 1;
+    m_headQueue.push_back(head);
+}
+
+//sets the domain of a point
+bool PlanePropagator::restrictDomain(int point, int domain)
+{
+    int newDomain = m_domains[point] & domain;
+    if (newDomain == m_domains[point])
+        return false;
+
+    m_domains[point] = static_cast<uint8_t>(newDomain);
+    pushPoint(point);
+    return true;
+}
+
+//removes orientations from a head
+void PlanePropagator::restrictHead(int head, int mask)
+{
+    int newMask = m_heads[head].m_mask & mask;
+    if (newMask == m_heads[head].m_mask)
+        return;
+
+    m_heads[head].m_mask = newMask;
+    pushHead(head);
+}
+
+//removes the head orientations that cannot have the point on their body
+//and takes out of the choice map the positions covering a point that is not free
+void PlanePropagator::processPoint(ChoiceMap& choices, int point)
+{
+    const bool canBeBody = (m_domains[point] & Body) != 0;
+    const int owner = m_owners[point];
+
+    //the plane positions covering the point are grouped by head
+    for (const int* it = m_stencils.coversBegin(point); it != m_stencils.coversEnd(point); ++it) {
+        int headPoint = *it / 4;
+        int head = m_headOfPoint[headPoint];
+        if (head == -1 || headPoint == point)
+            continue;
+        if (canBeBody && (owner == -1 || owner == headPoint))
+            continue;
+        restrictHead(head, ~(1 << (*it % 4)));
+    }
+
+    //a point belonging to a found plane cannot be on any other plane
+    if (owner != -1) {
+        invalidateCovers(choices, point);
+        m_hitsChanged = true;
+    }
+}
+
+//gives to the head the body points shared by all its orientations
+//and looks for empty points among the body points of the removed orientations
+void PlanePropagator::processHead(ChoiceMap& choices, int head)
+{
+    const int headPoint = m_heads[head].m_point;
+    const int mask = m_heads[head].m_mask;
+    const int removed = m_heads[head].m_processedMask & ~mask;
+    m_heads[head].m_processedMask = mask;
+
+    //no orientation is possible: the guesses contradict each other
+    if (mask == 0)
+        return;
+
+    m_hitsChanged = true;
+
+    int first = 0;
+    while (!(mask & (1 << first)))
+        first++;
+
+    const int* footprint = m_stencils.footprint(headPoint * 4 + first);
+    for (int k = 1; k < PlaneStencils::PlanePointsNo; k++) {
+        int point = footprint[k];
+        if (m_owners[point] != -1)
+            continue;
+
+        bool shared = true;
+        for (int orient = first + 1; orient < 4 && shared; orient++)
+            if (mask & (1 << orient))
+                shared = isOnBody(headPoint * 4 + orient, point);
+        if (!shared)
+            continue;
+
+        m_owners[point] = headPoint;
+        if (m_domains[point] != Body) {
+            m_domains[point] = Body;
+            m_inferences.push_back(toGuessPoint(point, GuessPoint::Hit));
+        }
+        pushPoint(point);
+    }
+
+    for (int orient = 0; orient < 4; orient++) {
+        if (!(removed & (1 << orient)) || !m_stencils.isValid(headPoint * 4 + orient))
+            continue;
+        footprint = m_stencils.footprint(headPoint * 4 + orient);
+        for (int k = 1; k < PlaneStencils::PlanePointsNo; k++)
+            checkEmpty(choices, footprint[k]);
+    }
+}
+
+//a hit that the choice map cannot explain must be on the body of a found head
+//if only one head can have it, the orientations of the head without it are impossible
+void PlanePropagator::checkHit(const ChoiceMap& choices, int point)
+{
+    if (m_owners[point] != -1 || isCoveredByChoices(choices, point))
+        return;
+
+    int lastHead = -1;
+    int orientMask = 0;
+    if (coveringHeads(point, lastHead, orientMask) == 1)
+        restrictHead(lastHead, orientMask);
+}
+
+//with one plane left to find, the plane must cover all the hits
+//that the found heads cannot explain
+//with no plane left, no position of the choice map is possible
+void PlanePropagator::checkPlanesLeft(ChoiceMap& choices)
+{
+    const int planesLeft = m_planeNo - static_cast<int>(m_heads.size());
+    if (planesLeft > 1)
+        return;
+
+    //the hits that must be explained by the plane left
+    //the grid has at most a few such hits, they are kept on the stack
+    const int MaxUnexplained = PlaneStencils::PlanePointsNo;
+    int unexplained[MaxUnexplained];
+    int unexplainedNo = 0;
+    if (planesLeft == 1) {
+        for (unsigned int i = 0; i < m_hits.size(); i++) {
+            int point = m_hits[i];
+            int lastHead = -1;
+            int orientMask = 0;
+            if (m_owners[point] != -1 || coveringHeads(point, lastHead, orientMask) != 0)
+                continue;
+            //more unexplained hits than points on a plane: the guesses contradict each other
+            if (unexplainedNo == MaxUnexplained)
+                return;
+            unexplained[unexplainedNo++] = point;
+        }
+        if (unexplainedNo == 0)
+            return;
+    }
+
+    const int positionNo = m_stencils.planePositionNo();
+    bool changed = false;
+    for (int position = 0; position < positionNo; position++) {
+        if (choices[position] < 0)
+            continue;
+
+        bool possible = planesLeft == 1;
+        const int* footprint = m_stencils.footprint(position);
+        for (int i = 0; i < unexplainedNo && possible; i++)
+            possible = std::find(footprint, footprint + PlaneStencils::PlanePointsNo, unexplained[i]) != footprint + PlaneStencils::PlanePointsNo;
+        if (possible)
+            continue;
+
+        choices.invalidate(position);
+        changed = true;
+    }
+
+    if (changed)
+        m_hitsChanged = true;
+}
+
+//a point that nothing can cover is empty
+void PlanePropagator::checkEmpty(const ChoiceMap& choices, int point)
+{
+    if (m_domains[point] != Unknown || isCoveredByChoices(choices, point))
+        return;
+
+    int lastHead = -1;
+    int orientMask = 0;
+    if (coveringHeads(point, lastHead, orientMask) != 0)
+        return;
+
+    m_domains[point] = Empty;
+    m_inferences.push_back(toGuessPoint(point, GuessPoint::Miss));
+    pushPoint(point);
+}
+
+//whether a plane position of the choice map covering the point is possible
+bool PlanePropagator::isCoveredByChoices(const ChoiceMap& choices, int point) const
+{
+    const int* lanes = choices.lanes();
+    for (const int* it = m_stencils.laneCoversBegin(point); it != m_stencils.laneCoversEnd(point); ++it)
+        if (lanes[*it] >= 0)
+            return true;
+    return false;
+}
+
+//the heads with an orientation having the point on the body
+//the covering positions are sorted, so those of a head are next to each other
+int PlanePropagator::coveringHeads(int point, int& lastHead, int& orientMask) const
+{
+    int headNo = 0;
+    for (const int* it = m_stencils.coversBegin(point); it != m_stencils.coversEnd(point); ++it) {
+        int headPoint = *it / 4;
+        int head = m_headOfPoint[headPoint];
+        if (head == -1 || headPoint == point || !(m_heads[head].m_mask & (1 << (*it % 4))))
+            continue;
+
+        if (head != lastHead) {
+            headNo++;
+            lastHead = head;
+            orientMask = 0;
+        }
+        orientMask |= 1 << (*it % 4);
+    }
+    return headNo;
+}
+
+//whether the point is on the body of a plane position
+bool PlanePropagator::isOnBody(int position, int point) const
+{
+    const int* footprint = m_stencils.footprint(position);
+    return std::find(footprint + 1, footprint + PlaneStencils::PlanePointsNo, point) != footprint + PlaneStencils::PlanePointsNo;
+}
+
+//marks impossible the positions of the choice map covering a point
+void PlanePropagator::invalidateCovers(ChoiceMap& choices, int point)
+{
+    choices.invalidateCovers(point);
+}
+
+//converts a grid point to a guess point
+GuessPoint PlanePropagator::toGuessPoint(int point, GuessPoint::Type type) const
+{
+    return GuessPoint(m_stencils.cellRow(point), m_stencils.cellCol(point), type);
+}
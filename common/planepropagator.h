@@ -0,0 +1,136 @@
+#ifndef PLANEPROPAGATOR_H
+#define PLANEPROPAGATOR_H
+
+#include "choicemap.h"
+#include "guesspoint.h"
+#include "planestencils.h"
+#include "snapshotstream.h"
+#include <cstdint>
+#include <vector>
+
+//Infers facts that follow from the guesses made so far by combining what is
+//known about all the found heads, the found planes and the other grid points.
+//
+//For each grid point a domain tells what the point can still be: empty,
+//the head of a plane or the body of a plane; a body point may also have an
+//owner, the found head whose plane it belongs to. For each found head a mask
+//keeps the orientations still possible. The planes do not overlap, so:
+//- an orientation is impossible if its body contains a point that cannot be
+//  a body point or that belongs to another plane
+//- the body points shared by all the orientations of a head belong to its plane
+//  and the plane positions of the choice map covering them are impossible
+//- a hit that no plane position of the choice map can explain belongs to a
+//  found head; if only one head can explain it, its other orientations are impossible
+//- when one plane is left to find, its position must cover all the hits that
+//  the found heads cannot explain; when none is left, the choice map is emptied
+//- a point that no head orientation and no position of the choice map covers is empty
+//
+//Changes are put in a work queue and the queue is processed until
+//nothing changes any more.
+class PlanePropagator
+{
+public:
+    //bits of the domain of a point
+    enum Domain { Empty = 1, Head = 2, Body = 4, Unknown = Empty | Head | Body };
+
+private:
+    //a found head
+    struct FoundHead
+    {
+        int m_point;
+        //possible orientations, bit i for orientation i
+        int m_mask;
+        //the mask when the head was last processed
+        int m_processedMask;
+    };
+
+    const PlaneStencils& m_stencils;
+    int m_planeNo;
+
+    std::vector<uint8_t> m_domains;
+    //the head point of the plane a point belongs to or -1
+    std::vector<int> m_owners;
+    //the index in m_heads of the head on a point or -1
+    std::vector<int> m_headOfPoint;
+    std::vector<FoundHead> m_heads;
+    //the points with a hit result that were not given an owner
+    std::vector<int> m_hits;
+
+    //work queues of points and heads with an in-queue flag for each
+    std::vector<int> m_pointQueue;
+    std::vector<char> m_pointQueued;
+    std::vector<int> m_headQueue;
+    std::vector<char> m_headQueued;
+    //whether the hits and the number of planes left must be checked again
+    bool m_hitsChanged;
+
+    //the facts found since the last call of takeInferences()
+    std::vector<GuessPoint> m_inferences;
+
+public:
+    PlanePropagator(const PlaneStencils& stencils, int planeNo);
+
+    //forgets everything
+    void reset();
+    //copies the state of another engine for the same grid
+    void assign(const PlanePropagator& other);
+    //writes the domains, the owners, the found heads, the hits and the work queues
+    void saveState(SnapshotWriter& writer) const;
+    //reads the state written by saveState() for the same grid,
+    //the tables derived from the heads and the queues are rebuilt
+    bool restoreState(SnapshotReader& reader);
+    //records a guess; the inferences are made by propagate()
+    void addGuess(const GuessPoint& gp);
+    //records the orientation of a plane decided elsewhere
+    void confirmPlane(int headPoint, int orient);
+
+    //processes the work queue until nothing changes
+    //plane positions found impossible are marked -1 in the choice map
+    void propagate(ChoiceMap& choices);
+    //whether there are changes not yet propagated
+    bool hasWork() const { return !m_pointQueue.empty() || !m_headQueue.empty() || m_hitsChanged; }
+
+    //the orientations still possible for a found head, bit i for orientation i
+    //returns 0 if there is no found head on the point
+    int orientationMask(int headPoint) const;
+    //the domain and the owner of a point
+    int domain(int point) const { return m_domains[point]; }
+    int owner(int point) const { return m_owners[point]; }
+
+    //gives the points that were found to be hits or misses since the last call:
+    //a hit on the body of a found head or a miss on a point no plane can cover
+    void takeInferences(std::vector<GuessPoint>& inferences);
+
+private:
+    void pushPoint(int point);
+    void pushHead(int head);
+    //sets the domain of a point, returns true if it changed
+    bool restrictDomain(int point, int domain);
+    //removes orientations from a head
+    void restrictHead(int head, int mask);
+
+    //the orientation masks made impossible by a changed point
+    void processPoint(ChoiceMap& choices, int point);
+    //gives to the head the body points shared by all its orientations
+    void processHead(ChoiceMap& choices, int head);
+    //checks that a hit can be explained
+    void checkHit(const ChoiceMap& choices, int point);
+    //checks the positions of the planes left to find
+    void checkPlanesLeft(ChoiceMap& choices);
+    //marks a point empty if nothing can cover it
+    void checkEmpty(const ChoiceMap& choices, int point);
+
+    //whether a plane position of the choice map covering the point is possible
+    bool isCoveredByChoices(const ChoiceMap& choices, int point) const;
+    //the number of heads with an orientation having the point on the body,
+    //the last such head and its orientations having the point on the body
+    int coveringHeads(int point, int& lastHead, int& orientMask) const;
+    //whether the point is on the body of a plane position
+    bool isOnBody(int position, int point) const;
+    //marks impossible the positions of the choice map covering a point
+    void invalidateCovers(ChoiceMap& choices, int point);
+    //converts a grid point to a guess point
+    GuessPoint toGuessPoint(int point, GuessPoint::Type type) const;
+};
+
+#endif // PLANEPROPAGATOR_H
@@ -3,6 +3,7 @@
 #include <QList>
 #include <QPoint>
 #include <QDebug>
+#include <QMutexLocker>
 #include <cstdlib>
 
 //constructor
@@ -10,9 +11,33 @@ PlaneRound::PlaneRound(PlaneGrid* playerGrid, PlaneGrid* computerGrid, ComputerL
     m_isComputerFirst(isComputerFirst),
     m_PlayerGrid(playerGrid),
     m_ComputerGrid(computerGrid),
-    m_computerLogic(logic)
+    m_computerGuessList(ArenaAllocator<PackedGuess>(&m_arena)),
+    m_playerGuessList(ArenaAllocator<PackedGuess>(&m_arena)),
+    m_computerLogic(logic),
+    m_currentRequest(0),
+    m_isComputerThinking(false),
+    m_spectators(nullptr)
 {
     reset();
+
+    //the worker lives in its own thread and is deleted when the thread ends
+    //the connections between the round and the worker are queued
+    m_worker = new ComputerMoveWorker(m_computerLogic, &m_logicMutex, &m_currentRequest);
+    m_worker->moveToThread(&m_workerThread);
+    connect(&m_workerThread, SIGNAL(finished()), m_worker, SLOT(deleteLater()));
+    connect(this, SIGNAL(computerMoveRequested(int)), m_worker, SLOT(computeMove(int)));
+    connect(m_worker, SIGNAL(moveComputed(int, QPoint)), this, SLOT(computerMoveComputed(int, QPoint)));
+    connect(m_worker, SIGNAL(moveNotFound(int)), this, SLOT(computerMoveNotFound(int)));
+    m_workerThread.start();
+}
+
+//cancels the computation in progress and stops the worker thread
+PlaneRound::~PlaneRound()
+{
+    m_currentRequest.fetchAndAddOrdered(1);
+    m_computerLogic->requestCancel();
+    m_workerThread.quit();
+    m_workerThread.wait();
 }
 
 
@@ -22,10 +47,18 @@ void PlaneRound::reset()
     m_PlayerGrid->resetGrid();
     m_ComputerGrid->resetGrid();
 
-    m_playerGuessList.clear();
-    m_computerGuessList.clear();
+    //gives back the memory of the previous round in one step
+    detachArenaVector(m_playerGuessList);
+    detachArenaVector(m_computerGuessList);
+    m_arena.release();
+    m_playerGuessList.reserve(m_ComputerGrid->getRowNo() * m_ComputerGrid->getColNo());
+    m_computerGuessList.reserve(m_PlayerGrid->getRowNo() * m_PlayerGrid->getColNo());
 
     m_gameStats.reset();
+    m_pendingGuesses.clear();
+
+    //waits for a computation in progress in the worker thread
+    QMutexLocker locker(&m_logicMutex);
     m_computerLogic->reset();
 }
 
@@ -40,10 +73,17 @@ void PlaneRound::initRound()
 //starts to play
 void PlaneRound::play()
 {
+    //cancels the computer move of the previous round
+    m_currentRequest.fetchAndAddOrdered(1);
+    m_computerLogic->requestCancel();
+    setComputerThinking(false);
+
     m_isComputerFirst = !m_isComputerFirst;
     reset();
     //waits for the player to finish the drawing and draws the planes for the computer
     initRound();
+    if (m_spectators)
+        m_spectators->roundStarted(m_PlayerGrid->getRowNo(), m_PlayerGrid->getColNo(), m_PlayerGrid->getPlaneNo(), m_isComputerFirst, m_gameStats);
 
     emit initGraphics();
     emit statsUpdated(m_gameStats);
@@ -68,13 +108,12 @@ bool PlaneRound::isRoundEndet(bool& isPlayerWinner) const
 }
 
 //decides whether all the planes have been guessed
-bool PlaneRound::enoughGuesses(PlaneGrid* pg, const QList<GuessPoint>& guessList ) const
+bool PlaneRound::enoughGuesses(PlaneGrid* pg, const ArenaVector<PackedGuess>& guessList ) const
 {
     int count = 0;
 
-    for(int i = 0; i < guessList.size(); i++) {
-        GuessPoint gp = guessList.at(i);
-        if (gp.m_type == GuessPoint::Dead)
+    for(unsigned int i = 0; i < guessList.size(); i++) {
+        if (guessList.at(i).isDead())
             count++;
     }
 
@@ -84,23 +123,108 @@ bool PlaneRound::enoughGuesses(PlaneGrid* pg, const QList<GuessPoint>& guessList
 //guesses a computer move
 GuessPoint PlaneRound::guessComputerMove()
 {
-    QPoint qp;
+    GridPoint qp;
     //use the computer strategy to get a move
-    m_computerLogic->makeChoice(qp);
+    {
+        QMutexLocker locker(&m_logicMutex);
+        m_computerLogic->makeChoice(qp);
+    }
+
+    return applyComputerMove(qp);
+}
 
+//asks the worker thread for the next computer move
+//the answer comes in computerMoveComputed()
+void PlaneRound::requestComputerMove()
+{
+    int request = m_currentRequest.fetchAndAddOrdered(1) + 1;
+    setComputerThinking(true);
+    emit computerMoveRequested(request);
+}
+
+//checks the result of a computer move and updates the computer's strategy
+GuessPoint PlaneRound::applyComputerMove(const GridPoint& qp)
+{
     //use the player grid to see the result of the grid
     GuessPoint::Type tp = m_PlayerGrid->getGuessResult(qp);
     GuessPoint gp(qp.x(), qp.y(), tp);
 
     //add the data to the computer strategy
-    m_computerLogic->addData(gp);
+    {
+        QMutexLocker locker(&m_logicMutex);
+        m_computerLogic->addData(gp);
+    }
 
     //update the computer guess list
-    m_computerGuessList.append(gp);
+    m_computerGuessList.push_back(PackedGuess(gp, m_PlayerGrid->getRowNo()));
 
     return gp;
 }
 
+//receives a computer move from the worker thread
+void PlaneRound::computerMoveComputed(int request, QPoint qp)
+{
+    //the move belongs to a cancelled request
+    if (request != m_currentRequest.load())
+        return;
+
+    setComputerThinking(false);
+
+    GuessPoint gp = applyComputerMove(GridPoint(qp.x(), qp.y()));
+    updateGameStats(gp, true);
+    emit computerMoveGenerated(gp);
+    endComputerMove();
+}
+
+//receives from the worker thread that the strategy has no move
+//the computer passes its turn
+void PlaneRound::computerMoveNotFound(int request)
+{
+    //the answer belongs to a cancelled request
+    if (request != m_currentRequest.load())
+        return;
+
+    setComputerThinking(false);
+    emit displayStatusMessage(tr("Computer has no move"));
+    endComputerMove();
+}
+
+//goes on with the step after the computer's move
+void PlaneRound::endComputerMove()
+{
+    //if computer is first waits for the player's move
+    //otherwise the step is finished
+    if (m_isComputerFirst) {
+        emit needPlayerGuess();
+        emit displayStatusMessage(tr("Player's turn"));
+    } else {
+        endStep();
+    }
+
+    //the guess made while the computer was thinking is played now
+    //the guesses left when the round ends are dropped
+    bool isPlayerWinner = false;
+    if (m_pendingGuesses.isEmpty() || m_isComputerThinking)
+        return;
+    if (isRoundEndet(isPlayerWinner)) {
+        m_pendingGuesses.clear();
+        return;
+    }
+    receivedPlayerGuess(m_pendingGuesses.takeFirst());
+}
+
+//changes the thinking state
+void PlaneRound::setComputerThinking(bool isThinking)
+{
+    if (m_isComputerThinking == isThinking)
+        return;
+
+    m_isComputerThinking = isThinking;
+    emit computerThinking(isThinking);
+    if (isThinking)
+        emit displayStatusMessage(tr("Computer is thinking"));
+}
+
 //request a move from the player
 void PlaneRound::readPlayerMove() const
 {
@@ -110,23 +234,35 @@ void PlaneRound::readPlayerMove() const
 //treats a player's guess
 void PlaneRound::receivedPlayerGuess(const GuessPoint& gp)
 {
+    //the guess is played after the computer's move
+    if (m_isComputerThinking) {
+        m_pendingGuesses.append(gp);
+        emit displayStatusMessage(tr("Computer is thinking, your guess is played after its move"));
+        return;
+    }
+
     //update the game statistics
     updateGameStats(gp, false);
     //add the player's guess to the list of guesses
     //assume that the guess is different from the other guesses
-    m_playerGuessList.append(gp);
+    m_playerGuessList.push_back(PackedGuess(gp, m_ComputerGrid->getRowNo()));
 
     //if the player is  first
     //run the computer's move
+    //the step ends when the move is received
     if (!m_isComputerFirst)
     {
-        GuessPoint gp = guessComputerMove();
-        updateGameStats(gp, true);
-        emit computerMoveGenerated(gp);
+        requestComputerMove();
+        return;
     }
 
-    //play step is finished
-    //verify if round is finished
+    endStep();
+}
+
+//play step is finished
+//verify if round is finished
+void PlaneRound::endStep()
+{
     bool isComputerWinner = false;
     if (!isRoundEndet(isComputerWinner))
         playStep();
@@ -144,6 +280,8 @@ void PlaneRound::receivedPlayerGuess(const GuessPoint& gp)
             emit statsUpdated(m_gameStats);
         }
 
+        if (m_spectators)
+            m_spectators->roundEnded(isComputerWinner, m_gameStats);
         emit displayStatusMessage(text);
         emit roundEnds(!isComputerWinner);
     }
@@ -152,14 +290,10 @@ void PlaneRound::receivedPlayerGuess(const GuessPoint& gp)
 //plays one computer move and one player move
 void PlaneRound::playStep()
 {
-    //if computer is first guesses the computer move
-    //and waits for the player's move
+    //if computer is first asks for the computer move
+    //the player's move is requested when the computer move arrives
     if (m_isComputerFirst) {
-        GuessPoint gp = guessComputerMove();
-        updateGameStats(gp, true);
-        emit computerMoveGenerated(gp);
-        emit needPlayerGuess();
-        emit displayStatusMessage(tr("Player's turn"));
+        requestComputerMove();
     } else {
     //if player is first waits for the player's guess
         emit needPlayerGuess();
@@ -170,5 +304,113 @@ void PlaneRound::playStep()
 void PlaneRound::updateGameStats(const GuessPoint& gp, bool isComputer)
 {
     m_gameStats.updateStats(gp, isComputer);
+    if (m_spectators)
+        m_spectators->guessMade(gp, isComputer, m_gameStats);
+    emit statsUpdated(m_gameStats);
+}
+
+//reports the allocations made for the current game
+QString PlaneRound::allocationReport() const
+{
+    QString toReturn = "";
+
+    toReturn += "Round: ";
+    toReturn += QString::fromStdString(m_arena.report());
+    toReturn += "\nPlayer grid: ";
+    toReturn += QString::fromStdString(m_PlayerGrid->arena().report());
+    toReturn += "\nComputer grid: ";
+    toReturn += QString::fromStdString(m_ComputerGrid->arena().report());
+    toReturn += "\nComputer logic: ";
+    toReturn += QString::fromStdString(m_computerLogic->arena().report());
+
+    return toReturn;
+}
+
+//writes a list of guesses
+static void saveGuessList(SnapshotWriter& writer, const ArenaVector<PackedGuess>& guesses)
+{
+    writer.write(static_cast<uint16_t>(guesses.size()));
+    for (unsigned int i = 0; i < guesses.size(); i++)
+        writer.write(static_cast<uint16_t>(guesses[i].code()));
+}
+
+//reads a list of guesses on a grid
+static bool restoreGuessList(SnapshotReader& reader, ArenaVector<PackedGuess>& guesses, int pointNo)
+{
+    guesses.clear();
+    const int guessNo = reader.readCount(pointNo);
+    for (int i = 0; i < guessNo && !reader.hasError(); i++) {
+        PackedGuess pg = PackedGuess::fromCode(reader.read<uint16_t>());
+        if (pg.cell() >= pointNo || pg.type() > GuessPoint::Dead) {
+            reader.setError();
+            break;
+        }
+        guesses.push_back(pg);
+    }
+    return !reader.hasError();
+}
+
+//the logic is locked while it is written
+void PlaneRound::saveState(SnapshotWriter& writer)
+{
+    QMutexLocker locker(&m_logicMutex);
+
+    writer.write(static_cast<uint8_t>((m_isComputerFirst ? 1 : 0) | (m_isComputerThinking ? 2 : 0)));
+    m_gameStats.saveState(writer);
+    m_PlayerGrid->saveState(writer);
+    m_ComputerGrid->saveState(writer);
+    saveGuessList(writer, m_playerGuessList);
+    saveGuessList(writer, m_computerGuessList);
+    m_computerLogic->saveState(writer);
+}
+
+//the computation in progress is cancelled before the state is replaced
+bool PlaneRound::restoreState(SnapshotReader& reader)
+{
+    m_currentRequest.fetchAndAddOrdered(1);
+    m_computerLogic->requestCancel();
+    setComputerThinking(false);
+    m_pendingGuesses.clear();
+
+    const int flags = reader.read<uint8_t>();
+    m_isComputerFirst = (flags & 1) != 0;
+    const bool isComputerMoveAwaited = (flags & 2) != 0;
+
+    bool ok;
+    {
+        QMutexLocker locker(&m_logicMutex);
+        ok = m_gameStats.restoreState(reader) &&
+                m_PlayerGrid->restoreState(reader) &&
+                m_ComputerGrid->restoreState(reader) &&
+                restoreGuessList(reader, m_playerGuessList, m_ComputerGrid->getRowNo() * m_ComputerGrid->getColNo()) &&
+                restoreGuessList(reader, m_computerGuessList, m_PlayerGrid->getRowNo() * m_PlayerGrid->getColNo()) &&
+                m_computerLogic->restoreState(reader);
+    }
+    if (!ok) {
+        reset();
+        return false;
+    }
+
+    if (m_spectators) {
+        m_spectators->beginRound(m_PlayerGrid->getRowNo(), m_PlayerGrid->getColNo(), m_PlayerGrid->getPlaneNo(), m_isComputerFirst);
+        for (unsigned int i = 0; i < m_computerGuessList.size(); i++)
+            m_spectators->addGuess(m_computerGuessList[i].toGuessPoint(m_PlayerGrid->getRowNo()), true);
+        for (unsigned int i = 0; i < m_playerGuessList.size(); i++)
+            m_spectators->addGuess(m_playerGuessList[i].toGuessPoint(m_ComputerGrid->getRowNo()), false);
+        //the argument of isRoundEndet() tells whether the computer won, as in endStep()
+        bool isComputerWinner = false;
+        if (isRoundEndet(isComputerWinner))
+            m_spectators->endRound(isComputerWinner);
+        m_spectators->publishKeyframe(m_gameStats);
+    }
+
+    emit initGraphics();
     emit statsUpdated(m_gameStats);
+
+    bool isPlayerWinner = false;
+    if (isComputerMoveAwaited)
+        requestComputerMove();
+    else if (!isRoundEndet(isPlayerWinner))
+        readPlayerMove();
+    return true;
 }
@@ -5,9 +5,17 @@
 #include "planegrid.h"
 #include "computerlogic.h"
 #include "gamestatistics.h"
+#include "gamearena.h"
+#include "packedtypes.h"
+#include "computermoveworker.h"
+#include "snapshotstream.h"
+#include "spectatorstream.h"
+#include <QAtomicInt>
 #include <QList>
+#include <QMutex>
 #include <QPoint>
 #include <QObject>
+#include <QThread>
 
 //implements the control logic for playing one round of planes
 class PlaneRound: public QObject
@@ -23,20 +31,45 @@ class PlaneRound: public QObject
     PlaneGrid* m_PlayerGrid;
     PlaneGrid* m_ComputerGrid;
 
+    //the memory for the lists of guesses
+    //it is released in one step when the round is reset
+    GameArena m_arena;
+
     //the list of guesses for computer and player
-    QList<GuessPoint> m_computerGuessList;
-    QList<GuessPoint> m_playerGuessList;
+    ArenaVector<PackedGuess> m_computerGuessList;
+    ArenaVector<PackedGuess> m_playerGuessList;
 
     //the computer's strategy
     ComputerLogic* m_computerLogic;
 
+    //the computer's moves are computed in a worker thread
+    QThread m_workerThread;
+    ComputerMoveWorker* m_worker;
+    //protects the computer logic while the worker uses it
+    QMutex m_logicMutex;
+    //number of the computer move that is awaited
+    //it is changed to cancel the computation in progress
+    QAtomicInt m_currentRequest;
+    //whether a computer move is being computed
+    bool m_isComputerThinking;
+    //the guesses the player made while the computer was thinking
+    //they are played in turn after the computer's moves
+    QList<GuessPoint> m_pendingGuesses;
+    //the spectators of the round, not owned
+    SpectatorStream* m_spectators;
+
 public:
     //constructs the round object
     PlaneRound(PlaneGrid* playerGrid, PlaneGrid* computerGrid, ComputerLogic* logic, bool isComputerFirst);
+    //stops the worker thread
+    ~PlaneRound();
     //returns whether the round has ended or not and gives the winner
     bool isRoundEndet(bool& isPlayerWinner) const;
     //based on the available information makes the next move for the computer
+    //the move is computed in the calling thread
     GuessPoint guessComputerMove();
+    //whether the computer is computing a move in the worker thread
+    bool isComputerThinking() const { return m_isComputerThinking; }
     //reads the player's move
     void readPlayerMove() const;
 
@@ -44,15 +77,44 @@ public:
     void reset();
 
     //tests whether all of the planes have been guessed
-    bool enoughGuesses(PlaneGrid* pg, const QList<GuessPoint>& guessList ) const;
+    bool enoughGuesses(PlaneGrid* pg, const ArenaVector<PackedGuess>& guessList ) const;
     //inits a new round
     void initRound();
     //update game statistics
     void updateGameStats(const GuessPoint& gp, bool isComputer);
+    //reports the allocations made for the current game
+    //by the round, the two grids and the computer logic
+    QString allocationReport() const;
+    //writes the state of the round: who moves first, whether a computer move
+    //is awaited, the statistics, the grids, the guesses and the computer logic
+    //waits for a computer move being computed
+    void saveState(SnapshotWriter& writer);
+    //reads a round written by saveState() for grids of the same size
+    //and goes on with it; the awaited computer move is requested again
+    bool restoreState(SnapshotReader& reader);
+    //the stream receives the start, the guesses and the end of the rounds
+    //and a keyframe when a round is restored; nullptr for none
+    void setSpectatorStream(SpectatorStream* stream) { m_spectators = stream; }
+
+private:
+    //asks the worker thread for the next computer move
+    void requestComputerMove();
+    //checks the result of a computer move and adds it to the computer's strategy
+    GuessPoint applyComputerMove(const GridPoint& qp);
+    //verifies whether the round has ended and either ends it or plays the next step
+    void endStep();
+    //goes on with the step after the computer's move and plays the next waiting guess
+    void endComputerMove();
+    //changes the thinking state and notifies the views
+    void setComputerThinking(bool isThinking);
 
 signals:
     //signals that a guess from the player is needed
     void needPlayerGuess() const;
+    //asks the worker thread for a computer move
+    void computerMoveRequested(int request);
+    //signals that the computer started or finished computing a move
+    void computerThinking(bool isThinking);
     //signals that computer has generated a move
     void computerMoveGenerated(const GuessPoint& gp);
     //signals that a message has to be displayed in the edit control window
@@ -67,11 +129,18 @@ signals:
 public slots:
 
     //received a player guess from the computer render area
+    //a guess made while the computer is thinking waits for the computer's move
     void receivedPlayerGuess(const GuessPoint& gp);
     //plays one step
     void playStep();
     //plays the game
     void play();
+
+private slots:
+    //receives a computer move from the worker thread
+    void computerMoveComputed(int request, QPoint qp);
+    //receives from the worker thread that the computer has no move
+    void computerMoveNotFound(int request);
 };
 
 
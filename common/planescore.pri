@@ -0,0 +1,67 @@
+#the game logic, using only the standard library
+#included by planescore/planescore.pro
+
+INCLUDEPATH += $$PWD
+DEPENDPATH += $$PWD
+
+SOURCES += $$PWD/plane.cpp \
+    $$PWD/computerlogic.cpp \
+    $$PWD/planegridcore.cpp \
+    $$PWD/guesspoint.cpp \
+    $$PWD/planeiterators.cpp \
+    $$PWD/gamestatistics.cpp \
+    $$PWD/gamearena.cpp \
+    $$PWD/planestencils.cpp \
+    $$PWD/choicemap.cpp \
+    $$PWD/choicekernels.cpp \
+    $$PWD/planepropagator.cpp \
+    $$PWD/threadpool.cpp \
+    $$PWD/expertsearch.cpp \
+    $$PWD/endgamesolver.cpp \
+    $$PWD/computerstrategy.cpp \
+    $$PWD/mappedfile.cpp \
+    $$PWD/openingbook.cpp \
+    $$PWD/configurationdatabase.cpp \
+    $$PWD/configurationfilter.cpp \
+    $$PWD/batchengine.cpp \
+    $$PWD/gamesession.cpp \
+    $$PWD/wireprotocol.cpp \
+    $$PWD/sessionsnapshot.cpp \
+    $$PWD/replaylog.cpp \
+    $$PWD/statisticsstore.cpp \
+    $$PWD/boardpool.cpp \
+    $$PWD/spectatorstream.cpp
+HEADERS += $$PWD/plane.h \
+    $$PWD/gridpoint.h \
+    $$PWD/computerlogic.h \
+    $$PWD/listiterator.h \
+    $$PWD/smallvector.h \
+    $$PWD/packedtypes.h \
+    $$PWD/planegridcore.h \
+    $$PWD/guesspoint.h \
+    $$PWD/planeiterators.h \
+    $$PWD/gamestatistics.h \
+    $$PWD/gamearena.h \
+    $$PWD/planestencils.h \
+    $$PWD/choicemap.h \
+    $$PWD/choicekernels.h \
+    $$PWD/planepropagator.h \
+    $$PWD/threadpool.h \
+    $$PWD/expertsearch.h \
+    $$PWD/endgamesolver.h \
+    $$PWD/computerstrategy.h \
+    $$PWD/strategypolicies.h \
+    $$PWD/mappedfile.h \
+    $$PWD/openingbook.h \
+    $$PWD/configurationdatabase.h \
+    $$PWD/configurationfilter.h \
+    $$PWD/batchengine.h \
+    $$PWD/gamesession.h \
+    $$PWD/wireprotocol.h \
+    $$PWD/snapshotstream.h \
+    $$PWD/sessionsnapshot.h \
+    $$PWD/replaylog.h \
+    $$PWD/statisticsstore.h \
+    $$PWD/boardpool.h \
+    $$PWD/objectpool.h \
+    $$PWD/spectatorstream.h
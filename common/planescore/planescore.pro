@@ -0,0 +1,9 @@
+#the headless library for the tools, the simulators and libcommon, without Qt
+TEMPLATE = lib
+CONFIG += staticlib
+CONFIG -= qt
+TARGET = planescore
+
+LIBS += -lpthread
+
+include(../planescore.pri)
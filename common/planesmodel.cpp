@@ -1,20 +1,33 @@
 #include "planesmodel.h"
-#include <QTime>
 
 PlanesModel::PlanesModel(int rowNo, int colNo, int planeNo):
     m_rowNo(rowNo), m_colNo(colNo), m_planeNo(planeNo)
 {
     //initializes the random number generator
-    QTime time = QTime::currentTime();
-    int seed = time.msec();
-    srand(seed);
+    Plane::seedRandomGenerator();
 
     //builds the plane grid objects
     m_playerGrid = new PlaneGrid(m_rowNo, m_colNo, m_planeNo, false);
     m_computerGrid = new PlaneGrid(m_rowNo, m_colNo, m_planeNo, true);
+    //the computer's planes are placed in advance, a round starts without waiting for them
+    m_boardPool = new BoardPool(m_rowNo, m_colNo, m_planeNo, 16);
+    m_computerGrid->setBoardPool(m_boardPool);
 
     //builds the computer logic object
     m_computerLogic = new ComputerLogic(m_rowNo, m_colNo, m_planeNo);
+    //uses the opening book for this geometry if it was built
+    m_computerLogic->setOpeningBook(OpeningBook::open(OpeningBook::defaultFileName(m_rowNo, m_colNo, m_planeNo)));
+    //and the database of the placements of the planes
+    m_computerLogic->setConfigurationDatabase(ConfigurationDatabase::open(ConfigurationDatabase::defaultFileName(m_rowNo, m_colNo, m_planeNo)));
+}
+
+//the opening book, the configuration database and the board pool are kept
+void PlanesModel::recycle()
+{
+    m_playerGrid->resetGrid();
+    m_computerGrid->resetGrid();
+    m_computerLogic->reset();
+    m_computerLogic->resetStrategies();
 }
 
 //deletes the objects
@@ -23,4 +36,5 @@ PlanesModel::~PlanesModel()
     delete m_computerLogic;
     delete m_computerGrid;
     delete m_playerGrid;
+    delete m_boardPool;
 }
@@ -3,6 +3,7 @@
 
 #include "planegrid.h"
 #include "computerlogic.h"
+#include "boardpool.h"
 
 
 //this is the main model object
@@ -22,6 +23,8 @@ class PlanesModel
     //as well as various operations: save, remove, search, etc.
     PlaneGrid* m_playerGrid;
     PlaneGrid* m_computerGrid;
+    //the boards of the computer generated in advance
+    BoardPool* m_boardPool;
 
     //ComputerLogic is the object that keeps the
     //computer's strategy
@@ -31,8 +34,14 @@ public:
     PlanesModel(int rowNo, int colNo, int planeNo);
     ~PlanesModel();
 
+    //returns the model to the state of a new one: empty grids and the logic
+    //reset with the default strategies; the objects, their memory and the
+    //tables are kept, so that the model can be kept in an ObjectPool
+    void recycle();
+
     PlaneGrid* playerGrid()  { return m_playerGrid; }
     PlaneGrid* computerGrid()  { return m_computerGrid; }
+    BoardPool* boardPool()  { return m_boardPool; }
 
     ComputerLogic* computerLogic()  { return m_computerLogic; }
 };
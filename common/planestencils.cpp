@@ -0,0 +1,80 @@
+#include "planestencils.h"
+#include "planeiterators.h"
+#include <map>
+#include <memory>
+#include <mutex>
+#include <utility>
+
+//builds the tables for a grid of the given size
+PlaneStencils::PlaneStencils(int rowNo, int colNo):
+    m_rowNo(rowNo),
+    m_colNo(colNo),
+    m_valid(rowNo * colNo * 4, 0),
+    m_footprints(rowNo * colNo * 4 * PlanePointsNo, -1),
+    m_coverStart(rowNo * colNo + 1, 0),
+    m_laneStride((rowNo * colNo + LaneAlignment - 1) / LaneAlignment * LaneAlignment),
+    m_laneBaseline(m_laneStride * 4, -1),
+    m_cellRows(rowNo * colNo),
+    m_cellCols(rowNo * colNo)
+{
+    const int positionNo = planePositionNo();
+
+    for (CellId cell = 0; cell < pointNo(); cell++) {
+        m_cellRows[cell] = cell % m_rowNo;
+        m_cellCols[cell] = cell / m_rowNo;
+    }
+
+    //footprints of the plane positions
+    for (int pos = 0; pos < positionNo; pos++) {
+        Plane pl = toPlane(pos);
+        if (!pl.isPositionValid(m_rowNo, m_colNo))
+            continue;
+
+        m_valid[pos] = 1;
+        m_laneBaseline[toLane(pos)] = 0;
+        PlanePointIterator ppi(pl);
+        int idx = 0;
+        while (ppi.hasNext()) {
+            GridPoint qp = ppi.next();
+            m_footprints[pos * PlanePointsNo + idx] = cellId(qp);
+            idx++;
+        }
+    }
+
+    //inverts the footprints: counts, prefix sums, then fills
+    for (int pos = 0; pos < positionNo; pos++) {
+        if (!m_valid[pos])
+            continue;
+        for (int i = 0; i < PlanePointsNo; i++)
+            m_coverStart[m_footprints[pos * PlanePointsNo + i] + 1]++;
+    }
+    for (int point = 0; point < pointNo(); point++)
+        m_coverStart[point + 1] += m_coverStart[point];
+
+    m_covers.resize(m_coverStart[pointNo()]);
+    std::vector<int> fill(m_coverStart.begin(), m_coverStart.end() - 1);
+    for (int pos = 0; pos < positionNo; pos++) {
+        if (!m_valid[pos])
+            continue;
+        for (int i = 0; i < PlanePointsNo; i++)
+            m_covers[fill[m_footprints[pos * PlanePointsNo + i]]++] = pos;
+    }
+
+    m_laneCovers.resize(m_covers.size());
+    for (unsigned int i = 0; i < m_covers.size(); i++)
+        m_laneCovers[i] = toLane(m_covers[i]);
+}
+
+//returns the tables for a grid size
+//the tables are built on first use and kept for the lifetime of the program
+const PlaneStencils& PlaneStencils::forGrid(int rowNo, int colNo)
+{
+    static std::mutex mutex;
+    static std::map<std::pair<int, int>, std::unique_ptr<PlaneStencils> > tables;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    std::unique_ptr<PlaneStencils>& table = tables[std::make_pair(rowNo, colNo)];
+    if (!table)
+        table.reset(new PlaneStencils(rowNo, colNo));
+    return *table;
+}
@@ -0,0 +1,103 @@
+#ifndef PLANESTENCILS_H
+#define PLANESTENCILS_H
+
+#include "gridpoint.h"
+#include "plane.h"
+#include <vector>
+
+//dense integer ids of the grid points and of the plane positions
+//a grid point (a cell) is col * rowNo + row
+//a plane position is the cell of its head * 4 + orientation
+typedef int CellId;
+typedef int PlaneId;
+
+//Precomputed geometry of all plane positions on a grid of a given size.
+//The logic works with CellId and PlaneId, Plane and GridPoint objects are
+//only built at the edges of its interface, with the conversions below.
+//For each position the table keeps the grid points covered by the plane
+//(the footprint stencil) and for each grid point the positions that cover it
+//(the influence stencil). The tables are built once for each grid size
+//and shared by all the objects that use that size.
+//
+//The influence stencils are also given in lane order, the layout of ChoiceMap:
+//one lane of laneStride() elements for each orientation, holding the grid points
+//in order, with laneStride() rounded up to a multiple of LaneAlignment so that
+//every lane starts on a vector boundary. Plane position p is at lane index
+//(p % 4) * laneStride() + p / 4.
+class PlaneStencils
+{
+public:
+    //number of points on a plane
+    static const int PlanePointsNo = 10;
+    //number of ints the lanes are padded to, one AVX2 register
+    static const int LaneAlignment = 8;
+
+private:
+    //size of the grid
+    int m_rowNo, m_colNo;
+    //whether the plane position is completely inside the grid
+    std::vector<char> m_valid;
+    //PlanePointsNo grid points for each valid plane position, the head first
+    std::vector<int> m_footprints;
+    //for each grid point the plane positions covering it
+    //stored contiguously, m_coverStart has one more element than the number of points
+    std::vector<int> m_coverStart;
+    std::vector<int> m_covers;
+    //the same plane positions as lane indices
+    std::vector<int> m_laneCovers;
+    //number of elements in one lane
+    int m_laneStride;
+    //the initial lanes: 0 for the valid plane positions, -1 elsewhere including the padding
+    std::vector<int> m_laneBaseline;
+    //the row and the column of each cell
+    std::vector<int> m_cellRows;
+    std::vector<int> m_cellCols;
+
+    PlaneStencils(int rowNo, int colNo);
+
+public:
+    //returns the shared tables for a grid size
+    static const PlaneStencils& forGrid(int rowNo, int colNo);
+
+    int getRowNo() const { return m_rowNo; }
+    int getColNo() const { return m_colNo; }
+    int planePositionNo() const { return m_rowNo * m_colNo * 4; }
+    int pointNo() const { return m_rowNo * m_colNo; }
+
+    //conversions between cells and points
+    CellId cellId(int row, int col) const { return col * m_rowNo + row; }
+    CellId cellId(const GridPoint& qp) const { return qp.y() * m_rowNo + qp.x(); }
+    bool isCellInGrid(int row, int col) const { return row >= 0 && row < m_rowNo && col >= 0 && col < m_colNo; }
+    int cellRow(CellId cell) const { return m_cellRows[cell]; }
+    int cellCol(CellId cell) const { return m_cellCols[cell]; }
+    GridPoint cellPoint(CellId cell) const { return GridPoint(m_cellRows[cell], m_cellCols[cell]); }
+
+    //conversions between plane positions and planes
+    static PlaneId planeId(CellId head, int orientation) { return head * 4 + orientation; }
+    PlaneId planeId(const Plane& pl) const { return planeId(cellId(pl.row(), pl.col()), pl.orientation()); }
+    static CellId headCell(PlaneId plane) { return plane / 4; }
+    static int orientation(PlaneId plane) { return plane % 4; }
+    Plane toPlane(PlaneId plane) const { return Plane(cellRow(headCell(plane)), cellCol(headCell(plane)), (Plane::Orientation)orientation(plane)); }
+
+    //whether a plane position is completely inside the grid
+    bool isValid(PlaneId position) const { return m_valid[position] != 0; }
+    //the grid points covered by a valid plane position, the head first
+    const CellId* footprint(PlaneId position) const { return &m_footprints[position * PlanePointsNo]; }
+    //the plane positions covering a grid point
+    const PlaneId* coversBegin(CellId point) const { return m_covers.data() + m_coverStart[point]; }
+    const PlaneId* coversEnd(CellId point) const { return m_covers.data() + m_coverStart[point + 1]; }
+
+    //number of elements in one lane and in all the four lanes
+    int laneStride() const { return m_laneStride; }
+    int laneSize() const { return m_laneStride * 4; }
+    //conversions between plane positions and lane indices
+    int toLane(int position) const { return (position % 4) * m_laneStride + position / 4; }
+    int fromLane(int lane) const { return (lane % m_laneStride) * 4 + lane / m_laneStride; }
+    //the plane positions covering a grid point as lane indices
+    const int* laneCoversBegin(int point) const { return m_laneCovers.data() + m_coverStart[point]; }
+    const int* laneCoversEnd(int point) const { return m_laneCovers.data() + m_coverStart[point + 1]; }
+    //the choices at the beginning of a game in lane order
+    const int* laneBaseline() const { return m_laneBaseline.data(); }
+};
+
+#endif // PLANESTENCILS_H
@@ -0,0 +1,318 @@
+#include "replaylog.h"
+#include <cstring>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace {
+
+//shortens a file
+bool truncateFile(const std::string& path, uint64_t size)
+{
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_WRITE, 0, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+        return false;
+    LARGE_INTEGER position;
+    position.QuadPart = static_cast<LONGLONG>(size);
+    bool ok = SetFilePointerEx(file, position, nullptr, FILE_BEGIN) && SetEndOfFile(file);
+    CloseHandle(file);
+    return ok;
+#else
+    return truncate(path.c_str(), static_cast<off_t>(size)) == 0;
+#endif
+}
+
+}
+
+//constructor
+ReplayLogWriter::ReplayLogWriter():
+    m_file(nullptr),
+    m_indexFile(nullptr),
+    m_offset(0),
+    m_blockRecordNo(0),
+    m_blockCapacity(0)
+{
+}
+
+//destructor
+ReplayLogWriter::~ReplayLogWriter()
+{
+    close();
+}
+
+//opens the log and its index for appending
+//a new log starts with the file header, an existing one is repaired so that
+//the new blocks are 8 byte aligned and follow the last complete block
+bool ReplayLogWriter::open(const std::string& path, std::size_t blockCapacity)
+{
+    close();
+
+    ReplayLog::FileHeader header;
+    bool isNew = true;
+    FILE* existing = std::fopen(path.c_str(), "rb");
+    if (existing != nullptr) {
+        std::size_t read = std::fread(&header, 1, sizeof(header), existing);
+        std::fclose(existing);
+        if (read != 0) {
+            if (read != sizeof(header) || header.m_magic != ReplayLog::Magic || header.m_version != ReplayLog::Version)
+                return false;
+            isNew = false;
+        }
+    }
+    if (!isNew && !repair(path))
+        return false;
+
+    m_file = std::fopen(path.c_str(), "ab");
+    m_indexFile = std::fopen(ReplayLog::indexFileName(path).c_str(), "ab");
+    if (m_file == nullptr || m_indexFile == nullptr) {
+        close();
+        return false;
+    }
+
+    if (isNew) {
+        std::memset(&header, 0, sizeof(header));
+        header.m_magic = ReplayLog::Magic;
+        header.m_version = ReplayLog::Version;
+        if (std::fwrite(&header, sizeof(header), 1, m_file) != 1 || std::fflush(m_file) != 0) {
+            close();
+            return false;
+        }
+    }
+
+    std::fseek(m_file, 0, SEEK_END);
+    m_offset = static_cast<uint64_t>(std::ftell(m_file));
+
+    m_blockCapacity = blockCapacity;
+    m_block.reserve(blockCapacity);
+    m_block.assign(sizeof(ReplayLog::BlockHeader), 0);
+    m_blockRecordNo = 0;
+    return true;
+}
+
+//the blocks are those a reader finds: the indexed ones and those that follow
+//them; the bytes after the last one are the start of a block whose write
+//was interrupted, and the index may have lost entries or end in half of one
+bool ReplayLogWriter::repair(const std::string& path)
+{
+    std::vector<ReplayLog::IndexEntry> blocks;
+    {
+        ReplayLogReader reader;
+        if (!reader.open(path))
+            return false;
+        for (int i = 0; i < reader.blockNo(); i++)
+            blocks.push_back(reader.block(i));
+    }
+
+    uint64_t end = sizeof(ReplayLog::FileHeader);
+    if (!blocks.empty())
+        end = blocks.back().m_offset + sizeof(ReplayLog::BlockHeader) + blocks.back().m_size;
+    if (!truncateFile(path, end))
+        return false;
+
+    FILE* index = std::fopen(ReplayLog::indexFileName(path).c_str(), "wb");
+    if (index == nullptr)
+        return false;
+    bool ok = blocks.empty() || std::fwrite(blocks.data(), sizeof(ReplayLog::IndexEntry), blocks.size(), index) == blocks.size();
+    ok = std::fclose(index) == 0 && ok;
+    return ok;
+}
+
+//writes the last block
+void ReplayLogWriter::close()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_file != nullptr && m_indexFile != nullptr)
+        writeBlock();
+    if (m_file != nullptr)
+        std::fclose(m_file);
+    if (m_indexFile != nullptr)
+        std::fclose(m_indexFile);
+    m_file = nullptr;
+    m_indexFile = nullptr;
+}
+
+//the boards are the planes of the grids, the moves the guesses of both sides
+bool ReplayLogWriter::append(const GameSession& session)
+{
+    const int planeNo = session.getPlaneNo();
+    const int rowNo = session.getRowNo();
+    std::vector<PackedPlane> planes(2 * planeNo);
+    const PlaneGridCore* grids[] = { &session.playerGrid(), &session.computerGrid() };
+    for (int k = 0; k < 2; k++) {
+        for (int i = 0; i < planeNo; i++) {
+            Plane pl;
+            if (!grids[k]->getPlane(i, pl))
+                return false;
+            planes[k * planeNo + i] = PackedPlane(pl, rowNo);
+        }
+    }
+
+    //the first side has as many moves as the other or one more
+    const std::vector<PackedGuess>& computerMoves = session.computerGuesses();
+    const std::vector<PackedGuess>& playerMoves = session.playerGuesses();
+    const std::vector<PackedGuess>& first = session.isComputerFirst() ? computerMoves : playerMoves;
+    const std::vector<PackedGuess>& second = session.isComputerFirst() ? playerMoves : computerMoves;
+    if (second.size() > first.size() || first.size() > second.size() + 1)
+        return false;
+    std::vector<PackedGuess> moves(first.size() + second.size());
+    for (unsigned int i = 0; i < moves.size(); i++)
+        moves[i] = (i % 2 == 0) ? first[i / 2] : second[i / 2];
+
+    return append(session.roundSeed(), rowNo, session.getColNo(), planeNo, session.isComputerFirst(),
+                  !session.isComputerWinner(), planes.data(), planes.data() + planeNo,
+                  moves.data(), static_cast<int>(moves.size()));
+}
+
+//copies the record to the block being filled
+//a record larger than a block gets a block of its own
+bool ReplayLogWriter::append(uint64_t seed, int rowNo, int colNo, int planeNo, bool isComputerFirst, bool isPlayerWinner,
+                             const PackedPlane* playerPlanes, const PackedPlane* computerPlanes,
+                             const PackedGuess* moves, int moveNo)
+{
+    if (rowNo <= 0 || rowNo > 255 || colNo <= 0 || colNo > 255 || planeNo <= 0 || planeNo > 255 ||
+        moveNo < 0 || moveNo > 0xffff)
+        return false;
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_file == nullptr)
+        return false;
+
+    const std::size_t size = ReplayLog::recordSize(planeNo, moveNo);
+    if (m_blockRecordNo > 0 && m_block.size() + size > m_blockCapacity && !writeBlock())
+        return false;
+
+    const std::size_t at = m_block.size();
+    m_block.resize(at + size, 0);
+
+    ReplayLog::RecordHeader header;
+    header.m_seed = seed;
+    header.m_rowNo = static_cast<uint8_t>(rowNo);
+    header.m_colNo = static_cast<uint8_t>(colNo);
+    header.m_planeNo = static_cast<uint8_t>(planeNo);
+    header.m_flags = static_cast<uint8_t>((isComputerFirst ? ReplayLog::ComputerFirst : 0) |
+                                          (isPlayerWinner ? ReplayLog::PlayerWinner : 0));
+    header.m_moveNo = static_cast<uint16_t>(moveNo);
+    header.m_reserved = 0;
+    std::memcpy(m_block.data() + at, &header, sizeof(header));
+
+    uint16_t* codes = reinterpret_cast<uint16_t*>(m_block.data() + at + sizeof(header));
+    for (int i = 0; i < planeNo; i++) {
+        codes[i] = static_cast<uint16_t>(playerPlanes[i].id());
+        codes[planeNo + i] = static_cast<uint16_t>(computerPlanes[i].id());
+    }
+    for (int i = 0; i < moveNo; i++)
+        codes[2 * planeNo + i] = static_cast<uint16_t>(moves[i].code());
+
+    m_blockRecordNo++;
+    return true;
+}
+
+//writes the block being filled
+bool ReplayLogWriter::flush()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_file == nullptr)
+        return false;
+    return writeBlock();
+}
+
+//the block is written before its index entry, so that an index entry
+//always describes a complete block
+bool ReplayLogWriter::writeBlock()
+{
+    if (m_blockRecordNo == 0)
+        return true;
+
+    ReplayLog::BlockHeader header;
+    header.m_magic = ReplayLog::BlockMagic;
+    header.m_recordNo = m_blockRecordNo;
+    header.m_size = static_cast<uint32_t>(m_block.size() - sizeof(header));
+    header.m_reserved = 0;
+    std::memcpy(m_block.data(), &header, sizeof(header));
+
+    ReplayLog::IndexEntry entry;
+    entry.m_offset = m_offset;
+    entry.m_recordNo = header.m_recordNo;
+    entry.m_size = header.m_size;
+
+    bool ok = std::fwrite(m_block.data(), 1, m_block.size(), m_file) == m_block.size() &&
+              std::fflush(m_file) == 0 &&
+              std::fwrite(&entry, sizeof(entry), 1, m_indexFile) == 1 &&
+              std::fflush(m_indexFile) == 0;
+
+    m_offset += m_block.size();
+    m_block.resize(sizeof(header));
+    m_blockRecordNo = 0;
+    return ok;
+}
+
+//constructor
+ReplayLogReader::ReplayLogReader():
+    m_recordNo(0)
+{
+}
+
+//takes the blocks of the index that are in the log, then follows the
+//blocks written after the last one of them
+bool ReplayLogReader::open(const std::string& path)
+{
+    m_file.close();
+    m_blocks.clear();
+    m_recordNo = 0;
+
+    if (!m_file.open(path) || m_file.size() < sizeof(ReplayLog::FileHeader))
+        return false;
+    const ReplayLog::FileHeader* header = reinterpret_cast<const ReplayLog::FileHeader*>(m_file.data());
+    if (header->m_magic != ReplayLog::Magic || header->m_version != ReplayLog::Version)
+        return false;
+
+    uint64_t next = sizeof(ReplayLog::FileHeader);
+    MappedFile index;
+    if (index.open(ReplayLog::indexFileName(path))) {
+        const std::size_t entryNo = index.size() / sizeof(ReplayLog::IndexEntry);
+        for (std::size_t i = 0; i < entryNo; i++) {
+            ReplayLog::IndexEntry entry;
+            std::memcpy(&entry, index.data() + i * sizeof(entry), sizeof(entry));
+            ReplayLog::IndexEntry found;
+            if (entry.m_offset < next || !isBlockAt(entry.m_offset, found) ||
+                found.m_recordNo != entry.m_recordNo || found.m_size != entry.m_size)
+                continue;
+            m_blocks.push_back(found);
+            next = found.m_offset + sizeof(ReplayLog::BlockHeader) + found.m_size;
+        }
+    }
+
+    ReplayLog::IndexEntry found;
+    while (isBlockAt(next, found)) {
+        m_blocks.push_back(found);
+        next = found.m_offset + sizeof(ReplayLog::BlockHeader) + found.m_size;
+    }
+
+    for (unsigned int i = 0; i < m_blocks.size(); i++)
+        m_recordNo += m_blocks[i].m_recordNo;
+    return true;
+}
+
+//checks the header of a block
+//the records are 8 byte aligned, so are the blocks
+bool ReplayLogReader::isBlockAt(uint64_t offset, ReplayLog::IndexEntry& entry) const
+{
+    if (offset % 8 != 0 || offset + sizeof(ReplayLog::BlockHeader) > m_file.size())
+        return false;
+
+    ReplayLog::BlockHeader header;
+    std::memcpy(&header, m_file.data() + offset, sizeof(header));
+    if (header.m_magic != ReplayLog::BlockMagic || header.m_size % 8 != 0 ||
+        offset + sizeof(header) + header.m_size > m_file.size())
+        return false;
+
+    entry.m_offset = offset;
+    entry.m_recordNo = header.m_recordNo;
+    entry.m_size = header.m_size;
+    return true;
+}
@@ -0,0 +1,245 @@
+#ifndef REPLAYLOG_H
+#define REPLAYLOG_H
+
+#include "gamesession.h"
+#include "mappedfile.h"
+#include "packedtypes.h"
+#include "threadpool.h"
+#include <cstdint>
+#include <cstdio>
+#include <future>
+#include <mutex>
+#include <string>
+#include <vector>
+
+//An append-only log of finished rounds for offline analysis.
+//A record holds the seed of the round (the state of the session's generator
+//before the planes were placed), both boards, the guesses of both sides in
+//the order they were played and the outcome.
+//
+//File layout, in the byte order of the machine that wrote it:
+//  FileHeader
+//  blocks: BlockHeader, then recordNo records, BlockHeader::m_size bytes
+//A record is a RecordHeader followed by the planes of the player and of the
+//computer (PackedPlane ids, planeNo each) and the moves (PackedGuess codes),
+//padded to 8 bytes. The moves alternate between the sides, starting with
+//the side that moved first.
+//
+//The blocks are written whole, so a reader never sees half a block unless
+//the writer was interrupted. Each block also gets an IndexEntry in the
+//index file (the log name followed by ".idx"), so that a reader finds the
+//blocks without reading the log; a block missing from the index is found
+//by following the blocks after the last indexed one.
+class ReplayLog
+{
+public:
+    //"PLRL"
+    static const uint32_t Magic = 0x4c524c50;
+    //"PLRB"
+    static const uint32_t BlockMagic = 0x42524c50;
+    static const uint32_t Version = 1;
+
+    struct FileHeader
+    {
+        uint32_t m_magic;
+        uint32_t m_version;
+        uint32_t m_reserved[2];
+    };
+
+    struct BlockHeader
+    {
+        uint32_t m_magic;
+        uint32_t m_recordNo;
+        //the bytes of the records
+        uint32_t m_size;
+        uint32_t m_reserved;
+    };
+
+    struct IndexEntry
+    {
+        //the position of the block header in the log
+        uint64_t m_offset;
+        uint32_t m_recordNo;
+        uint32_t m_size;
+    };
+
+    //the bits of RecordHeader::m_flags
+    enum RecordFlags { ComputerFirst = 1, PlayerWinner = 2 };
+
+    struct RecordHeader
+    {
+        uint64_t m_seed;
+        uint8_t m_rowNo;
+        uint8_t m_colNo;
+        uint8_t m_planeNo;
+        uint8_t m_flags;
+        uint16_t m_moveNo;
+        uint16_t m_reserved;
+    };
+
+    //the size of a record with its padding
+    static int recordSize(int planeNo, int moveNo)
+    {
+        return (static_cast<int>(sizeof(RecordHeader)) + 2 * (2 * planeNo + moveNo) + 7) & ~7;
+    }
+    //the name of the index file of a log
+    static std::string indexFileName(const std::string& path) { return path + ".idx"; }
+};
+
+static_assert(sizeof(ReplayLog::FileHeader) == 16, "the file header has 16 bytes");
+static_assert(sizeof(ReplayLog::BlockHeader) == 16, "the block header has 16 bytes");
+static_assert(sizeof(ReplayLog::IndexEntry) == 16, "the index entries have 16 bytes");
+static_assert(sizeof(ReplayLog::RecordHeader) == 16, "the record header has 16 bytes");
+
+//a record of a log, read in place
+class ReplayRecord
+{
+    const ReplayLog::RecordHeader* m_header;
+
+public:
+    explicit ReplayRecord(const ReplayLog::RecordHeader* header): m_header(header) {}
+
+    uint64_t seed() const { return m_header->m_seed; }
+    int rowNo() const { return m_header->m_rowNo; }
+    int colNo() const { return m_header->m_colNo; }
+    int planeNo() const { return m_header->m_planeNo; }
+    bool isComputerFirst() const { return (m_header->m_flags & ReplayLog::ComputerFirst) != 0; }
+    bool isPlayerWinner() const { return (m_header->m_flags & ReplayLog::PlayerWinner) != 0; }
+    int moveNo() const { return m_header->m_moveNo; }
+
+    //the planes of the boards
+    PackedPlane playerPlane(int i) const { return PackedPlane::fromId(codes()[i]); }
+    PackedPlane computerPlane(int i) const { return PackedPlane::fromId(codes()[planeNo() + i]); }
+    //the moves in the order they were played
+    PackedGuess move(int i) const { return PackedGuess::fromCode(codes()[2 * planeNo() + i]); }
+    //whether a move was made by the computer, on the player's board
+    bool isComputerMove(int i) const { return ((i % 2) == 0) == isComputerFirst(); }
+
+private:
+    const uint16_t* codes() const { return reinterpret_cast<const uint16_t*>(m_header + 1); }
+};
+
+//Appends records to a log. The records are collected in a block that is
+//written when it is full, by flush() or by close().
+//append() can be called from several threads.
+class ReplayLogWriter
+{
+    std::mutex m_mutex;
+    FILE* m_file;
+    FILE* m_indexFile;
+    //the position of the next block in the log
+    uint64_t m_offset;
+    //the block being filled, its header included
+    std::vector<uint8_t> m_block;
+    uint32_t m_blockRecordNo;
+    std::size_t m_blockCapacity;
+
+public:
+    ReplayLogWriter();
+    //writes the last block
+    ~ReplayLogWriter();
+
+    //opens a log to add records after the existing ones, or creates it
+    //a block left incomplete by an interrupted write is removed first
+    //returns false if the file cannot be opened or is not a log
+    bool open(const std::string& path, std::size_t blockCapacity = 64 * 1024);
+    bool isOpen() const { return m_file != nullptr; }
+    //writes the block being filled and closes the files
+    void close();
+
+    //appends the finished round of a session
+    bool append(const GameSession& session);
+    //appends a round; the moves alternate between the sides starting with the first one
+    bool append(uint64_t seed, int rowNo, int colNo, int planeNo, bool isComputerFirst, bool isPlayerWinner,
+                const PackedPlane* playerPlanes, const PackedPlane* computerPlanes,
+                const PackedGuess* moves, int moveNo);
+    //writes the block being filled, even if it is not full
+    bool flush();
+
+private:
+    //cuts an existing log after its last complete block and writes its
+    //index again with all its blocks
+    static bool repair(const std::string& path);
+    //writes the block being filled and its index entry, the mutex is held
+    bool writeBlock();
+
+    ReplayLogWriter(const ReplayLogWriter&) = delete;
+    ReplayLogWriter& operator=(const ReplayLogWriter&) = delete;
+};
+
+//Reads a log from memory-mapped files.
+//The records of a block are read in place; the blocks can be shared among
+//the threads of a pool, each thread reading its own range of blocks.
+class ReplayLogReader
+{
+    MappedFile m_file;
+    std::vector<ReplayLog::IndexEntry> m_blocks;
+    uint64_t m_recordNo;
+
+public:
+    ReplayLogReader();
+
+    //maps a log and finds its blocks with the index file
+    //returns false if the file is missing or is not a log
+    bool open(const std::string& path);
+
+    int blockNo() const { return static_cast<int>(m_blocks.size()); }
+    uint64_t recordNo() const { return m_recordNo; }
+    const ReplayLog::IndexEntry& block(int i) const { return m_blocks[i]; }
+
+    //calls visitor(record) for the records of a block
+    //a damaged block is read up to the first record that does not fit
+    template <class Visitor>
+    void forEachRecord(int block, Visitor& visitor) const
+    {
+        const ReplayLog::IndexEntry& entry = m_blocks[block];
+        const uint8_t* data = m_file.data() + entry.m_offset + sizeof(ReplayLog::BlockHeader);
+        const uint8_t* end = data + entry.m_size;
+        for (uint32_t i = 0; i < entry.m_recordNo && end - data >= static_cast<std::ptrdiff_t>(sizeof(ReplayLog::RecordHeader)); i++) {
+            const ReplayLog::RecordHeader* header = reinterpret_cast<const ReplayLog::RecordHeader*>(data);
+            const int size = ReplayLog::recordSize(header->m_planeNo, header->m_moveNo);
+            if (end - data < size)
+                break;
+            visitor(ReplayRecord(header));
+            data += size;
+        }
+    }
+
+    //calls visitor(record) for all the records in order
+    template <class Visitor>
+    void forEachRecord(Visitor& visitor) const
+    {
+        for (int i = 0; i < blockNo(); i++)
+            forEachRecord(i, visitor);
+    }
+
+    //reads the records with the threads of a pool: the blocks are split in
+    //partNo contiguous ranges and visitors[k] gets the records of range k,
+    //so the visitors need no locking; the call returns when all are read
+    template <class Visitor>
+    void forEachRecordParallel(ThreadPool& pool, std::vector<Visitor>& visitors) const
+    {
+        const int partNo = static_cast<int>(visitors.size());
+        std::vector<std::future<void> > parts;
+        for (int k = 0; k < partNo; k++) {
+            const int first = static_cast<int>(static_cast<int64_t>(blockNo()) * k / partNo);
+            const int last = static_cast<int>(static_cast<int64_t>(blockNo()) * (k + 1) / partNo);
+            Visitor* visitor = &visitors[k];
+            parts.push_back(pool.submit([this, first, last, visitor]() {
+                for (int i = first; i < last; i++)
+                    forEachRecord(i, *visitor);
+            }));
+        }
+        for (unsigned int k = 0; k < parts.size(); k++)
+            parts[k].get();
+    }
+
+private:
+    //whether a block header is at the offset and its records fit in the file
+    bool isBlockAt(uint64_t offset, ReplayLog::IndexEntry& entry) const;
+
+    ReplayLogReader(const ReplayLogReader&) = delete;
+    ReplayLogReader& operator=(const ReplayLogReader&) = delete;
+};
+
+#endif // REPLAYLOG_H
@@ -0,0 +1,87 @@
+#include "sessionsnapshot.h"
+#include "mappedfile.h"
+#include <cstdio>
+
+//writes the sessions
+//the buffer keeps its capacity, so saving again does not allocate
+void SessionSnapshot::save(const std::vector<std::unique_ptr<GameSession> >& sessions, std::vector<uint8_t>& buffer)
+{
+    buffer.clear();
+    SnapshotWriter writer(buffer);
+    writer.write(Magic);
+    writer.write(Version);
+    writer.write(static_cast<uint32_t>(sessions.size()));
+    writer.write(static_cast<uint32_t>(0));
+
+    for (unsigned int i = 0; i < sessions.size(); i++) {
+        std::size_t at = writer.reserveSize();
+        if (sessions[i])
+            sessions[i]->saveState(writer);
+        writer.fillSize(at);
+    }
+}
+
+//reads the sessions
+//a session must use all the bytes of its slot
+bool SessionSnapshot::restore(const uint8_t* data, std::size_t size, std::vector<std::unique_ptr<GameSession> >& sessions)
+{
+    SnapshotReader reader(data, size);
+    Header header;
+    header.m_magic = reader.read<uint32_t>();
+    header.m_version = reader.read<uint32_t>();
+    header.m_sessionNo = reader.read<uint32_t>();
+    header.m_reserved = reader.read<uint32_t>();
+    if (reader.hasError() || header.m_magic != Magic || header.m_version != Version)
+        return false;
+    //every slot has at least its size
+    if (header.m_sessionNo > reader.remaining() / sizeof(uint32_t))
+        return false;
+
+    sessions.resize(header.m_sessionNo);
+    for (unsigned int i = 0; i < header.m_sessionNo; i++) {
+        const std::size_t sessionSize = reader.read<uint32_t>();
+        const uint8_t* sessionData = reader.data();
+        if (reader.hasError() || !reader.skip(sessionSize))
+            return false;
+
+        if (sessionSize == 0) {
+            sessions[i].reset();
+            continue;
+        }
+
+        int rowNo, colNo, planeNo;
+        if (!GameSession::readGeometry(sessionData, sessionSize, rowNo, colNo, planeNo))
+            return false;
+        if (!sessions[i] || sessions[i]->getRowNo() != rowNo || sessions[i]->getColNo() != colNo ||
+            sessions[i]->getPlaneNo() != planeNo)
+            sessions[i].reset(new GameSession(rowNo, colNo, planeNo));
+
+        SnapshotReader sessionReader(sessionData, sessionSize);
+        if (!sessions[i]->restoreState(sessionReader) || sessionReader.remaining() != 0)
+            return false;
+    }
+    return true;
+}
+
+//writes the buffer of save() in one call
+bool SessionSnapshot::write(const std::string& path, const std::vector<std::unique_ptr<GameSession> >& sessions)
+{
+    std::vector<uint8_t> buffer;
+    save(sessions, buffer);
+
+    FILE* file = std::fopen(path.c_str(), "wb");
+    if (file == nullptr)
+        return false;
+
+    bool ok = std::fwrite(buffer.data(), 1, buffer.size(), file) == buffer.size();
+    return std::fclose(file) == 0 && ok;
+}
+
+//the sessions are read from the mapped pages
+bool SessionSnapshot::read(const std::string& path, std::vector<std::unique_ptr<GameSession> >& sessions)
+{
+    MappedFile file;
+    if (!file.open(path))
+        return false;
+    return restore(file.data(), file.size(), sessions);
+}
@@ -0,0 +1,46 @@
+#ifndef SESSIONSNAPSHOT_H
+#define SESSIONSNAPSHOT_H
+
+#include "gamesession.h"
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+//Snapshots of many game sessions in one buffer or file, e.g. all the sessions
+//of a server before a restart or a migration. The sessions are written in one
+//pass and restored without replaying their moves.
+//
+//Layout, in the byte order of the machine that wrote it:
+//  Header
+//  for each session: uint32_t size, then the bytes of GameSession::saveState()
+//  a size of 0 is an empty slot, so the sessions keep their places
+class SessionSnapshot
+{
+public:
+    //"PLSS"
+    static const uint32_t Magic = 0x53534c50;
+    static const uint32_t Version = 1;
+
+    struct Header
+    {
+        uint32_t m_magic;
+        uint32_t m_version;
+        uint32_t m_sessionNo;
+        uint32_t m_reserved;
+    };
+
+    //writes the sessions to the buffer, the empty pointers are empty slots
+    static void save(const std::vector<std::unique_ptr<GameSession> >& sessions, std::vector<uint8_t>& buffer);
+    //reads the sessions of a snapshot, the vector gets one element per slot
+    //the sessions already in the vector are reused when their geometry matches
+    //returns false if the data is not a valid snapshot
+    static bool restore(const uint8_t* data, std::size_t size, std::vector<std::unique_ptr<GameSession> >& sessions);
+
+    //writes a snapshot file
+    static bool write(const std::string& path, const std::vector<std::unique_ptr<GameSession> >& sessions);
+    //maps a snapshot file and reads its sessions
+    static bool read(const std::string& path, std::vector<std::unique_ptr<GameSession> >& sessions);
+};
+
+#endif // SESSIONSNAPSHOT_H
@@ -0,0 +1,78 @@
+#ifndef SMALLVECTOR_H
+#define SMALLVECTOR_H
+
+#include <algorithm>
+#include <vector>
+
+//A contiguous list keeping up to N elements inside the object.
+//Lists that are built for every plane or every point (the points of a plane,
+//the planes through a point) have a known bound, with N chosen from it they
+//cost no memory allocation. When more elements are added they move to a
+//std::vector, which keeps the list contiguous.
+//T must be default constructible and copyable.
+template <class T, int N>
+class SmallVector
+{
+    T m_inline[N];
+    std::vector<T> m_overflow;
+    //the elements, in m_inline or in m_overflow
+    T* m_data;
+    int m_size;
+    int m_capacity;
+
+public:
+    SmallVector(): m_data(m_inline), m_size(0), m_capacity(N) {}
+    SmallVector(const SmallVector& other): m_data(m_inline), m_size(0), m_capacity(N) { *this = other; }
+
+    SmallVector& operator=(const SmallVector& other)
+    {
+        if (this == &other)
+            return *this;
+        clear();
+        reserve(other.m_size);
+        std::copy(other.m_data, other.m_data + other.m_size, m_data);
+        m_size = other.m_size;
+        return *this;
+    }
+
+    int size() const { return m_size; }
+    bool empty() const { return m_size == 0; }
+    int capacity() const { return m_capacity; }
+    //whether the elements are kept inside the object
+    bool isInline() const { return m_data == m_inline; }
+
+    T* data() { return m_data; }
+    const T* data() const { return m_data; }
+    T* begin() { return m_data; }
+    T* end() { return m_data + m_size; }
+    const T* begin() const { return m_data; }
+    const T* end() const { return m_data + m_size; }
+    T& operator[](int idx) { return m_data[idx]; }
+    const T& operator[](int idx) const { return m_data[idx]; }
+
+    void push_back(const T& value)
+    {
+        if (m_size == m_capacity)
+            reserve(2 * m_capacity);
+        m_data[m_size++] = value;
+    }
+
+    //keeps the capacity
+    void clear() { m_size = 0; }
+    //drops the elements after the first size ones
+    void truncate(int size) { m_size = std::min(m_size, size); }
+
+    //makes room for capacity elements
+    void reserve(int capacity)
+    {
+        if (capacity <= m_capacity)
+            return;
+        std::vector<T> overflow(capacity);
+        std::copy(m_data, m_data + m_size, overflow.begin());
+        m_overflow.swap(overflow);
+        m_data = m_overflow.data();
+        m_capacity = capacity;
+    }
+};
+
+#endif // SMALLVECTOR_H
@@ -0,0 +1,135 @@
+#ifndef SNAPSHOTSTREAM_H
+#define SNAPSHOTSTREAM_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <vector>
+
+//The bytes of the snapshots of the game objects (see SessionSnapshot).
+//The values are copied as they are in memory, in the byte order of the
+//machine that wrote them, like the opening book files; the objects write
+//their state field after field and read it back in the same order.
+
+//appends the values to a buffer
+class SnapshotWriter
+{
+    std::vector<uint8_t>& m_buffer;
+
+public:
+    explicit SnapshotWriter(std::vector<uint8_t>& buffer): m_buffer(buffer) {}
+
+    //the bytes written to the buffer so far, including what it held before
+    std::size_t size() const { return m_buffer.size(); }
+
+    template <typename T>
+    void write(T value)
+    {
+        static_assert(std::is_arithmetic<T>::value, "only numbers are written");
+        writeBytes(&value, sizeof(value));
+    }
+
+    template <typename T>
+    void writeArray(const T* values, int n)
+    {
+        static_assert(std::is_arithmetic<T>::value, "only numbers are written");
+        writeBytes(values, n * sizeof(T));
+    }
+
+    //leaves room for a size that is known later
+    std::size_t reserveSize()
+    {
+        std::size_t at = m_buffer.size();
+        write<uint32_t>(0);
+        return at;
+    }
+
+    //writes at a reserved place the number of bytes written after it
+    void fillSize(std::size_t at)
+    {
+        const uint32_t size = static_cast<uint32_t>(m_buffer.size() - at - sizeof(uint32_t));
+        std::memcpy(m_buffer.data() + at, &size, sizeof(size));
+    }
+
+private:
+    void writeBytes(const void* data, std::size_t n)
+    {
+        const std::size_t at = m_buffer.size();
+        m_buffer.resize(at + n);
+        if (n > 0)
+            std::memcpy(m_buffer.data() + at, data, n);
+    }
+};
+
+//reads the values from memory, e.g. a mapped file
+//reading past the end sets the error flag and gives zeros
+class SnapshotReader
+{
+    const uint8_t* m_data;
+    const uint8_t* m_end;
+    bool m_error;
+
+public:
+    SnapshotReader(const uint8_t* data, std::size_t size): m_data(data), m_end(data + size), m_error(false) {}
+
+    bool hasError() const { return m_error; }
+    //marks the data as invalid, used when a value is out of range
+    void setError() { m_error = true; m_data = m_end; }
+    std::size_t remaining() const { return static_cast<std::size_t>(m_end - m_data); }
+    const uint8_t* data() const { return m_data; }
+
+    template <typename T>
+    T read()
+    {
+        static_assert(std::is_arithmetic<T>::value, "only numbers are read");
+        T value = T();
+        readBytes(&value, sizeof(value));
+        return value;
+    }
+
+    template <typename T>
+    bool readArray(T* values, int n)
+    {
+        static_assert(std::is_arithmetic<T>::value, "only numbers are read");
+        return readBytes(values, n * sizeof(T));
+    }
+
+    //reads a count written as uint16_t, which must not be above max
+    int readCount(int max)
+    {
+        int n = read<uint16_t>();
+        if (n > max) {
+            setError();
+            return 0;
+        }
+        return n;
+    }
+
+    //skips n bytes
+    bool skip(std::size_t n)
+    {
+        if (remaining() < n) {
+            setError();
+            return false;
+        }
+        m_data += n;
+        return true;
+    }
+
+private:
+    bool readBytes(void* data, std::size_t n)
+    {
+        if (remaining() < n) {
+            setError();
+            std::memset(data, 0, n);
+            return false;
+        }
+        if (n > 0)
+            std::memcpy(data, m_data, n);
+        m_data += n;
+        return true;
+    }
+};
+
+#endif // SNAPSHOTSTREAM_H
@@ -0,0 +1,180 @@
+#include "spectatorstream.h"
+#include "wireprotocol.h"
+#include <algorithm>
+
+//constructor
+SpectatorStream::SpectatorStream(int keyframeInterval):
+    m_keyframeInterval(std::max(keyframeInterval, 1)),
+    m_rowNo(0),
+    m_colNo(0),
+    m_planeNo(0),
+    m_sequence(0),
+    m_sinceKeyframe(0),
+    m_isComputerFirst(false),
+    m_isFinished(true),
+    m_isComputerWinner(false)
+{
+    m_metrics.m_frames = 0;
+    m_metrics.m_keyframes = 0;
+    m_metrics.m_bytes = 0;
+    m_metrics.m_deliveries = 0;
+}
+
+//the keyframe carries the current sequence, the next frame follows it
+void SpectatorStream::subscribe(SpectatorSubscriber* subscriber)
+{
+    if (std::find(m_subscribers.begin(), m_subscribers.end(), subscriber) != m_subscribers.end())
+        return;
+    m_subscribers.push_back(subscriber);
+    if (m_cells.empty())
+        return;
+
+    WireWriter writer(m_scratch.data(), static_cast<int>(m_scratch.size()));
+    writer.beginFrame();
+    writeKeyframe(writer, m_sentStats);
+    if (!writer.endFrame())
+        return;
+    subscriber->deliver(makeFrame(writer.size(), true));
+    m_metrics.m_deliveries++;
+}
+
+void SpectatorStream::unsubscribe(SpectatorSubscriber* subscriber)
+{
+    std::vector<SpectatorSubscriber*>::iterator it = std::find(m_subscribers.begin(), m_subscribers.end(), subscriber);
+    if (it != m_subscribers.end())
+        m_subscribers.erase(it);
+}
+
+//the scratch buffer has room for a keyframe with the complete statistics
+void SpectatorStream::beginRound(int rowNo, int colNo, int planeNo, bool isComputerFirst)
+{
+    m_rowNo = rowNo;
+    m_colNo = colNo;
+    m_planeNo = planeNo;
+    m_isComputerFirst = isComputerFirst;
+    m_isFinished = false;
+    m_isComputerWinner = false;
+    m_cells.assign(2 * rowNo * colNo, 0);
+    const int scratchSize = WireProtocol::HeaderSize + 128 + (2 * rowNo * colNo + 3) / 4;
+    if (static_cast<int>(m_scratch.size()) < scratchSize)
+        m_scratch.resize(scratchSize);
+}
+
+//the guesses of the computer are on the player's board, the first one
+void SpectatorStream::addGuess(const GuessPoint& gp, bool isComputer)
+{
+    if (gp.m_row < 0 || gp.m_row >= m_rowNo || gp.m_col < 0 || gp.m_col >= m_colNo)
+        return;
+    const int board = isComputer ? 0 : 1;
+    m_cells[board * m_rowNo * m_colNo + gp.m_col * m_rowNo + gp.m_row] = static_cast<uint8_t>(gp.m_type + 1);
+}
+
+void SpectatorStream::endRound(bool isComputerWinner)
+{
+    m_isFinished = true;
+    m_isComputerWinner = isComputerWinner;
+}
+
+//without subscribers only the sequence and the statistics are kept
+void SpectatorStream::publishKeyframe(const GameStatistics& stats)
+{
+    if (m_cells.empty())
+        return;
+    advance(stats, true);
+    if (m_subscribers.empty())
+        return;
+
+    WireWriter writer(m_scratch.data(), static_cast<int>(m_scratch.size()));
+    writer.beginFrame();
+    writeKeyframe(writer, stats);
+    if (writer.endFrame())
+        publish(writer.size(), true);
+}
+
+void SpectatorStream::roundStarted(int rowNo, int colNo, int planeNo, bool isComputerFirst, const GameStatistics& stats)
+{
+    beginRound(rowNo, colNo, planeNo, isComputerFirst);
+    publishKeyframe(stats);
+}
+
+//a keyframe replaces the delta when the interval is reached
+void SpectatorStream::guessMade(const GuessPoint& gp, bool isComputer, const GameStatistics& stats)
+{
+    if (m_cells.empty())
+        return;
+    addGuess(gp, isComputer);
+    if (m_sinceKeyframe + 1 >= m_keyframeInterval) {
+        publishKeyframe(stats);
+        return;
+    }
+    if (m_subscribers.empty()) {
+        advance(stats, false);
+        return;
+    }
+
+    WireWriter writer(m_scratch.data(), static_cast<int>(m_scratch.size()));
+    writer.beginFrame();
+    writer.delta(m_sequence + 1);
+    if (isComputer)
+        writer.computerMove(gp);
+    else
+        writer.guessResult(gp);
+    writer.statisticsDelta(m_sentStats, stats);
+    advance(stats, false);
+    if (writer.endFrame())
+        publish(writer.size(), false);
+}
+
+void SpectatorStream::roundEnded(bool isComputerWinner, const GameStatistics& stats)
+{
+    if (m_cells.empty())
+        return;
+    endRound(isComputerWinner);
+    if (m_subscribers.empty()) {
+        advance(stats, false);
+        return;
+    }
+
+    WireWriter writer(m_scratch.data(), static_cast<int>(m_scratch.size()));
+    writer.beginFrame();
+    writer.delta(m_sequence + 1);
+    writer.roundEnded(isComputerWinner);
+    writer.statisticsDelta(m_sentStats, stats);
+    advance(stats, false);
+    if (writer.endFrame())
+        publish(writer.size(), false);
+}
+
+//the flags are those of the keyframe message
+void SpectatorStream::writeKeyframe(WireWriter& writer, const GameStatistics& stats)
+{
+    const int flags = (m_isComputerFirst ? 1 : 0) | (m_isFinished ? 2 : 0) | (m_isComputerWinner ? 4 : 0);
+    writer.keyframe(m_sequence, m_rowNo, m_colNo, m_planeNo, flags, m_cells.data());
+    writer.statistics(stats);
+}
+
+SpectatorFrame SpectatorStream::makeFrame(int size, bool isKeyframe)
+{
+    m_metrics.m_frames++;
+    if (isKeyframe)
+        m_metrics.m_keyframes++;
+    m_metrics.m_bytes += size;
+    return std::make_shared<std::vector<uint8_t> >(m_scratch.begin(), m_scratch.begin() + size);
+}
+
+//the frame that is being sent has the new sequence
+void SpectatorStream::advance(const GameStatistics& stats, bool isKeyframe)
+{
+    m_sequence++;
+    m_sinceKeyframe = isKeyframe ? 0 : m_sinceKeyframe + 1;
+    m_sentStats = stats;
+}
+
+//the subscribers share the buffer of the frame
+void SpectatorStream::publish(int size, bool isKeyframe)
+{
+    const SpectatorFrame frame = makeFrame(size, isKeyframe);
+    for (unsigned int i = 0; i < m_subscribers.size(); i++)
+        m_subscribers[i]->deliver(frame);
+    m_metrics.m_deliveries += m_subscribers.size();
+}
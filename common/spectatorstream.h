@@ -0,0 +1,118 @@
+#ifndef SPECTATORSTREAM_H
+#define SPECTATORSTREAM_H
+
+#include "gamestatistics.h"
+#include "guesspoint.h"
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+class WireWriter;
+
+//an encoded frame shared by all the spectators of a game
+typedef std::shared_ptr<const std::vector<uint8_t> > SpectatorFrame;
+
+//receives the frames of a game
+class SpectatorSubscriber
+{
+public:
+    virtual ~SpectatorSubscriber() {}
+    //called on the thread of the game for each frame; it must not block,
+    //a subscriber that sends the frame later keeps the pointer;
+    //it must not subscribe or unsubscribe from deliver()
+    virtual void deliver(const SpectatorFrame& frame) = 0;
+};
+
+//Turns the events of a round (PlaneRound and GameSession call it) into
+//frames of the wire protocol for the spectators of the game. A move is sent
+//as a delta: the guessed cell and the fields of the statistics that changed.
+//Every keyframeInterval frames, at the start of a round and to each new
+//subscriber a keyframe with the state of both boards is sent instead, so a
+//spectator that joins late or missed a frame (the sequence numbers are
+//consecutive) catches up at the next keyframe.
+//
+//A frame is encoded once, in a buffer of the stream, and copied into one
+//buffer counted by reference that all the subscribers share: the cost of a
+//move is one encoding plus one call of deliver() for each subscriber, and
+//nothing is encoded while there is no subscriber.
+//The stream is used on the thread of the game only.
+class SpectatorStream
+{
+public:
+    struct Metrics
+    {
+        uint64_t m_frames;
+        uint64_t m_keyframes;
+        //the bytes of the frames, each frame counted once
+        uint64_t m_bytes;
+        //the calls of deliver()
+        uint64_t m_deliveries;
+    };
+
+private:
+    const int m_keyframeInterval;
+    std::vector<SpectatorSubscriber*> m_subscribers;
+
+    int m_rowNo;
+    int m_colNo;
+    int m_planeNo;
+    //the cells of the player's board then of the computer's board, as in
+    //the keyframe: 0 when not guessed, otherwise the result + 1
+    std::vector<uint8_t> m_cells;
+    //the statistics the spectators have
+    GameStatistics m_sentStats;
+    //the number of the last frame
+    int m_sequence;
+    //the frames since the last keyframe
+    int m_sinceKeyframe;
+    bool m_isComputerFirst;
+    bool m_isFinished;
+    bool m_isComputerWinner;
+
+    //where the frames are encoded
+    std::vector<uint8_t> m_scratch;
+    Metrics m_metrics;
+
+public:
+    explicit SpectatorStream(int keyframeInterval = 32);
+
+    //the subscriber receives a keyframe at once, then the following frames
+    void subscribe(SpectatorSubscriber* subscriber);
+    void unsubscribe(SpectatorSubscriber* subscriber);
+    int subscriberNo() const { return static_cast<int>(m_subscribers.size()); }
+
+    //clears the boards for a round without sending anything
+    //the memory is allocated again only for a larger grid
+    void beginRound(int rowNo, int colNo, int planeNo, bool isComputerFirst);
+    //marks a guess on the boards without sending anything
+    void addGuess(const GuessPoint& gp, bool isComputer);
+    //marks the end of the round without sending anything
+    void endRound(bool isComputerWinner);
+    //sends the state of the round and the statistics
+    void publishKeyframe(const GameStatistics& stats);
+
+    //beginRound() then publishKeyframe()
+    void roundStarted(int rowNo, int colNo, int planeNo, bool isComputerFirst, const GameStatistics& stats);
+    //a guess of either side with the statistics that include it
+    void guessMade(const GuessPoint& gp, bool isComputer, const GameStatistics& stats);
+    //the winner with the statistics that include the score
+    void roundEnded(bool isComputerWinner, const GameStatistics& stats);
+
+    int sequence() const { return m_sequence; }
+    const Metrics& metrics() const { return m_metrics; }
+
+private:
+    //counts a frame, sent or not, and keeps the statistics it carries
+    void advance(const GameStatistics& stats, bool isKeyframe);
+    //writes a keyframe and the statistics in an open frame
+    void writeKeyframe(WireWriter& writer, const GameStatistics& stats);
+    //copies the encoded frame in a buffer that can be shared
+    SpectatorFrame makeFrame(int size, bool isKeyframe);
+    //gives the encoded frame to all the subscribers
+    void publish(int size, bool isKeyframe);
+
+    SpectatorStream(const SpectatorStream&) = delete;
+    SpectatorStream& operator=(const SpectatorStream&) = delete;
+};
+
+#endif // SPECTATORSTREAM_H
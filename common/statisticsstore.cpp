@@ -0,0 +1,493 @@
+#include "statisticsstore.h"
+#include "choicekernels.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <future>
+#include <limits>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace {
+
+const char* const ColumnNames[StatisticsStore::ColumnNo] = {
+    "playerMoves", "playerHits", "playerDead", "playerMisses",
+    "computerMoves", "computerHits", "computerDead", "computerMisses",
+    "playerWins", "computerWins",
+    "rowNo", "colNo", "planeNo", "strategy", "computerWinner", "duration"
+};
+
+//the key of the rows that are filtered out
+const int32_t ExcludedKey = std::numeric_limits<int32_t>::min();
+
+//the size of a file, or -1 if it cannot be opened
+int64_t fileSize(const std::string& path)
+{
+    FILE* file = std::fopen(path.c_str(), "rb");
+    if (file == nullptr)
+        return -1;
+    std::fseek(file, 0, SEEK_END);
+    int64_t size = static_cast<int64_t>(std::ftell(file));
+    std::fclose(file);
+    return size;
+}
+
+//shortens a file
+bool truncateFile(const std::string& path, int64_t size)
+{
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_WRITE, 0, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+        return false;
+    LARGE_INTEGER position;
+    position.QuadPart = size;
+    bool ok = SetFilePointerEx(file, position, nullptr, FILE_BEGIN) && SetEndOfFile(file);
+    CloseHandle(file);
+    return ok;
+#else
+    return truncate(path.c_str(), static_cast<off_t>(size)) == 0;
+#endif
+}
+
+//whether the header of a column file is that of the column
+bool isColumnHeader(const StatisticsStore::ColumnHeader& header, int column)
+{
+    return header.m_magic == StatisticsStore::Magic && header.m_version == StatisticsStore::Version &&
+           header.m_column == static_cast<uint32_t>(column);
+}
+
+//the position of the first row from first on whose key is neither
+//excluded nor one of the keys found; there must be such a row
+//a key seen is remembered in a small table indexed by its low bits,
+//so that the list of the keys found is seldom searched
+int findNewKey(const int32_t* keys, int first, const std::vector<int32_t>& found, int32_t* seen, int seenSize)
+{
+    for (int i = first; ; i++) {
+        const int32_t key = keys[i];
+        int32_t& slot = seen[key & (seenSize - 1)];
+        //one branch for both tests, the excluded rows come in any order
+        if ((key == slot) | (key == ExcludedKey))
+            continue;
+        if (std::find(found.begin(), found.end(), key) == found.end())
+            return i;
+        slot = key;
+    }
+}
+
+}
+
+//the name of a column
+const char* StatisticsStore::columnName(int column)
+{
+    return (column >= 0 && column < ColumnNo) ? ColumnNames[column] : "";
+}
+
+//the column with a name
+int StatisticsStore::findColumn(const std::string& name)
+{
+    for (int i = 0; i < ColumnNo; i++)
+        if (name == ColumnNames[i])
+            return i;
+    return -1;
+}
+
+//the file of a column
+std::string StatisticsStore::columnFileName(const std::string& directory, int column)
+{
+    return directory + "/" + columnName(column) + ".col";
+}
+
+//constructor
+StatisticsRow::StatisticsRow()
+{
+    std::memset(m_values, 0, sizeof(m_values));
+}
+
+//the statistics of the session are those of the round with the score after it
+StatisticsRow::StatisticsRow(const GameSession& session, int duration)
+{
+    const GameStatistics& stats = session.stats();
+    const int values[StatisticsStore::ColumnNo] = {
+        stats.m_playerMoves, stats.m_playerHits, stats.m_playerDead, stats.m_playerMisses,
+        stats.m_computerMoves, stats.m_computerHits, stats.m_computerDead, stats.m_computerMisses,
+        stats.m_playerWins, stats.m_computerWins,
+        session.getRowNo(), session.getColNo(), session.getPlaneNo(),
+        session.logic().strategies().mainStrategy(), session.isComputerWinner() ? 1 : 0, duration
+    };
+    for (int i = 0; i < StatisticsStore::ColumnNo; i++)
+        m_values[i] = values[i];
+}
+
+//constructor
+StatisticsWriter::StatisticsWriter():
+    m_rowCapacity(0)
+{
+    for (int i = 0; i < StatisticsStore::ColumnNo; i++)
+        m_files[i] = nullptr;
+}
+
+//destructor
+StatisticsWriter::~StatisticsWriter()
+{
+    close();
+}
+
+//the columns are first made as long as each other, so that the new rows
+//are at the same position in all of them
+bool StatisticsWriter::open(const std::string& directory, std::size_t rowCapacity)
+{
+    close();
+
+    if (repairColumns(directory) < 0)
+        return false;
+
+    for (int i = 0; i < StatisticsStore::ColumnNo; i++) {
+        m_files[i] = std::fopen(StatisticsStore::columnFileName(directory, i).c_str(), "ab");
+        if (m_files[i] == nullptr) {
+            close();
+            return false;
+        }
+
+        std::fseek(m_files[i], 0, SEEK_END);
+        if (std::ftell(m_files[i]) == 0) {
+            StatisticsStore::ColumnHeader header;
+            header.m_magic = StatisticsStore::Magic;
+            header.m_version = StatisticsStore::Version;
+            header.m_column = static_cast<uint32_t>(i);
+            header.m_reserved = 0;
+            if (std::fwrite(&header, sizeof(header), 1, m_files[i]) != 1 || std::fflush(m_files[i]) != 0) {
+                close();
+                return false;
+            }
+        }
+
+        m_columns[i].clear();
+        m_columns[i].reserve(rowCapacity);
+    }
+
+    m_rowCapacity = rowCapacity;
+    return true;
+}
+
+//writes the rows waiting
+void StatisticsWriter::close()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_files[0] != nullptr)
+        writeRows();
+    for (int i = 0; i < StatisticsStore::ColumnNo; i++) {
+        if (m_files[i] != nullptr)
+            std::fclose(m_files[i]);
+        m_files[i] = nullptr;
+    }
+}
+
+//adds a row to those waiting
+bool StatisticsWriter::append(const StatisticsRow& row)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_files[0] == nullptr)
+        return false;
+
+    for (int i = 0; i < StatisticsStore::ColumnNo; i++)
+        m_columns[i].push_back(row.m_values[i]);
+    if (m_columns[0].size() >= m_rowCapacity)
+        return writeRows();
+    return true;
+}
+
+//writes the rows waiting
+bool StatisticsWriter::flush()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_files[0] == nullptr)
+        return false;
+    return writeRows();
+}
+
+//each column gets the values of the rows waiting
+bool StatisticsWriter::writeRows()
+{
+    const std::size_t rowNo = m_columns[0].size();
+    if (rowNo == 0)
+        return true;
+
+    bool ok = true;
+    for (int i = 0; i < StatisticsStore::ColumnNo; i++) {
+        ok = std::fwrite(m_columns[i].data(), sizeof(int32_t), rowNo, m_files[i]) == rowNo &&
+             std::fflush(m_files[i]) == 0 && ok;
+        m_columns[i].clear();
+    }
+    return ok;
+}
+
+//a file shorter than its header, including a missing file, has no rows
+//and is emptied so that the writer gives it a header again
+int64_t StatisticsWriter::repairColumns(const std::string& directory)
+{
+    int64_t sizes[StatisticsStore::ColumnNo];
+    int64_t rowNo = std::numeric_limits<int64_t>::max();
+    for (int i = 0; i < StatisticsStore::ColumnNo; i++) {
+        const std::string path = StatisticsStore::columnFileName(directory, i);
+        sizes[i] = fileSize(path);
+        if (sizes[i] >= static_cast<int64_t>(sizeof(StatisticsStore::ColumnHeader))) {
+            StatisticsStore::ColumnHeader header;
+            FILE* file = std::fopen(path.c_str(), "rb");
+            bool valid = file != nullptr && std::fread(&header, sizeof(header), 1, file) == 1 && isColumnHeader(header, i);
+            if (file != nullptr)
+                std::fclose(file);
+            if (!valid)
+                return -1;
+        }
+        const int64_t columnRowNo = sizes[i] < static_cast<int64_t>(sizeof(StatisticsStore::ColumnHeader)) ?
+                                    0 : (sizes[i] - static_cast<int64_t>(sizeof(StatisticsStore::ColumnHeader))) /
+                                        static_cast<int64_t>(sizeof(int32_t));
+        rowNo = std::min(rowNo, columnRowNo);
+    }
+
+    for (int i = 0; i < StatisticsStore::ColumnNo; i++) {
+        int64_t size = sizeof(StatisticsStore::ColumnHeader) + rowNo * sizeof(int32_t);
+        if (sizes[i] < static_cast<int64_t>(sizeof(StatisticsStore::ColumnHeader)))
+            size = 0;
+        if (sizes[i] > size && !truncateFile(StatisticsStore::columnFileName(directory, i), size))
+            return -1;
+    }
+    return rowNo;
+}
+
+//constructor
+StatisticsReader::StatisticsReader():
+    m_rowNo(0)
+{
+    for (int i = 0; i < StatisticsStore::ColumnNo; i++)
+        m_columns[i] = nullptr;
+}
+
+//the values follow the header, which keeps them aligned
+bool StatisticsReader::open(const std::string& directory)
+{
+    m_rowNo = 0;
+    for (int i = 0; i < StatisticsStore::ColumnNo; i++) {
+        m_files[i].close();
+        m_columns[i] = nullptr;
+    }
+
+    int64_t rowNo = std::numeric_limits<int64_t>::max();
+    for (int i = 0; i < StatisticsStore::ColumnNo; i++) {
+        MappedFile& file = m_files[i];
+        if (!file.open(StatisticsStore::columnFileName(directory, i)) ||
+            file.size() < sizeof(StatisticsStore::ColumnHeader))
+            return false;
+        StatisticsStore::ColumnHeader header;
+        std::memcpy(&header, file.data(), sizeof(header));
+        if (!isColumnHeader(header, i))
+            return false;
+
+        m_columns[i] = reinterpret_cast<const int32_t*>(file.data() + sizeof(header));
+        rowNo = std::min(rowNo, static_cast<int64_t>((file.size() - sizeof(header)) / sizeof(int32_t)));
+    }
+
+    m_rowNo = rowNo;
+    return true;
+}
+
+//constructor
+StatisticsQuery::StatisticsQuery(const StatisticsReader& reader):
+    m_reader(reader),
+    m_filterColumn(-1),
+    m_filterValue(0)
+{
+}
+
+//groups the rows by one more column
+bool StatisticsQuery::addGroupColumn(int column)
+{
+    if (static_cast<int>(m_groupColumns.size()) >= MaxGroupColumnNo)
+        return false;
+    m_groupColumns.push_back(column);
+    return true;
+}
+
+//takes only the rows having the value in the column
+void StatisticsQuery::setFilter(int column, int32_t value)
+{
+    m_filterColumn = column;
+    m_filterValue = value;
+}
+
+//a key is the value of the group column when there is one,
+//otherwise the values of the group columns one byte each, the first one highest
+int32_t StatisticsQuery::keyValue(int32_t key, int i) const
+{
+    const int groupColumnNo = static_cast<int>(m_groupColumns.size());
+    if (groupColumnNo == 1)
+        return key;
+    return (key >> (8 * (groupColumnNo - 1 - i))) & 0xff;
+}
+
+//the mean of a column by group
+std::vector<StatisticsGroup> StatisticsQuery::mean(int valueColumn, ThreadPool* pool) const
+{
+    Part result;
+    run(valueColumn, false, pool, result);
+
+    std::vector<StatisticsGroup> groups;
+    for (std::map<int32_t, StatisticsGroup>::const_iterator it = result.m_groups.begin(); it != result.m_groups.end(); ++it)
+        groups.push_back(it->second);
+    return groups;
+}
+
+//the values of each group are collected, then the values at the ranks are
+//found with nth_element
+std::vector<StatisticsGroup> StatisticsQuery::percentiles(int valueColumn, const std::vector<double>& ranks,
+                                                          ThreadPool* pool) const
+{
+    Part result;
+    run(valueColumn, true, pool, result);
+
+    std::vector<StatisticsGroup> groups;
+    for (std::map<int32_t, StatisticsGroup>::const_iterator it = result.m_groups.begin(); it != result.m_groups.end(); ++it) {
+        StatisticsGroup group = it->second;
+        std::vector<int32_t>& values = result.m_values[it->first];
+        const int64_t valueNo = static_cast<int64_t>(values.size());
+        for (unsigned int i = 0; i < ranks.size(); i++) {
+            int64_t rank = static_cast<int64_t>(std::ceil(ranks[i] / 100.0 * valueNo));
+            rank = std::max<int64_t>(1, std::min(rank, valueNo));
+            std::nth_element(values.begin(), values.begin() + (rank - 1), values.end());
+            group.m_percentiles.push_back(values[rank - 1]);
+        }
+        groups.push_back(group);
+    }
+    return groups;
+}
+
+//the parts are ranges of blocks; their groups are added together
+void StatisticsQuery::run(int valueColumn, bool collectValues, ThreadPool* pool, Part& result) const
+{
+    const int64_t rowNo = m_reader.rowNo();
+    const int64_t blockNo = (rowNo + BlockSize - 1) / BlockSize;
+    int partNo = pool != nullptr ? pool->threadNo() : 1;
+    if (partNo > blockNo)
+        partNo = static_cast<int>(blockNo);
+    if (partNo <= 1) {
+        runPart(valueColumn, collectValues, 0, rowNo, result);
+        return;
+    }
+
+    std::vector<Part> parts(partNo);
+    std::vector<std::future<void> > futures;
+    for (int k = 0; k < partNo; k++) {
+        const int64_t first = std::min(rowNo, blockNo * k / partNo * BlockSize);
+        const int64_t last = std::min(rowNo, blockNo * (k + 1) / partNo * BlockSize);
+        Part* part = &parts[k];
+        futures.push_back(pool->submit([this, valueColumn, collectValues, first, last, part]() {
+            runPart(valueColumn, collectValues, first, last, *part);
+        }));
+    }
+    for (unsigned int k = 0; k < futures.size(); k++)
+        futures[k].get();
+
+    for (int k = 0; k < partNo; k++) {
+        for (std::map<int32_t, StatisticsGroup>::const_iterator it = parts[k].m_groups.begin(); it != parts[k].m_groups.end(); ++it) {
+            StatisticsGroup& group = result.m_groups[it->first];
+            group.m_key = it->first;
+            group.m_count += it->second.m_count;
+            group.m_sum += it->second.m_sum;
+        }
+        for (std::map<int32_t, std::vector<int32_t> >::iterator it = parts[k].m_values.begin(); it != parts[k].m_values.end(); ++it) {
+            std::vector<int32_t>& values = result.m_values[it->first];
+            if (values.empty())
+                values.swap(it->second);
+            else
+                values.insert(values.end(), it->second.begin(), it->second.end());
+        }
+    }
+}
+
+//the groups of a block are found one after the other: the sums of a group
+//are taken by the kernel, until the rows counted are all the rows of the
+//block, so that the rows are only searched for keys until all the groups
+//are known; the values of a group are copied without branches, each one
+//written and kept if its key matches
+void StatisticsQuery::runPart(int valueColumn, bool collectValues, int64_t first, int64_t last, Part& part) const
+{
+    const ChoiceKernels& kernels = ChoiceKernels::active();
+    const int SeenSize = 64;
+    int32_t seen[SeenSize];
+    std::vector<int32_t> buffer;
+    std::vector<int32_t> found;
+    for (int64_t block = first; block < last; block += BlockSize) {
+        const int size = static_cast<int>(std::min<int64_t>(BlockSize, last - block));
+        const int32_t* keys = blockKeys(block, size, buffer);
+        const int32_t* values = m_reader.column(valueColumn) + block;
+
+        //the keys are summed as values to count the excluded rows
+        int64_t sum = 0;
+        int rowNo = m_filterColumn >= 0 ? kernels.m_sumEqual(keys, keys, size, ExcludedKey, sum) : 0;
+        std::fill(seen, seen + SeenSize, ExcludedKey);
+        found.clear();
+        int next = 0;
+        while (rowNo < size) {
+            next = findNewKey(keys, next, found, seen, SeenSize);
+            const int32_t key = keys[next];
+            found.push_back(key);
+            const int count = kernels.m_sumEqual(keys, values, size, key, sum);
+            rowNo += count;
+            StatisticsGroup& group = part.m_groups[key];
+            group.m_key = key;
+            group.m_count += count;
+            group.m_sum += sum;
+
+            if (!collectValues)
+                continue;
+            std::vector<int32_t>& groupValues = part.m_values[key];
+            const std::size_t at = groupValues.size();
+            groupValues.resize(at + count + 1);
+            int32_t* out = groupValues.data() + at;
+            int n = 0;
+            for (int i = 0; i < size; i++) {
+                out[n] = values[i];
+                n += (keys[i] == key);
+            }
+            groupValues.resize(at + count);
+        }
+    }
+}
+
+//a single group column without a filter gives the keys directly
+//the other keys are computed with loops the compiler can vectorize
+const int32_t* StatisticsQuery::blockKeys(int64_t first, int size, std::vector<int32_t>& buffer) const
+{
+    const int groupColumnNo = static_cast<int>(m_groupColumns.size());
+    if (groupColumnNo == 1 && m_filterColumn < 0)
+        return m_reader.column(m_groupColumns[0]) + first;
+
+    buffer.resize(size);
+    int32_t* keys = buffer.data();
+    if (groupColumnNo == 0) {
+        std::fill(keys, keys + size, 0);
+    } else if (groupColumnNo == 1) {
+        std::memcpy(keys, m_reader.column(m_groupColumns[0]) + first, size * sizeof(int32_t));
+    } else {
+        std::fill(keys, keys + size, 0);
+        for (int c = 0; c < groupColumnNo; c++) {
+            const int32_t* column = m_reader.column(m_groupColumns[c]) + first;
+            for (int i = 0; i < size; i++)
+                keys[i] = static_cast<int32_t>((static_cast<uint32_t>(keys[i]) << 8) | (static_cast<uint32_t>(column[i]) & 0xff));
+        }
+    }
+
+    if (m_filterColumn >= 0) {
+        const int32_t* filter = m_reader.column(m_filterColumn) + first;
+        for (int i = 0; i < size; i++) {
+            const int32_t excluded = -static_cast<int32_t>(filter[i] != m_filterValue);
+            keys[i] = (keys[i] & ~excluded) | (ExcludedKey & excluded);
+        }
+    }
+    return keys;
+}
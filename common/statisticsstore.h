@@ -0,0 +1,205 @@
+#ifndef STATISTICSSTORE_H
+#define STATISTICSSTORE_H
+
+#include "gamesession.h"
+#include "mappedfile.h"
+#include "threadpool.h"
+#include <cstdint>
+#include <cstdio>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+//A store of the statistics of the finished rounds, one row per round, kept
+//by columns for aggregate queries over the whole history.
+//Each column is a file in the directory of the store, named after the
+//column with the extension ".col": a ColumnHeader followed by one int32_t
+//per row, in the byte order of the machine that wrote it. The rows are
+//appended to all the columns in chunks; a chunk that was not written to
+//every column (the writer was interrupted) is dropped by the readers and
+//by the next writer.
+class StatisticsStore
+{
+public:
+    //"PLSC"
+    static const uint32_t Magic = 0x43534c50;
+    static const uint32_t Version = 1;
+
+    //the columns: the fields of GameStatistics after the round, the geometry,
+    //the position of the main strategy of the computer in
+    //StrategyRegistry::names(), the winner (1 for the computer) and the
+    //duration of the round in milliseconds
+    enum Column {
+        PlayerMoves, PlayerHits, PlayerDead, PlayerMisses,
+        ComputerMoves, ComputerHits, ComputerDead, ComputerMisses,
+        PlayerWins, ComputerWins,
+        RowNo, ColNo, PlaneNo, Strategy, ComputerWinner, Duration,
+        ColumnNo
+    };
+
+    struct ColumnHeader
+    {
+        uint32_t m_magic;
+        uint32_t m_version;
+        uint32_t m_column;
+        uint32_t m_reserved;
+    };
+
+    //the name of a column, as in the file names
+    static const char* columnName(int column);
+    //the column with a name, or -1
+    static int findColumn(const std::string& name);
+    //the file of a column
+    static std::string columnFileName(const std::string& directory, int column);
+};
+
+static_assert(sizeof(StatisticsStore::ColumnHeader) == 16, "the column header has 16 bytes");
+
+//one round, the values of the columns
+struct StatisticsRow
+{
+    int32_t m_values[StatisticsStore::ColumnNo];
+
+    StatisticsRow();
+    //the round that has just ended in a session
+    StatisticsRow(const GameSession& session, int duration);
+};
+
+//Appends rows to a store. The rows are collected and written to the
+//column files when rowCapacity of them are waiting, by flush() or by close().
+//append() can be called from several threads.
+class StatisticsWriter
+{
+    std::mutex m_mutex;
+    FILE* m_files[StatisticsStore::ColumnNo];
+    //the rows waiting, by column
+    std::vector<int32_t> m_columns[StatisticsStore::ColumnNo];
+    std::size_t m_rowCapacity;
+
+public:
+    StatisticsWriter();
+    //writes the rows waiting
+    ~StatisticsWriter();
+
+    //opens the columns of a store to add rows after the existing ones, or
+    //creates them; the directory must exist
+    //returns false if a file cannot be opened or is not a column of a store
+    bool open(const std::string& directory, std::size_t rowCapacity = 4096);
+    bool isOpen() const { return m_files[0] != nullptr; }
+    //writes the rows waiting and closes the files
+    void close();
+
+    bool append(const StatisticsRow& row);
+    //writes the rows waiting, even if there are few
+    bool flush();
+
+private:
+    //writes the rows waiting, the mutex is held
+    bool writeRows();
+    //makes the columns as long as the shortest one
+    //returns the number of complete rows or -1 if a file is not a column
+    static int64_t repairColumns(const std::string& directory);
+
+    StatisticsWriter(const StatisticsWriter&) = delete;
+    StatisticsWriter& operator=(const StatisticsWriter&) = delete;
+};
+
+//Reads a store from memory-mapped files, the columns are read in place.
+class StatisticsReader
+{
+    MappedFile m_files[StatisticsStore::ColumnNo];
+    const int32_t* m_columns[StatisticsStore::ColumnNo];
+    int64_t m_rowNo;
+
+public:
+    StatisticsReader();
+
+    //maps the columns of a store
+    //returns false if a column is missing or is not a column of a store
+    bool open(const std::string& directory);
+
+    //the number of rows present in all the columns
+    int64_t rowNo() const { return m_rowNo; }
+    //the values of a column, rowNo() of them
+    const int32_t* column(int column) const { return m_columns[column]; }
+
+private:
+    StatisticsReader(const StatisticsReader&) = delete;
+    StatisticsReader& operator=(const StatisticsReader&) = delete;
+};
+
+//the result of a query for one group of rows
+struct StatisticsGroup
+{
+    //the values of the group columns, see StatisticsQuery::keyValue()
+    int32_t m_key;
+    int64_t m_count;
+    int64_t m_sum;
+    //the values at the requested ranks
+    std::vector<int32_t> m_percentiles;
+
+    StatisticsGroup(): m_key(0), m_count(0), m_sum(0) {}
+    double mean() const { return m_count > 0 ? static_cast<double>(m_sum) / m_count : 0.0; }
+};
+
+//An aggregate query over a store: the rows can be filtered by the value of
+//one column and grouped by the values of up to MaxGroupColumnNo columns.
+//The rows are read in blocks of BlockSize rows: the keys of the groups are
+//computed for a block, then the sums of each group present in the block are
+//taken with ChoiceKernels::m_sumEqual. This suits the few groups of
+//categorical columns such as the geometry or the strategy.
+//The blocks can be shared among the threads of a pool.
+class StatisticsQuery
+{
+public:
+    static const int MaxGroupColumnNo = 3;
+    static const int BlockSize = 16 * 1024;
+
+private:
+    const StatisticsReader& m_reader;
+    std::vector<int> m_groupColumns;
+    //-1 when all the rows are taken
+    int m_filterColumn;
+    int32_t m_filterValue;
+
+    //the groups found by the rows of a part of the store
+    struct Part
+    {
+        std::map<int32_t, StatisticsGroup> m_groups;
+        //the values of the groups, collected for the percentiles
+        std::map<int32_t, std::vector<int32_t> > m_values;
+    };
+
+public:
+    explicit StatisticsQuery(const StatisticsReader& reader);
+
+    //groups the rows by one more column; when there are several group
+    //columns their values must be between 0 and 255, like the geometry
+    //returns false if there are MaxGroupColumnNo columns already
+    bool addGroupColumn(int column);
+    //takes only the rows having the value in the column
+    void setFilter(int column, int32_t value);
+
+    //the value of the ith group column in a key
+    int32_t keyValue(int32_t key, int i) const;
+
+    //the number of rows, the sum and the mean of a column by group,
+    //in increasing order of the keys
+    std::vector<StatisticsGroup> mean(int valueColumn, ThreadPool* pool = nullptr) const;
+    //the same with the values of the column at the given percentiles
+    //(0 to 100, nearest rank) in StatisticsGroup::m_percentiles
+    std::vector<StatisticsGroup> percentiles(int valueColumn, const std::vector<double>& ranks,
+                                             ThreadPool* pool = nullptr) const;
+
+private:
+    //reads the rows of the store in parts, one for each thread of the pool
+    void run(int valueColumn, bool collectValues, ThreadPool* pool, Part& result) const;
+    //reads the rows from first to last
+    void runPart(int valueColumn, bool collectValues, int64_t first, int64_t last, Part& part) const;
+    //the keys of the rows of a block, ExcludedKey for the rows that are filtered out
+    //returns a column of the store when it can be used as it is, otherwise buffer
+    const int32_t* blockKeys(int64_t first, int size, std::vector<int32_t>& buffer) const;
+};
+
+#endif // STATISTICSSTORE_H
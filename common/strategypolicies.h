@@ -0,0 +1,143 @@
+#ifndef STRATEGYPOLICIES_H
+#define STRATEGYPOLICIES_H
+
+#include "computerlogic.h"
+#include "computerstrategy.h"
+#include <initializer_list>
+
+//Policies are the basic strategies as classes with a static choose() function.
+//They are combined at compile time with MixedStrategy, so that the
+//calls to the policies of a mix are resolved and inlined by the compiler,
+//and are registered one by one with PolicyStrategy.
+
+//chooses the most likely head position
+struct FindHeadPolicy
+{
+    static bool choose(const ComputerLogic& logic, GridPoint& qp) { return logic.makeChoiceFindHeadMode(qp); }
+};
+
+//tests the points of a found plane head
+struct FindPositionPolicy
+{
+    static bool choose(const ComputerLogic& logic, GridPoint& qp) { return logic.makeChoiceFindPositionMode(qp); }
+};
+
+//chooses a point about which there is no data
+struct RandomPolicy
+{
+    static bool choose(const ComputerLogic& logic, GridPoint& qp) { return logic.makeChoiceRandomMode(qp); }
+    //makes the draw of choose() without looking for the point
+    static bool skip(const ComputerLogic& logic) { return logic.skipChoiceRandomMode(); }
+};
+
+//chooses the point with the maximum expected information gain
+struct InformationGainPolicy
+{
+    static bool choose(const ComputerLogic& logic, GridPoint& qp) { return logic.makeChoiceMaxInformationMode(qp); }
+};
+
+//a single policy as a registrable strategy
+template <class Policy>
+class PolicyStrategy: public ComputerStrategy
+{
+public:
+    bool choose(const ComputerLogic& logic, GridPoint& qp) const override { return Policy::choose(logic, qp); }
+};
+
+//calls the policy at a given position in a list of policies
+template <class... Policies>
+struct PolicyDispatch;
+
+template <>
+struct PolicyDispatch<>
+{
+    static bool choose(int, const ComputerLogic&, GridPoint&) { return false; }
+};
+
+template <class First, class... Rest>
+struct PolicyDispatch<First, Rest...>
+{
+    static bool choose(int idx, const ComputerLogic& logic, GridPoint& qp) {
+        if (idx == 0)
+            return First::choose(logic, qp);
+        return PolicyDispatch<Rest...>::choose(idx - 1, logic, qp);
+    }
+};
+
+//a mix of policies fixed at compile time
+//one policy is drawn by weight and only that one is evaluated; when it has
+//no move the next ones are tried in turn, and the mix has no move when none
+//of them has one
+template <class... Policies>
+class MixedStrategy: public ComputerStrategy
+{
+    static const int PolicyNo = sizeof...(Policies);
+    int m_weights[PolicyNo];
+    int m_totalWeight;
+
+public:
+    MixedStrategy(std::initializer_list<int> weights): m_totalWeight(0) {
+        int idx = 0;
+        for (std::initializer_list<int>::const_iterator it = weights.begin(); it != weights.end() && idx < PolicyNo; ++it, ++idx) {
+            m_weights[idx] = *it;
+            m_totalWeight += *it;
+        }
+        for (; idx < PolicyNo; idx++)
+            m_weights[idx] = 0;
+    }
+
+    bool choose(const ComputerLogic& logic, GridPoint& qp) const override {
+        int idx = 0;
+        if (m_totalWeight > 0) {
+            int draw = Plane::generateRandomNumber(m_totalWeight);
+            while (draw >= m_weights[idx]) {
+                draw -= m_weights[idx];
+                idx++;
+            }
+        }
+
+        for (int k = 0; k < PolicyNo; k++)
+            if (PolicyDispatch<Policies...>::choose((idx + k) % PolicyNo, logic, qp))
+                return true;
+        return false;
+    }
+};
+
+//the mix used by the computer since the first version of the game, with its
+//rules: no move without a head candidate, one draw out of 10 that gives
+//6/3/1 to find head, find position and random, and 7/3 to find head and
+//the other one when find position or random has no move
+//random looks for its point only when the draw selects it or find position
+//has no move; otherwise it only makes its draw, so that the moves stay those
+//of the first version. Find position is cheap and draws first, it is always
+//evaluated after the draw of 10
+class ClassicStrategy: public ComputerStrategy
+{
+public:
+    bool choose(const ComputerLogic& logic, GridPoint& qp) const override {
+        GridPoint head;
+        if (!FindHeadPolicy::choose(logic, head))
+            return false;
+
+        const int idx = Plane::generateRandomNumber(10);
+        if (idx < 6) {
+            qp = head;
+            return true;
+        }
+
+        GridPoint position;
+        const bool hasPosition = FindPositionPolicy::choose(logic, position);
+        if (idx == 9 || (idx > 6 && !hasPosition)) {
+            if (!RandomPolicy::choose(logic, qp))
+                qp = hasPosition ? position : head;
+            return true;
+        }
+
+        //a draw of 6 needs both policies to play find position
+        const bool hasRandom = RandomPolicy::skip(logic);
+        qp = hasPosition && (idx > 6 || hasRandom) ? position : head;
+        return true;
+    }
+};
+
+#endif // STRATEGYPOLICIES_H
@@ -0,0 +1,47 @@
+#include "threadpool.h"
+
+//starts the threads
+ThreadPool::ThreadPool(int threadNo):
+    m_stopping(false)
+{
+    if (threadNo < 1)
+        threadNo = 1;
+    for (int i = 0; i < threadNo; i++)
+        m_threads.push_back(std::thread(&ThreadPool::run, this));
+}
+
+//waits for the tasks already submitted and stops the threads
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+    m_condition.notify_all();
+    for (unsigned int i = 0; i < m_threads.size(); i++)
+        m_threads[i].join();
+}
+
+//the pool shared by the whole program
+ThreadPool& ThreadPool::shared()
+{
+    static ThreadPool pool(static_cast<int>(std::thread::hardware_concurrency()));
+    return pool;
+}
+
+//takes the tasks one by one until the pool is stopped
+void ThreadPool::run()
+{
+    while (true) {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_condition.wait(lock, [this]() { return m_stopping || !m_tasks.empty(); });
+            if (m_tasks.empty())
+                return;
+            task = std::move(m_tasks.front());
+            m_tasks.pop_front();
+        }
+        task();
+    }
+}
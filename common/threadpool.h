@@ -0,0 +1,56 @@
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+//a fixed number of threads running the tasks submitted to them in order
+//the tasks must not wait for other tasks of the same pool
+class ThreadPool
+{
+    std::vector<std::thread> m_threads;
+    std::deque<std::function<void()> > m_tasks;
+    std::mutex m_mutex;
+    std::condition_variable m_condition;
+    bool m_stopping;
+
+public:
+    explicit ThreadPool(int threadNo);
+    //waits for the tasks already submitted and stops the threads
+    ~ThreadPool();
+
+    int threadNo() const { return static_cast<int>(m_threads.size()); }
+
+    //runs a task on one of the threads, the future gives its result
+    template <class Task>
+    std::future<typename std::result_of<Task()>::type> submit(Task task)
+    {
+        typedef typename std::result_of<Task()>::type Result;
+        std::shared_ptr<std::packaged_task<Result()> > packaged(new std::packaged_task<Result()>(task));
+        std::future<Result> result = packaged->get_future();
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_tasks.push_back([packaged]() { (*packaged)(); });
+        }
+        m_condition.notify_one();
+        return result;
+    }
+
+    //the pool shared by the whole program, one thread per processor
+    static ThreadPool& shared();
+
+private:
+    //the loop of each thread
+    void run();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+};
+
+#endif // THREADPOOL_H
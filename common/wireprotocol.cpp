@@ -0,0 +1,376 @@
+#include "wireprotocol.h"
+
+namespace {
+
+//the fields of GameStatistics in declaration order
+void statisticsFields(GameStatistics& stats, int** fields)
+{
+    int* all[] = { &stats.m_playerMoves, &stats.m_playerHits, &stats.m_playerDead, &stats.m_playerMisses,
+                   &stats.m_computerMoves, &stats.m_computerHits, &stats.m_computerDead, &stats.m_computerMisses,
+                   &stats.m_playerWins, &stats.m_computerWins };
+    for (int i = 0; i < WireProtocol::StatisticsFieldNo; i++)
+        fields[i] = all[i];
+}
+
+}
+
+//constructor
+//a frame with an incomplete header, a size shorter than the header or a
+//newer version is an error
+WireReader::WireReader(const uint8_t* frame, int size, int position):
+    m_frame(frame),
+    m_data(frame + position),
+    m_end(frame + size),
+    m_version(0),
+    m_error(false)
+{
+    if (size < WireProtocol::HeaderSize || frameSize(frame, size) != size ||
+        position < WireProtocol::HeaderSize || position > size) {
+        m_error = true;
+        m_data = m_end;
+        return;
+    }
+    m_version = frame[2];
+    if (m_version == 0 || m_version > WireProtocol::Version) {
+        m_error = true;
+        m_data = m_end;
+    }
+}
+
+//the size of the frame at the start of the data
+int WireReader::frameSize(const uint8_t* data, int size)
+{
+    if (size < 2)
+        return 0;
+    int frame = 2 + (data[0] | (data[1] << 8));
+    if (frame < WireProtocol::HeaderSize)
+        frame = WireProtocol::HeaderSize;
+    return size >= frame ? frame : 0;
+}
+
+//decodes the next message
+//the size of the body is checked before it is read
+bool WireReader::next(WireMessage& message)
+{
+    if (m_data >= m_end)
+        return false;
+
+    const int type = *m_data++;
+    const int left = static_cast<int>(m_end - m_data);
+    message.m_type = type;
+
+    switch (type) {
+    case WireProtocol::NewRound:
+    case WireProtocol::RoundEnded:
+    case WireProtocol::Error:
+        if (left < 1)
+            break;
+        message.m_args[0] = m_data[0];
+        m_data += 1;
+        return true;
+
+    case WireProtocol::Hello:
+        if (left < 2)
+            break;
+        message.m_args[0] = m_data[0];
+        message.m_args[1] = m_data[1];
+        m_data += 2;
+        return true;
+
+    case WireProtocol::RoundStarted:
+        if (left < 3)
+            break;
+        message.m_args[0] = m_data[0];
+        message.m_args[1] = m_data[1];
+        message.m_args[2] = m_data[2];
+        m_data += 3;
+        return true;
+
+    case WireProtocol::PlayerGuess:
+    case WireProtocol::GuessResult:
+    case WireProtocol::ComputerMove:
+        if (left < 2)
+            break;
+        message.m_guess = WireProtocol::unpackGuess(static_cast<uint16_t>(m_data[0] | (m_data[1] << 8)));
+        m_data += 2;
+        return true;
+
+    case WireProtocol::Planes:
+        if (left < 1 || left < 1 + 2 * m_data[0])
+            break;
+        message.m_planeNo = m_data[0];
+        message.m_planes = m_data + 1;
+        m_data += 1 + 2 * message.m_planeNo;
+        return true;
+
+    case WireProtocol::Statistics: {
+        int* fields[WireProtocol::StatisticsFieldNo];
+        statisticsFields(message.m_stats, fields);
+        bool ok = true;
+        for (int i = 0; i < WireProtocol::StatisticsFieldNo && ok; i++)
+            ok = readVarint(*fields[i]);
+        if (!ok)
+            break;
+        return true;
+    }
+
+    case WireProtocol::Keyframe: {
+        if (!readVarint(message.m_sequence) || m_end - m_data < 4)
+            break;
+        for (int i = 0; i < 4; i++)
+            message.m_args[i] = m_data[i];
+        m_data += 4;
+        const int size = (2 * message.m_args[0] * message.m_args[1] + 3) / 4;
+        if (m_end - m_data < size)
+            break;
+        message.m_cells = m_data;
+        m_data += size;
+        return true;
+    }
+
+    case WireProtocol::Delta:
+        if (!readVarint(message.m_sequence))
+            break;
+        return true;
+
+    //the changes are zigzag varints, the fields not in the mask are 0
+    case WireProtocol::StatisticsDelta: {
+        int* fields[WireProtocol::StatisticsFieldNo];
+        statisticsFields(message.m_stats, fields);
+        int mask = 0;
+        bool ok = readVarint(mask);
+        message.m_args[0] = mask;
+        for (int i = 0; i < WireProtocol::StatisticsFieldNo && ok; i++) {
+            int value = 0;
+            if (mask & (1 << i))
+                ok = readVarint(value);
+            const uint32_t zigzag = static_cast<uint32_t>(value);
+            *fields[i] = static_cast<int>(zigzag >> 1) ^ -static_cast<int>(zigzag & 1);
+        }
+        if (!ok)
+            break;
+        return true;
+    }
+
+    default:
+        break;
+    }
+
+    //an unknown type or a truncated body, the rest of the frame cannot be read
+    m_error = true;
+    m_data = m_end;
+    return false;
+}
+
+//reads a varint, at most 5 bytes
+bool WireReader::readVarint(int& value)
+{
+    uint32_t result = 0;
+    for (int shift = 0; shift < 35 && m_data < m_end; shift += 7) {
+        const uint8_t byte = *m_data++;
+        result |= static_cast<uint32_t>(byte & 0x7f) << shift;
+        if (!(byte & 0x80)) {
+            value = static_cast<int>(result);
+            return true;
+        }
+    }
+    return false;
+}
+
+//constructor
+WireWriter::WireWriter(uint8_t* buffer, int capacity, int size):
+    m_buffer(buffer),
+    m_capacity(capacity),
+    m_size(size),
+    m_position(size),
+    m_overflow(false)
+{
+}
+
+//opens a frame after the complete ones
+void WireWriter::beginFrame()
+{
+    m_position = m_size;
+    m_overflow = false;
+    if (reserve(WireProtocol::HeaderSize))
+        m_position += WireProtocol::HeaderSize;
+}
+
+//writes the header of the open frame
+bool WireWriter::endFrame()
+{
+    const int payload = m_position - m_size - 2;
+    if (m_overflow || payload > 0xffff) {
+        m_position = m_size;
+        return false;
+    }
+    m_buffer[m_size] = static_cast<uint8_t>(payload & 0xff);
+    m_buffer[m_size + 1] = static_cast<uint8_t>(payload >> 8);
+    m_buffer[m_size + 2] = static_cast<uint8_t>(WireProtocol::Version);
+    m_size = m_position;
+    return true;
+}
+
+void WireWriter::newRound(bool isComputerFirst)
+{
+    writeByte(WireProtocol::NewRound);
+    writeByte(isComputerFirst ? 1 : 0);
+}
+
+void WireWriter::playerGuess(int row, int col)
+{
+    writeByte(WireProtocol::PlayerGuess);
+    writeShort(WireProtocol::packGuess(GuessPoint(row, col, GuessPoint::Miss)));
+}
+
+void WireWriter::hello(int version, int shard)
+{
+    writeByte(WireProtocol::Hello);
+    writeByte(version);
+    writeByte(shard);
+}
+
+void WireWriter::roundStarted(int rowNo, int colNo, int planeNo)
+{
+    writeByte(WireProtocol::RoundStarted);
+    writeByte(rowNo);
+    writeByte(colNo);
+    writeByte(planeNo);
+}
+
+void WireWriter::guessResult(const GuessPoint& gp)
+{
+    writeByte(WireProtocol::GuessResult);
+    writeShort(WireProtocol::packGuess(gp));
+}
+
+void WireWriter::computerMove(const GuessPoint& gp)
+{
+    writeByte(WireProtocol::ComputerMove);
+    writeShort(WireProtocol::packGuess(gp));
+}
+
+void WireWriter::roundEnded(bool isComputerWinner)
+{
+    writeByte(WireProtocol::RoundEnded);
+    writeByte(isComputerWinner ? 1 : 0);
+}
+
+void WireWriter::planes(const Plane* planes, int planeNo)
+{
+    writeByte(WireProtocol::Planes);
+    writeByte(planeNo);
+    for (int i = 0; i < planeNo; i++)
+        writeShort(WireProtocol::packPlane(planes[i]));
+}
+
+void WireWriter::statistics(const GameStatistics& stats)
+{
+    writeByte(WireProtocol::Statistics);
+    writeVarint(stats.m_playerMoves);
+    writeVarint(stats.m_playerHits);
+    writeVarint(stats.m_playerDead);
+    writeVarint(stats.m_playerMisses);
+    writeVarint(stats.m_computerMoves);
+    writeVarint(stats.m_computerHits);
+    writeVarint(stats.m_computerDead);
+    writeVarint(stats.m_computerMisses);
+    writeVarint(stats.m_playerWins);
+    writeVarint(stats.m_computerWins);
+}
+
+void WireWriter::error(int code)
+{
+    writeByte(WireProtocol::Error);
+    writeByte(code);
+}
+
+//the cells are packed 4 per byte
+void WireWriter::keyframe(int sequence, int rowNo, int colNo, int planeNo, int flags, const uint8_t* cells)
+{
+    writeByte(WireProtocol::Keyframe);
+    writeVarint(sequence);
+    writeByte(rowNo);
+    writeByte(colNo);
+    writeByte(planeNo);
+    writeByte(flags);
+    const int cellNo = 2 * rowNo * colNo;
+    for (int i = 0; i < cellNo; i += 4) {
+        int value = 0;
+        for (int k = 0; k < 4 && i + k < cellNo; k++)
+            value |= (cells[i + k] & 3) << (2 * k);
+        writeByte(value);
+    }
+}
+
+void WireWriter::delta(int sequence)
+{
+    writeByte(WireProtocol::Delta);
+    writeVarint(sequence);
+}
+
+void WireWriter::statisticsDelta(const GameStatistics& previous, const GameStatistics& current)
+{
+    GameStatistics before = previous;
+    GameStatistics after = current;
+    int* oldFields[WireProtocol::StatisticsFieldNo];
+    int* newFields[WireProtocol::StatisticsFieldNo];
+    statisticsFields(before, oldFields);
+    statisticsFields(after, newFields);
+
+    int mask = 0;
+    for (int i = 0; i < WireProtocol::StatisticsFieldNo; i++)
+        if (*newFields[i] != *oldFields[i])
+            mask |= 1 << i;
+
+    writeByte(WireProtocol::StatisticsDelta);
+    writeVarint(mask);
+    for (int i = 0; i < WireProtocol::StatisticsFieldNo; i++) {
+        if (!(mask & (1 << i)))
+            continue;
+        const int change = *newFields[i] - *oldFields[i];
+        writeVarint(static_cast<int>((static_cast<uint32_t>(change) << 1) ^ static_cast<uint32_t>(-(change < 0))));
+    }
+}
+
+//makes room for n bytes
+uint8_t* WireWriter::reserve(int n)
+{
+    if (m_overflow || m_position + n > m_capacity) {
+        m_overflow = true;
+        return nullptr;
+    }
+    return m_buffer + m_position;
+}
+
+void WireWriter::writeByte(int value)
+{
+    uint8_t* data = reserve(1);
+    if (!data)
+        return;
+    data[0] = static_cast<uint8_t>(value);
+    m_position += 1;
+}
+
+void WireWriter::writeShort(int value)
+{
+    uint8_t* data = reserve(2);
+    if (!data)
+        return;
+    data[0] = static_cast<uint8_t>(value & 0xff);
+    data[1] = static_cast<uint8_t>((value >> 8) & 0xff);
+    m_position += 2;
+}
+
+//negative values are written as their 32 bit pattern
+void WireWriter::writeVarint(int value)
+{
+    uint32_t rest = static_cast<uint32_t>(value);
+    do {
+        uint8_t byte = static_cast<uint8_t>(rest & 0x7f);
+        rest >>= 7;
+        if (rest)
+            byte |= 0x80;
+        writeByte(byte);
+    } while (rest && !m_overflow);
+}
@@ -0,0 +1,218 @@
+#ifndef WIREPROTOCOL_H
+#define WIREPROTOCOL_H
+
+#include "guesspoint.h"
+#include "plane.h"
+#include "gamestatistics.h"
+#include <cstdint>
+
+//The binary messages exchanged by a game server and its clients.
+//
+//A frame is the size of the rest of the frame (16 bits, little endian),
+//the protocol version (8 bits) and the messages one after the other.
+//A message is a type byte and a body whose size is given by the type, so the
+//answers of a step (the result of the player's guess, the computer's move,
+//the end of the round) travel in one frame.
+//
+//Grid points, guesses and planes are packed in 16 bits (little endian):
+//the row in bits 0-6, the column in bits 7-13 and the result of the guess
+//or the orientation of the plane in bits 14-15, so the grids have at most
+//127 rows and columns. The statistics are unsigned LEB128 varints.
+//
+//Message bodies:
+//  NewRound      u8 computerFirst
+//  PlayerGuess   u16 point
+//  Hello         u8 version, u8 shard
+//  RoundStarted  u8 rows, u8 cols, u8 planes
+//  GuessResult   u16 guess            the result of the player's guess
+//  ComputerMove  u16 guess            the computer's guess and its result
+//  RoundEnded    u8 computerWinner
+//  Planes        u8 count, u16 plane[count]
+//  Statistics    the 10 fields of GameStatistics in declaration order
+//  Error         u8 code
+//
+//The messages sent to the spectators of a game (see SpectatorStream):
+//  Keyframe      varint sequence, u8 rows, u8 cols, u8 planes, u8 flags,
+//                the cells of the player's board then of the computer's board,
+//                2 bits each, 4 cells per byte, in CellId order: 0 when not
+//                guessed, otherwise the result of the guess + 1;
+//                flags: 1 computerFirst, 2 finished, 4 computerWinner
+//  Delta         varint sequence; the changes follow in the frame
+//  StatisticsDelta varint mask of the fields of GameStatistics that changed,
+//                then the change of each of them as a zigzag varint
+//
+//A reader accepts the frames of its version and of the older versions.
+namespace WireProtocol {
+
+const int Version = 1;
+//the size of the frame header
+const int HeaderSize = 3;
+//the largest grid dimension that can be packed
+const int MaxDimension = 127;
+//the number of fields of GameStatistics
+const int StatisticsFieldNo = 10;
+
+enum MessageType {
+    NewRound = 1,
+    PlayerGuess = 2,
+    Hello = 16,
+    RoundStarted = 17,
+    GuessResult = 18,
+    ComputerMove = 19,
+    RoundEnded = 20,
+    Planes = 21,
+    Statistics = 22,
+    Keyframe = 23,
+    Delta = 24,
+    StatisticsDelta = 25,
+    Error = 31
+};
+
+enum ErrorCode {
+    UnknownMessage = 1,
+    NoRound = 2,
+    InvalidGuess = 3,
+    InvalidFrame = 4
+};
+
+inline uint16_t packGuess(const GuessPoint& gp)
+{
+    return static_cast<uint16_t>(gp.m_row | (gp.m_col << 7) | (gp.m_type << 14));
+}
+
+inline GuessPoint unpackGuess(uint16_t value)
+{
+    return GuessPoint(value & 0x7f, (value >> 7) & 0x7f, static_cast<GuessPoint::Type>(value >> 14));
+}
+
+inline uint16_t packPlane(const Plane& pl)
+{
+    return static_cast<uint16_t>(pl.row() | (pl.col() << 7) | (pl.orientation() << 14));
+}
+
+inline Plane unpackPlane(uint16_t value)
+{
+    return Plane(value & 0x7f, (value >> 7) & 0x7f, static_cast<Plane::Orientation>(value >> 14));
+}
+
+}
+
+//a decoded message, only the fields of its type are set
+//the planes are not copied: they are unpacked from the frame on demand,
+//so the frame must stay in place while the message is used
+struct WireMessage
+{
+    int m_type;
+    //NewRound: computerFirst; Hello: version, shard; RoundStarted: rows, cols, planes;
+    //RoundEnded: computerWinner; Error: code; Keyframe: rows, cols, planes, flags;
+    //StatisticsDelta: mask
+    int m_args[4];
+    //Keyframe, Delta
+    int m_sequence;
+    //PlayerGuess (the type is Miss), GuessResult, ComputerMove
+    GuessPoint m_guess;
+    //Statistics; StatisticsDelta: the changes, 0 for the fields not in the mask
+    GameStatistics m_stats;
+    //Planes
+    const uint8_t* m_planes;
+    int m_planeNo;
+    //Keyframe, read in place like the planes
+    const uint8_t* m_cells;
+
+    WireMessage(): m_type(0), m_sequence(0), m_guess(0, 0), m_planes(nullptr), m_planeNo(0), m_cells(nullptr) {}
+
+    Plane plane(int i) const
+    {
+        return WireProtocol::unpackPlane(static_cast<uint16_t>(m_planes[2 * i] | (m_planes[2 * i + 1] << 8)));
+    }
+
+    //the state of a cell of a keyframe: 0 when not guessed, otherwise the
+    //result + 1; board 0 is the player's board, board 1 the computer's board
+    int cell(int board, int cellId) const
+    {
+        const int index = board * m_args[0] * m_args[1] + cellId;
+        return (m_cells[index / 4] >> (2 * (index % 4))) & 3;
+    }
+};
+
+//Decodes the messages of a frame in place.
+class WireReader
+{
+    const uint8_t* m_frame;
+    const uint8_t* m_data;
+    const uint8_t* m_end;
+    int m_version;
+    bool m_error;
+
+public:
+    //the reader of a complete frame, header included
+    //the messages are read from the given position of the frame, a frame
+    //read in several steps is resumed from the position() of the last step
+    WireReader(const uint8_t* frame, int size, int position = WireProtocol::HeaderSize);
+
+    //the size of the frame at the start of the data, header included,
+    //or 0 if the data does not contain the whole frame yet
+    static int frameSize(const uint8_t* data, int size);
+
+    //decodes the next message, returns false at the end of the frame or on an error
+    bool next(WireMessage& message);
+    //whether the frame is malformed or of a newer version
+    bool hasError() const { return m_error; }
+    //the position of the next message in the frame
+    int position() const { return static_cast<int>(m_data - m_frame); }
+    int version() const { return m_version; }
+
+private:
+    //reads a varint of the statistics
+    bool readVarint(int& value);
+};
+
+//Encodes frames in a buffer given by the caller, the writer does not allocate.
+//When a frame does not fit it is dropped and endFrame() returns false.
+class WireWriter
+{
+    uint8_t* m_buffer;
+    int m_capacity;
+    //the end of the complete frames, which is the start of the open frame
+    int m_size;
+    //where the next byte of the open frame goes
+    int m_position;
+    //whether a message of the open frame did not fit
+    bool m_overflow;
+
+public:
+    //the frames are written after the first size bytes of the buffer
+    WireWriter(uint8_t* buffer, int capacity, int size = 0);
+
+    //the bytes of the buffer used by the complete frames
+    int size() const { return m_size; }
+
+    void beginFrame();
+    //completes the frame, returns false if it did not fit
+    bool endFrame();
+
+    void newRound(bool isComputerFirst);
+    void playerGuess(int row, int col);
+    void hello(int version, int shard);
+    void roundStarted(int rowNo, int colNo, int planeNo);
+    void guessResult(const GuessPoint& gp);
+    void computerMove(const GuessPoint& gp);
+    void roundEnded(bool isComputerWinner);
+    void planes(const Plane* planes, int planeNo);
+    void statistics(const GameStatistics& stats);
+    void error(int code);
+    //cells has the states of both boards, one per byte, in the order of the message
+    void keyframe(int sequence, int rowNo, int colNo, int planeNo, int flags, const uint8_t* cells);
+    void delta(int sequence);
+    //the fields that differ between two statistics
+    void statisticsDelta(const GameStatistics& previous, const GameStatistics& current);
+
+private:
+    //makes room for n bytes, returns nullptr if there is none
+    uint8_t* reserve(int n);
+    void writeByte(int value);
+    void writeShort(int value);
+    void writeVarint(int value);
+};
+
+#endif // WIREPROTOCOL_H
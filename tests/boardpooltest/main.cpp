@@ -0,0 +1,159 @@
+#include "boardpool.h"
+#include "planegridcore.h"
+#include "planestencils.h"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+//Stresses the ring of a BoardPool with consumers on several threads while
+//its producer refills it. Every board taken must have its planes inside the
+//grid and without overlap, and the counts must add up: the boards produced
+//are those taken plus those left in the pool, so no board was lost or taken
+//twice. The grids that take their boards from the pool must be valid, and a
+//pool for a geometry that cannot hold the planes must stay empty.
+//
+//usage: BoardPoolTest [rows cols planes [threads [boards per thread]]]
+
+namespace {
+
+typedef std::chrono::steady_clock Clock;
+
+//the results of a consumer
+struct Consumer
+{
+    long long m_takenNo;
+    long long m_missedNo;
+    long long m_invalidNo;
+
+    Consumer(): m_takenNo(0), m_missedNo(0), m_invalidNo(0) {}
+};
+
+//whether the planes of a board are valid positions that do not overlap
+bool isValidBoard(const PlaneStencils& stencils, const PackedPlane* planes, int planeNo, std::vector<int>& covered)
+{
+    covered.assign(stencils.pointNo(), 0);
+    for (int i = 0; i < planeNo; i++) {
+        const int id = planes[i].id();
+        if (id < 0 || id >= stencils.planePositionNo() || !stencils.isValid(id))
+            return false;
+        const int* footprint = stencils.footprint(id);
+        for (int k = 0; k < PlaneStencils::PlanePointsNo; k++)
+            if (covered[footprint[k]]++ != 0)
+                return false;
+    }
+    return true;
+}
+
+//takes takeNo boards, or stops at the deadline
+//an empty pool lets the other threads run, the producer among them
+void consume(BoardPool* pool, int takeNo, Clock::time_point deadline, Consumer* consumer)
+{
+    const PlaneStencils& stencils = PlaneStencils::forGrid(pool->getRowNo(), pool->getColNo());
+    PackedPlane planes[BoardPool::MaxPlaneNo];
+    std::vector<int> covered;
+    while (consumer->m_takenNo < takeNo && Clock::now() < deadline) {
+        if (!pool->take(planes)) {
+            consumer->m_missedNo++;
+            std::this_thread::yield();
+            continue;
+        }
+        consumer->m_takenNo++;
+        if (!isValidBoard(stencils, planes, pool->getPlaneNo(), covered))
+            consumer->m_invalidNo++;
+    }
+}
+
+}
+
+int main(int argc, char* argv[])
+{
+    int rowNo = 10, colNo = 10, planeNo = 3, threadNo = 4, takeNo = 20000;
+    if (argc != 1 && argc != 4 && argc != 5 && argc != 6) {
+        std::fprintf(stderr, "usage: %s [rows cols planes [threads [boards per thread]]]\n", argv[0]);
+        return 1;
+    }
+    if (argc >= 4) {
+        rowNo = std::atoi(argv[1]);
+        colNo = std::atoi(argv[2]);
+        planeNo = std::atoi(argv[3]);
+    }
+    if (argc >= 5)
+        threadNo = std::atoi(argv[4]);
+    if (argc == 6)
+        takeNo = std::atoi(argv[5]);
+    if (threadNo <= 0 || takeNo <= 0 || planeNo <= 0 || planeNo > BoardPool::MaxPlaneNo) {
+        std::fprintf(stderr, "invalid arguments\n");
+        return 1;
+    }
+
+    Plane::seedRandomGenerator();
+    bool passed = true;
+
+    //the consumers empty the ring over and over while it is refilled
+    BoardPool pool(rowNo, colNo, planeNo, 64);
+    std::vector<Consumer> consumers(threadNo);
+    std::vector<std::thread> threads;
+    const Clock::time_point deadline = Clock::now() + std::chrono::seconds(30);
+    for (int i = 0; i < threadNo; i++)
+        threads.push_back(std::thread(consume, &pool, takeNo, deadline, &consumers[i]));
+    for (unsigned int i = 0; i < threads.size(); i++)
+        threads[i].join();
+
+    Consumer total;
+    for (unsigned int i = 0; i < consumers.size(); i++) {
+        total.m_takenNo += consumers[i].m_takenNo;
+        total.m_missedNo += consumers[i].m_missedNo;
+        total.m_invalidNo += consumers[i].m_invalidNo;
+    }
+
+    //the producer may still be refilling, the counts add up once it sleeps
+    BoardPool::Metrics metrics = pool.metrics();
+    const Clock::time_point settled = Clock::now() + std::chrono::seconds(5);
+    while (metrics.m_produced != metrics.m_taken + metrics.m_occupancy && Clock::now() < settled) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        metrics = pool.metrics();
+    }
+    std::printf("%d threads: taken %lld, missed %lld, invalid %lld; pool produced %llu, rejected %llu, refills %llu, left %d\n",
+                threadNo, total.m_takenNo, total.m_missedNo, total.m_invalidNo,
+                static_cast<unsigned long long>(metrics.m_produced), static_cast<unsigned long long>(metrics.m_rejected),
+                static_cast<unsigned long long>(metrics.m_refills), metrics.m_occupancy);
+    if (total.m_takenNo != static_cast<long long>(threadNo) * takeNo || total.m_invalidNo != 0 ||
+        metrics.m_taken != static_cast<uint64_t>(total.m_takenNo) ||
+        metrics.m_missed != static_cast<uint64_t>(total.m_missedNo) ||
+        metrics.m_produced != metrics.m_taken + metrics.m_occupancy ||
+        metrics.m_occupancy > metrics.m_capacity) {
+        std::printf("the boards taken do not match the pool\n");
+        passed = false;
+    }
+
+    //the grids take their boards from the pool
+    PlaneGridCore grid(rowNo, colNo, planeNo, true);
+    grid.setBoardPool(&pool);
+    int invalidGridNo = 0;
+    for (int i = 0; i < 1000; i++) {
+        grid.initGrid();
+        if (grid.getPlaneListSize() != planeNo || grid.doPlanesOverlap() || grid.isPlaneOutsideGrid())
+            invalidGridNo++;
+    }
+    std::printf("grids from the pool: %d invalid of 1000\n", invalidGridNo);
+    passed = passed && invalidGridNo == 0;
+
+    //5 planes do not fit on 4x4: the producer gives up and the pool stays empty
+    BoardPool impossible(4, 4, 5, 8);
+    PackedPlane planes[BoardPool::MaxPlaneNo];
+    const Clock::time_point giveUp = Clock::now() + std::chrono::seconds(5);
+    while (impossible.metrics().m_rejected < 1000 && Clock::now() < giveUp)
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    const BoardPool::Metrics impossibleMetrics = impossible.metrics();
+    const bool isEmpty = !impossible.take(planes) && impossibleMetrics.m_produced == 0;
+    std::printf("impossible geometry: rejected %llu, produced %llu\n",
+                static_cast<unsigned long long>(impossibleMetrics.m_rejected),
+                static_cast<unsigned long long>(impossibleMetrics.m_produced));
+    passed = passed && isEmpty && impossibleMetrics.m_rejected == 1000;
+
+    std::printf("%s\n", passed ? "passed" : "failed");
+    return passed ? 0 : 1;
+}
@@ -0,0 +1,141 @@
+#include "choicekernels.h"
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+//Checks the information kernels. On random probabilities of sizes that
+//leave a remainder after the vectors, every version the processor supports
+//must give the scores and the best point of the scalar version; the scores
+//must be those computed with std::log, the points marked as guessed must
+//not be chosen and nothing must be written past the end of the arrays.
+//
+//usage: ChoiceKernelsTest
+
+namespace {
+
+int failureNo = 0;
+
+void check(bool condition, const char* what)
+{
+    if (!condition && failureNo++ < 10)
+        std::printf("failed: %s\n", what);
+}
+
+const float DeadBonus = 3.0f;
+
+//the score of the information gain mode with the logarithm of the library
+double referenceScore(double pDead, double pHit)
+{
+    const double pMiss = 1.0 - pDead - pHit;
+    double score = DeadBonus * pDead;
+    if (pDead > 0.0)
+        score -= pDead * std::log(pDead);
+    if (pHit > 0.0)
+        score -= pHit * std::log(pHit);
+    if (pMiss > 0.0)
+        score -= pMiss * std::log(pMiss);
+    return score;
+}
+
+//the weights of a grid and the marks of its guessed points, with one more
+//element after the end to see that it is not written
+struct Grid
+{
+    std::vector<float> m_headWeights;
+    std::vector<float> m_bodyWeights;
+    std::vector<int> m_marks;
+    float m_scale;
+
+    Grid(int size, std::mt19937& random):
+        m_headWeights(size + 1, -7.0f), m_bodyWeights(size + 1, -7.0f), m_marks(size + 1, 0)
+    {
+        std::uniform_real_distribution<float> weight(0.0f, 4.0f);
+        for (int i = 0; i < size; i++) {
+            //some points have no weight, some get probabilities of one
+            const unsigned int kind = random() % 8;
+            m_headWeights[i] = kind == 0 ? 0.0f : weight(random) * (kind == 1 ? 8.0f : 0.1f);
+            m_bodyWeights[i] = kind == 2 ? 0.0f : weight(random);
+            m_marks[i] = random() % 4 == 0 ? -2 : static_cast<int>(random() % 3) - 1;
+        }
+        m_scale = 1.0f / 8.0f;
+    }
+};
+
+void checkSize(int size, std::mt19937& random)
+{
+    const ChoiceKernels* scalar = ChoiceKernels::forName("scalar");
+    const Grid grid(size, random);
+
+    std::vector<float> pDead(size + 1, -7.0f), pHit(size + 1, -7.0f), scores(size + 1, -7.0f);
+    scalar->m_outcomeProbabilities(grid.m_headWeights.data(), grid.m_bodyWeights.data(), size, grid.m_scale,
+                                   pDead.data(), pHit.data());
+    const int best = scalar->m_informationScores(pDead.data(), pHit.data(), grid.m_marks.data(), size, DeadBonus,
+                                                 scores.data());
+
+    int expectedBest = -1;
+    double bestScore = -1.0;
+    bool close = true;
+    for (int i = 0; i < size; i++) {
+        const double score = referenceScore(pDead[i], pHit[i]);
+        close = close && std::fabs(scores[i] - score) < 1e-5;
+        if (grid.m_marks[i] != -2 && score > bestScore + 1e-5) {
+            bestScore = score;
+            expectedBest = i;
+        }
+    }
+    check(close, "the scores are those of std::log");
+    check(best == -1 ? expectedBest == -1 : grid.m_marks[best] != -2 && scores[best] >= bestScore - 1e-5,
+          "the best point is not guessed and has the largest score");
+    check(pDead[size] == -7.0f && pHit[size] == -7.0f && scores[size] == -7.0f, "the scalar kernels stop at the end");
+
+    const char* names[] = { "sse4.1", "avx2" };
+    for (int n = 0; n < 2; n++) {
+        const ChoiceKernels* kernels = ChoiceKernels::forName(names[n]);
+        if (kernels == nullptr)
+            continue;
+
+        std::vector<float> dead(size + 1, -7.0f), hit(size + 1, -7.0f), vectorScores(size + 1, -7.0f);
+        kernels->m_outcomeProbabilities(grid.m_headWeights.data(), grid.m_bodyWeights.data(), size, grid.m_scale,
+                                        dead.data(), hit.data());
+        check(dead == pDead && hit == pHit, "the probabilities of a vector version are those of the scalar one");
+        const int vectorBest = kernels->m_informationScores(dead.data(), hit.data(), grid.m_marks.data(), size,
+                                                            DeadBonus, vectorScores.data());
+        check(vectorScores == scores && vectorBest == best, "the scores of a vector version are those of the scalar one");
+
+        //in place, as the logic computes them
+        std::vector<float> weights(grid.m_headWeights), bodyWeights(grid.m_bodyWeights);
+        kernels->m_outcomeProbabilities(weights.data(), bodyWeights.data(), size, grid.m_scale, weights.data(),
+                                        bodyWeights.data());
+        const int inPlaceBest = kernels->m_informationScores(weights.data(), bodyWeights.data(), grid.m_marks.data(),
+                                                             size, DeadBonus, weights.data());
+        check(weights == scores && inPlaceBest == best, "the kernels work in place");
+    }
+}
+
+}
+
+int main()
+{
+    std::mt19937 random(28);
+    for (int round = 0; round < 20; round++)
+        for (int size = 0; size <= 40; size++)
+            checkSize(size, random);
+    checkSize(100, random);
+    checkSize(143, random);
+
+    //a grid where every point is guessed has no best point
+    std::vector<float> pDead(9, 0.2f), pHit(9, 0.3f), scores(9);
+    std::vector<int> marks(9, -2);
+    const char* names[] = { "scalar", "sse4.1", "avx2" };
+    for (int n = 0; n < 3; n++) {
+        const ChoiceKernels* kernels = ChoiceKernels::forName(names[n]);
+        if (kernels != nullptr)
+            check(kernels->m_informationScores(pDead.data(), pHit.data(), marks.data(), 9, DeadBonus, scores.data()) == -1,
+                  "no point when all are guessed");
+    }
+
+    std::printf("kernels: %s\n", ChoiceKernels::active().m_name);
+    std::printf("%s\n", failureNo == 0 ? "passed" : "failed");
+    return failureNo == 0 ? 0 : 1;
+}
@@ -0,0 +1,248 @@
+#include "computerlogic.h"
+#include "endgamesolver.h"
+#include "planegridcore.h"
+#include <cstdio>
+#include <cstdlib>
+#include <unordered_map>
+#include <vector>
+
+//Checks the endgame solver against a brute force search on small grids.
+//The computer plays against boards with random planes until one head is
+//left to find. There the placements of the planes agreeing with the guesses
+//are enumerated one by one, and the smallest sum over them of the moves
+//needed to find the last head is searched over all the points. The solver
+//must be used exactly when there are at most MaxHypothesisNo placements,
+//and playing its moves against each placement must find the last head with
+//that smallest sum of moves.
+//
+//usage: EndgameSolverTest [games]
+
+namespace {
+
+int failureNo = 0;
+
+void check(bool condition, const char* what)
+{
+    if (!condition && failureNo++ < 10)
+        std::printf("failed: %s\n", what);
+}
+
+//the placements of the planes agreeing with the guesses
+class BruteForce
+{
+    const PlaneStencils& m_stencils;
+    //the result at each point of each placement: Miss, Hit or Dead
+    std::vector<std::vector<int> > m_results;
+    //the points not guessed yet
+    std::vector<int> m_points;
+    std::unordered_map<uint64_t, int> m_costs;
+
+public:
+    BruteForce(const ComputerLogic& logic):
+        m_stencils(logic.stencils())
+    {
+        const int pointNo = m_stencils.pointNo();
+        std::vector<int> guessed(pointNo, -1);
+        const ArenaVector<GuessPoint>& guesses = logic.getListGuesses();
+        for (unsigned int i = 0; i < guesses.size(); i++)
+            guessed[m_stencils.cellId(guesses[i].m_row, guesses[i].m_col)] = guesses[i].m_type;
+        for (int point = 0; point < pointNo; point++)
+            if (guessed[point] < 0)
+                m_points.push_back(point);
+
+        //the positions that leave the misses empty
+        std::vector<int> positions;
+        for (int position = 0; position < m_stencils.planePositionNo(); position++) {
+            if (!m_stencils.isValid(position))
+                continue;
+            bool ok = true;
+            for (int k = 0; k < PlaneStencils::PlanePointsNo && ok; k++)
+                ok = guessed[m_stencils.footprint(position)[k]] != GuessPoint::Miss;
+            if (ok)
+                positions.push_back(position);
+        }
+
+        std::vector<int> chosen;
+        std::vector<int> results(pointNo, GuessPoint::Miss);
+        enumerate(positions, 0, logic.getPlaneNo(), chosen, results, guessed);
+    }
+
+    int hypothesisNo() const { return static_cast<int>(m_results.size()); }
+    const std::vector<int>& results(int hypothesis) const { return m_results[hypothesis]; }
+
+    //the smallest sum of the moves of the hypotheses
+    int cost()
+    {
+        const int n = hypothesisNo();
+        return cost(n == 64 ? ~uint64_t(0) : (uint64_t(1) << n) - 1);
+    }
+
+private:
+    //the sets of planes, in increasing order of their positions, that do
+    //not overlap and give the result of every guess
+    void enumerate(const std::vector<int>& positions, unsigned int first, int planeNo, std::vector<int>& chosen,
+                   std::vector<int>& results, const std::vector<int>& guessed)
+    {
+        if (static_cast<int>(chosen.size()) == planeNo) {
+            for (unsigned int point = 0; point < guessed.size(); point++)
+                if (guessed[point] >= 0 && guessed[point] != results[point])
+                    return;
+            //more than 64 placements are not searched
+            if (m_results.size() < 64)
+                m_results.push_back(results);
+            else
+                m_results.push_back(std::vector<int>());
+            return;
+        }
+
+        for (unsigned int i = first; i < positions.size(); i++) {
+            const int* footprint = m_stencils.footprint(positions[i]);
+            bool free = true;
+            for (int k = 0; k < PlaneStencils::PlanePointsNo && free; k++)
+                free = results[footprint[k]] == GuessPoint::Miss;
+            if (!free)
+                continue;
+            results[footprint[0]] = GuessPoint::Dead;
+            for (int k = 1; k < PlaneStencils::PlanePointsNo; k++)
+                results[footprint[k]] = GuessPoint::Hit;
+            chosen.push_back(positions[i]);
+            enumerate(positions, i + 1, planeNo, chosen, results, guessed);
+            chosen.pop_back();
+            for (int k = 0; k < PlaneStencils::PlanePointsNo; k++)
+                results[footprint[k]] = GuessPoint::Miss;
+        }
+    }
+
+    //C(S) = 1 for one hypothesis, otherwise the smallest |S| + C(hit) + C(miss)
+    //over the points that split S
+    int cost(uint64_t set)
+    {
+        if (set == 0)
+            return 0;
+        int size = 0;
+        for (uint64_t s = set; s != 0; s &= s - 1)
+            size++;
+        if (size == 1)
+            return 1;
+        const std::unordered_map<uint64_t, int>::const_iterator it = m_costs.find(set);
+        if (it != m_costs.end())
+            return it->second;
+
+        int best = -1;
+        for (unsigned int i = 0; i < m_points.size(); i++) {
+            uint64_t hit = 0;
+            uint64_t miss = 0;
+            for (int h = 0; h < hypothesisNo(); h++) {
+                if (!(set & (uint64_t(1) << h)))
+                    continue;
+                const int result = m_results[h][m_points[i]];
+                if (result == GuessPoint::Hit)
+                    hit |= uint64_t(1) << h;
+                else if (result == GuessPoint::Miss)
+                    miss |= uint64_t(1) << h;
+            }
+            if (hit == set || miss == set)
+                continue;
+            const int c = size + cost(hit) + cost(miss);
+            if (best < 0 || c < best)
+                best = c;
+        }
+        m_costs[set] = best;
+        return best;
+    }
+};
+
+//the moves of the solver until the last head of a placement is found
+int solverMoves(const ComputerLogic& logic, const std::vector<int>& results)
+{
+    ComputerLogic scratch(logic.getRowNo(), logic.getColNo(), logic.getPlaneNo());
+    scratch.assignState(logic);
+    const PlaneStencils& stencils = logic.stencils();
+    for (int moveNo = 1; moveNo <= stencils.pointNo(); moveNo++) {
+        int point = -1;
+        if (!EndgameSolver::choose(scratch, point) || point < 0 || point >= stencils.pointNo()) {
+            check(false, "the solver has a move in its endgame");
+            return -1;
+        }
+        if (results[point] == GuessPoint::Dead)
+            return moveNo;
+        scratch.addData(GuessPoint(stencils.cellRow(point), stencils.cellCol(point),
+                                   static_cast<GuessPoint::Type>(results[point])));
+    }
+    check(false, "the solver finds the last head");
+    return -1;
+}
+
+//plays a game until one head is left, then compares the solver with the
+//brute force search; returns whether the solver was used
+bool playGame(int rowNo, int colNo, int planeNo, int& hypothesisNo)
+{
+    PlaneGridCore grid(rowNo, colNo, planeNo, false);
+    grid.initGrid();
+    ComputerLogic logic(rowNo, colNo, planeNo);
+    int deadNo = 0;
+    while (deadNo < planeNo - 1) {
+        GridPoint qp;
+        if (!logic.makeChoice(qp)) {
+            check(false, "the computer has a move");
+            return false;
+        }
+        const GuessPoint::Type type = grid.getGuessResult(qp);
+        logic.addData(GuessPoint(qp.x(), qp.y(), type));
+        deadNo += type == GuessPoint::Dead;
+    }
+
+    //one head is left: the solver is used from the first move with few enough placements
+    for (;;) {
+        BruteForce brute(logic);
+        int point = -1;
+        const bool used = EndgameSolver::choose(logic, point);
+        check(used == (brute.hypothesisNo() > 0 && brute.hypothesisNo() <= EndgameSolver::MaxHypothesisNo),
+              "the solver is used with few placements");
+        if (used) {
+            hypothesisNo = brute.hypothesisNo();
+            int moveNo = 0;
+            for (int h = 0; h < brute.hypothesisNo(); h++)
+                moveNo += solverMoves(logic, brute.results(h));
+            check(moveNo == brute.cost(), "the solver needs the fewest moves");
+            return true;
+        }
+
+        GridPoint qp;
+        if (!logic.makeChoice(qp))
+            return false;
+        const GuessPoint::Type type = grid.getGuessResult(qp);
+        if (type == GuessPoint::Dead)
+            return false;
+        logic.addData(GuessPoint(qp.x(), qp.y(), type));
+    }
+}
+
+}
+
+int main(int argc, char* argv[])
+{
+    const int gameNo = argc > 1 ? std::atoi(argv[1]) : 40;
+
+    RandomGenerator random(34);
+    RandomScope scope(random);
+
+    int solvedNo = 0;
+    int hypothesisNo = 0;
+    for (int game = 0; game < gameNo; game++) {
+        //the cache must not hide a wrong move of an earlier game
+        EndgameSolver::clearCache();
+        int n = 0;
+        const bool solved = game % 2 == 0 ? playGame(8, 8, 2, n) : playGame(10, 10, 3, n);
+        if (solved) {
+            solvedNo++;
+            hypothesisNo += n;
+        }
+    }
+    check(gameNo == 0 || solvedNo > 0, "the solver is used in some games");
+    std::printf("%d games, %d endgames solved, %.1f placements per endgame\n", gameNo, solvedNo,
+                solvedNo > 0 ? static_cast<double>(hypothesisNo) / solvedNo : 0.0);
+
+    std::printf("%s\n", failureNo == 0 ? "passed" : "failed");
+    return failureNo == 0 ? 0 : 1;
+}
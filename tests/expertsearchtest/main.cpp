@@ -0,0 +1,113 @@
+#include "expertsearch.h"
+#include "computerlogic.h"
+#include "planegridcore.h"
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+//Checks that the logics and the boards each thread keeps for the expert
+//search do not change its results. With budgets large enough to be used up
+//never, the moves and the evaluations computed on the main thread, after
+//searches of other states and of another grid, must be those computed on a
+//new thread, whose workspace is empty.
+//
+//usage: ExpertSearchTest [games]
+
+namespace {
+
+int failureNo = 0;
+
+void check(bool condition, const char* what)
+{
+    if (!condition && failureNo++ < 10)
+        std::printf("failed: %s\n", what);
+}
+
+//the result of a search of a state
+struct Result
+{
+    bool m_found;
+    GridPoint m_move;
+    bool m_evaluated;
+    ExpertSearch::Evaluation m_evaluation;
+};
+
+//searches a state with a generator in a given state
+Result search(const ExpertSearch& expert, const ComputerLogic& logic, uint64_t state)
+{
+    Result result;
+    RandomGenerator random(state);
+    RandomScope scope(random);
+    result.m_found = expert.choose(logic, result.m_move);
+
+    std::mt19937 boards(static_cast<unsigned int>(state));
+    result.m_evaluated = result.m_found && expert.evaluate(logic, logic.stencils().cellId(result.m_move), boards,
+                                                           result.m_evaluation);
+    return result;
+}
+
+bool sameResult(const Result& a, const Result& b)
+{
+    return a.m_found == b.m_found && (!a.m_found || a.m_move == b.m_move) && a.m_evaluated == b.m_evaluated &&
+           (!a.m_evaluated || (a.m_evaluation.m_bestPoint == b.m_evaluation.m_bestPoint &&
+                               a.m_evaluation.m_bestValue == b.m_evaluation.m_bestValue &&
+                               a.m_evaluation.m_value == b.m_evaluation.m_value));
+}
+
+//plays a game with the expert search, comparing each move with a search on a new thread
+//returns the number of moves
+int playGame(const ExpertSearch& expert, int rowNo, int colNo, int planeNo, RandomGenerator& random)
+{
+    PlaneGridCore grid(rowNo, colNo, planeNo, false);
+    grid.initGrid();
+    ComputerLogic logic(rowNo, colNo, planeNo);
+
+    int moveNo = 0;
+    int deadNo = 0;
+    while (deadNo < planeNo && moveNo < rowNo * colNo) {
+        const uint64_t state = random.generate(1 << 30);
+        const Result result = search(expert, logic, state);
+        Result fresh;
+        std::thread thread([&]() { fresh = search(expert, logic, state); });
+        thread.join();
+        check(sameResult(result, fresh), "the search of a thread with a workspace gives the results of a new thread");
+        if (!result.m_found) {
+            check(false, "the expert search has a move");
+            break;
+        }
+
+        const GuessPoint::Type type = grid.getGuessResult(result.m_move);
+        logic.addData(GuessPoint(result.m_move.x(), result.m_move.y(), type));
+        deadNo += type == GuessPoint::Dead;
+        moveNo++;
+    }
+    check(deadNo == planeNo, "the expert search finds every plane");
+    return moveNo;
+}
+
+}
+
+int main(int argc, char* argv[])
+{
+    const int gameNo = argc > 1 ? std::atoi(argv[1]) : 4;
+
+    ExpertSearch::Settings settings = ExpertSearch::defaultSettings();
+    settings.m_depth = 2;
+    settings.m_candidateNo = 3;
+    settings.m_boardNo = 12;
+    settings.m_nodeBudget = 1 << 30;
+    settings.m_timeBudgetMs = 1 << 30;
+    const ExpertSearch expert(settings);
+
+    RandomGenerator random(33);
+    RandomScope scope(random);
+
+    int moveNo = 0;
+    for (int game = 0; game < gameNo; game++)
+        moveNo += game % 2 == 0 ? playGame(expert, 10, 10, 3, random) : playGame(expert, 8, 8, 2, random);
+    std::printf("%d games, %d moves\n", gameNo, moveNo);
+
+    std::printf("%s\n", failureNo == 0 ? "passed" : "failed");
+    return failureNo == 0 ? 0 : 1;
+}
@@ -0,0 +1,147 @@
+#include "gameanalyzer.h"
+#include <cstdio>
+#include <vector>
+
+//Checks the post-game analyzer on a replay log holding finished sessions
+//and records that do not describe a game: a grid too large for the packed
+//codes, a plane and a move outside the grid and a move with an unknown
+//result. Those records must be counted as rejected without being replayed,
+//every move of the computer in the other games must be measured, and the
+//results must not depend on the number of threads.
+//
+//usage: GameAnalyzerTest
+
+namespace {
+
+int failureNo = 0;
+
+void check(bool condition, const char* what)
+{
+    if (!condition && failureNo++ < 10)
+        std::printf("failed: %s\n", what);
+}
+
+//plays a round of a session to its end and appends it
+void appendSession(ReplayLogWriter& writer, RandomGenerator& random, bool isComputerFirst)
+{
+    GameSession session(10, 10, 3);
+    session.start(isComputerFirst);
+    std::vector<int> order(100);
+    for (unsigned int i = 0; i < order.size(); i++)
+        order[i] = i;
+    for (int i = static_cast<int>(order.size()) - 1; i > 0; i--)
+        std::swap(order[i], order[random.generate(i + 1)]);
+    for (int step = 0; !session.isFinished(); step++) {
+        GuessPoint gp(0, 0);
+        session.playComputerMove(gp);
+        session.playPlayerGuess(order[step] % 10, order[step] / 10, gp);
+        session.endStep();
+    }
+    check(writer.append(session), "a session is appended");
+}
+
+//appends a round of 10x10 with 3 planes whose codes are given
+void appendRound(ReplayLogWriter& writer, int rowNo, int planeId, int moveCode)
+{
+    const PackedPlane planes[] = { PackedPlane::fromId(0), PackedPlane::fromId(planeId), PackedPlane::fromId(40) };
+    const PackedGuess moves[] = { PackedGuess::fromCode(4 * 12), PackedGuess::fromCode(moveCode),
+                                  PackedGuess::fromCode(4 * 57 + GuessPoint::Hit) };
+    check(writer.append(1, rowNo, 10, 3, true, false, planes, planes, moves, 3), "a round is appended");
+}
+
+//the records of the log that are games
+bool isGame(uint32_t record)
+{
+    return record == 0 || record == 2 || record == 5 || record == 7;
+}
+
+//counts the moves of the computer in the games
+struct MoveCounter
+{
+    uint32_t m_recordNo;
+    int m_moveNo;
+
+    MoveCounter(): m_recordNo(0), m_moveNo(0) {}
+
+    void operator()(const ReplayRecord& record)
+    {
+        for (int i = 0; i < record.moveNo() && isGame(m_recordNo); i++)
+            m_moveNo += record.isComputerMove(i);
+        m_recordNo++;
+    }
+};
+
+bool sameResults(const std::vector<GameAnalyzer::MoveResult>& a, const std::vector<GameAnalyzer::MoveResult>& b)
+{
+    if (a.size() != b.size())
+        return false;
+    for (unsigned int i = 0; i < a.size(); i++)
+        if (a[i].m_game != b[i].m_game || a[i].m_move != b[i].m_move || a[i].m_bestRow != b[i].m_bestRow ||
+            a[i].m_bestCol != b[i].m_bestCol || a[i].m_playedValue != b[i].m_playedValue ||
+            a[i].m_bestValue != b[i].m_bestValue || a[i].m_isValid != b[i].m_isValid)
+            return false;
+    return true;
+}
+
+}
+
+int main()
+{
+    const std::string path = "gameanalyzertest.log";
+    std::remove(path.c_str());
+    std::remove(ReplayLog::indexFileName(path).c_str());
+
+    RandomGenerator random(47);
+    RandomScope scope(random);
+    ReplayLogWriter writer;
+    check(writer.open(path), "a new log is opened");
+    appendSession(writer, random, true);
+    //a grid larger than the codes of the guesses
+    appendRound(writer, 200, 4 * 23, 4 * 34);
+    appendSession(writer, random, false);
+    //a plane outside the grid
+    appendRound(writer, 10, 4 * 100 + 2, 4 * 34);
+    //a move outside the grid
+    appendRound(writer, 10, 4 * 23, 4 * 150 + GuessPoint::Miss);
+    appendSession(writer, random, true);
+    //a move with an unknown result
+    appendRound(writer, 10, 4 * 23, 4 * 34 + 3);
+    //a round with valid codes
+    appendRound(writer, 10, 4 * 23, 4 * 34 + GuessPoint::Dead);
+    writer.close();
+
+    {
+        ReplayLogReader log;
+        check(log.open(path) && log.recordNo() == 8, "the log is read");
+        MoveCounter counter;
+        log.forEachRecord(counter);
+
+        //small searches, the values are not checked
+        GameAnalyzer::Settings settings = GameAnalyzer::defaultSettings();
+        settings.m_search.m_candidateNo = 3;
+        settings.m_search.m_boardNo = 20;
+        settings.m_batchSize = 3;
+
+        GameAnalyzer analyzer(settings, 3);
+        const std::vector<GameAnalyzer::MoveResult> results = analyzer.analyze(log);
+        check(analyzer.rejectedNo() == 4, "the records that are not games are rejected");
+        check(static_cast<int>(results.size()) == counter.m_moveNo, "the moves of the games are measured");
+        bool inOrder = true;
+        for (unsigned int i = 0; i < results.size(); i++) {
+            const uint32_t game = results[i].m_game;
+            inOrder = inOrder && isGame(game) && results[i].m_isComputer &&
+                      (i == 0 || game > results[i - 1].m_game || results[i].m_move > results[i - 1].m_move);
+        }
+        check(inOrder, "the results are in the order of the games");
+
+        GameAnalyzer single(settings, 1);
+        check(sameResults(single.analyze(log), results) && single.rejectedNo() == 4, "the same results with one thread");
+        std::printf("%d moves measured, %d records rejected\n", static_cast<int>(results.size()), analyzer.rejectedNo());
+    }
+
+    std::remove(path.c_str());
+    std::remove(ReplayLog::indexFileName(path).c_str());
+
+    std::printf("%s\n", failureNo == 0 ? "passed" : "failed");
+    return failureNo == 0 ? 0 : 1;
+}
@@ -0,0 +1,16 @@
+TEMPLATE = app
+CONFIG += console
+CONFIG -= app_bundle
+CONFIG -= qt
+
+#the server runs in the process of the test
+SOURCES += main.cpp \
+    ../../tools/planesserver/gameserver.cpp
+
+HEADERS += ../../tools/planesserver/gameserver.h
+
+unix: LIBS += -L$$OUT_PWD/../../common/planescore/ -lplanescore -lpthread
+
+INCLUDEPATH += $$PWD/../../common \
+    $$PWD/../../tools/planesserver
+DEPENDPATH += $$PWD/../../common
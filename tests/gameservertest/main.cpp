@@ -0,0 +1,477 @@
+#include "gameserver.h"
+#include "plane.h"
+#include "planeiterators.h"
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <random>
+#include <thread>
+#include <vector>
+
+//Stresses a GameServer with several shards in the same process.
+//Client threads open many connections, which the server spreads over its
+//shards, and play rounds on all of them in turn with blocking sockets. Every
+//answer must decode and follow the protocol: the Hello of the connections
+//names every shard, a round starts with the grid of the server, every step
+//has the result of the guess and the computer's move until the round ends,
+//and the end of a round sends the planes and the statistics. The results of
+//the guesses must match the planes, the statistics must count the moves and
+//the rounds, a repeated guess and a guess after the end of a round must be
+//refused. Some connections close after each round and connect again, so the
+//sessions are recycled. At the end the moves counted by the server must be
+//those the clients played and all the connections must be closed.
+//
+//usage: GameServerTest [threads [connections per thread [rounds]]]
+
+namespace {
+
+typedef std::chrono::steady_clock Clock;
+
+const int ShardNo = 4;
+const int RowNo = 10;
+const int ColNo = 10;
+const int PlaneNo = 3;
+
+//the results of a client thread
+struct Report
+{
+    long long m_roundNo;
+    long long m_stepNo;
+    //the moves of both sides accepted by the server
+    long long m_moveNo;
+    long long m_refusedNo;
+    int m_errorNo;
+    //the connections received by each shard
+    std::vector<int> m_shardConnections;
+
+    Report(): m_roundNo(0), m_stepNo(0), m_moveNo(0), m_refusedNo(0), m_errorNo(0), m_shardConnections(ShardNo, 0) {}
+};
+
+//a connection and the round it plays
+struct Client
+{
+    int m_fd;
+    uint8_t m_input[512];
+    int m_inputSize;
+
+    bool m_inRound;
+    bool m_isComputerFirst;
+    //the rounds ended on this connection, the statistics count them
+    int m_endedNo;
+    //the points still to guess, as col * RowNo + row
+    std::vector<int> m_points;
+    //the player's guesses of the round and their results
+    std::vector<GuessPoint> m_guesses;
+    int m_computerMoveNo;
+};
+
+//the messages of a frame
+struct Answer
+{
+    std::vector<WireMessage> m_messages;
+    //the planes are read in place, they are copied
+    std::vector<Plane> m_planes;
+
+    int count(int type) const
+    {
+        int n = 0;
+        for (unsigned int i = 0; i < m_messages.size(); i++)
+            if (m_messages[i].m_type == type)
+                n++;
+        return n;
+    }
+
+    const WireMessage* find(int type) const
+    {
+        for (unsigned int i = 0; i < m_messages.size(); i++)
+            if (m_messages[i].m_type == type)
+                return &m_messages[i];
+        return nullptr;
+    }
+};
+
+void fail(Report& report, const char* what, int value = 0)
+{
+    if (report.m_errorNo++ < 5)
+        std::printf("%s (%d)\n", what, value);
+}
+
+int connectTo(int port)
+{
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0)
+        return -1;
+    sockaddr_in address;
+    std::memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_port = htons(static_cast<uint16_t>(port));
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+        close(fd);
+        return -1;
+    }
+    int noDelay = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+    //a server that stops answering fails the test instead of blocking it
+    timeval timeout;
+    timeout.tv_sec = 10;
+    timeout.tv_usec = 0;
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    return fd;
+}
+
+bool sendNewRound(Client& client)
+{
+    uint8_t frame[16];
+    WireWriter writer(frame, sizeof(frame));
+    writer.beginFrame();
+    writer.newRound(client.m_isComputerFirst);
+    writer.endFrame();
+    return send(client.m_fd, frame, writer.size(), MSG_NOSIGNAL) == writer.size();
+}
+
+bool sendGuess(Client& client, int point)
+{
+    uint8_t frame[16];
+    WireWriter writer(frame, sizeof(frame));
+    writer.beginFrame();
+    writer.playerGuess(point % RowNo, point / RowNo);
+    writer.endFrame();
+    return send(client.m_fd, frame, writer.size(), MSG_NOSIGNAL) == writer.size();
+}
+
+//waits for the next frame and decodes its messages
+//returns false if the connection is closed or the frame is not valid
+bool receive(Client& client, Answer& answer)
+{
+    int frameSize;
+    while ((frameSize = WireReader::frameSize(client.m_input, client.m_inputSize)) == 0) {
+        ssize_t size = recv(client.m_fd, client.m_input + client.m_inputSize, sizeof(client.m_input) - client.m_inputSize, 0);
+        if (size <= 0)
+            return false;
+        client.m_inputSize += static_cast<int>(size);
+    }
+    if (frameSize < 0)
+        return false;
+
+    answer.m_messages.clear();
+    answer.m_planes.clear();
+    WireReader reader(client.m_input, frameSize);
+    WireMessage message;
+    while (reader.next(message)) {
+        if (message.m_type == WireProtocol::Planes)
+            for (int i = 0; i < message.m_planeNo; i++)
+                answer.m_planes.push_back(message.plane(i));
+        answer.m_messages.push_back(message);
+    }
+    client.m_inputSize -= frameSize;
+    std::memmove(client.m_input, client.m_input + frameSize, client.m_inputSize);
+    return !reader.hasError();
+}
+
+//connects and reads the Hello of the server
+bool openClient(Client& client, int port, Report& report)
+{
+    client.m_fd = connectTo(port);
+    client.m_inputSize = 0;
+    client.m_inRound = false;
+    client.m_endedNo = 0;
+    if (client.m_fd < 0) {
+        fail(report, "cannot connect");
+        return false;
+    }
+    Answer answer;
+    const WireMessage* hello = nullptr;
+    if (!receive(client, answer) || answer.m_messages.size() != 1 || (hello = answer.find(WireProtocol::Hello)) == nullptr) {
+        fail(report, "no hello");
+        return false;
+    }
+    if (hello->m_args[0] != WireProtocol::Version || hello->m_args[1] < 0 || hello->m_args[1] >= ShardNo) {
+        fail(report, "invalid hello", hello->m_args[1]);
+        return false;
+    }
+    report.m_shardConnections[hello->m_args[1]]++;
+    return true;
+}
+
+//whether the results of the player's guesses are those of the planes
+bool matchesPlanes(const std::vector<GuessPoint>& guesses, const std::vector<Plane>& planes)
+{
+    std::vector<int> results(RowNo * ColNo, GuessPoint::Miss);
+    for (unsigned int i = 0; i < planes.size(); i++) {
+        PlanePointIterator ppi(planes[i]);
+        bool isHead = true;
+        while (ppi.hasNext()) {
+            GridPoint qp = ppi.next();
+            if (qp.x() < 0 || qp.x() >= RowNo || qp.y() < 0 || qp.y() >= ColNo)
+                return false;
+            results[qp.y() * RowNo + qp.x()] = isHead ? GuessPoint::Dead : GuessPoint::Hit;
+            isHead = false;
+        }
+    }
+    for (unsigned int i = 0; i < guesses.size(); i++)
+        if (results[guesses[i].m_col * RowNo + guesses[i].m_row] != guesses[i].m_type)
+            return false;
+    return true;
+}
+
+//starts a round, returns false if the connection cannot go on
+bool startRound(Client& client, std::mt19937& random, Report& report)
+{
+    Answer answer;
+    if (!sendNewRound(client) || !receive(client, answer)) {
+        fail(report, "no answer to the new round");
+        return false;
+    }
+    const WireMessage* started = answer.find(WireProtocol::RoundStarted);
+    if (started == nullptr || started->m_args[0] != RowNo || started->m_args[1] != ColNo || started->m_args[2] != PlaneNo) {
+        fail(report, "the round did not start with the grid of the server");
+        return false;
+    }
+    //the computer moves first or not at all
+    if (answer.count(WireProtocol::ComputerMove) != (client.m_isComputerFirst ? 1 : 0) ||
+        answer.m_messages.size() != (client.m_isComputerFirst ? 2u : 1u)) {
+        fail(report, "unexpected answer to the new round", client.m_isComputerFirst);
+        return false;
+    }
+    report.m_moveNo += answer.count(WireProtocol::ComputerMove);
+
+    client.m_inRound = true;
+    client.m_computerMoveNo = answer.count(WireProtocol::ComputerMove);
+    client.m_guesses.clear();
+    client.m_points.resize(RowNo * ColNo);
+    for (unsigned int i = 0; i < client.m_points.size(); i++)
+        client.m_points[i] = i;
+    for (int i = static_cast<int>(client.m_points.size()) - 1; i > 0; i--)
+        std::swap(client.m_points[i], client.m_points[random() % (i + 1)]);
+    return true;
+}
+
+//checks the end of a round
+void endRound(Client& client, const Answer& answer, Report& report)
+{
+    const WireMessage* ended = answer.find(WireProtocol::RoundEnded);
+    const WireMessage* stats = answer.find(WireProtocol::Statistics);
+    if (stats == nullptr || answer.find(WireProtocol::Planes) == nullptr || static_cast<int>(answer.m_planes.size()) != PlaneNo) {
+        fail(report, "the end of the round has no planes or no statistics");
+        return;
+    }
+    if (!matchesPlanes(client.m_guesses, answer.m_planes))
+        fail(report, "the results of the guesses do not match the planes");
+
+    int deadNo = 0;
+    for (unsigned int i = 0; i < client.m_guesses.size(); i++)
+        if (client.m_guesses[i].m_type == GuessPoint::Dead)
+            deadNo++;
+    if (ended->m_args[0] == 0 && deadNo != PlaneNo)
+        fail(report, "the player won without finding all the heads", deadNo);
+
+    client.m_endedNo++;
+    const GameStatistics& s = stats->m_stats;
+    if (s.m_playerMoves != static_cast<int>(client.m_guesses.size()) || s.m_computerMoves != client.m_computerMoveNo ||
+        s.m_playerDead != deadNo || s.m_playerWins + s.m_computerWins != client.m_endedNo ||
+        (ended->m_args[0] != 0 ? s.m_computerWins : s.m_playerWins) == 0)
+        fail(report, "the statistics do not count the round", s.m_playerMoves);
+    client.m_inRound = false;
+    report.m_roundNo++;
+}
+
+//plays one step of a round: a guess and the answers
+//the first step of a round is followed by a repeated guess,
+//the end of the first round by a guess that is too late
+//returns false if the connection cannot go on
+bool playStep(Client& client, Report& report)
+{
+    if (client.m_points.empty()) {
+        fail(report, "the round did not end with all the points guessed");
+        return false;
+    }
+    const int point = client.m_points.back();
+    client.m_points.pop_back();
+    Answer answer;
+    if (!sendGuess(client, point) || !receive(client, answer)) {
+        fail(report, "no answer to the guess");
+        return false;
+    }
+
+    const WireMessage* result = answer.find(WireProtocol::GuessResult);
+    const bool isEnded = answer.find(WireProtocol::RoundEnded) != nullptr;
+    if (result == nullptr || answer.count(WireProtocol::GuessResult) != 1 ||
+        result->m_guess.m_row != point % RowNo || result->m_guess.m_col != point / RowNo) {
+        fail(report, "the step has no result for the guess", point);
+        return false;
+    }
+    //the computer answers until the round ends
+    const int computerMoveNo = answer.count(WireProtocol::ComputerMove);
+    if (computerMoveNo > 1 || (!isEnded && computerMoveNo != 1) || answer.find(WireProtocol::Error) != nullptr) {
+        fail(report, "the step has no computer move", computerMoveNo);
+        return false;
+    }
+    client.m_guesses.push_back(result->m_guess);
+    client.m_computerMoveNo += computerMoveNo;
+    report.m_moveNo += 1 + computerMoveNo;
+    report.m_stepNo++;
+
+    if (isEnded)
+        endRound(client, answer, report);
+
+    //the server refuses a guess it already has and a guess without a round
+    const bool isFirstStep = client.m_guesses.size() == 1 && !isEnded;
+    const bool isFirstEnd = isEnded && client.m_endedNo == 1;
+    if (isFirstStep || isFirstEnd) {
+        if (!sendGuess(client, point) || !receive(client, answer)) {
+            fail(report, "no answer to the refused guess");
+            return false;
+        }
+        const WireMessage* error = answer.find(WireProtocol::Error);
+        const int code = isFirstStep ? WireProtocol::InvalidGuess : WireProtocol::NoRound;
+        if (answer.m_messages.size() != 1 || error == nullptr || error->m_args[0] != code)
+            fail(report, "the guess was not refused", code);
+        report.m_refusedNo++;
+    }
+    return true;
+}
+
+//plays the rounds of its connections in turn, one step at a time
+//every fourth connection closes after each round and connects again
+void runThread(int port, int connectionNo, int roundNo, uint64_t seed, Report& report)
+{
+    std::mt19937 random(static_cast<uint32_t>(seed));
+    std::vector<Client> clients(connectionNo);
+    std::vector<int> roundsLeft(connectionNo, roundNo);
+    int activeNo = 0;
+    for (int i = 0; i < connectionNo; i++) {
+        clients[i].m_isComputerFirst = (i % 2) != 0;
+        if (openClient(clients[i], port, report))
+            activeNo++;
+        else
+            roundsLeft[i] = 0;
+    }
+
+    while (activeNo > 0) {
+        for (int i = 0; i < connectionNo; i++) {
+            Client& client = clients[i];
+            if (roundsLeft[i] == 0)
+                continue;
+            bool ok = client.m_inRound ? playStep(client, report) : startRound(client, random, report);
+            if (ok && !client.m_inRound) {
+                roundsLeft[i]--;
+                client.m_isComputerFirst = !client.m_isComputerFirst;
+                if (roundsLeft[i] > 0 && i % 4 == 0) {
+                    close(client.m_fd);
+                    ok = openClient(client, port, report);
+                }
+            }
+            if (!ok)
+                roundsLeft[i] = 0;
+            if (roundsLeft[i] == 0) {
+                close(client.m_fd);
+                client.m_fd = -1;
+                activeNo--;
+            }
+        }
+    }
+}
+
+}
+
+int main(int argc, char* argv[])
+{
+    int threadNo = 4, connectionNo = 16, roundNo = 6;
+    if (argc > 4) {
+        std::fprintf(stderr, "usage: %s [threads [connections per thread [rounds]]]\n", argv[0]);
+        return 1;
+    }
+    if (argc >= 2)
+        threadNo = std::atoi(argv[1]);
+    if (argc >= 3)
+        connectionNo = std::atoi(argv[2]);
+    if (argc == 4)
+        roundNo = std::atoi(argv[3]);
+    if (threadNo <= 0 || connectionNo <= 0 || roundNo <= 0) {
+        std::fprintf(stderr, "invalid arguments\n");
+        return 1;
+    }
+
+    Plane::seedRandomGenerator();
+    GameServer::Options options;
+    options.m_shardNo = ShardNo;
+    options.m_rowNo = RowNo;
+    options.m_colNo = ColNo;
+    options.m_planeNo = PlaneNo;
+
+    //an address that is not IPv4 is refused
+    GameServer::Options invalid = options;
+    invalid.m_bindAddress = "localhost";
+    if (GameServer(invalid).start()) {
+        std::printf("the server starts on an invalid address\nfailed\n");
+        return 1;
+    }
+
+    //the first free port of a range, on the loopback address by default
+    std::unique_ptr<GameServer> server;
+    for (int port = 27878; port < 27978 && !server; port++) {
+        options.m_port = port;
+        server.reset(new GameServer(options));
+        if (!server->start())
+            server.reset();
+    }
+    if (!server) {
+        std::printf("the server cannot start\n");
+        return 1;
+    }
+
+    std::vector<Report> reports(threadNo);
+    std::vector<std::thread> threads;
+    for (int i = 0; i < threadNo; i++)
+        threads.push_back(std::thread(runThread, options.m_port, connectionNo, roundNo, 777u + i, std::ref(reports[i])));
+    for (unsigned int i = 0; i < threads.size(); i++)
+        threads[i].join();
+
+    Report total;
+    for (unsigned int i = 0; i < reports.size(); i++) {
+        total.m_roundNo += reports[i].m_roundNo;
+        total.m_stepNo += reports[i].m_stepNo;
+        total.m_moveNo += reports[i].m_moveNo;
+        total.m_refusedNo += reports[i].m_refusedNo;
+        total.m_errorNo += reports[i].m_errorNo;
+        for (int shard = 0; shard < ShardNo; shard++)
+            total.m_shardConnections[shard] += reports[i].m_shardConnections[shard];
+    }
+
+    //the shards close the connections on their own threads
+    const Clock::time_point deadline = Clock::now() + std::chrono::seconds(5);
+    while (server->connectionNo() != 0 && Clock::now() < deadline)
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    const int openNo = server->connectionNo();
+    const long long serverMoveNo = server->moveNo();
+    const ObjectPool<GameSession>::Metrics sessions = server->sessionPoolMetrics();
+    server->stop();
+
+    std::printf("%d connections on %d shards:", threadNo * connectionNo, ShardNo);
+    bool allShards = true;
+    for (int shard = 0; shard < ShardNo; shard++) {
+        std::printf(" %d", total.m_shardConnections[shard]);
+        allShards = allShards && total.m_shardConnections[shard] > 0;
+    }
+    std::printf("\nrounds %lld, steps %lld, moves %lld (server %lld), refused %lld, errors %d, left open %d\n",
+                total.m_roundNo, total.m_stepNo, total.m_moveNo, serverMoveNo, total.m_refusedNo, total.m_errorNo, openNo);
+    std::printf("sessions created %llu, reused %llu\n", static_cast<unsigned long long>(sessions.m_created),
+                static_cast<unsigned long long>(sessions.m_reused));
+
+    const bool passed = total.m_errorNo == 0 && allShards &&
+                        total.m_roundNo == static_cast<long long>(threadNo) * connectionNo * roundNo &&
+                        total.m_moveNo == serverMoveNo && openNo == 0 && (roundNo == 1 || sessions.m_reused > 0);
+    std::printf("%s\n", passed ? "passed" : "failed");
+    return passed ? 0 : 1;
+}
@@ -0,0 +1,203 @@
+#include "computerlogic.h"
+#include "planegridcore.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+//Checks that the inferences of the plane propagator are sound on small
+//grids. The computer plays against boards with random planes; after every
+//move all the placements of the planes agreeing with the guesses are
+//enumerated. In each placement every point must be allowed by its domain,
+//every point with an owner must be on the plane of that head, the plane of
+//a found head must have one of its orientations, the planes not found must
+//be at positions the choice map keeps, and the inferred guesses must be
+//the results of the placement, the body of a found plane being a miss.
+//The placement of the board must be one of them.
+//
+//usage: PlanePropagatorTest [games]
+
+namespace {
+
+int failureNo = 0;
+
+void check(bool condition, const char* what)
+{
+    if (!condition && failureNo++ < 10)
+        std::printf("failed: %s\n", what);
+}
+
+//checks the state of a logic against the placements agreeing with its guesses
+class Checker
+{
+    const ComputerLogic& m_logic;
+    const PlaneStencils& m_stencils;
+    //the result of each guessed point, -1 for the others
+    std::vector<int> m_guessed;
+    std::vector<int> m_positions;
+    //the plane of the placement being built on each point, -1 for none
+    std::vector<int> m_planeOfPoint;
+    std::vector<int> m_chosen;
+    //the positions of the planes of the board
+    std::vector<int> m_board;
+
+public:
+    int m_placementNo;
+    bool m_hasBoard;
+
+    Checker(const ComputerLogic& logic, const std::vector<int>& board):
+        m_logic(logic), m_stencils(logic.stencils()), m_board(board), m_placementNo(0), m_hasBoard(false)
+    {
+        m_guessed.assign(m_stencils.pointNo(), -1);
+        const ArenaVector<GuessPoint>& guesses = logic.getListGuesses();
+        for (unsigned int i = 0; i < guesses.size(); i++)
+            m_guessed[m_stencils.cellId(guesses[i].m_row, guesses[i].m_col)] = guesses[i].m_type;
+        for (int position = 0; position < m_stencils.planePositionNo(); position++) {
+            if (!m_stencils.isValid(position))
+                continue;
+            bool ok = true;
+            for (int k = 0; k < PlaneStencils::PlanePointsNo && ok; k++)
+                ok = m_guessed[m_stencils.footprint(position)[k]] != GuessPoint::Miss;
+            if (ok)
+                m_positions.push_back(position);
+        }
+        m_planeOfPoint.assign(m_stencils.pointNo(), -1);
+    }
+
+    void run() { enumerate(0); }
+
+private:
+    //the result of a point in the placement
+    int result(int point) const
+    {
+        const int plane = m_planeOfPoint[point];
+        if (plane < 0)
+            return GuessPoint::Miss;
+        return PlaneStencils::headCell(plane) == point ? GuessPoint::Dead : GuessPoint::Hit;
+    }
+
+    void enumerate(unsigned int first)
+    {
+        if (static_cast<int>(m_chosen.size()) == m_logic.getPlaneNo()) {
+            for (int point = 0; point < m_stencils.pointNo(); point++)
+                if (m_guessed[point] >= 0 && m_guessed[point] != result(point))
+                    return;
+            checkPlacement();
+            return;
+        }
+
+        for (unsigned int i = first; i < m_positions.size(); i++) {
+            const int* footprint = m_stencils.footprint(m_positions[i]);
+            bool free = true;
+            for (int k = 0; k < PlaneStencils::PlanePointsNo && free; k++)
+                free = m_planeOfPoint[footprint[k]] < 0;
+            if (!free)
+                continue;
+            for (int k = 0; k < PlaneStencils::PlanePointsNo; k++)
+                m_planeOfPoint[footprint[k]] = m_positions[i];
+            m_chosen.push_back(m_positions[i]);
+            enumerate(i + 1);
+            m_chosen.pop_back();
+            for (int k = 0; k < PlaneStencils::PlanePointsNo; k++)
+                m_planeOfPoint[footprint[k]] = -1;
+        }
+    }
+
+    void checkPlacement()
+    {
+        m_placementNo++;
+        if (m_chosen == m_board)
+            m_hasBoard = true;
+
+        const PlanePropagator& propagator = m_logic.propagator();
+        for (int point = 0; point < m_stencils.pointNo(); point++) {
+            const int type = result(point);
+            const int role = type == GuessPoint::Miss ? PlanePropagator::Empty :
+                             type == GuessPoint::Dead ? PlanePropagator::Head : PlanePropagator::Body;
+            check((propagator.domain(point) & role) != 0, "the domain of a point");
+            const int owner = propagator.owner(point);
+            check(owner < 0 || (type == GuessPoint::Hit && PlaneStencils::headCell(m_planeOfPoint[point]) == owner),
+                  "the owner of a point");
+        }
+
+        const ChoiceMap& choices = m_logic.getChoiceMap();
+        for (unsigned int i = 0; i < m_chosen.size(); i++) {
+            const int head = PlaneStencils::headCell(m_chosen[i]);
+            if (m_guessed[head] == GuessPoint::Dead)
+                check((propagator.orientationMask(head) & (1 << PlaneStencils::orientation(m_chosen[i]))) != 0,
+                      "the orientation of a found head");
+            else
+                check(choices[m_chosen[i]] >= 0, "the position of a plane left to find");
+        }
+
+        //the body of a found plane is listed as a miss for the planes left to find
+        const ArenaVector<GuessPoint>& inferred = m_logic.getExtendedListGuesses();
+        for (unsigned int i = 0; i < inferred.size(); i++) {
+            const int point = m_stencils.cellId(inferred[i].m_row, inferred[i].m_col);
+            const bool isFoundBody = result(point) == GuessPoint::Hit &&
+                                     m_guessed[PlaneStencils::headCell(m_planeOfPoint[point])] == GuessPoint::Dead;
+            check(result(point) == inferred[i].m_type || (inferred[i].m_type == GuessPoint::Miss && isFoundBody),
+                  "an inferred guess");
+        }
+    }
+};
+
+//the positions of the planes of a board, in increasing order
+std::vector<int> boardPositions(const PlaneGridCore& grid, const PlaneStencils& stencils)
+{
+    std::vector<int> positions;
+    for (int i = 0; i < grid.getPlaneNo(); i++) {
+        Plane pl;
+        grid.getPlane(i, pl);
+        positions.push_back(stencils.planeId(pl));
+    }
+    std::sort(positions.begin(), positions.end());
+    return positions;
+}
+
+//plays a game and checks the state after every move
+//returns the number of placements checked
+long long playGame(int rowNo, int colNo, int planeNo)
+{
+    PlaneGridCore grid(rowNo, colNo, planeNo, false);
+    grid.initGrid();
+    ComputerLogic logic(rowNo, colNo, planeNo);
+    const std::vector<int> board = boardPositions(grid, logic.stencils());
+
+    long long placementNo = 0;
+    int deadNo = 0;
+    while (deadNo < planeNo) {
+        GridPoint qp;
+        if (!logic.makeChoice(qp)) {
+            check(false, "the computer has a move");
+            break;
+        }
+        const GuessPoint::Type type = grid.getGuessResult(qp);
+        logic.addData(GuessPoint(qp.x(), qp.y(), type));
+        deadNo += type == GuessPoint::Dead;
+
+        Checker checker(logic, board);
+        checker.run();
+        check(checker.m_hasBoard, "the board agrees with the guesses");
+        placementNo += checker.m_placementNo;
+    }
+    return placementNo;
+}
+
+}
+
+int main(int argc, char* argv[])
+{
+    const int gameNo = argc > 1 ? std::atoi(argv[1]) : 30;
+
+    RandomGenerator random(32);
+    RandomScope scope(random);
+
+    long long placementNo = 0;
+    for (int game = 0; game < gameNo; game++)
+        placementNo += game % 3 == 2 ? playGame(9, 9, 3) : playGame(8, 8, 2);
+    std::printf("%d games, %lld placements checked\n", gameNo, placementNo);
+
+    std::printf("%s\n", failureNo == 0 ? "passed" : "failed");
+    return failureNo == 0 ? 0 : 1;
+}
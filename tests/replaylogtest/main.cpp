@@ -0,0 +1,285 @@
+#include "replaylog.h"
+#include <cstdio>
+#include <vector>
+
+//Checks the replay log. Rounds of several geometries are appended to a log
+//with small blocks and read back in order, by one thread and by the threads
+//of a pool; a finished session is appended and read back with its seed, its
+//boards and its moves. The blocks must be found without the index file, and
+//a log that is opened again must keep its records and add the new ones
+//after them, also when its last block was cut by an interrupted write.
+//
+//usage: ReplayLogTest
+
+namespace {
+
+int failureNo = 0;
+
+void check(bool condition, const char* what)
+{
+    if (!condition && failureNo++ < 10)
+        std::printf("failed: %s\n", what);
+}
+
+//a round as it was appended
+struct Round
+{
+    uint64_t m_seed;
+    int m_rowNo;
+    int m_colNo;
+    int m_planeNo;
+    bool m_isComputerFirst;
+    bool m_isPlayerWinner;
+    std::vector<PackedPlane> m_planes;
+    std::vector<PackedGuess> m_moves;
+
+    bool operator==(const Round& other) const
+    {
+        return m_seed == other.m_seed && m_rowNo == other.m_rowNo && m_colNo == other.m_colNo &&
+               m_planeNo == other.m_planeNo && m_isComputerFirst == other.m_isComputerFirst &&
+               m_isPlayerWinner == other.m_isPlayerWinner && m_planes == other.m_planes && m_moves == other.m_moves;
+    }
+};
+
+//a round with random fields, the codes are not checked by the log
+Round makeRound(RandomGenerator& random)
+{
+    Round round;
+    round.m_seed = (static_cast<uint64_t>(random.generate(1 << 30)) << 32) | random.generate(1 << 30);
+    round.m_rowNo = 5 + random.generate(20);
+    round.m_colNo = 5 + random.generate(20);
+    round.m_planeNo = 1 + random.generate(6);
+    round.m_isComputerFirst = random.generate(2) == 0;
+    round.m_isPlayerWinner = random.generate(2) == 0;
+    for (int i = 0; i < 2 * round.m_planeNo; i++)
+        round.m_planes.push_back(PackedPlane::fromId(random.generate(1 << 16)));
+    const int moveNo = random.generate(2 * round.m_rowNo * round.m_colNo);
+    for (int i = 0; i < moveNo; i++)
+        round.m_moves.push_back(PackedGuess::fromCode(random.generate(1 << 16)));
+    return round;
+}
+
+bool appendRound(ReplayLogWriter& writer, const Round& round)
+{
+    return writer.append(round.m_seed, round.m_rowNo, round.m_colNo, round.m_planeNo, round.m_isComputerFirst,
+                         round.m_isPlayerWinner, round.m_planes.data(), round.m_planes.data() + round.m_planeNo,
+                         round.m_moves.data(), static_cast<int>(round.m_moves.size()));
+}
+
+//collects the records it visits
+struct Collector
+{
+    std::vector<Round> m_rounds;
+
+    void operator()(const ReplayRecord& record)
+    {
+        Round round;
+        round.m_seed = record.seed();
+        round.m_rowNo = record.rowNo();
+        round.m_colNo = record.colNo();
+        round.m_planeNo = record.planeNo();
+        round.m_isComputerFirst = record.isComputerFirst();
+        round.m_isPlayerWinner = record.isPlayerWinner();
+        for (int i = 0; i < record.planeNo(); i++)
+            round.m_planes.push_back(record.playerPlane(i));
+        for (int i = 0; i < record.planeNo(); i++)
+            round.m_planes.push_back(record.computerPlane(i));
+        for (int i = 0; i < record.moveNo(); i++)
+            round.m_moves.push_back(record.move(i));
+        m_rounds.push_back(round);
+    }
+};
+
+//the rounds of a log, empty if it cannot be read
+std::vector<Round> readLog(const std::string& path)
+{
+    ReplayLogReader reader;
+    Collector collector;
+    if (reader.open(path))
+        reader.forEachRecord(collector);
+    check(collector.m_rounds.size() == reader.recordNo(), "the records of the blocks are read");
+    return collector.m_rounds;
+}
+
+long fileSize(const std::string& path)
+{
+    FILE* file = std::fopen(path.c_str(), "rb");
+    if (file == nullptr)
+        return -1;
+    std::fseek(file, 0, SEEK_END);
+    const long size = std::ftell(file);
+    std::fclose(file);
+    return size;
+}
+
+//removes the last bytes of a file, as an interrupted write would leave it
+void cutFile(const std::string& path, int byteNo)
+{
+    std::vector<char> data(fileSize(path));
+    FILE* file = std::fopen(path.c_str(), "rb");
+    check(file != nullptr && std::fread(data.data(), 1, data.size(), file) == data.size(), "the file is read");
+    if (file != nullptr)
+        std::fclose(file);
+    file = std::fopen(path.c_str(), "wb");
+    check(file != nullptr && std::fwrite(data.data(), 1, data.size() - byteNo, file) == data.size() - byteNo, "the file is cut");
+    if (file != nullptr)
+        std::fclose(file);
+}
+
+//a finished round of a session, the moves alternate between the sides
+Round sessionRound(RandomGenerator& random)
+{
+    GameSession session(10, 10, 3);
+    session.start(true);
+    std::vector<int> order(100);
+    for (unsigned int i = 0; i < order.size(); i++)
+        order[i] = i;
+    for (int i = static_cast<int>(order.size()) - 1; i > 0; i--)
+        std::swap(order[i], order[random.generate(i + 1)]);
+    for (int step = 0; !session.isFinished(); step++) {
+        GuessPoint gp(0, 0);
+        session.playComputerMove(gp);
+        session.playPlayerGuess(order[step] % 10, order[step] / 10, gp);
+        session.endStep();
+    }
+
+    Round round;
+    round.m_seed = session.roundSeed();
+    round.m_rowNo = 10;
+    round.m_colNo = 10;
+    round.m_planeNo = 3;
+    round.m_isComputerFirst = true;
+    round.m_isPlayerWinner = !session.isComputerWinner();
+    const PlaneGridCore* grids[] = { &session.playerGrid(), &session.computerGrid() };
+    for (int k = 0; k < 2; k++) {
+        for (int i = 0; i < 3; i++) {
+            Plane pl;
+            grids[k]->getPlane(i, pl);
+            round.m_planes.push_back(PackedPlane(pl, 10));
+        }
+    }
+    for (unsigned int i = 0; i < session.playerGuesses().size() || i < session.computerGuesses().size(); i++) {
+        if (i < session.computerGuesses().size())
+            round.m_moves.push_back(session.computerGuesses()[i]);
+        if (i < session.playerGuesses().size())
+            round.m_moves.push_back(session.playerGuesses()[i]);
+    }
+
+    ReplayLogWriter writer;
+    check(writer.open("replaylogtest.session.log") && writer.append(session), "a session is appended");
+    writer.close();
+    return round;
+}
+
+}
+
+int main()
+{
+    const std::string path = "replaylogtest.log";
+    std::remove(path.c_str());
+    std::remove(ReplayLog::indexFileName(path).c_str());
+
+    RandomGenerator random(44);
+    RandomScope scope(random);
+    std::vector<Round> rounds;
+    for (int i = 0; i < 600; i++)
+        rounds.push_back(makeRound(random));
+
+    //the rounds are written in blocks of 2 KB
+    ReplayLogWriter writer;
+    check(writer.open(path, 2048), "a new log is opened");
+    for (unsigned int i = 0; i < 400; i++)
+        check(appendRound(writer, rounds[i]), "a round is appended");
+    writer.close();
+
+    check(readLog(path) == std::vector<Round>(rounds.begin(), rounds.begin() + 400), "the rounds are read back");
+    int blockNo = 0;
+    {
+        ReplayLogReader reader;
+        check(reader.open(path), "the log is opened");
+        blockNo = reader.blockNo();
+        check(blockNo > 10, "the log has many blocks");
+        for (int i = 0; i < blockNo; i++)
+            check(reader.block(i).m_offset % 8 == 0 && reader.block(i).m_size <= 2048, "the blocks are aligned and small");
+
+        //the threads of a pool read the same records
+        ThreadPool pool(3);
+        std::vector<Collector> collectors(5);
+        reader.forEachRecordParallel(pool, collectors);
+        std::vector<Round> parallel;
+        for (unsigned int k = 0; k < collectors.size(); k++)
+            parallel.insert(parallel.end(), collectors[k].m_rounds.begin(), collectors[k].m_rounds.end());
+        check(parallel == std::vector<Round>(rounds.begin(), rounds.begin() + 400), "the rounds are read by a pool");
+    }
+
+    //a log opened again keeps its records
+    check(writer.open(path, 2048), "the log is opened again");
+    for (unsigned int i = 400; i < 500; i++)
+        appendRound(writer, rounds[i]);
+    writer.flush();
+    check(readLog(path) == std::vector<Round>(rounds.begin(), rounds.begin() + 500), "the rounds of a flushed log");
+    writer.close();
+
+    //the blocks are found without the index
+    std::remove(ReplayLog::indexFileName(path).c_str());
+    {
+        ReplayLogReader reader;
+        check(reader.open(path) && reader.blockNo() > blockNo, "the blocks are found without the index");
+    }
+    check(readLog(path) == std::vector<Round>(rounds.begin(), rounds.begin() + 500), "the rounds are read without the index");
+
+    //a session is recorded with its moves in order
+    std::remove("replaylogtest.session.log");
+    std::remove(ReplayLog::indexFileName("replaylogtest.session.log").c_str());
+    const Round round = sessionRound(random);
+    const std::vector<Round> sessionRounds = readLog("replaylogtest.session.log");
+    check(sessionRounds.size() == 1 && sessionRounds[0] == round, "the round of a session");
+
+    //a log whose last block was cut by an interrupted write, and whose index
+    //ends in half an entry, keeps its complete blocks; the rounds appended
+    //after it is opened again follow them
+    int lostNo = 0;
+    {
+        ReplayLogReader reader;
+        check(reader.open(path), "the log is opened");
+        lostNo = reader.block(reader.blockNo() - 1).m_recordNo;
+    }
+    cutFile(path, 10);
+    FILE* index = std::fopen(ReplayLog::indexFileName(path).c_str(), "ab");
+    const uint64_t halfEntry = 0;
+    check(index != nullptr && std::fwrite(&halfEntry, sizeof(halfEntry), 1, index) == 1, "half an index entry is written");
+    if (index != nullptr)
+        std::fclose(index);
+    std::vector<Round> kept(rounds.begin(), rounds.begin() + 500 - lostNo);
+    check(readLog(path) == kept, "the complete blocks of a cut log");
+
+    check(writer.open(path, 2048), "a cut log is opened again");
+    for (unsigned int i = 500; i < 600; i++)
+        appendRound(writer, rounds[i]);
+    writer.close();
+    kept.insert(kept.end(), rounds.begin() + 500, rounds.end());
+    check(readLog(path) == kept, "the rounds appended to a repaired log");
+    {
+        ReplayLogReader reader;
+        check(reader.open(path) && fileSize(ReplayLog::indexFileName(path)) ==
+              static_cast<long>(reader.blockNo() * sizeof(ReplayLog::IndexEntry)), "the index of a repaired log");
+    }
+
+    //a file that is not a log is refused
+    {
+        ReplayLogReader reader;
+        check(!reader.open("replaylogtest.session.log.idx"), "a file that is not a log");
+        check(!reader.open("replaylogtest.missing.log"), "a missing log");
+
+        check(reader.open(path), "the log is opened");
+        std::printf("%llu rounds in %d blocks\n", static_cast<unsigned long long>(reader.recordNo()), reader.blockNo());
+    }
+
+    std::remove(path.c_str());
+    std::remove(ReplayLog::indexFileName(path).c_str());
+    std::remove("replaylogtest.session.log");
+    std::remove(ReplayLog::indexFileName("replaylogtest.session.log").c_str());
+
+    std::printf("%s\n", failureNo == 0 ? "passed" : "failed");
+    return failureNo == 0 ? 0 : 1;
+}
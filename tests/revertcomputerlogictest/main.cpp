@@ -0,0 +1,85 @@
+#include "computerlogic.h"
+#include "planegridcore.h"
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+//Checks RevertComputerLogic. The state of a logic that played part of a
+//game is assigned to it: it must then have the whole state of the logic,
+//head data and propagation engine included, and reverting some moves and
+//playing them again must bring that state back. A logic of another grid
+//must not be assigned.
+//
+//usage: RevertComputerLogicTest [games]
+
+namespace {
+
+int failureNo = 0;
+
+void check(bool condition, const char* what)
+{
+    if (!condition && failureNo++ < 10)
+        std::printf("failed: %s\n", what);
+}
+
+std::vector<uint8_t> stateOf(const ComputerLogic& logic)
+{
+    std::vector<uint8_t> state;
+    SnapshotWriter writer(state);
+    logic.saveState(writer);
+    return state;
+}
+
+//plays a game for a number of moves and checks the assignment at each one
+void playGame(int moveNo)
+{
+    PlaneGridCore grid(10, 10, 3, false);
+    grid.initGrid();
+    ComputerLogic logic(10, 10, 3);
+    RevertComputerLogic revert(10, 10, 3);
+
+    for (int i = 0; i < moveNo; i++) {
+        GridPoint qp;
+        if (!logic.makeChoice(qp))
+            break;
+        logic.addData(GuessPoint(qp.x(), qp.y(), grid.getGuessResult(qp)));
+
+        revert = logic;
+        const std::vector<uint8_t> state = stateOf(logic);
+        check(stateOf(revert) == state, "the state is assigned");
+        check(!revert.hasNext() && revert.hasPrev(), "the assigned logic is at its last move");
+
+        const int n = 1 + i / 3;
+        revert.revert(n);
+        check(stateOf(revert) != state, "the moves are reverted");
+        for (int k = 0; k < n; k++)
+            revert.next();
+        check(stateOf(revert) == state, "the moves are played again");
+    }
+}
+
+}
+
+int main(int argc, char* argv[])
+{
+    const int gameNo = argc > 1 ? std::atoi(argv[1]) : 20;
+
+    RandomGenerator random(26);
+    RandomScope scope(random);
+
+    for (int game = 0; game < gameNo; game++)
+        playGame(5 + game);
+
+    //a logic of another grid is not assigned
+    ComputerLogic other(10, 12, 3);
+    GridPoint qp;
+    other.makeChoice(qp);
+    other.addData(GuessPoint(qp.x(), qp.y(), GuessPoint::Miss));
+    RevertComputerLogic revert(10, 10, 3);
+    const std::vector<uint8_t> state = stateOf(revert);
+    revert = other;
+    check(stateOf(revert) == state && !revert.hasNext(), "a logic of another grid is not assigned");
+
+    std::printf("%s\n", failureNo == 0 ? "passed" : "failed");
+    return failureNo == 0 ? 0 : 1;
+}
@@ -0,0 +1,13 @@
+TEMPLATE = app
+CONFIG += console
+CONFIG -= app_bundle
+CONFIG -= qt
+
+SOURCES += main.cpp
+
+win32:CONFIG(release, debug|release): LIBS += -L$$OUT_PWD/../../common/planescore/release/ -lplanescore
+else:win32:CONFIG(debug, debug|release): LIBS += -L$$OUT_PWD/../../common/planescore/debug/ -lplanescore
+else:unix: LIBS += -L$$OUT_PWD/../../common/planescore/ -lplanescore -lpthread
+
+INCLUDEPATH += $$PWD/../../common
+DEPENDPATH += $$PWD/../../common
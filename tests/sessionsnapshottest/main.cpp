@@ -0,0 +1,250 @@
+#include "sessionsnapshot.h"
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+//Checks the snapshots of game sessions. Sessions of several geometries,
+//with an empty slot, are played for a few steps, saved and restored into
+//new sessions: the restored sessions must save the same bytes and go on
+//with the same moves as the originals until their rounds end. A file must
+//give back the same sessions, the sessions already allocated must be reused,
+//and truncated snapshots, a wrong magic or version and a computer
+//logic with a head outside the grid must be refused.
+//
+//usage: SessionSnapshotTest
+
+namespace {
+
+int failureNo = 0;
+
+void check(bool condition, const char* what)
+{
+    if (!condition && failureNo++ < 10)
+        std::printf("failed: %s\n", what);
+}
+
+struct Geometry
+{
+    int m_rowNo;
+    int m_colNo;
+    int m_planeNo;
+    //the steps played before the snapshot, -1 for a round played to its end
+    int m_stepNo;
+};
+
+//the last slot is empty
+const int SessionNo = 6;
+const Geometry geometries[SessionNo - 1] = {
+    { 10, 10, 3, 12 }, { 8, 8, 2, 5 }, { 12, 14, 4, 20 }, { 10, 10, 3, 0 }, { 10, 10, 3, -1 }
+};
+
+//the order of the player's guesses of a session
+std::vector<int> guessOrder(const GameSession& session, uint64_t seed)
+{
+    RandomGenerator random(seed);
+    std::vector<int> order(session.getRowNo() * session.getColNo());
+    for (unsigned int i = 0; i < order.size(); i++)
+        order[i] = i;
+    for (int i = static_cast<int>(order.size()) - 1; i > 0; i--)
+        std::swap(order[i], order[random.generate(i + 1)]);
+    return order;
+}
+
+//plays one step, the player guessing the next cell of its order
+GuessPoint playStep(GameSession& session, const std::vector<int>& order)
+{
+    GuessPoint computerMove(0, 0);
+    session.playComputerMove(computerMove);
+    const int cell = order[session.playerGuesses().size()];
+    GuessPoint gp(0, 0);
+    session.playPlayerGuess(cell % session.getRowNo(), cell / session.getRowNo(), gp);
+    session.endStep();
+    return computerMove;
+}
+
+std::vector<uint8_t> sessionBytes(const GameSession& session)
+{
+    std::vector<uint8_t> buffer;
+    SnapshotWriter writer(buffer);
+    session.saveState(writer);
+    return buffer;
+}
+
+std::vector<uint8_t> logicBytes(const ComputerLogic& logic)
+{
+    std::vector<uint8_t> buffer;
+    SnapshotWriter writer(buffer);
+    logic.saveState(writer);
+    return buffer;
+}
+
+//the offset of the head count in the state of the computer logic
+//the state starts with the choice map, the propagator and the guessed planes
+std::size_t headCountOffset(const ComputerLogic& logic)
+{
+    std::vector<uint8_t> buffer;
+    SnapshotWriter writer(buffer);
+    logic.getChoiceMap().saveState(writer);
+    logic.propagator().saveState(writer);
+    uint16_t planeNo;
+    std::memcpy(&planeNo, logicBytes(logic).data() + buffer.size(), sizeof(planeNo));
+    return buffer.size() + sizeof(uint16_t) * (1 + planeNo);
+}
+
+//whether the state of a computer logic is refused, the restored logic must
+//save the same bytes
+bool isRefused(const std::vector<uint8_t>& state, int rowNo, int colNo, int planeNo)
+{
+    ComputerLogic logic(rowNo, colNo, planeNo);
+    SnapshotReader reader(state.data(), state.size());
+    if (!logic.restoreState(reader))
+        return true;
+    check(reader.remaining() == 0 && logicBytes(logic) == state, "the restored computer logic saves the same bytes");
+    return false;
+}
+
+bool isRefused(const std::vector<uint8_t>& snapshot)
+{
+    std::vector<std::unique_ptr<GameSession> > sessions;
+    return !SessionSnapshot::restore(snapshot.data(), snapshot.size(), sessions);
+}
+
+//the original sessions and those restored from their snapshot give the same
+//moves until the end of their rounds
+void checkLockstep(std::vector<std::unique_ptr<GameSession> >& sessions,
+                   std::vector<std::unique_ptr<GameSession> >& restored)
+{
+    for (unsigned int i = 0; i < sessions.size(); i++) {
+        if (!sessions[i])
+            continue;
+        const std::vector<int> order = guessOrder(*sessions[i], i);
+        int stepNo = 0;
+        while (!sessions[i]->isFinished() && !restored[i]->isFinished()) {
+            const GuessPoint a = playStep(*sessions[i], order);
+            const GuessPoint b = playStep(*restored[i], order);
+            if (a.m_row != b.m_row || a.m_col != b.m_col || a.m_type != b.m_type) {
+                check(false, "the restored session makes the same moves");
+                break;
+            }
+            stepNo++;
+        }
+        check(sessions[i]->isFinished() == restored[i]->isFinished() &&
+              sessions[i]->isComputerWinner() == restored[i]->isComputerWinner(), "the restored round ends the same");
+        check(sessionBytes(*sessions[i]) == sessionBytes(*restored[i]), "the restored session after the round");
+        //the next round draws the same planes
+        sessions[i]->start(true);
+        restored[i]->start(true);
+        check(sessionBytes(*sessions[i]) == sessionBytes(*restored[i]), "the next round of the restored session");
+    }
+}
+
+}
+
+int main()
+{
+    RandomGenerator random(43);
+    RandomScope scope(random);
+
+    std::vector<std::unique_ptr<GameSession> > sessions(SessionNo);
+    for (int i = 0; i < SessionNo - 1; i++) {
+        const Geometry& g = geometries[i];
+        sessions[i].reset(new GameSession(g.m_rowNo, g.m_colNo, g.m_planeNo));
+        sessions[i]->start(i % 2 == 0);
+        const std::vector<int> order = guessOrder(*sessions[i], i);
+        for (int step = 0; (g.m_stepNo < 0 || step < g.m_stepNo) && !sessions[i]->isFinished(); step++)
+            playStep(*sessions[i], order);
+    }
+    check(sessions[SessionNo - 2]->isFinished(), "a round played to its end");
+
+    std::vector<uint8_t> snapshot;
+    SessionSnapshot::save(sessions, snapshot);
+
+    //a round trip through memory
+    std::vector<std::unique_ptr<GameSession> > restored;
+    check(SessionSnapshot::restore(snapshot.data(), snapshot.size(), restored), "the snapshot is restored");
+    check(restored.size() == sessions.size(), "the number of slots");
+    for (unsigned int i = 0; i < restored.size() && i < sessions.size(); i++) {
+        if (!sessions[i]) {
+            check(!restored[i], "an empty slot");
+            continue;
+        }
+        check(restored[i] && restored[i]->getRowNo() == sessions[i]->getRowNo() &&
+              restored[i]->getColNo() == sessions[i]->getColNo() &&
+              restored[i]->getPlaneNo() == sessions[i]->getPlaneNo(), "the geometry of a session");
+        if (restored[i])
+            check(sessionBytes(*restored[i]) == sessionBytes(*sessions[i]), "the restored session saves the same bytes");
+    }
+    std::vector<uint8_t> again;
+    SessionSnapshot::save(restored, again);
+    check(again == snapshot, "the restored sessions save the same snapshot");
+
+    //the sessions that are already allocated are reused
+    const GameSession* first = restored[0].get();
+    check(SessionSnapshot::restore(snapshot.data(), snapshot.size(), restored) && restored[0].get() == first,
+          "the allocated sessions are reused");
+
+    //a round trip through a file
+    const std::string path = "sessionsnapshottest.snapshot";
+    std::vector<std::unique_ptr<GameSession> > fromFile;
+    check(SessionSnapshot::write(path, sessions), "the snapshot file is written");
+    check(SessionSnapshot::read(path, fromFile), "the snapshot file is read");
+    std::vector<uint8_t> fileSnapshot;
+    SessionSnapshot::save(fromFile, fileSnapshot);
+    check(fileSnapshot == snapshot, "the sessions of the file");
+    std::remove(path.c_str());
+    check(!SessionSnapshot::read(path, fromFile), "a missing file");
+
+    //a wrong header and truncated snapshots are refused
+    std::vector<uint8_t> bad = snapshot;
+    bad[0] ^= 1;
+    check(isRefused(bad), "a wrong magic");
+    bad = snapshot;
+    bad[4] += 1;
+    check(isRefused(bad), "a wrong version");
+    bad = snapshot;
+    bad[8] = 0xff;
+    check(isRefused(bad), "more sessions than the bytes");
+    int acceptedNo = 0;
+    for (std::size_t size = 0; size < snapshot.size(); size++) {
+        std::vector<uint8_t> truncated(snapshot.begin(), snapshot.begin() + size);
+        if (!isRefused(truncated))
+            acceptedNo++;
+    }
+    check(acceptedNo == 0, "the truncated snapshots are refused");
+
+    //a head of the computer logic outside the grid is refused
+    //the head of a plane with an unknown orientation is kept in the head data
+    ComputerLogic logic(10, 10, 3);
+    logic.addData(GuessPoint(5, 5, GuessPoint::Dead));
+    const std::vector<uint8_t> logicState = logicBytes(logic);
+    const std::size_t headCount = headCountOffset(logic);
+    uint16_t headNo;
+    std::memcpy(&headNo, logicState.data() + headCount, sizeof(headNo));
+    check(headNo == 1, "the computer logic has head data");
+    check(isRefused(logicState, 10, 10, 3) == false, "the state of the computer logic is restored");
+    std::vector<uint8_t> badLogic = logicState;
+    const uint16_t head = 10 * 10;
+    std::memcpy(badLogic.data() + headCount + sizeof(uint16_t), &head, sizeof(head));
+    check(isRefused(badLogic, 10, 10, 3), "a head outside the grid");
+    badLogic = logicState;
+    badLogic[headCount + 2 * sizeof(uint16_t)] = 4;
+    check(isRefused(badLogic, 10, 10, 3), "an orientation that does not exist");
+    //the points not tested of the first orientation that has some
+    std::size_t at = headCount + 2 * sizeof(uint16_t) + sizeof(int8_t);
+    for (int k = 0; k < 4 && logicState[at + 1] == 0; k++)
+        at += 2;
+    check(logicState[at + 1] > 0, "the head data has points not tested");
+    badLogic = logicState;
+    std::memcpy(badLogic.data() + at + 2, &head, sizeof(head));
+    check(isRefused(badLogic, 10, 10, 3), "a point not tested outside the grid");
+
+    std::printf("%d sessions, %u bytes\n", SessionNo, static_cast<unsigned int>(snapshot.size()));
+
+    //the restored sessions go on as the originals
+    std::vector<std::unique_ptr<GameSession> > lockstep;
+    SessionSnapshot::restore(snapshot.data(), snapshot.size(), lockstep);
+    checkLockstep(sessions, lockstep);
+
+    std::printf("%s\n", failureNo == 0 ? "passed" : "failed");
+    return failureNo == 0 ? 0 : 1;
+}
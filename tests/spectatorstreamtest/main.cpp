@@ -0,0 +1,237 @@
+#include "gamesession.h"
+#include "spectatorstream.h"
+#include "wireprotocol.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+//Checks that a spectator rebuilds a game from the frames of a SpectatorStream.
+//A viewer decodes the frames like a remote client: it takes both boards,
+//the flags and the statistics from the keyframes and applies the deltas
+//that follow them in sequence. After every step of every round each viewer
+//that is in sync must have the boards, the flags and the statistics of the
+//session. The viewers cover a subscriber from the start, one that misses
+//every 17th frame and catches up at the next keyframe, late subscribers,
+//an unsubscribe, and a session restored from a snapshot. The viewers that
+//subscribed together must receive the same buffers.
+//
+//usage: SpectatorStreamTest [rows cols planes [games]]
+
+namespace {
+
+struct Viewer: public SpectatorSubscriber
+{
+    int m_rowNo;
+    int m_colNo;
+    int m_flags;
+    int m_sequence;
+    //whether the viewer has a keyframe and all the deltas after it
+    bool m_isSynced;
+    std::vector<int> m_cells;
+    GameStatistics m_stats;
+    //every dropEvery-th frame is lost, none if 0
+    int m_dropEvery;
+    //the keyframes that brought the viewer in sync after a lost frame
+    int m_resyncNo;
+    int m_frameNo;
+    int m_errorNo;
+    //the buffer of the last frame received
+    const void* m_lastBuffer;
+
+    Viewer(): m_rowNo(0), m_colNo(0), m_flags(0), m_sequence(-1), m_isSynced(false),
+        m_dropEvery(0), m_resyncNo(0), m_frameNo(0), m_errorNo(0), m_lastBuffer(nullptr) {}
+
+    void deliver(const SpectatorFrame& frame) override
+    {
+        m_lastBuffer = frame.get();
+        m_frameNo++;
+        if (m_dropEvery != 0 && m_frameNo % m_dropEvery == 0) {
+            m_isSynced = false;
+            return;
+        }
+
+        WireReader reader(frame->data(), static_cast<int>(frame->size()));
+        WireMessage message;
+        bool hasHead = false;
+        while (reader.next(message)) {
+            switch (message.m_type) {
+            case WireProtocol::Keyframe:
+                m_rowNo = message.m_args[0];
+                m_colNo = message.m_args[1];
+                m_flags = message.m_args[3];
+                m_cells.assign(2 * m_rowNo * m_colNo, 0);
+                for (int board = 0; board < 2; board++)
+                    for (int cell = 0; cell < m_rowNo * m_colNo; cell++)
+                        m_cells[board * m_rowNo * m_colNo + cell] = message.cell(board, cell);
+                m_sequence = message.m_sequence;
+                if (!m_isSynced && m_frameNo > 1)
+                    m_resyncNo++;
+                m_isSynced = true;
+                hasHead = true;
+                break;
+            case WireProtocol::Delta:
+                //a missed frame: wait for the next keyframe
+                if (!m_isSynced || message.m_sequence != m_sequence + 1) {
+                    m_isSynced = false;
+                    return;
+                }
+                m_sequence = message.m_sequence;
+                hasHead = true;
+                break;
+            case WireProtocol::Statistics:
+                m_stats = message.m_stats;
+                break;
+            case WireProtocol::StatisticsDelta:
+                m_stats.m_playerMoves += message.m_stats.m_playerMoves;
+                m_stats.m_playerHits += message.m_stats.m_playerHits;
+                m_stats.m_playerDead += message.m_stats.m_playerDead;
+                m_stats.m_playerMisses += message.m_stats.m_playerMisses;
+                m_stats.m_computerMoves += message.m_stats.m_computerMoves;
+                m_stats.m_computerHits += message.m_stats.m_computerHits;
+                m_stats.m_computerDead += message.m_stats.m_computerDead;
+                m_stats.m_computerMisses += message.m_stats.m_computerMisses;
+                m_stats.m_playerWins += message.m_stats.m_playerWins;
+                m_stats.m_computerWins += message.m_stats.m_computerWins;
+                break;
+            case WireProtocol::ComputerMove:
+                m_cells[message.m_guess.m_col * m_rowNo + message.m_guess.m_row] = message.m_guess.m_type + 1;
+                break;
+            case WireProtocol::GuessResult:
+                m_cells[m_rowNo * m_colNo + message.m_guess.m_col * m_rowNo + message.m_guess.m_row] = message.m_guess.m_type + 1;
+                break;
+            case WireProtocol::RoundEnded:
+                m_flags |= 2 | (message.m_args[0] ? 4 : 0);
+                break;
+            default:
+                m_errorNo++;
+                break;
+            }
+        }
+        //a frame starts with a keyframe or a delta
+        if (reader.hasError() || !hasHead)
+            m_errorNo++;
+    }
+};
+
+bool sameStatistics(const GameStatistics& a, const GameStatistics& b)
+{
+    return a.m_playerMoves == b.m_playerMoves && a.m_playerHits == b.m_playerHits &&
+           a.m_playerDead == b.m_playerDead && a.m_playerMisses == b.m_playerMisses &&
+           a.m_computerMoves == b.m_computerMoves && a.m_computerHits == b.m_computerHits &&
+           a.m_computerDead == b.m_computerDead && a.m_computerMisses == b.m_computerMisses &&
+           a.m_playerWins == b.m_playerWins && a.m_computerWins == b.m_computerWins;
+}
+
+//whether a viewer in sync has the state of the session
+bool matches(const Viewer& viewer, const GameSession& session)
+{
+    if (!viewer.m_isSynced)
+        return true;
+
+    const int cellNo = session.getRowNo() * session.getColNo();
+    std::vector<int> cells(2 * cellNo, 0);
+    for (unsigned int i = 0; i < session.computerGuesses().size(); i++)
+        cells[session.computerGuesses()[i].cell()] = session.computerGuesses()[i].type() + 1;
+    for (unsigned int i = 0; i < session.playerGuesses().size(); i++)
+        cells[cellNo + session.playerGuesses()[i].cell()] = session.playerGuesses()[i].type() + 1;
+    const int flags = (session.isComputerFirst() ? 1 : 0) | (session.isFinished() ? 2 : 0) |
+                      (session.isComputerWinner() ? 4 : 0);
+    return cells == viewer.m_cells && viewer.m_flags == flags && sameStatistics(viewer.m_stats, session.stats());
+}
+
+}
+
+int main(int argc, char* argv[])
+{
+    int rowNo = 10, colNo = 10, planeNo = 3, gameNo = 200;
+    if (argc != 1 && argc != 4 && argc != 5) {
+        std::fprintf(stderr, "usage: %s [rows cols planes [games]]\n", argv[0]);
+        return 1;
+    }
+    if (argc >= 4) {
+        rowNo = std::atoi(argv[1]);
+        colNo = std::atoi(argv[2]);
+        planeNo = std::atoi(argv[3]);
+    }
+    if (argc == 5)
+        gameNo = std::atoi(argv[4]);
+
+    //the session draws its seed from the shared generator
+    RandomGenerator random(2024);
+    RandomScope scope(random);
+    GameSession session(rowNo, colNo, planeNo);
+    SpectatorStream stream(32);
+    std::vector<Viewer> viewers(4);
+    viewers[1].m_dropEvery = 17;
+    session.setSpectatorStream(&stream);
+    stream.subscribe(&viewers[0]);
+    stream.subscribe(&viewers[1]);
+
+    int checkNo = 0;
+    int mismatchNo = 0;
+    int unsharedNo = 0;
+    std::vector<int> order(rowNo * colNo);
+    for (int game = 0; game < gameNo; game++) {
+        session.start(game % 2 != 0);
+        //late subscribers, then a round restored from a snapshot
+        if (game == 3) {
+            stream.subscribe(&viewers[2]);
+            stream.subscribe(&viewers[3]);
+        }
+        if (game == 5) {
+            std::vector<uint8_t> buffer;
+            SnapshotWriter writer(buffer);
+            session.saveState(writer);
+            SnapshotReader reader(buffer.data(), buffer.size());
+            if (!session.restoreState(reader)) {
+                std::printf("the session was not restored\n");
+                return 1;
+            }
+        }
+
+        for (unsigned int i = 0; i < order.size(); i++)
+            order[i] = i;
+        for (int i = static_cast<int>(order.size()) - 1; i > 0; i--)
+            std::swap(order[i], order[random.generate(i + 1)]);
+
+        int next = 0;
+        while (!session.isFinished()) {
+            GuessPoint gp(0, 0);
+            session.playComputerMove(gp);
+            const int cell = order[next++];
+            session.playPlayerGuess(cell % rowNo, cell / rowNo, gp);
+            session.endStep();
+            for (unsigned int i = 0; i < viewers.size(); i++) {
+                checkNo++;
+                if (!matches(viewers[i], session) && mismatchNo++ < 5)
+                    std::printf("game %d: viewer %u differs from the session\n", game, i);
+            }
+            if (game >= 3 && viewers[2].m_lastBuffer != viewers[3].m_lastBuffer)
+                unsharedNo++;
+        }
+
+        //an unsubscribed viewer receives nothing more
+        if (game == gameNo / 2) {
+            stream.unsubscribe(&viewers[0]);
+            viewers[0].m_isSynced = false;
+        }
+    }
+
+    int errorNo = 0;
+    for (unsigned int i = 0; i < viewers.size(); i++)
+        errorNo += viewers[i].m_errorNo;
+    //the viewer that misses frames catches up at the keyframes
+    const bool resynced = viewers[1].m_resyncNo > 0;
+    const SpectatorStream::Metrics& metrics = stream.metrics();
+    std::printf("%d games, %d checks, %d mismatches, %d decoding errors, %d frames not shared, %d resyncs\n",
+                gameNo, checkNo, mismatchNo, errorNo, unsharedNo, viewers[1].m_resyncNo);
+    std::printf("frames %llu, keyframes %llu, %.1f bytes per frame, %llu deliveries\n",
+                static_cast<unsigned long long>(metrics.m_frames), static_cast<unsigned long long>(metrics.m_keyframes),
+                metrics.m_frames > 0 ? static_cast<double>(metrics.m_bytes) / metrics.m_frames : 0.0,
+                static_cast<unsigned long long>(metrics.m_deliveries));
+
+    const bool passed = checkNo > 0 && mismatchNo == 0 && errorNo == 0 && unsharedNo == 0 && resynced;
+    std::printf("%s\n", passed ? "passed" : "failed");
+    return passed ? 0 : 1;
+}
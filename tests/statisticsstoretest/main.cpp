@@ -0,0 +1,216 @@
+#include "statisticsstore.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <map>
+#include <vector>
+
+//Checks the statistics store. Random rows spanning several query blocks are
+//written to the columns of a store in the current directory and read back;
+//the means and the percentiles of the queries, grouped and filtered, with
+//and without a pool, must be those computed from the rows one by one. A
+//store whose last rows were not written to every column must drop them, and
+//the rows appended after it is opened again must follow the complete ones.
+//
+//usage: StatisticsStoreTest
+
+namespace {
+
+int failureNo = 0;
+
+void check(bool condition, const char* what)
+{
+    if (!condition && failureNo++ < 10)
+        std::printf("failed: %s\n", what);
+}
+
+StatisticsRow makeRow(RandomGenerator& random)
+{
+    static const int sizes[] = { 8, 10, 12 };
+    StatisticsRow row;
+    for (int c = 0; c < StatisticsStore::ColumnNo; c++)
+        row.m_values[c] = random.generate(200);
+    row.m_values[StatisticsStore::RowNo] = sizes[random.generate(3)];
+    row.m_values[StatisticsStore::ColNo] = sizes[random.generate(2)];
+    row.m_values[StatisticsStore::PlaneNo] = 2 + random.generate(2);
+    row.m_values[StatisticsStore::Strategy] = random.generate(4);
+    row.m_values[StatisticsStore::ComputerWinner] = random.generate(2);
+    row.m_values[StatisticsStore::Duration] = random.generate(100000) - 50;
+    return row;
+}
+
+void removeStore()
+{
+    for (int c = 0; c < StatisticsStore::ColumnNo; c++)
+        std::remove(StatisticsStore::columnFileName(".", c).c_str());
+}
+
+//whether the store has the rows
+bool hasRows(const StatisticsReader& reader, const std::vector<StatisticsRow>& rows)
+{
+    if (reader.rowNo() != static_cast<int64_t>(rows.size()))
+        return false;
+    for (int c = 0; c < StatisticsStore::ColumnNo; c++)
+        for (unsigned int i = 0; i < rows.size(); i++)
+            if (reader.column(c)[i] != rows[i].m_values[c])
+                return false;
+    return true;
+}
+
+//the value at a percentile, nearest rank
+int32_t percentile(std::vector<int32_t> values, double rank)
+{
+    std::sort(values.begin(), values.end());
+    int64_t n = static_cast<int64_t>(std::ceil(rank / 100.0 * values.size()));
+    n = std::max<int64_t>(1, std::min<int64_t>(n, values.size()));
+    return values[n - 1];
+}
+
+//checks a query against the rows taken one by one
+void checkQuery(const StatisticsReader& reader, const std::vector<StatisticsRow>& rows,
+                const std::vector<int>& groupColumns, int filterColumn, int32_t filterValue,
+                int valueColumn, ThreadPool* pool)
+{
+    StatisticsQuery query(reader);
+    for (unsigned int i = 0; i < groupColumns.size(); i++)
+        query.addGroupColumn(groupColumns[i]);
+    if (filterColumn >= 0)
+        query.setFilter(filterColumn, filterValue);
+
+    //the values of each group, by the values of the group columns
+    std::map<std::vector<int32_t>, std::vector<int32_t> > expected;
+    for (unsigned int i = 0; i < rows.size(); i++) {
+        if (filterColumn >= 0 && rows[i].m_values[filterColumn] != filterValue)
+            continue;
+        std::vector<int32_t> key;
+        for (unsigned int k = 0; k < groupColumns.size(); k++)
+            key.push_back(rows[i].m_values[groupColumns[k]]);
+        expected[key].push_back(rows[i].m_values[valueColumn]);
+    }
+
+    std::vector<double> ranks;
+    ranks.push_back(0);
+    ranks.push_back(10);
+    ranks.push_back(50);
+    ranks.push_back(99.5);
+    ranks.push_back(100);
+    const std::vector<StatisticsGroup> means = query.mean(valueColumn, pool);
+    const std::vector<StatisticsGroup> groups = query.percentiles(valueColumn, ranks, pool);
+    check(means.size() == expected.size() && groups.size() == expected.size(), "the number of groups");
+
+    for (unsigned int g = 0; g < groups.size() && g < means.size(); g++) {
+        std::vector<int32_t> key;
+        for (unsigned int k = 0; k < groupColumns.size(); k++)
+            key.push_back(query.keyValue(groups[g].m_key, k));
+        const std::map<std::vector<int32_t>, std::vector<int32_t> >::const_iterator it = expected.find(key);
+        if (it == expected.end()) {
+            check(false, "the key of a group");
+            continue;
+        }
+        int64_t sum = 0;
+        for (unsigned int i = 0; i < it->second.size(); i++)
+            sum += it->second[i];
+        check(means[g].m_key == groups[g].m_key, "the order of the groups");
+        check(means[g].m_count == static_cast<int64_t>(it->second.size()) && means[g].m_sum == sum, "the mean of a group");
+        check(groups[g].m_count == means[g].m_count && groups[g].m_sum == sum, "the count of a group");
+        bool same = groups[g].m_percentiles.size() == ranks.size();
+        for (unsigned int r = 0; r < ranks.size() && same; r++)
+            same = groups[g].m_percentiles[r] == percentile(it->second, ranks[r]);
+        check(same, "the percentiles of a group");
+    }
+}
+
+//removes the last bytes of a column, as an interrupted write would leave it
+void cutColumn(int column, int byteNo)
+{
+    const std::string path = StatisticsStore::columnFileName(".", column);
+    std::vector<char> data;
+    FILE* file = std::fopen(path.c_str(), "rb");
+    if (file != nullptr) {
+        char buffer[4096];
+        std::size_t n;
+        while ((n = std::fread(buffer, 1, sizeof(buffer), file)) > 0)
+            data.insert(data.end(), buffer, buffer + n);
+        std::fclose(file);
+    }
+    file = std::fopen(path.c_str(), "wb");
+    check(file != nullptr && data.size() > static_cast<std::size_t>(byteNo) &&
+          std::fwrite(data.data(), 1, data.size() - byteNo, file) == data.size() - byteNo, "the column is cut");
+    if (file != nullptr)
+        std::fclose(file);
+}
+
+}
+
+int main()
+{
+    removeStore();
+
+    //more than two blocks of the queries
+    RandomGenerator random(45);
+    std::vector<StatisticsRow> rows;
+    for (int i = 0; i < 2 * StatisticsQuery::BlockSize + 1000; i++)
+        rows.push_back(makeRow(random));
+
+    StatisticsWriter writer;
+    check(writer.open(".", 1000), "a new store is opened");
+    for (unsigned int i = 0; i < rows.size(); i++)
+        check(writer.append(rows[i]), "a row is appended");
+    writer.close();
+
+    {
+        StatisticsReader reader;
+        check(reader.open(".") && hasRows(reader, rows), "the rows are read back");
+
+        ThreadPool pool(3);
+        std::vector<int> none;
+        std::vector<int> geometry;
+        geometry.push_back(StatisticsStore::RowNo);
+        geometry.push_back(StatisticsStore::ColNo);
+        geometry.push_back(StatisticsStore::PlaneNo);
+        std::vector<int> strategy(1, StatisticsStore::Strategy);
+        std::vector<int> winner(1, StatisticsStore::ComputerWinner);
+
+        checkQuery(reader, rows, none, -1, 0, StatisticsStore::Duration, nullptr);
+        checkQuery(reader, rows, geometry, -1, 0, StatisticsStore::ComputerMoves, nullptr);
+        checkQuery(reader, rows, geometry, -1, 0, StatisticsStore::ComputerMoves, &pool);
+        checkQuery(reader, rows, strategy, StatisticsStore::PlaneNo, 3, StatisticsStore::Duration, &pool);
+        checkQuery(reader, rows, winner, StatisticsStore::Strategy, 2, StatisticsStore::Duration, nullptr);
+        //a filter that no row passes
+        checkQuery(reader, rows, winner, StatisticsStore::RowNo, 9, StatisticsStore::Duration, &pool);
+
+        StatisticsQuery query(reader);
+        bool added = true;
+        for (int i = 0; i < StatisticsQuery::MaxGroupColumnNo; i++)
+            added = added && query.addGroupColumn(i);
+        check(added && !query.addGroupColumn(StatisticsStore::Duration), "the group columns are limited");
+    }
+
+    //the rows of an interrupted write are dropped when the store is opened again
+    cutColumn(StatisticsStore::Duration, 10);
+    rows.resize(rows.size() - 3);
+    {
+        StatisticsReader reader;
+        check(reader.open(".") && hasRows(reader, rows), "the complete rows of a cut store");
+    }
+    check(writer.open(".", 1000), "a cut store is opened again");
+    for (int i = 0; i < 500; i++) {
+        rows.push_back(makeRow(random));
+        writer.append(rows.back());
+    }
+    writer.close();
+    {
+        StatisticsReader reader;
+        check(reader.open(".") && hasRows(reader, rows), "the rows appended to a repaired store");
+        std::printf("%lld rows\n", static_cast<long long>(reader.rowNo()));
+    }
+
+    //a missing column
+    std::remove(StatisticsStore::columnFileName(".", StatisticsStore::Strategy).c_str());
+    StatisticsReader reader;
+    check(!reader.open("."), "a store with a missing column");
+    removeStore();
+
+    std::printf("%s\n", failureNo == 0 ? "passed" : "failed");
+    return failureNo == 0 ? 0 : 1;
+}
@@ -0,0 +1,145 @@
+#include "strategypolicies.h"
+#include "planegridcore.h"
+#include <cstdio>
+#include <cstdlib>
+
+//Checks the mixes of policies. During games against boards with random
+//planes, the classic strategy must choose the move of its first version,
+//which evaluated every policy, and leave the generator in the same state.
+//A mix must play the policy its weights select and fall back to the next
+//ones when that policy has no move.
+//
+//usage: StrategyTest [games]
+
+namespace {
+
+int failureNo = 0;
+
+void check(bool condition, const char* what)
+{
+    if (!condition && failureNo++ < 10)
+        std::printf("failed: %s\n", what);
+}
+
+//the classic strategy as it was first written, evaluating every policy
+bool chooseClassic(const ComputerLogic& logic, GridPoint& qp)
+{
+    GridPoint head;
+    if (!FindHeadPolicy::choose(logic, head))
+        return false;
+
+    const int idx = Plane::generateRandomNumber(10);
+    if (idx < 6) {
+        qp = head;
+        return true;
+    }
+
+    GridPoint position, random;
+    const bool hasPosition = FindPositionPolicy::choose(logic, position);
+    const bool hasRandom = RandomPolicy::choose(logic, random);
+    if (hasPosition && hasRandom)
+        qp = idx < 9 ? position : random;
+    else if (hasRandom)
+        qp = idx < 7 ? head : random;
+    else if (hasPosition)
+        qp = idx < 7 ? head : position;
+    else
+        qp = head;
+    return true;
+}
+
+//chooses a move with a strategy and a generator in a given state
+bool choose(const ComputerStrategy* strategy, const ComputerLogic& logic, uint64_t state, GridPoint& qp,
+            uint64_t& nextState)
+{
+    RandomGenerator random(state);
+    RandomScope scope(random);
+    const bool found = strategy != nullptr ? strategy->choose(logic, qp) : chooseClassic(logic, qp);
+    nextState = random.state();
+    return found;
+}
+
+//plays a game with the classic strategy, comparing each move with the first version
+//returns the number of moves
+int playGame(RandomGenerator& random)
+{
+    PlaneGridCore grid(10, 10, 3, false);
+    grid.initGrid();
+    ComputerLogic logic(10, 10, 3);
+    const ClassicStrategy classic;
+
+    int moveNo = 0;
+    int deadNo = 0;
+    while (deadNo < 3 && moveNo < 100) {
+        const uint64_t state = random.state();
+        GridPoint expected, qp;
+        uint64_t expectedState, nextState;
+        const bool hasExpected = choose(nullptr, logic, state, expected, expectedState);
+        const bool found = choose(&classic, logic, state, qp, nextState);
+        check(found == hasExpected && (!found || qp == expected) && nextState == expectedState,
+              "the classic strategy plays the move of its first version");
+        if (!found)
+            break;
+
+        const GuessPoint::Type type = grid.getGuessResult(qp);
+        logic.addData(GuessPoint(qp.x(), qp.y(), type));
+        deadNo += type == GuessPoint::Dead;
+        moveNo++;
+        random.setState(nextState);
+    }
+    check(deadNo == 3, "the classic strategy finds every plane");
+    return moveNo;
+}
+
+//checks the fallbacks of the mixes at the start of a game, where find
+//position has no head to test
+void checkMixes()
+{
+    ComputerLogic logic(10, 10, 3);
+    GridPoint qp, expected;
+    uint64_t state, expectedState;
+
+    const MixedStrategy<FindPositionPolicy> alone({ 1 });
+    check(!choose(&alone, logic, 5, qp, state), "a mix without a move");
+
+    //a draw that selects find position goes on with find head
+    const MixedStrategy<FindPositionPolicy, FindHeadPolicy> fallback({ 1, 0 });
+    const PolicyStrategy<FindHeadPolicy> head;
+    RandomGenerator random(5);
+    random.generate(1);
+    choose(&head, logic, random.state(), expected, expectedState);
+    check(choose(&fallback, logic, 5, qp, state) && qp == expected && state == expectedState,
+          "a mix falls back to the next policy");
+
+    //without weights the first policy is played, without a draw
+    const MixedStrategy<FindHeadPolicy, RandomPolicy> unweighted({ 0, 0 });
+    choose(&head, logic, 5, expected, expectedState);
+    check(choose(&unweighted, logic, 5, qp, state) && qp == expected && state == expectedState,
+          "a mix without weights plays its first policy");
+
+    //a draw that selects random evaluates only random
+    const MixedStrategy<FindHeadPolicy, RandomPolicy> randomOnly({ 0, 1 });
+    const PolicyStrategy<RandomPolicy> randomPolicy;
+    choose(&randomPolicy, logic, random.state(), expected, expectedState);
+    check(choose(&randomOnly, logic, 5, qp, state) && qp == expected && state == expectedState,
+          "a mix plays the policy of its draw");
+}
+
+}
+
+int main(int argc, char* argv[])
+{
+    const int gameNo = argc > 1 ? std::atoi(argv[1]) : 100;
+
+    RandomGenerator random(29);
+    RandomScope scope(random);
+
+    checkMixes();
+    int moveNo = 0;
+    for (int game = 0; game < gameNo; game++)
+        moveNo += playGame(random);
+    std::printf("%d games, %.1f moves per game\n", gameNo, gameNo > 0 ? static_cast<double>(moveNo) / gameNo : 0.0);
+
+    std::printf("%s\n", failureNo == 0 ? "passed" : "failed");
+    return failureNo == 0 ? 0 : 1;
+}
@@ -0,0 +1,19 @@
+TEMPLATE = subdirs
+
+SUBDIRS = wireprotocoltest \
+    sessionsnapshottest \
+    replaylogtest \
+    statisticsstoretest \
+    textenginetest \
+    gameanalyzertest \
+    boardpooltest \
+    spectatorstreamtest \
+    strategytest \
+    planepropagatortest \
+    endgamesolvertest \
+    revertcomputerlogictest \
+    expertsearchtest \
+    choicekernelstest
+
+#the game server uses Linux sockets and epoll
+linux: SUBDIRS += gameservertest
@@ -0,0 +1,198 @@
+#include "textengine.h"
+#include "planegridcore.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+//Checks the text protocol of the engine with transcripts of commands: the
+//answers of the commands and of the invalid ones, the same moves for the
+//same seed, and whole games against boards with random planes, in which
+//every move must be new and every plane must be found. After a game the
+//points the engine inferred from the results must still take a result.
+//
+//usage: TextEngineTest [games]
+
+namespace {
+
+int failureNo = 0;
+
+void check(bool condition, const char* what)
+{
+    if (!condition && failureNo++ < 10)
+        std::printf("failed: %s\n", what);
+}
+
+//the words of the results, by GuessPoint::Type
+const char* const resultNames[] = { "miss", "hit", "dead" };
+
+//sends a line to the engine, returns its answer
+std::string send(TextEngine& engine, const char* line)
+{
+    std::vector<char> buffer(line, line + std::strlen(line) + 1);
+    engine.handleLine(buffer.data());
+    return std::string(engine.output(), engine.outputSize());
+}
+
+bool startsWith(const std::string& text, const char* prefix)
+{
+    return text.compare(0, std::strlen(prefix), prefix) == 0;
+}
+
+bool endsWith(const std::string& text, const char* suffix)
+{
+    const std::size_t n = std::strlen(suffix);
+    return text.size() >= n && text.compare(text.size() - n, n, suffix) == 0;
+}
+
+//the move of an answer to go, false for "bestmove none"
+bool bestMove(const std::string& answer, int& row, int& col)
+{
+    const std::size_t at = answer.find("bestmove ");
+    check(startsWith(answer, "info time ") && at != std::string::npos && endsWith(answer, "\n"), "the answer of go");
+    return at != std::string::npos && std::sscanf(answer.c_str() + at, "bestmove %d %d", &row, &col) == 2;
+}
+
+//the answers to commands without a game
+void checkCommands(TextEngine& engine)
+{
+    const std::string identity = send(engine, "planes");
+    check(startsWith(identity, "id name PlanesEngine\n") && identity.find("\noption strategy ") != std::string::npos &&
+          endsWith(identity, "planesok\n"), "planes");
+    check(send(engine, "isready") == "readyok\n", "isready");
+    check(send(engine, "") == "" && send(engine, "  \t ") == "", "an empty line");
+    check(send(engine, "jump 1 2") == "error unknown command jump\n", "an unknown command");
+    check(startsWith(send(engine, "go 1 2 3 4 5 6 7 8 9"), "error too many words"), "too many words");
+
+    check(startsWith(send(engine, "newgame 10 10"), "error usage: newgame"), "newgame without planes");
+    check(startsWith(send(engine, "newgame 0 10 3"), "error usage: newgame"), "newgame with no rows");
+    check(startsWith(send(engine, "newgame 10 128 3"), "error usage: newgame"), "newgame with too many columns");
+    check(startsWith(send(engine, "newgame 10 10 3 x"), "error usage: newgame"), "newgame with a bad seed");
+    check(send(engine, "newgame 10 10 3 7") == "ok\n", "newgame");
+
+    check(startsWith(send(engine, "result 10 0 miss"), "error usage: result"), "a result outside the grid");
+    check(startsWith(send(engine, "result 0 0 sunk"), "error usage: result"), "an unknown result");
+    check(send(engine, "result 0 0 miss") == "ok\n", "a result");
+    check(send(engine, "result 0 0 hit") == "error point already guessed\n", "a result given twice");
+
+    check(startsWith(send(engine, "go movetime"), "error usage: go"), "go without a time");
+    check(startsWith(send(engine, "go wait 5"), "error usage: go"), "go with an unknown option");
+    check(startsWith(send(engine, "setoption strategy none"), "error unknown strategy none"), "an unknown strategy");
+    check(startsWith(send(engine, "setoption weight"), "error usage: setoption"), "setoption without a value");
+
+    //eval gives a line for each row of both tables
+    check(send(engine, "newgame 6 9 1 3") == "ok\n", "newgame on another grid");
+    const std::string eval = send(engine, "eval");
+    int lineNo = 0;
+    for (std::size_t i = 0; i < eval.size(); i++)
+        lineNo += eval[i] == '\n';
+    check(startsWith(eval, "info guesses 0 ") && eval.find("\ndead 5 ") != std::string::npos &&
+          eval.find("\nhit 0 ") != std::string::npos && endsWith(eval, "evalend\n") && lineNo == 2 + 2 * 6, "eval");
+
+    int row, col;
+    check(bestMove(send(engine, "go movetime 50"), row, col) && row >= 0 && row < 6 && col >= 0 && col < 9, "go movetime");
+}
+
+//the moves of a game without results, the same for the same seed
+std::string moves(TextEngine& engine, const char* newGame)
+{
+    send(engine, newGame);
+    std::string text;
+    for (int i = 0; i < 5; i++) {
+        const std::string answer = send(engine, "go");
+        text += answer.substr(answer.find("bestmove"));
+        int row = 0, col = 0;
+        bestMove(answer, row, col);
+        char line[64];
+        std::snprintf(line, sizeof(line), "result %d %d miss", row, col);
+        send(engine, line);
+    }
+    return text;
+}
+
+//plays a game against a board, returns the number of moves
+//the points the logic inferred can still be given a result
+int playGame(TextEngine& engine, int rowNo, int colNo, int planeNo, int seed, int& inferredNo)
+{
+    PlaneGridCore grid(rowNo, colNo, planeNo, false);
+    grid.initGrid();
+
+    char line[64];
+    std::snprintf(line, sizeof(line), "newgame %d %d %d %d", rowNo, colNo, planeNo, seed);
+    check(send(engine, line) == "ok\n", "newgame of a game");
+
+    std::vector<bool> isGuessed(rowNo * colNo, false);
+    int deadNo = 0;
+    int moveNo = 0;
+    while (deadNo < planeNo && moveNo < rowNo * colNo) {
+        int row = 0, col = 0;
+        if (!bestMove(send(engine, "go"), row, col)) {
+            check(false, "a move while planes are left");
+            break;
+        }
+        if (row < 0 || row >= rowNo || col < 0 || col >= colNo || isGuessed[col * rowNo + row]) {
+            check(false, "a new move inside the grid");
+            break;
+        }
+        isGuessed[col * rowNo + row] = true;
+        moveNo++;
+
+        const GuessPoint::Type type = grid.getGuessResult(GridPoint(row, col));
+        std::snprintf(line, sizeof(line), "result %d %d %s", row, col, resultNames[type]);
+        check(send(engine, line) == "ok\n", "the result of a move");
+        if (type == GuessPoint::Dead)
+            deadNo++;
+    }
+    check(deadNo == planeNo, "every plane is found");
+
+    //a logic given the same results tells which points were inferred
+    ComputerLogic logic(rowNo, colNo, planeNo);
+    for (int cell = 0; cell < rowNo * colNo; cell++)
+        if (isGuessed[cell])
+            logic.addData(GuessPoint(cell % rowNo, cell / rowNo, grid.getGuessResult(GridPoint(cell % rowNo, cell / rowNo))));
+    for (int cell = 0; cell < rowNo * colNo; cell++) {
+        const int row = cell % rowNo;
+        const int col = cell / rowNo;
+        if (isGuessed[cell] || !logic.isPointGuessed(logic.stencils().cellId(row, col)))
+            continue;
+        std::snprintf(line, sizeof(line), "result %d %d %s", row, col, resultNames[grid.getGuessResult(GridPoint(row, col))]);
+        check(send(engine, line) == "ok\n", "the result of an inferred point");
+        check(send(engine, line) == "error point already guessed\n", "the result of an inferred point given twice");
+        inferredNo++;
+    }
+    check(send(engine, "isready") == "readyok\n", "the engine is ready after a game");
+    return moveNo;
+}
+
+}
+
+int main(int argc, char* argv[])
+{
+    const int gameNo = argc > 1 ? std::atoi(argv[1]) : 50;
+
+    RandomGenerator random(46);
+    RandomScope scope(random);
+    //the engine has a large buffer
+    std::unique_ptr<TextEngine> engine(new TextEngine());
+
+    checkCommands(*engine);
+
+    const std::string first = moves(*engine, "newgame 10 10 3 12345");
+    check(first == moves(*engine, "newgame 10 10 3 12345"), "the same moves for the same seed");
+    check(first != moves(*engine, "newgame 10 10 3 54321"), "other moves for another seed");
+
+    int moveNo = 0;
+    int inferredNo = 0;
+    for (int game = 0; game < gameNo; game++)
+        moveNo += playGame(*engine, game % 3 == 0 ? 12 : 10, 10, game % 3 == 0 ? 4 : 3, game, inferredNo);
+    check(gameNo == 0 || inferredNo > 0, "some points were inferred");
+    std::printf("%d games, %.1f moves per game, %d inferred points\n", gameNo,
+                gameNo > 0 ? static_cast<double>(moveNo) / gameNo : 0.0, inferredNo);
+
+    char quit[] = "quit";
+    check(!engine->handleLine(quit), "quit");
+
+    std::printf("%s\n", failureNo == 0 ? "passed" : "failed");
+    return failureNo == 0 ? 0 : 1;
+}
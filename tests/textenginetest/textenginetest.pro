@@ -0,0 +1,18 @@
+TEMPLATE = app
+CONFIG += console
+CONFIG -= app_bundle
+CONFIG -= qt
+
+#the engine runs in the process of the test
+SOURCES += main.cpp \
+    ../../tools/planesengine/textengine.cpp
+
+HEADERS += ../../tools/planesengine/textengine.h
+
+win32:CONFIG(release, debug|release): LIBS += -L$$OUT_PWD/../../common/planescore/release/ -lplanescore
+else:win32:CONFIG(debug, debug|release): LIBS += -L$$OUT_PWD/../../common/planescore/debug/ -lplanescore
+else:unix: LIBS += -L$$OUT_PWD/../../common/planescore/ -lplanescore -lpthread
+
+INCLUDEPATH += $$PWD/../../common \
+    $$PWD/../../tools/planesengine
+DEPENDPATH += $$PWD/../../common
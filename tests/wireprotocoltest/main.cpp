@@ -0,0 +1,334 @@
+#include "wireprotocol.h"
+#include <cstdio>
+#include <vector>
+
+//Checks the frames of the wire protocol: every message type written by a
+//WireWriter must be read back by a WireReader with the same fields, the
+//frames of a buffer must be found one after the other, a frame that is not
+//complete must not be read, and a frame cut inside a message, of an unknown
+//message type or of another version must be an error. A frame that does not
+//fit in the buffer of the writer must be dropped whole.
+//
+//usage: WireProtocolTest
+
+namespace {
+
+int failureNo = 0;
+
+void check(bool condition, const char* what)
+{
+    if (!condition && failureNo++ < 10)
+        std::printf("failed: %s\n", what);
+}
+
+GameStatistics makeStatistics(int base)
+{
+    GameStatistics stats;
+    stats.m_playerMoves = base;
+    stats.m_playerHits = base + 127;
+    stats.m_playerDead = base + 128;
+    stats.m_playerMisses = base + 16383;
+    stats.m_computerMoves = base + 16384;
+    stats.m_computerHits = base + 2097152;
+    stats.m_computerDead = base + 3;
+    stats.m_computerMisses = base + (1 << 28);
+    stats.m_playerWins = base + 1000000;
+    stats.m_computerWins = base;
+    return stats;
+}
+
+bool sameStatistics(const GameStatistics& a, const GameStatistics& b)
+{
+    return a.m_playerMoves == b.m_playerMoves && a.m_playerHits == b.m_playerHits &&
+           a.m_playerDead == b.m_playerDead && a.m_playerMisses == b.m_playerMisses &&
+           a.m_computerMoves == b.m_computerMoves && a.m_computerHits == b.m_computerHits &&
+           a.m_computerDead == b.m_computerDead && a.m_computerMisses == b.m_computerMisses &&
+           a.m_playerWins == b.m_playerWins && a.m_computerWins == b.m_computerWins;
+}
+
+bool sameGuess(const GuessPoint& a, const GuessPoint& b)
+{
+    return a.m_row == b.m_row && a.m_col == b.m_col && a.m_type == b.m_type;
+}
+
+//the planes of the Planes message, every orientation and the largest coordinates
+const int PlaneNo = 5;
+const Plane planes[PlaneNo] = {
+    Plane(0, 0, Plane::NorthSouth), Plane(126, 126, Plane::SouthNorth), Plane(3, 120, Plane::WestEast),
+    Plane(64, 1, Plane::EastWest), Plane(9, 9, Plane::NorthSouth)
+};
+
+//the cells of the keyframe, 2 boards of 3x5
+const int KeyframeRowNo = 3;
+const int KeyframeColNo = 5;
+const uint8_t cells[2 * KeyframeRowNo * KeyframeColNo] = {
+    0, 1, 2, 3, 0, 0, 3, 3, 1, 2, 0, 0, 0, 1, 1,
+    3, 2, 1, 0, 3, 2, 1, 0, 0, 0, 0, 2, 2, 2, 3
+};
+
+//the messages of the test frame
+const int MessageNo = 14;
+
+//writes message i of the test frame
+void writeMessage(WireWriter& writer, int i)
+{
+    GameStatistics before = makeStatistics(40);
+    GameStatistics after = before;
+    after.m_playerMoves += 1;
+    after.m_playerDead += 1;
+    after.m_computerMisses -= 300;
+
+    switch (i) {
+    case 0: writer.newRound(true); break;
+    case 1: writer.playerGuess(126, 5); break;
+    case 2: writer.hello(WireProtocol::Version, 7); break;
+    case 3: writer.roundStarted(127, 1, 32); break;
+    case 4: writer.guessResult(GuessPoint(4, 126, GuessPoint::Dead)); break;
+    case 5: writer.computerMove(GuessPoint(0, 0, GuessPoint::Hit)); break;
+    case 6: writer.roundEnded(false); break;
+    case 7: writer.planes(planes, PlaneNo); break;
+    case 8: writer.statistics(makeStatistics(0)); break;
+    case 9: writer.error(WireProtocol::InvalidGuess); break;
+    case 10: writer.keyframe(300, KeyframeRowNo, KeyframeColNo, 2, 5, cells); break;
+    case 11: writer.delta(1 << 20); break;
+    case 12: writer.statisticsDelta(before, after); break;
+    case 13: writer.newRound(false); break;
+    }
+}
+
+//checks message i of the test frame
+void checkMessage(const WireMessage& message, int i)
+{
+    switch (i) {
+    case 0:
+        check(message.m_type == WireProtocol::NewRound && message.m_args[0] == 1, "NewRound");
+        break;
+    case 1:
+        check(message.m_type == WireProtocol::PlayerGuess && message.m_guess.m_row == 126 &&
+              message.m_guess.m_col == 5, "PlayerGuess");
+        break;
+    case 2:
+        check(message.m_type == WireProtocol::Hello && message.m_args[0] == WireProtocol::Version &&
+              message.m_args[1] == 7, "Hello");
+        break;
+    case 3:
+        check(message.m_type == WireProtocol::RoundStarted && message.m_args[0] == 127 &&
+              message.m_args[1] == 1 && message.m_args[2] == 32, "RoundStarted");
+        break;
+    case 4:
+        check(message.m_type == WireProtocol::GuessResult &&
+              sameGuess(message.m_guess, GuessPoint(4, 126, GuessPoint::Dead)), "GuessResult");
+        break;
+    case 5:
+        check(message.m_type == WireProtocol::ComputerMove &&
+              sameGuess(message.m_guess, GuessPoint(0, 0, GuessPoint::Hit)), "ComputerMove");
+        break;
+    case 6:
+        check(message.m_type == WireProtocol::RoundEnded && message.m_args[0] == 0, "RoundEnded");
+        break;
+    case 7: {
+        bool same = message.m_type == WireProtocol::Planes && message.m_planeNo == PlaneNo;
+        for (int k = 0; k < PlaneNo && same; k++)
+            same = message.plane(k) == planes[k];
+        check(same, "Planes");
+        break;
+    }
+    case 8:
+        check(message.m_type == WireProtocol::Statistics && sameStatistics(message.m_stats, makeStatistics(0)), "Statistics");
+        break;
+    case 9:
+        check(message.m_type == WireProtocol::Error && message.m_args[0] == WireProtocol::InvalidGuess, "Error");
+        break;
+    case 10: {
+        bool same = message.m_type == WireProtocol::Keyframe && message.m_sequence == 300 &&
+                    message.m_args[0] == KeyframeRowNo && message.m_args[1] == KeyframeColNo &&
+                    message.m_args[2] == 2 && message.m_args[3] == 5;
+        for (int board = 0; board < 2 && same; board++)
+            for (int cell = 0; cell < KeyframeRowNo * KeyframeColNo && same; cell++)
+                same = message.cell(board, cell) == cells[board * KeyframeRowNo * KeyframeColNo + cell];
+        check(same, "Keyframe");
+        break;
+    }
+    case 11:
+        check(message.m_type == WireProtocol::Delta && message.m_sequence == (1 << 20), "Delta");
+        break;
+    case 12: {
+        GameStatistics change;
+        change.reset();
+        change.resetScore();
+        change.m_playerMoves = 1;
+        change.m_playerDead = 1;
+        change.m_computerMisses = -300;
+        check(message.m_type == WireProtocol::StatisticsDelta && message.m_args[0] == ((1 << 0) | (1 << 2) | (1 << 7)) &&
+              sameStatistics(message.m_stats, change), "StatisticsDelta");
+        break;
+    }
+    case 13:
+        check(message.m_type == WireProtocol::NewRound && message.m_args[0] == 0, "NewRound");
+        break;
+    }
+}
+
+//writes a frame with the first n messages, returns its size
+int writeFrame(uint8_t* buffer, int capacity, int n)
+{
+    WireWriter writer(buffer, capacity);
+    writer.beginFrame();
+    for (int i = 0; i < n; i++)
+        writeMessage(writer, i);
+    return writer.endFrame() ? writer.size() : -1;
+}
+
+//reads the messages of a frame, returns their number or -1 on an error
+int readFrame(const uint8_t* frame, int size)
+{
+    WireReader reader(frame, size);
+    WireMessage message;
+    int n = 0;
+    while (reader.next(message))
+        checkMessage(message, n++);
+    return reader.hasError() ? -1 : n;
+}
+
+//every message type read back with its fields
+void checkRoundTrip()
+{
+    uint8_t buffer[1024];
+    const int size = writeFrame(buffer, sizeof(buffer), MessageNo);
+    check(size > 0, "the frame fits");
+    check(WireReader::frameSize(buffer, size) == size, "the frame size");
+    check(readFrame(buffer, size) == MessageNo, "all the messages are read");
+
+    //the 16 bit forms of the guesses keep the coordinates and every result
+    const GuessPoint::Type types[] = { GuessPoint::Miss, GuessPoint::Hit, GuessPoint::Dead };
+    bool same = true;
+    for (int row = 0; row <= WireProtocol::MaxDimension; row += 9)
+        for (int col = 0; col <= WireProtocol::MaxDimension; col += 7)
+            for (int t = 0; t < 3; t++)
+                same = same && sameGuess(WireProtocol::unpackGuess(WireProtocol::packGuess(GuessPoint(row, col, types[t]))),
+                                         GuessPoint(row, col, types[t]));
+    check(same, "the packed guesses");
+}
+
+//the frames of a buffer are found one after the other, a partial one is not
+void checkFrameSequence()
+{
+    uint8_t buffer[4096];
+    WireWriter writer(buffer, sizeof(buffer));
+    std::vector<int> ends;
+    for (int n = 0; n <= MessageNo; n++) {
+        writer.beginFrame();
+        for (int i = 0; i < n; i++)
+            writeMessage(writer, i);
+        writer.endFrame();
+        ends.push_back(writer.size());
+    }
+
+    int position = 0;
+    for (int n = 0; n <= MessageNo; n++) {
+        const int size = WireReader::frameSize(buffer + position, writer.size() - position);
+        check(position + size == ends[n], "the size of a frame in a buffer");
+        check(readFrame(buffer + position, size) == n, "the messages of a frame in a buffer");
+        //a frame with a byte missing is not complete
+        check(WireReader::frameSize(buffer + position, size - 1) == 0, "an incomplete frame");
+        position += size;
+    }
+    check(WireReader::frameSize(buffer, 0) == 0 && WireReader::frameSize(buffer, 1) == 0, "an incomplete header");
+}
+
+//a frame cut inside a message is an error, a frame cut between messages is not
+void checkTruncatedFrames()
+{
+    uint8_t buffer[1024];
+    //the size of the frame with the first n messages
+    std::vector<int> boundaries;
+    for (int n = 0; n <= MessageNo; n++)
+        boundaries.push_back(writeFrame(buffer, sizeof(buffer), n));
+    const int fullSize = boundaries.back();
+
+    int checkedNo = 0;
+    for (int size = WireProtocol::HeaderSize; size < fullSize; size++) {
+        std::vector<uint8_t> frame(buffer, buffer + size);
+        frame[0] = static_cast<uint8_t>((size - 2) & 0xff);
+        frame[1] = static_cast<uint8_t>((size - 2) >> 8);
+        int complete = 0;
+        while (complete < static_cast<int>(boundaries.size()) && boundaries[complete] <= size)
+            complete++;
+        const bool atBoundary = boundaries[complete - 1] == size;
+        const int read = readFrame(frame.data(), size);
+        check(read == (atBoundary ? complete - 1 : -1), "a truncated frame");
+        checkedNo++;
+    }
+    check(checkedNo > 0, "truncated frames were checked");
+
+    //the reader is given fewer bytes than the header announces
+    writeFrame(buffer, sizeof(buffer), MessageNo);
+    WireReader shortReader(buffer, fullSize - 1);
+    WireMessage message;
+    check(!shortReader.next(message) && shortReader.hasError(), "a frame shorter than its header");
+    uint8_t header[2] = { 0, 0 };
+    WireReader headerOnly(header, 2);
+    check(!headerOnly.next(message) && headerOnly.hasError(), "a frame without a version");
+}
+
+//unknown types and versions are errors, the messages before an unknown type are read
+void checkInvalidFrames()
+{
+    uint8_t buffer[64];
+    int size = writeFrame(buffer, sizeof(buffer), 3);
+    buffer[size] = 99;
+    buffer[0] = static_cast<uint8_t>(buffer[0] + 1);
+    WireReader reader(buffer, size + 1);
+    WireMessage message;
+    int n = 0;
+    while (reader.next(message))
+        checkMessage(message, n++);
+    check(n == 3 && reader.hasError(), "an unknown message type");
+
+    size = writeFrame(buffer, sizeof(buffer), 3);
+    buffer[2] = WireProtocol::Version + 1;
+    check(readFrame(buffer, size) == -1, "a newer version");
+    buffer[2] = 0;
+    check(readFrame(buffer, size) == -1, "version 0");
+}
+
+//a frame that does not fit is dropped, the complete frames are kept
+void checkOverflow()
+{
+    uint8_t buffer[1024];
+    const int fullSize = writeFrame(buffer, sizeof(buffer), MessageNo);
+    for (int capacity = 0; capacity < fullSize; capacity++) {
+        WireWriter writer(buffer, capacity);
+        writer.beginFrame();
+        for (int i = 0; i < MessageNo; i++)
+            writeMessage(writer, i);
+        if (writer.endFrame() || writer.size() != 0) {
+            check(false, "a frame larger than the buffer");
+            break;
+        }
+    }
+
+    WireWriter writer(buffer, 16);
+    writer.beginFrame();
+    writer.newRound(true);
+    check(writer.endFrame() && writer.size() == 5, "a small frame");
+    writer.beginFrame();
+    writer.planes(planes, PlaneNo);
+    check(!writer.endFrame() && writer.size() == 5, "a frame dropped after a complete one");
+    writer.beginFrame();
+    writer.playerGuess(1, 2);
+    check(writer.endFrame() && writer.size() == 11, "a frame after a dropped one");
+}
+
+}
+
+int main()
+{
+    checkRoundTrip();
+    checkFrameSequence();
+    checkTruncatedFrames();
+    checkInvalidFrames();
+    checkOverflow();
+    std::printf("%s\n", failureNo == 0 ? "passed" : "failed");
+    return failureNo == 0 ? 0 : 1;
+}
@@ -0,0 +1,206 @@
+#include "batchengine.h"
+#include "choicekernels.h"
+#include "choicemap.h"
+#include "planegridcore.h"
+#include "planestencils.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+//Measures the throughput of BatchEngine for growing batch sizes and compares
+//it with the same games played one by one on a ChoiceMap each, the way
+//ComputerLogic plays its find head mode.
+//The same games are played at every batch size: game k is on board
+//k % BoardNo and draws its moves from a generator seeded with k, so the
+//moves of every game must be the same for all the batch sizes and for the
+//games played one by one; the tool checks it and fails otherwise.
+//A batch of n games is kept full: a finished game is replaced by the next
+//one until all the games are played. The times include reading the results
+//on the boards, which is the same small cost for both.
+//
+//usage: BatchBench [games [rows cols planes [kernels]]]
+
+namespace {
+
+typedef std::chrono::steady_clock Clock;
+
+//the number of different boards
+const int BoardNo = 1024;
+
+//the result of a guess on each point of a board
+struct Boards
+{
+    int m_pointNo;
+    std::vector<GuessPoint::Type> m_results;
+
+    GuessPoint::Type result(int board, int point) const { return m_results[board * m_pointNo + point]; }
+};
+
+//places the planes of the boards with their own generators
+void makeBoards(int rowNo, int colNo, int planeNo, Boards& boards)
+{
+    boards.m_pointNo = rowNo * colNo;
+    boards.m_results.resize(BoardNo * boards.m_pointNo);
+    PlaneGridCore grid(rowNo, colNo, planeNo, true);
+    for (int board = 0; board < BoardNo; board++) {
+        RandomGenerator random(1000003 + board);
+        RandomScope scope(random);
+        grid.initGrid();
+        for (int point = 0; point < boards.m_pointNo; point++)
+            boards.m_results[board * boards.m_pointNo + point] = grid.getGuessResult(GridPoint(point % rowNo, point / rowNo));
+    }
+}
+
+//a hash of the moves of a game
+uint64_t addMove(uint64_t hash, int point)
+{
+    return (hash ^ static_cast<uint64_t>(point + 1)) * 0x100000001b3ULL;
+}
+
+//the results of a run
+struct Run
+{
+    double m_seconds;
+    long long m_moveNo;
+    std::vector<uint64_t> m_hashes;
+};
+
+//plays the games one by one
+void playOneByOne(int rowNo, int colNo, int planeNo, const Boards& boards, int gameNo, Run& run)
+{
+    const PlaneStencils& stencils = PlaneStencils::forGrid(rowNo, colNo);
+    ChoiceMap map(stencils);
+    run.m_moveNo = 0;
+    run.m_hashes.assign(gameNo, 0);
+
+    const Clock::time_point start = Clock::now();
+    for (int game = 0; game < gameNo; game++) {
+        RandomGenerator random(game);
+        uint64_t hash = 0;
+        int deadNo = 0;
+
+        map.reset();
+        while (deadNo < planeNo) {
+            int count = 0;
+            const int maxScore = map.maxScore(count);
+            if (maxScore < 0)
+                break;
+            const int point = map.findNth(maxScore, random.generate(count)) / 4;
+
+            const GuessPoint::Type result = boards.result(game % BoardNo, point);
+            hash = addMove(hash, point);
+            run.m_moveNo++;
+            if (result == GuessPoint::Dead)
+                deadNo++;
+
+            map.markGuessed(point);
+            if (result == GuessPoint::Hit)
+                map.incrementCovers(point);
+            else
+                map.invalidateCovers(point);
+        }
+        run.m_hashes[game] = hash;
+    }
+    run.m_seconds = std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+//plays the games in a batch of batchNo slots
+void playBatch(int rowNo, int colNo, int planeNo, const Boards& boards, int gameNo, int batchNo, Run& run)
+{
+    BatchEngine engine(rowNo, colNo, planeNo, batchNo, 0);
+    run.m_moveNo = 0;
+    run.m_hashes.assign(gameNo, 0);
+    std::vector<int> points(batchNo);
+    std::vector<GuessPoint::Type> results(batchNo);
+    //the game played in each slot, -1 when there are no more games
+    std::vector<int> games(batchNo);
+    for (int slot = 0; slot < batchNo; slot++)
+        games[slot] = slot < gameNo ? slot : -1;
+    int nextGame = batchNo;
+    int playingNo = std::min(batchNo, gameNo);
+
+    const Clock::time_point start = Clock::now();
+    while (playingNo > 0) {
+        engine.chooseMoves(points.data());
+
+        for (int slot = 0; slot < batchNo; slot++) {
+            if (games[slot] == -1) {
+                points[slot] = -1;
+                continue;
+            }
+            if (points[slot] == -1)
+                continue;
+            results[slot] = boards.result(games[slot] % BoardNo, points[slot]);
+            run.m_hashes[games[slot]] = addMove(run.m_hashes[games[slot]], points[slot]);
+            run.m_moveNo++;
+        }
+
+        engine.addGuesses(points.data(), results.data());
+
+        //a game that has no move left ends too
+        for (int slot = 0; slot < batchNo; slot++) {
+            if (games[slot] == -1 || (!engine.isFinished(slot) && points[slot] != -1))
+                continue;
+            if (nextGame < gameNo) {
+                games[slot] = nextGame;
+                engine.resetGame(slot, nextGame);
+                nextGame++;
+            } else {
+                games[slot] = -1;
+                playingNo--;
+            }
+        }
+    }
+    run.m_seconds = std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+}
+
+int main(int argc, char* argv[])
+{
+    int gameNo = 400000;
+    int rowNo = 10, colNo = 10, planeNo = 3;
+    if (argc != 1 && argc != 2 && argc != 5 && argc != 6) {
+        std::fprintf(stderr, "usage: %s [games [rows cols planes [kernels]]]\n", argv[0]);
+        return 1;
+    }
+    if (argc >= 2)
+        gameNo = std::atoi(argv[1]);
+    if (argc >= 5) {
+        rowNo = std::atoi(argv[2]);
+        colNo = std::atoi(argv[3]);
+        planeNo = std::atoi(argv[4]);
+    }
+    if (gameNo <= 0 || rowNo <= 0 || colNo <= 0 || planeNo <= 0 || rowNo * colNo > BatchEngine::MaxPointNo) {
+        std::fprintf(stderr, "invalid arguments\n");
+        return 1;
+    }
+    if (argc == 6 && !ChoiceKernels::select(argv[5])) {
+        std::fprintf(stderr, "the kernels %s are not available\n", argv[5]);
+        return 1;
+    }
+
+    Boards boards;
+    makeBoards(rowNo, colNo, planeNo, boards);
+
+    Run reference;
+    playOneByOne(rowNo, colNo, planeNo, boards, gameNo, reference);
+    std::printf("kernels %s, %d games on %dx%d with %d planes, %.2f moves per game\n", ChoiceKernels::active().m_name,
+                gameNo, rowNo, colNo, planeNo, static_cast<double>(reference.m_moveNo) / gameNo);
+    std::printf("one by one        %9.0f games/s\n", gameNo / reference.m_seconds);
+
+    const int batchNos[] = { 1, 8, 32, 128, 512, 2048, 8192, 32768 };
+    bool same = true;
+    for (unsigned int i = 0; i < sizeof(batchNos) / sizeof(batchNos[0]); i++) {
+        Run run;
+        playBatch(rowNo, colNo, planeNo, boards, gameNo, batchNos[i], run);
+        const bool sameMoves = run.m_moveNo == reference.m_moveNo && run.m_hashes == reference.m_hashes;
+        same = same && sameMoves;
+        std::printf("batch size %6d %9.0f games/s%s\n", batchNos[i], gameNo / run.m_seconds,
+                    sameMoves ? "" : "  the moves differ from the games played one by one");
+    }
+    return same ? 0 : 1;
+}
@@ -0,0 +1,40 @@
+#include "configurationdatabase.h"
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+//Builds the database of all the placements of the planes for one grid geometry.
+//Each set of planes that do not overlap is written once as the bit masks
+//of its covered points and heads.
+//
+//usage: ConfigurationDbBuilder [rows cols planes [file]]
+
+int main(int argc, char* argv[])
+{
+    int rowNo = 10, colNo = 10, planeNo = 3;
+    if (argc >= 4) {
+        rowNo = std::atoi(argv[1]);
+        colNo = std::atoi(argv[2]);
+        planeNo = std::atoi(argv[3]);
+    }
+    std::string path = argc >= 5 ? argv[4] : ConfigurationDatabase::defaultFileName(rowNo, colNo, planeNo);
+
+    if (rowNo <= 0 || colNo <= 0 || planeNo <= 0) {
+        std::fprintf(stderr, "usage: %s [rows cols planes [file]]\n", argv[0]);
+        return 1;
+    }
+
+    std::vector<ConfigurationDatabase::Record> records;
+    if (!ConfigurationDatabase::enumerate(rowNo, colNo, planeNo, records)) {
+        std::fprintf(stderr, "grids of more than %d points are not supported\n", ConfigurationDatabase::MaxPointNo);
+        return 1;
+    }
+
+    if (!ConfigurationDatabase::write(path, rowNo, colNo, planeNo, records)) {
+        std::fprintf(stderr, "cannot write %s\n", path.c_str());
+        return 1;
+    }
+
+    std::printf("%s: %d configurations\n", path.c_str(), static_cast<int>(records.size()));
+    return 0;
+}
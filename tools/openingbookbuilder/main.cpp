@@ -0,0 +1,99 @@
+#include "computerlogic.h"
+#include "openingbook.h"
+#include "planestencils.h"
+#include <cstdio>
+#include <cstdlib>
+#include <set>
+#include <vector>
+
+//Builds the opening book for one grid geometry.
+//Starting from the empty grid the computer's move is chosen with the
+//information gain strategy; the tree of results (miss, hit, dead)
+//of these moves is explored up to the requested depth and the move
+//of every position is written to the book.
+//
+//usage: OpeningBookBuilder [rows cols planes depth [file]]
+
+namespace {
+
+//explores the positions reachable from a history of guesses
+void expand(ComputerLogic& logic, std::vector<GuessPoint>& history, int maxDepth,
+            std::vector<OpeningBook::Entry>& entries, std::set<uint64_t>& seen)
+{
+    const int rowNo = logic.getRowNo();
+
+    //the same set of guesses can be reached in several orders
+    uint64_t key = OpeningBook::hashGuesses(history.data(), static_cast<int>(history.size()), rowNo);
+    if (!seen.insert(key).second)
+        return;
+
+    logic.reset();
+    for (unsigned int i = 0; i < history.size(); i++)
+        logic.addData(history[i]);
+
+    if (logic.areAllGuessed())
+        return;
+
+    GridPoint qp;
+    if (!logic.makeChoiceMaxInformationMode(qp))
+        return;
+
+    int point = qp.y() * rowNo + qp.x();
+    OpeningBook::Entry entry;
+    entry.m_key = key;
+    entry.m_point = static_cast<uint16_t>(point);
+    entries.push_back(entry);
+
+    if (static_cast<int>(history.size()) + 1 >= maxDepth)
+        return;
+
+    //a dead result is explored only if a remaining plane position has its head there
+    const PlaneStencils& stencils = PlaneStencils::forGrid(rowNo, logic.getColNo());
+    const ChoiceMap& choices = logic.getChoiceMap();
+    bool deadPossible = false;
+    for (const int* it = stencils.coversBegin(point); it != stencils.coversEnd(point); ++it)
+        if (*it / 4 == point && choices[*it] >= 0)
+            deadPossible = true;
+
+    const GuessPoint::Type results[] = { GuessPoint::Miss, GuessPoint::Hit, GuessPoint::Dead };
+    for (int i = 0; i < 3; i++) {
+        if (results[i] == GuessPoint::Dead && !deadPossible)
+            continue;
+        history.push_back(GuessPoint(qp.x(), qp.y(), results[i]));
+        expand(logic, history, maxDepth, entries, seen);
+        history.pop_back();
+    }
+}
+
+}
+
+int main(int argc, char* argv[])
+{
+    int rowNo = 10, colNo = 10, planeNo = 3, maxDepth = 6;
+    if (argc >= 5) {
+        rowNo = std::atoi(argv[1]);
+        colNo = std::atoi(argv[2]);
+        planeNo = std::atoi(argv[3]);
+        maxDepth = std::atoi(argv[4]);
+    }
+    std::string path = argc >= 6 ? argv[5] : OpeningBook::defaultFileName(rowNo, colNo, planeNo);
+
+    if (rowNo <= 0 || colNo <= 0 || planeNo <= 0 || maxDepth <= 0 || rowNo * colNo > 16384) {
+        std::fprintf(stderr, "usage: %s [rows cols planes depth [file]]\n", argv[0]);
+        return 1;
+    }
+
+    ComputerLogic logic(rowNo, colNo, planeNo);
+    std::vector<GuessPoint> history;
+    std::vector<OpeningBook::Entry> entries;
+    std::set<uint64_t> seen;
+    expand(logic, history, maxDepth, entries, seen);
+
+    if (!OpeningBook::write(path, rowNo, colNo, planeNo, maxDepth, entries)) {
+        std::fprintf(stderr, "cannot write %s\n", path.c_str());
+        return 1;
+    }
+
+    std::printf("%s: %d positions up to %d guesses\n", path.c_str(), static_cast<int>(entries.size()), maxDepth);
+    return 0;
+}
@@ -0,0 +1,212 @@
+#include "gameanalyzer.h"
+#include "snapshotstream.h"
+#include <algorithm>
+#include <atomic>
+#include <future>
+#include <random>
+
+namespace {
+
+//the seed of the boards of a move, from the seed of its game
+uint32_t moveSeed(uint64_t gameSeed, int move)
+{
+    uint64_t x = gameSeed + static_cast<uint64_t>(move + 1) * 0x9e3779b97f4a7c15ULL;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return static_cast<uint32_t>(x ^ (x >> 31));
+}
+
+//a logic for the grid of a game, kept when the grid does not change
+ComputerLogic& logicFor(std::unique_ptr<ComputerLogic>& logic, const ReplayRecord& record)
+{
+    if (!logic || logic->getRowNo() != record.rowNo() || logic->getColNo() != record.colNo() ||
+        logic->getPlaneNo() != record.planeNo())
+        logic.reset(new ComputerLogic(record.rowNo(), record.colNo(), record.planeNo()));
+    return *logic;
+}
+
+}
+
+//a stronger search than the one of the expert level
+GameAnalyzer::Settings GameAnalyzer::defaultSettings()
+{
+    Settings settings;
+    settings.m_sides = ComputerSide;
+    settings.m_search = ExpertSearch::defaultSettings();
+    settings.m_search.m_candidateNo = 10;
+    settings.m_search.m_boardNo = 100;
+    settings.m_search.m_nodeBudget = 1 << 20;
+    settings.m_search.m_timeBudgetMs = 1 << 30;
+    settings.m_batchSize = 256;
+    return settings;
+}
+
+//constructor
+GameAnalyzer::GameAnalyzer(const Settings& settings, int threadNo):
+    m_settings(settings),
+    m_search(settings.m_search),
+    m_pool(std::max(1, threadNo)),
+    m_rejectedNo(0)
+{
+    m_settings.m_batchSize = std::max(1, m_settings.m_batchSize);
+}
+
+//analyzes the games of a log, one batch at a time
+std::vector<GameAnalyzer::MoveResult> GameAnalyzer::analyze(const ReplayLogReader& log)
+{
+    std::vector<ReplayRecord> records;
+    auto collect = [&records](const ReplayRecord& record) { records.push_back(record); };
+    log.forEachRecord(collect);
+
+    std::vector<MoveResult> results;
+    const int workerNo = m_pool.threadNo();
+    std::vector<std::unique_ptr<ComputerLogic> > logics(2 * workerNo);
+    std::vector<std::vector<uint8_t> > states;
+    std::vector<std::vector<Item> > gameItems;
+    std::vector<char> isRejected;
+    std::vector<Item> items;
+    m_rejectedNo = 0;
+
+    for (std::size_t first = 0; first < records.size(); first += m_settings.m_batchSize) {
+        const int gameNo = static_cast<int>(std::min(records.size() - first, static_cast<std::size_t>(m_settings.m_batchSize)));
+        states.resize(gameNo);
+        gameItems.resize(gameNo);
+        isRejected.assign(gameNo, 0);
+
+        runParallel(gameNo, [&](int i, int worker) {
+            states[i].clear();
+            gameItems[i].clear();
+            isRejected[i] = !checkpoint(records[first + i], static_cast<int>(first) + i, &logics[2 * worker],
+                                        states[i], gameItems[i]);
+        });
+
+        items.clear();
+        for (int i = 0; i < gameNo; i++) {
+            items.insert(items.end(), gameItems[i].begin(), gameItems[i].end());
+            m_rejectedNo += isRejected[i];
+        }
+
+        const std::size_t base = results.size();
+        results.resize(base + items.size());
+        runParallel(static_cast<int>(items.size()), [&](int i, int worker) {
+            const Item& item = items[i];
+            const int game = item.m_game - static_cast<int>(first);
+            measure(records[item.m_game], item, states[game], logics[2 * worker], results[base + i]);
+        });
+    }
+    return results;
+}
+
+//the log does not check the codes of the records: a grid that PackedGuess
+//cannot describe, a plane or a move outside the grid or an unknown result
+//would be read outside the tables of the logic
+bool GameAnalyzer::isValid(const ReplayRecord& record)
+{
+    const int rowNo = record.rowNo();
+    const int colNo = record.colNo();
+    if (rowNo == 0 || colNo == 0 || record.planeNo() == 0 || rowNo > 127 || colNo > 127)
+        return false;
+
+    const int cellNo = rowNo * colNo;
+    for (int i = 0; i < record.planeNo(); i++)
+        if (record.playerPlane(i).headCell() >= cellNo || record.computerPlane(i).headCell() >= cellNo)
+            return false;
+    for (int i = 0; i < record.moveNo(); i++) {
+        const PackedGuess move = record.move(i);
+        if (move.cell() >= cellNo || move.type() > GuessPoint::Dead)
+            return false;
+    }
+    return true;
+}
+
+//replays a game, each side guessing the board of the other one
+bool GameAnalyzer::checkpoint(const ReplayRecord& record, int game, std::unique_ptr<ComputerLogic>* logics,
+                              std::vector<uint8_t>& states, std::vector<Item>& items) const
+{
+    if (!isValid(record))
+        return false;
+
+    ComputerLogic& computer = logicFor(logics[0], record);
+    ComputerLogic& player = logicFor(logics[1], record);
+    computer.reset();
+    player.reset();
+
+    int plies[2] = { 0, 0 };
+    for (int i = 0; i < record.moveNo(); i++) {
+        const bool isComputer = record.isComputerMove(i);
+        const int side = isComputer ? ComputerSide : PlayerSide;
+        ComputerLogic& logic = isComputer ? computer : player;
+        int& ply = plies[isComputer ? 0 : 1];
+
+        if (m_settings.m_sides & side) {
+            Item item;
+            item.m_game = game;
+            item.m_move = i;
+            item.m_ply = ply;
+            item.m_offset = states.size();
+            SnapshotWriter writer(states);
+            logic.saveState(writer);
+            item.m_size = states.size() - item.m_offset;
+            items.push_back(item);
+        }
+
+        //a point already known adds nothing to the logic
+        const PackedGuess move = record.move(i);
+        if (!logic.isPointGuessed(move.cell()))
+            logic.addData(move.toGuessPoint(record.rowNo()));
+        ply++;
+    }
+    return true;
+}
+
+//measures a move from the state saved before it
+void GameAnalyzer::measure(const ReplayRecord& record, const Item& item, const std::vector<uint8_t>& states,
+                           std::unique_ptr<ComputerLogic>& logic, MoveResult& result) const
+{
+    const int rowNo = record.rowNo();
+    const PackedGuess move = record.move(item.m_move);
+    result.m_game = static_cast<uint32_t>(item.m_game);
+    result.m_move = static_cast<uint16_t>(item.m_move);
+    result.m_isComputer = record.isComputerMove(item.m_move);
+    result.m_ply = static_cast<uint16_t>(item.m_ply);
+    result.m_row = move.cell() % rowNo;
+    result.m_col = move.cell() / rowNo;
+    result.m_type = move.type();
+    result.m_bestRow = result.m_row;
+    result.m_bestCol = result.m_col;
+    result.m_playedValue = 0.0f;
+    result.m_bestValue = 0.0f;
+    result.m_isValid = false;
+
+    ComputerLogic& state = logicFor(logic, record);
+    SnapshotReader reader(states.data() + item.m_offset, item.m_size);
+    if (!state.restoreState(reader))
+        return;
+
+    std::mt19937 random(moveSeed(record.seed(), item.m_move));
+    ExpertSearch::Evaluation evaluation;
+    if (!m_search.evaluate(state, move.cell(), random, evaluation))
+        return;
+
+    result.m_bestRow = evaluation.m_bestPoint % rowNo;
+    result.m_bestCol = evaluation.m_bestPoint / rowNo;
+    result.m_playedValue = evaluation.m_value;
+    result.m_bestValue = evaluation.m_bestValue;
+    result.m_isValid = true;
+}
+
+//the workers are tasks of the pool taking the next work from a counter
+template <class Work>
+void GameAnalyzer::runParallel(int n, Work work)
+{
+    std::atomic<int> next(0);
+    std::vector<std::future<void> > workers;
+    for (int k = 0; k < m_pool.threadNo(); k++) {
+        workers.push_back(m_pool.submit([&next, n, k, &work]() {
+            for (int i = next.fetch_add(1); i < n; i = next.fetch_add(1))
+                work(i, k);
+        }));
+    }
+    for (unsigned int k = 0; k < workers.size(); k++)
+        workers[k].get();
+}
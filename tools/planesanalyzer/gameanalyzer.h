@@ -0,0 +1,114 @@
+#ifndef GAMEANALYZER_H
+#define GAMEANALYZER_H
+
+#include "computerlogic.h"
+#include "expertsearch.h"
+#include "replaylog.h"
+#include "threadpool.h"
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+//Finds the moves of recorded games that lost expected moves: each move is
+//measured against the best candidate of the expert search, with more boards
+//and candidates than in a game and no time limit.
+//
+//The games are read in batches. A first pass replays each game once through
+//ComputerLogic and saves the state before each analyzed move with
+//saveState(), one buffer per game; a second pass measures the moves from the
+//saved states, so no move replays its game from the start. Both passes share
+//the work among the threads of a pool through a counter, the moves of all the
+//games of a batch being mixed, so that long games do not keep one thread busy.
+//The boards of a move are drawn with a generator seeded by the seed of the
+//game and the move: the results do not depend on the number of threads.
+//A record whose grid, planes or moves do not fit the grid is not replayed,
+//it is counted by rejectedNo().
+class GameAnalyzer
+{
+public:
+    enum Side { ComputerSide = 1, PlayerSide = 2, BothSides = 3 };
+
+    struct Settings
+    {
+        //the sides whose moves are analyzed
+        int m_sides;
+        //the search measuring the moves
+        ExpertSearch::Settings m_search;
+        //the games replayed before their moves are measured
+        int m_batchSize;
+    };
+
+    //the analysis of one move
+    struct MoveResult
+    {
+        //the game in the order of the log and the move in the order of the game
+        uint32_t m_game;
+        uint16_t m_move;
+        bool m_isComputer;
+        //the moves of this side before this one
+        uint16_t m_ply;
+        //the move played, its result as GuessPoint::Type
+        int m_row;
+        int m_col;
+        int m_type;
+        //the best candidate
+        int m_bestRow;
+        int m_bestCol;
+        float m_playedValue;
+        float m_bestValue;
+        //false when nothing was left to measure
+        bool m_isValid;
+
+        float loss() const { return m_isValid ? m_playedValue - m_bestValue : 0.0f; }
+    };
+
+    //10 candidates and 100 boards
+    static Settings defaultSettings();
+
+private:
+    //a move to measure and the state saved before it
+    struct Item
+    {
+        int m_game;
+        int m_move;
+        int m_ply;
+        std::size_t m_offset;
+        std::size_t m_size;
+    };
+
+    Settings m_settings;
+    ExpertSearch m_search;
+    ThreadPool m_pool;
+    //the records of the last analysis that were not replayed
+    int m_rejectedNo;
+
+public:
+    GameAnalyzer(const Settings& settings, int threadNo);
+
+    //analyzes the games of a log
+    //the results are in the order of the games and of their moves
+    std::vector<MoveResult> analyze(const ReplayLogReader& log);
+    //the records of the last analysis that do not describe a game
+    int rejectedNo() const { return m_rejectedNo; }
+
+private:
+    //whether the grid of a record can be played and its planes and moves are on it
+    static bool isValid(const ReplayRecord& record);
+    //replays a game and saves the state before each analyzed move
+    //returns false, without replaying it, if the record is not valid
+    bool checkpoint(const ReplayRecord& record, int game, std::unique_ptr<ComputerLogic>* logics,
+                    std::vector<uint8_t>& states, std::vector<Item>& items) const;
+    //measures a move from its saved state; the logic is reused by the thread
+    //the moves come from the records accepted by checkpoint()
+    void measure(const ReplayRecord& record, const Item& item, const std::vector<uint8_t>& states,
+                 std::unique_ptr<ComputerLogic>& logic, MoveResult& result) const;
+    //calls work(i, worker) for i from 0 to n - 1 on the threads of the pool,
+    //each worker taking the next i from a counter; returns when all are done
+    template <class Work>
+    void runParallel(int n, Work work);
+
+    GameAnalyzer(const GameAnalyzer&) = delete;
+    GameAnalyzer& operator=(const GameAnalyzer&) = delete;
+};
+
+#endif // GAMEANALYZER_H
@@ -0,0 +1,109 @@
+#include "gameanalyzer.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+//Replays the games of a replay log written by the game server and shows the
+//moves that lost at least a number of expected moves against the best
+//candidate of a stronger search, with the mean loss of each game.
+//The values are expected numbers of moves left to find all the heads.
+//
+//usage: PlanesAnalyzer log [-side computer|player|both] [-threshold moves]
+//                      [-boards n] [-candidates n] [-depth n] [-threads n]
+//e.g. the moves of the computer that lost half a move or more:
+//  PlanesAnalyzer replay.log -threshold 0.5 -threads 8
+
+namespace {
+
+int usage(const char* program)
+{
+    std::fprintf(stderr, "usage: %s log [-side computer|player|both] [-threshold moves]"
+                 " [-boards n] [-candidates n] [-depth n] [-threads n]\n", program);
+    return 1;
+}
+
+}
+
+int main(int argc, char* argv[])
+{
+    if (argc < 2)
+        return usage(argv[0]);
+
+    std::string path = argv[1];
+    GameAnalyzer::Settings settings = GameAnalyzer::defaultSettings();
+    double threshold = 0.5;
+    int threadNo = 1;
+    for (int i = 2; i < argc; i++) {
+        if (!std::strcmp(argv[i], "-side") && i + 1 < argc) {
+            const char* side = argv[++i];
+            if (!std::strcmp(side, "computer"))
+                settings.m_sides = GameAnalyzer::ComputerSide;
+            else if (!std::strcmp(side, "player"))
+                settings.m_sides = GameAnalyzer::PlayerSide;
+            else if (!std::strcmp(side, "both"))
+                settings.m_sides = GameAnalyzer::BothSides;
+            else
+                return usage(argv[0]);
+        } else if (!std::strcmp(argv[i], "-threshold") && i + 1 < argc) {
+            threshold = std::atof(argv[++i]);
+        } else if (!std::strcmp(argv[i], "-boards") && i + 1 < argc) {
+            settings.m_search.m_boardNo = std::atoi(argv[++i]);
+        } else if (!std::strcmp(argv[i], "-candidates") && i + 1 < argc) {
+            settings.m_search.m_candidateNo = std::atoi(argv[++i]);
+        } else if (!std::strcmp(argv[i], "-depth") && i + 1 < argc) {
+            settings.m_search.m_depth = std::atoi(argv[++i]);
+        } else if (!std::strcmp(argv[i], "-threads") && i + 1 < argc) {
+            threadNo = std::atoi(argv[++i]);
+        } else {
+            return usage(argv[0]);
+        }
+    }
+
+    ReplayLogReader log;
+    if (!log.open(path)) {
+        std::fprintf(stderr, "cannot read the replay log %s\n", path.c_str());
+        return 1;
+    }
+
+    GameAnalyzer analyzer(settings, threadNo);
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    std::vector<GameAnalyzer::MoveResult> results = analyzer.analyze(log);
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    //the results of a game follow each other
+    const char* types[] = { "miss", "hit", "dead" };
+    int measuredNo = 0;
+    int lossNo = 0;
+    double totalLoss = 0.0;
+    for (std::size_t i = 0; i < results.size();) {
+        const uint32_t game = results[i].m_game;
+        int gameMeasuredNo = 0;
+        double gameLoss = 0.0;
+        for (; i < results.size() && results[i].m_game == game; i++) {
+            const GameAnalyzer::MoveResult& result = results[i];
+            if (!result.m_isValid)
+                continue;
+            gameMeasuredNo++;
+            gameLoss += result.loss();
+            if (result.loss() < threshold)
+                continue;
+            lossNo++;
+            std::printf("game %u move %d %s ply %d played %d %d %s value %.2f best %d %d value %.2f loss %.2f\n",
+                        game, result.m_move, result.m_isComputer ? "computer" : "player", result.m_ply,
+                        result.m_row, result.m_col, types[result.m_type], result.m_playedValue,
+                        result.m_bestRow, result.m_bestCol, result.m_bestValue, result.loss());
+        }
+        if (gameMeasuredNo > 0)
+            std::printf("game %u moves %d loss %.2f mean %.3f\n", game, gameMeasuredNo, gameLoss, gameLoss / gameMeasuredNo);
+        measuredNo += gameMeasuredNo;
+        totalLoss += gameLoss;
+    }
+
+    std::printf("%llu games, %d rejected, %d moves measured, %d lost %.2f moves or more, mean loss %.3f, in %.1f s\n",
+                static_cast<unsigned long long>(log.recordNo()), analyzer.rejectedNo(), measuredNo, lossNo, threshold,
+                measuredNo > 0 ? totalLoss / measuredNo : 0.0, elapsed);
+    return 0;
+}
@@ -0,0 +1,38 @@
+#include "plane.h"
+#include "textengine.h"
+#include <cstdio>
+#include <cstring>
+#include <memory>
+
+//The computer's logic as an engine driven through stdin and stdout with the
+//text protocol described in textengine.h, for tournament runners and other
+//tools written in any language.
+//
+//usage: PlanesEngine
+
+int main()
+{
+    Plane::seedRandomGenerator();
+    //the engine keeps its answer buffer, it is not put on the stack
+    std::unique_ptr<TextEngine> engine(new TextEngine());
+
+    char line[4096];
+    while (std::fgets(line, sizeof(line), stdin) != nullptr) {
+        const std::size_t length = std::strlen(line);
+        if (length == sizeof(line) - 1 && line[length - 1] != '\n') {
+            int c;
+            while ((c = std::fgetc(stdin)) != EOF && c != '\n') {
+            }
+            std::fputs("error line too long\n", stdout);
+            std::fflush(stdout);
+            continue;
+        }
+
+        const bool isRunning = engine->handleLine(line);
+        std::fwrite(engine->output(), 1, engine->outputSize(), stdout);
+        std::fflush(stdout);
+        if (!isRunning)
+            break;
+    }
+    return 0;
+}
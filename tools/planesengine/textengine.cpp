@@ -0,0 +1,332 @@
+#include "textengine.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstdarg>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+namespace {
+
+//splits a line in place at the spaces
+//returns the number of words, or MaxTokenNo + 1 if there are more
+int splitLine(char* line, char** tokens)
+{
+    int tokenNo = 0;
+    char* p = line;
+    for (;;) {
+        while (*p == ' ' || *p == '\t' || *p == '\r' || *p == '\n')
+            *p++ = '\0';
+        if (*p == '\0')
+            return tokenNo;
+        if (tokenNo == TextEngine::MaxTokenNo)
+            return tokenNo + 1;
+        tokens[tokenNo++] = p;
+        while (*p != '\0' && *p != ' ' && *p != '\t' && *p != '\r' && *p != '\n')
+            p++;
+    }
+}
+
+//reads an integer from min to max
+bool parseInt(const char* text, int min, int max, int& value)
+{
+    char* end = nullptr;
+    errno = 0;
+    long number = std::strtol(text, &end, 10);
+    if (end == text || *end != '\0' || errno != 0 || number < min || number > max)
+        return false;
+    value = static_cast<int>(number);
+    return true;
+}
+
+//reads a seed
+bool parseSeed(const char* text, uint64_t& value)
+{
+    char* end = nullptr;
+    errno = 0;
+    unsigned long long number = std::strtoull(text, &end, 10);
+    if (end == text || *end != '\0' || errno != 0)
+        return false;
+    value = static_cast<uint64_t>(number);
+    return true;
+}
+
+}
+
+//constructor
+TextEngine::TextEngine():
+    m_logic(new ComputerLogic(10, 10, 3)),
+    m_random(static_cast<uint64_t>(Plane::generateRandomNumber(1 << 30))),
+    m_pDead(10 * 10),
+    m_pHit(10 * 10),
+    m_outputSize(0),
+    m_isTimerArmed(false),
+    m_isStopping(false)
+{
+    m_output[0] = '\0';
+    m_timerThread = std::thread(&TextEngine::timerLoop, this);
+}
+
+//destructor
+TextEngine::~TextEngine()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_timerMutex);
+        m_isStopping = true;
+    }
+    m_timerCondition.notify_one();
+    m_timerThread.join();
+}
+
+//handles one line
+bool TextEngine::handleLine(char* line)
+{
+    m_outputSize = 0;
+    m_output[0] = '\0';
+
+    char* tokens[MaxTokenNo];
+    const int tokenNo = splitLine(line, tokens);
+    if (tokenNo == 0)
+        return true;
+    if (tokenNo > MaxTokenNo) {
+        write("error too many words\n");
+        return true;
+    }
+
+    const char* command = tokens[0];
+    char** args = tokens + 1;
+    const int argNo = tokenNo - 1;
+    if (!std::strcmp(command, "go"))
+        go(args, argNo);
+    else if (!std::strcmp(command, "result"))
+        result(args, argNo);
+    else if (!std::strcmp(command, "eval"))
+        eval();
+    else if (!std::strcmp(command, "newgame"))
+        newGame(args, argNo);
+    else if (!std::strcmp(command, "isready"))
+        write("readyok\n");
+    else if (!std::strcmp(command, "setoption"))
+        setOption(args, argNo);
+    else if (!std::strcmp(command, "planes"))
+        identify();
+    else if (!std::strcmp(command, "quit"))
+        return false;
+    else
+        write("error unknown command %s\n", command);
+    return true;
+}
+
+//the name, the protocol and the strategies with their weights
+void TextEngine::identify()
+{
+    write("id name PlanesEngine\n");
+    write("id protocol 1\n");
+    std::vector<std::string> names = m_logic->strategies().names();
+    for (unsigned int i = 0; i < names.size(); i++)
+        write("option strategy %s weight %d\n", names[i].c_str(), m_logic->strategies().weight(names[i]));
+    write("planesok\n");
+}
+
+//the logic is kept when the geometry does not change, otherwise a new one
+//takes the weights of the strategies of the old one
+void TextEngine::newGame(char** args, int argNo)
+{
+    int rowNo = 0;
+    int colNo = 0;
+    int planeNo = 0;
+    uint64_t seed = 0;
+    if ((argNo != 3 && argNo != 4) || !parseInt(args[0], 1, MaxDimension, rowNo) ||
+        !parseInt(args[1], 1, MaxDimension, colNo) || !parseInt(args[2], 1, MaxPlaneNo, planeNo) ||
+        (argNo == 4 && !parseSeed(args[3], seed))) {
+        write("error usage: newgame rows cols planes [seed]\n");
+        return;
+    }
+    if (argNo == 3)
+        seed = (static_cast<uint64_t>(Plane::generateRandomNumber(1 << 30)) << 30) | Plane::generateRandomNumber(1 << 30);
+
+    if (rowNo != m_logic->getRowNo() || colNo != m_logic->getColNo() || planeNo != m_logic->getPlaneNo()) {
+        std::unique_ptr<ComputerLogic> logic(new ComputerLogic(rowNo, colNo, planeNo));
+        std::vector<std::string> names = m_logic->strategies().names();
+        for (unsigned int i = 0; i < names.size(); i++)
+            logic->strategies().setWeight(names[i], m_logic->strategies().weight(names[i]));
+        m_logic.swap(logic);
+        m_pDead.assign(rowNo * colNo, 0.0f);
+        m_pHit.assign(rowNo * colNo, 0.0f);
+    } else {
+        m_logic->reset();
+    }
+
+    m_random.setState(seed);
+    write("ok\n");
+}
+
+//the strategies of the logic
+void TextEngine::setOption(char** args, int argNo)
+{
+    int weight = 0;
+    if (argNo == 2 && !std::strcmp(args[0], "strategy")) {
+        if (!m_logic->strategies().selectOnly(args[1])) {
+            write("error unknown strategy %s\n", args[1]);
+            return;
+        }
+    } else if (argNo == 3 && !std::strcmp(args[0], "weight") && parseInt(args[2], 0, 1 << 20, weight)) {
+        if (!m_logic->strategies().setWeight(args[1], weight)) {
+            write("error unknown strategy %s\n", args[1]);
+            return;
+        }
+    } else {
+        write("error usage: setoption strategy name | setoption weight name weight\n");
+        return;
+    }
+    write("ok\n");
+}
+
+//a point can be given only one result; the points the logic inferred from
+//the other results are not guessed and can still be given one
+void TextEngine::result(char** args, int argNo)
+{
+    int row = 0;
+    int col = 0;
+    if (argNo != 3 || !parseInt(args[0], 0, m_logic->getRowNo() - 1, row) ||
+        !parseInt(args[1], 0, m_logic->getColNo() - 1, col)) {
+        write("error usage: result row col miss|hit|dead\n");
+        return;
+    }
+
+    GuessPoint::Type type;
+    if (!std::strcmp(args[2], "miss"))
+        type = GuessPoint::Miss;
+    else if (!std::strcmp(args[2], "hit"))
+        type = GuessPoint::Hit;
+    else if (!std::strcmp(args[2], "dead"))
+        type = GuessPoint::Dead;
+    else {
+        write("error usage: result row col miss|hit|dead\n");
+        return;
+    }
+
+    const ArenaVector<GuessPoint>& guesses = m_logic->getListGuesses();
+    for (unsigned int i = 0; i < guesses.size(); i++) {
+        if (guesses[i].m_row == row && guesses[i].m_col == col) {
+            write("error point already guessed\n");
+            return;
+        }
+    }
+
+    m_logic->addData(GuessPoint(row, col, type));
+    write("ok\n");
+}
+
+//the strategies draw their numbers from the generator of the game
+//the move is not played: its result is given by the next result command
+void TextEngine::go(char** args, int argNo)
+{
+    int moveTime = 0;
+    if ((argNo != 0 && argNo != 2) ||
+        (argNo == 2 && (std::strcmp(args[0], "movetime") || !parseInt(args[1], 1, 1 << 30, moveTime)))) {
+        write("error usage: go [movetime ms]\n");
+        return;
+    }
+
+    const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    if (moveTime > 0)
+        armTimer(start + std::chrono::milliseconds(moveTime));
+
+    GridPoint qp;
+    bool found;
+    {
+        RandomScope scope(m_random);
+        found = m_logic->makeChoice(qp);
+    }
+
+    if (moveTime > 0) {
+        disarmTimer();
+        m_logic->clearCancel();
+    }
+
+    const long long elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+    write("info time %lld\n", elapsed);
+    if (found)
+        write("bestmove %d %d\n", qp.x(), qp.y());
+    else
+        write("bestmove none\n");
+}
+
+//the probabilities come from the configuration database when one is set,
+//otherwise from the weights of the candidate positions
+void TextEngine::eval()
+{
+    std::fill(m_pDead.begin(), m_pDead.end(), 0.0f);
+    std::fill(m_pHit.begin(), m_pHit.end(), 0.0f);
+    const int headsLeft = m_logic->computeOutcomeProbabilities(m_pDead.data(), m_pHit.data());
+    int positionNo = 0;
+    const int maxScore = m_logic->getChoiceMap().maxScore(positionNo);
+
+    write("info guesses %d headsleft %d maxscore %d positions %d\n",
+          static_cast<int>(m_logic->getListGuesses().size()), headsLeft, maxScore, positionNo);
+
+    const PlaneStencils& stencils = m_logic->stencils();
+    const std::vector<float>* tables[] = { &m_pDead, &m_pHit };
+    const char* names[] = { "dead", "hit" };
+    for (int k = 0; k < 2; k++) {
+        for (int row = 0; row < m_logic->getRowNo(); row++) {
+            write("%s %d", names[k], row);
+            for (int col = 0; col < m_logic->getColNo(); col++)
+                write(" %d", static_cast<int>((*tables[k])[stencils.cellId(row, col)] * 1000.0f + 0.5f));
+            write("\n");
+        }
+    }
+    write("evalend\n");
+}
+
+//appends to the answer
+void TextEngine::write(const char* format, ...)
+{
+    const int room = OutputCapacity - m_outputSize;
+    if (room <= 1)
+        return;
+
+    va_list args;
+    va_start(args, format);
+    const int size = std::vsnprintf(m_output + m_outputSize, room, format, args);
+    va_end(args);
+    if (size > 0)
+        m_outputSize += std::min(size, room - 1);
+}
+
+//waits for a deadline, then cancels the move if the timer is still armed
+void TextEngine::timerLoop()
+{
+    std::unique_lock<std::mutex> lock(m_timerMutex);
+    while (!m_isStopping) {
+        if (!m_isTimerArmed) {
+            m_timerCondition.wait(lock);
+            continue;
+        }
+        m_timerCondition.wait_until(lock, m_deadline);
+        if (m_isTimerArmed && std::chrono::steady_clock::now() >= m_deadline) {
+            m_logic->requestCancel();
+            m_isTimerArmed = false;
+        }
+    }
+}
+
+//starts the timer of a move
+void TextEngine::armTimer(std::chrono::steady_clock::time_point deadline)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_timerMutex);
+        m_deadline = deadline;
+        m_isTimerArmed = true;
+    }
+    m_timerCondition.notify_one();
+}
+
+//the cancel request is made with the mutex held, so none is made after this
+void TextEngine::disarmTimer()
+{
+    std::lock_guard<std::mutex> lock(m_timerMutex);
+    m_isTimerArmed = false;
+}
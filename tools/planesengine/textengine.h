@@ -0,0 +1,107 @@
+#ifndef TEXTENGINE_H
+#define TEXTENGINE_H
+
+#include "computerlogic.h"
+#include "plane.h"
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+//The computer's logic behind a line-based text protocol, in the spirit of
+//the UCI protocol of chess engines, so that tournament runners and other
+//tools can drive it through stdin and stdout without Qt.
+//The engine guesses the planes of an opponent's board: it proposes moves
+//and is told their results.
+//
+//Commands, one per line, words separated by spaces:
+//  planes                        identifies the engine: "id ..." and "option ..."
+//                                lines, then "planesok"
+//  isready                       "readyok"
+//  setoption strategy <name>     uses only this strategy
+//  setoption weight <name> <w>   changes the mixing weight of a strategy
+//  newgame <rows> <cols> <planes> [<seed>]
+//                                starts a game; a seed gives the same moves again
+//  result <row> <col> miss|hit|dead
+//                                the result of a guess on the opponent's board
+//  go [movetime <ms>]            "info time <us>" then "bestmove <row> <col>",
+//                                or "bestmove none" when no move is left;
+//                                the search is cancelled after ms milliseconds
+//  eval                          "info ..." with the state of the game, the
+//                                probabilities of a dead and of a hit at each
+//                                point in thousandths, one line per row
+//                                ("dead <row> ..." and "hit <row> ..."), then "evalend"
+//  quit
+//The other commands reply "ok" when they succeed; an invalid command
+//replies "error <reason>".
+//
+//Until the geometry changes the commands allocate no memory: the line is
+//split in place, the answer is written to a fixed buffer and the timer of
+//movetime is a thread waiting on a condition. The strategies may allocate
+//(the expert search does), the default one does not.
+class TextEngine
+{
+public:
+    static const int MaxTokenNo = 8;
+    //room for the answer of eval on the largest grid
+    static const int OutputCapacity = 256 * 1024;
+    static const int MaxDimension = 127;
+    static const int MaxPlaneNo = 32;
+
+private:
+    std::unique_ptr<ComputerLogic> m_logic;
+    //the generator of the strategies, seeded by newgame
+    RandomGenerator m_random;
+    //the probabilities written by eval, one per grid point
+    std::vector<float> m_pDead;
+    std::vector<float> m_pHit;
+
+    char m_output[OutputCapacity];
+    int m_outputSize;
+
+    //the timer of movetime: the thread cancels the move of the logic
+    //when the deadline passes while the timer is armed
+    std::thread m_timerThread;
+    std::mutex m_timerMutex;
+    std::condition_variable m_timerCondition;
+    std::chrono::steady_clock::time_point m_deadline;
+    bool m_isTimerArmed;
+    bool m_isStopping;
+
+public:
+    //starts with a game on a 10x10 grid with 3 planes
+    TextEngine();
+    //stops the timer thread
+    ~TextEngine();
+
+    //handles one line, which is split in place; the answer is in output()
+    //returns false after quit
+    bool handleLine(char* line);
+    //the answer of the last line, each line of it ending with '\n'
+    const char* output() const { return m_output; }
+    int outputSize() const { return m_outputSize; }
+
+private:
+    //the commands, the arguments are the words after the command
+    void identify();
+    void newGame(char** args, int argNo);
+    void setOption(char** args, int argNo);
+    void result(char** args, int argNo);
+    void go(char** args, int argNo);
+    void eval();
+
+    //appends to the answer, the text is cut when the buffer is full
+    void write(const char* format, ...);
+    //the loop of the timer thread
+    void timerLoop();
+    void armTimer(std::chrono::steady_clock::time_point deadline);
+    //returns when the timer can no longer cancel the move
+    void disarmTimer();
+
+    TextEngine(const TextEngine&) = delete;
+    TextEngine& operator=(const TextEngine&) = delete;
+};
+
+#endif // TEXTENGINE_H
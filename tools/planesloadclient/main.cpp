@@ -0,0 +1,378 @@
+#include "wireprotocol.h"
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <queue>
+#include <random>
+#include <thread>
+#include <vector>
+
+//Measures the game server from the same machine.
+//Opens many connections and plays rounds on each of them: the guesses are
+//the points of the grid in a random order, each guess is sent after a think
+//time. The latency of a step is the time from sending a guess to receiving
+//the computer's answer (or the end of the round); the latency of a round
+//start is the time from sending a new round request to its answer.
+//The run passes when all the connections are served, the number of
+//sessions per server shard reaches the target and the 99th percentile of
+//the latency is below the target.
+//
+//usage: PlanesLoadClient [-host a.b.c.d] [-port n] [-connections n] [-threads n]
+//                        [-seconds n] [-think ms] [-target-sessions n] [-target-p99 ms]
+
+namespace {
+
+typedef std::chrono::steady_clock Clock;
+
+struct Options
+{
+    const char* m_host;
+    int m_port;
+    int m_connectionNo;
+    int m_threadNo;
+    int m_seconds;
+    int m_thinkMs;
+    //sessions per shard of the server
+    int m_targetSessions;
+    double m_targetP99Ms;
+
+    Options(): m_host("127.0.0.1"), m_port(7878), m_connectionNo(2000), m_threadNo(1),
+        m_seconds(10), m_thinkMs(1000), m_targetSessions(2000), m_targetP99Ms(25.0) {}
+};
+
+//what a connection does when its think time is over
+enum Action { NoAction, SendGuess, SendNewRound };
+
+struct Client
+{
+    int m_fd;
+    uint8_t m_input[512];
+    int m_inputSize;
+
+    int m_rowNo;
+    bool m_isComputerFirst;
+    //the points still to guess, as col * rowNo + row
+    std::vector<int> m_points;
+
+    //whether a guess was sent and its step is not answered
+    bool m_inStep;
+    Clock::time_point m_sentAt;
+    //whether a new round was asked for and not started
+    bool m_inStart;
+    Clock::time_point m_startSentAt;
+    Action m_action;
+};
+
+//the results of a thread
+struct Report
+{
+    std::vector<float> m_latenciesMs;
+    std::vector<float> m_startLatenciesMs;
+    long long m_stepNo;
+    long long m_roundNo;
+    int m_errorNo;
+    int m_connected;
+    int m_shardNo;
+
+    Report(): m_stepNo(0), m_roundNo(0), m_errorNo(0), m_connected(0), m_shardNo(0) {}
+};
+
+int connectTo(const Options& options)
+{
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0)
+        return -1;
+    sockaddr_in address;
+    std::memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_port = htons(static_cast<uint16_t>(options.m_port));
+    inet_pton(AF_INET, options.m_host, &address.sin_addr);
+    if (connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+        close(fd);
+        return -1;
+    }
+    int noDelay = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+    return fd;
+}
+
+//sends a frame with one message
+bool sendNewRound(Client& client)
+{
+    uint8_t frame[16];
+    WireWriter writer(frame, sizeof(frame));
+    writer.beginFrame();
+    writer.newRound(client.m_isComputerFirst);
+    writer.endFrame();
+    return send(client.m_fd, frame, writer.size(), MSG_NOSIGNAL) == writer.size();
+}
+
+bool sendGuess(Client& client, int row, int col)
+{
+    uint8_t frame[16];
+    WireWriter writer(frame, sizeof(frame));
+    writer.beginFrame();
+    writer.playerGuess(row, col);
+    writer.endFrame();
+    return send(client.m_fd, frame, writer.size(), MSG_NOSIGNAL) == writer.size();
+}
+
+//plays on a share of the connections until the end of the run
+//the latencies are kept after the warm up second
+void runThread(const Options& options, int connectionNo, unsigned int seed, Report& report)
+{
+    std::mt19937 random(seed);
+    std::vector<Client> clients;
+    clients.reserve(connectionNo);
+    for (int i = 0; i < connectionNo; i++) {
+        Client client = Client();
+        client.m_fd = connectTo(options);
+        if (client.m_fd < 0)
+            continue;
+        client.m_inputSize = 0;
+        client.m_rowNo = 0;
+        client.m_isComputerFirst = (i % 2) != 0;
+        client.m_inStep = false;
+        client.m_inStart = false;
+        client.m_action = NoAction;
+        clients.push_back(client);
+    }
+    report.m_connected = static_cast<int>(clients.size());
+    report.m_latenciesMs.reserve(1 << 20);
+
+    const Clock::time_point start = Clock::now();
+    const Clock::time_point warm = start + std::chrono::seconds(1);
+    const Clock::time_point end = start + std::chrono::seconds(options.m_seconds);
+    const Clock::duration think = std::chrono::milliseconds(options.m_thinkMs);
+    //the first moves are spread over the think time
+    std::uniform_int_distribution<int> spread(0, options.m_thinkMs > 0 ? options.m_thinkMs : 0);
+
+    //the connections whose action is due first are at the top
+    typedef std::pair<Clock::time_point, int> Due;
+    std::priority_queue<Due, std::vector<Due>, std::greater<Due> > schedule;
+    auto plan = [&](int i, Action action, Clock::time_point dueAt) {
+        clients[i].m_action = action;
+        schedule.push(Due(dueAt, i));
+    };
+
+    int epollFd = epoll_create1(0);
+    for (unsigned int i = 0; i < clients.size(); i++) {
+        epoll_event event;
+        event.events = EPOLLIN;
+        event.data.u32 = i;
+        epoll_ctl(epollFd, EPOLL_CTL_ADD, clients[i].m_fd, &event);
+    }
+    const int MaxEventNo = 256;
+    epoll_event events[MaxEventNo];
+
+    for (;;) {
+        Clock::time_point now = Clock::now();
+        if (now >= end)
+            break;
+
+        //sends the actions that are due
+        while (!schedule.empty() && schedule.top().first <= now) {
+            Client& client = clients[schedule.top().second];
+            schedule.pop();
+            if (client.m_action == SendNewRound) {
+                client.m_inStart = true;
+                client.m_startSentAt = Clock::now();
+                sendNewRound(client);
+            } else {
+                int point = client.m_points.back();
+                client.m_points.pop_back();
+                client.m_inStep = true;
+                client.m_sentAt = Clock::now();
+                sendGuess(client, point % client.m_rowNo, point / client.m_rowNo);
+            }
+            client.m_action = NoAction;
+        }
+
+        //waits for the answers until the next action is due
+        int timeout = 100;
+        if (!schedule.empty()) {
+            Clock::duration wait = schedule.top().first - Clock::now();
+            timeout = wait.count() <= 0 ? 0 : static_cast<int>(std::chrono::duration_cast<std::chrono::milliseconds>(wait).count()) + 1;
+        }
+        int eventNo = epoll_wait(epollFd, events, MaxEventNo, timeout);
+        if (eventNo < 0)
+            break;
+
+        for (int e = 0; e < eventNo; e++) {
+            const unsigned int i = events[e].data.u32;
+            Client& client = clients[i];
+            ssize_t size = recv(client.m_fd, client.m_input + client.m_inputSize, sizeof(client.m_input) - client.m_inputSize, 0);
+            if (size <= 0) {
+                report.m_errorNo++;
+                epoll_ctl(epollFd, EPOLL_CTL_DEL, client.m_fd, nullptr);
+                continue;
+            }
+            client.m_inputSize += static_cast<int>(size);
+
+            //the answers of a step come in one frame
+            const Clock::time_point received = Clock::now();
+            int position = 0;
+            int frameSize;
+            while ((frameSize = WireReader::frameSize(client.m_input + position, client.m_inputSize - position)) > 0) {
+                WireReader reader(client.m_input + position, frameSize);
+                WireMessage message;
+                bool stepDone = false;
+                bool roundEnded = false;
+                bool guessNeeded = false;
+                while (reader.next(message)) {
+                    switch (message.m_type) {
+                    case WireProtocol::Hello:
+                        report.m_shardNo = std::max(report.m_shardNo, message.m_args[1] + 1);
+                        plan(i, SendNewRound, received + std::chrono::milliseconds(spread(random)));
+                        break;
+                    case WireProtocol::RoundStarted:
+                        client.m_rowNo = message.m_args[0];
+                        client.m_points.resize(message.m_args[0] * message.m_args[1]);
+                        for (unsigned int k = 0; k < client.m_points.size(); k++)
+                            client.m_points[k] = k;
+                        std::shuffle(client.m_points.begin(), client.m_points.end(), random);
+                        guessNeeded = !client.m_isComputerFirst;
+                        if (client.m_inStart && client.m_startSentAt >= warm)
+                            report.m_startLatenciesMs.push_back(std::chrono::duration<float, std::milli>(received - client.m_startSentAt).count());
+                        client.m_inStart = false;
+                        break;
+                    case WireProtocol::GuessResult:
+                        stepDone = client.m_inStep;
+                        guessNeeded = true;
+                        break;
+                    case WireProtocol::ComputerMove:
+                        guessNeeded = true;
+                        break;
+                    case WireProtocol::RoundEnded:
+                        roundEnded = true;
+                        break;
+                    case WireProtocol::Planes:
+                    case WireProtocol::Statistics:
+                        break;
+                    default:
+                        report.m_errorNo++;
+                        break;
+                    }
+                }
+                if (reader.hasError())
+                    report.m_errorNo++;
+                position += frameSize;
+
+                if (roundEnded) {
+                    report.m_roundNo++;
+                    client.m_isComputerFirst = !client.m_isComputerFirst;
+                    plan(i, SendNewRound, received + think);
+                } else if (guessNeeded) {
+                    plan(i, client.m_points.empty() ? SendNewRound : SendGuess, received + think);
+                }
+
+                if (stepDone) {
+                    client.m_inStep = false;
+                    report.m_stepNo++;
+                    if (client.m_sentAt >= warm)
+                        report.m_latenciesMs.push_back(std::chrono::duration<float, std::milli>(received - client.m_sentAt).count());
+                }
+            }
+            client.m_inputSize -= position;
+            std::memmove(client.m_input, client.m_input + position, client.m_inputSize);
+        }
+    }
+
+    for (unsigned int i = 0; i < clients.size(); i++)
+        close(clients[i].m_fd);
+    close(epollFd);
+}
+
+}
+
+int main(int argc, char* argv[])
+{
+    Options options;
+    for (int i = 1; i < argc; i++) {
+        bool hasValue = i + 1 < argc;
+        if (!std::strcmp(argv[i], "-host") && hasValue)
+            options.m_host = argv[++i];
+        else if (!std::strcmp(argv[i], "-port") && hasValue)
+            options.m_port = std::atoi(argv[++i]);
+        else if (!std::strcmp(argv[i], "-connections") && hasValue)
+            options.m_connectionNo = std::atoi(argv[++i]);
+        else if (!std::strcmp(argv[i], "-threads") && hasValue)
+            options.m_threadNo = std::atoi(argv[++i]);
+        else if (!std::strcmp(argv[i], "-seconds") && hasValue)
+            options.m_seconds = std::atoi(argv[++i]);
+        else if (!std::strcmp(argv[i], "-think") && hasValue)
+            options.m_thinkMs = std::atoi(argv[++i]);
+        else if (!std::strcmp(argv[i], "-target-sessions") && hasValue)
+            options.m_targetSessions = std::atoi(argv[++i]);
+        else if (!std::strcmp(argv[i], "-target-p99") && hasValue)
+            options.m_targetP99Ms = std::atof(argv[++i]);
+        else {
+            std::fprintf(stderr, "usage: %s [-host a.b.c.d] [-port n] [-connections n] [-threads n]\n"
+                                 "       [-seconds n] [-think ms] [-target-sessions n] [-target-p99 ms]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (options.m_threadNo <= 0 || options.m_connectionNo <= 0 || options.m_seconds <= 1) {
+        std::fprintf(stderr, "invalid options\n");
+        return 1;
+    }
+
+    std::vector<Report> reports(options.m_threadNo);
+    std::vector<std::thread> threads;
+    for (int i = 0; i < options.m_threadNo; i++) {
+        int connectionNo = options.m_connectionNo / options.m_threadNo + (i < options.m_connectionNo % options.m_threadNo ? 1 : 0);
+        threads.push_back(std::thread(runThread, std::cref(options), connectionNo, 12345u + i, std::ref(reports[i])));
+    }
+    for (unsigned int i = 0; i < threads.size(); i++)
+        threads[i].join();
+
+    Report total;
+    for (unsigned int i = 0; i < reports.size(); i++) {
+        total.m_latenciesMs.insert(total.m_latenciesMs.end(), reports[i].m_latenciesMs.begin(), reports[i].m_latenciesMs.end());
+        total.m_startLatenciesMs.insert(total.m_startLatenciesMs.end(), reports[i].m_startLatenciesMs.begin(), reports[i].m_startLatenciesMs.end());
+        total.m_stepNo += reports[i].m_stepNo;
+        total.m_roundNo += reports[i].m_roundNo;
+        total.m_errorNo += reports[i].m_errorNo;
+        total.m_connected += reports[i].m_connected;
+        total.m_shardNo = std::max(total.m_shardNo, reports[i].m_shardNo);
+    }
+    if (total.m_latenciesMs.empty() || total.m_shardNo == 0) {
+        std::fprintf(stderr, "no step was measured\n");
+        return 1;
+    }
+
+    std::vector<float>& latencies = total.m_latenciesMs;
+    std::sort(latencies.begin(), latencies.end());
+    const float p50 = latencies[latencies.size() / 2];
+    const float p99 = latencies[latencies.size() * 99 / 100];
+    const float maximum = latencies.back();
+    const double sessionsPerShard = static_cast<double>(total.m_connected) / total.m_shardNo;
+
+    std::printf("connections %d of %d, server shards %d, sessions per shard %.0f\n",
+                total.m_connected, options.m_connectionNo, total.m_shardNo, sessionsPerShard);
+    std::printf("steps %lld (%.0f/s), rounds %lld, errors %d\n", total.m_stepNo,
+                total.m_stepNo / static_cast<double>(options.m_seconds), total.m_roundNo, total.m_errorNo);
+    std::printf("step latency ms: p50 %.3f p99 %.3f max %.3f\n", p50, p99, maximum);
+    std::vector<float>& starts = total.m_startLatenciesMs;
+    if (!starts.empty()) {
+        std::sort(starts.begin(), starts.end());
+        std::printf("round start latency ms: p50 %.3f p99 %.3f max %.3f\n",
+                    starts[starts.size() / 2], starts[starts.size() * 99 / 100], starts.back());
+    }
+
+    bool passed = total.m_connected == options.m_connectionNo && total.m_errorNo == 0 &&
+                  sessionsPerShard >= options.m_targetSessions && p99 <= options.m_targetP99Ms;
+    std::printf("targets: %d sessions per shard, p99 <= %.1f ms: %s\n",
+                options.m_targetSessions, options.m_targetP99Ms, passed ? "passed" : "failed");
+    return passed ? 0 : 2;
+}
@@ -0,0 +1,559 @@
+#include "gameserver.h"
+#include <arpa/inet.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace {
+
+//makes a descriptor non blocking
+bool setNonBlocking(int fd)
+{
+    int flags = fcntl(fd, F_GETFL, 0);
+    return flags >= 0 && fcntl(fd, F_SETFL, flags | O_NONBLOCK) == 0;
+}
+
+//the epoll key of a connection: its slot in the low bits, the generation of
+//the slot in the high bits; no slot has the key of the wake pipe, -1
+uint64_t eventKey(int slot, uint32_t generation)
+{
+    return static_cast<uint64_t>(generation) << 32 | static_cast<uint32_t>(slot);
+}
+
+}
+
+//constructor
+GameServer::GameServer(const Options& options):
+    m_options(options),
+    m_listenFd(-1),
+    m_sessionPool([options]() { return new GameSession(options.m_rowNo, options.m_colNo, options.m_planeNo); },
+                  options.m_idleSessionNo),
+    m_stopping(false),
+    m_nextShard(0)
+{
+    if (options.m_boardPoolSize > 0)
+        m_boardPool.reset(new BoardPool(options.m_rowNo, options.m_colNo, options.m_planeNo, options.m_boardPoolSize));
+    int shardNo = options.m_shardNo > 0 ? options.m_shardNo : 1;
+    for (int i = 0; i < shardNo; i++)
+        m_shards.push_back(std::unique_ptr<Shard>(new Shard(options, i, m_replayLog, m_statistics, m_boardPool.get(), m_sessionPool)));
+}
+
+//destructor
+GameServer::~GameServer()
+{
+    stop();
+}
+
+//listens on the address and the port and starts the threads
+bool GameServer::start()
+{
+    sockaddr_in address;
+    std::memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_port = htons(static_cast<uint16_t>(m_options.m_port));
+    if (inet_pton(AF_INET, m_options.m_bindAddress.c_str(), &address.sin_addr) != 1)
+        return false;
+
+    m_listenFd = socket(AF_INET, SOCK_STREAM, 0);
+    if (m_listenFd < 0)
+        return false;
+
+    int reuse = 1;
+    setsockopt(m_listenFd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+    if (bind(m_listenFd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 ||
+        listen(m_listenFd, SOMAXCONN) != 0 || !setNonBlocking(m_listenFd)) {
+        close(m_listenFd);
+        m_listenFd = -1;
+        return false;
+    }
+
+    //the strategies are those registered by the computer logic
+    GameSession probe(m_options.m_rowNo, m_options.m_colNo, m_options.m_planeNo);
+    if (!probe.logic().strategies().selectOnly(m_options.m_strategy) ||
+        (!m_options.m_replayPath.empty() && !m_replayLog.open(m_options.m_replayPath)) ||
+        (!m_options.m_statisticsPath.empty() && !m_statistics.open(m_options.m_statisticsPath))) {
+        m_replayLog.close();
+        close(m_listenFd);
+        m_listenFd = -1;
+        return false;
+    }
+
+    for (unsigned int i = 0; i < m_shards.size(); i++)
+        if (!m_shards[i]->start())
+            return false;
+
+    m_acceptThread = std::thread(&GameServer::acceptLoop, this);
+    return true;
+}
+
+//stops accepting connections and ends the event loops
+void GameServer::stop()
+{
+    m_stopping = true;
+    if (m_acceptThread.joinable())
+        m_acceptThread.join();
+    for (unsigned int i = 0; i < m_shards.size(); i++)
+        m_shards[i]->stop();
+    if (m_listenFd >= 0) {
+        close(m_listenFd);
+        m_listenFd = -1;
+    }
+    m_replayLog.close();
+    m_statistics.close();
+}
+
+//the number of open connections
+int GameServer::connectionNo() const
+{
+    int count = 0;
+    for (unsigned int i = 0; i < m_shards.size(); i++)
+        count += m_shards[i]->connectionNo();
+    return count;
+}
+
+//the number of moves played
+int64_t GameServer::moveNo() const
+{
+    int64_t count = 0;
+    for (unsigned int i = 0; i < m_shards.size(); i++)
+        count += m_shards[i]->moveNo();
+    return count;
+}
+
+//accepts the connections and gives them to the shards in turn
+//the listening socket is polled with a timeout to see the stop request
+void GameServer::acceptLoop()
+{
+    while (!m_stopping) {
+        pollfd listenPoll;
+        listenPoll.fd = m_listenFd;
+        listenPoll.events = POLLIN;
+        listenPoll.revents = 0;
+        if (poll(&listenPoll, 1, 100) <= 0)
+            continue;
+
+        for (;;) {
+            int fd = accept(m_listenFd, nullptr, nullptr);
+            if (fd < 0)
+                break;
+            int noDelay = 1;
+            setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+            if (!setNonBlocking(fd)) {
+                close(fd);
+                continue;
+            }
+            m_shards[m_nextShard]->addConnection(fd);
+            m_nextShard = (m_nextShard + 1) % static_cast<int>(m_shards.size());
+        }
+    }
+}
+
+//constructor
+GameServer::Shard::Shard(const Options& options, int index, ReplayLogWriter& replayLog, StatisticsWriter& statistics,
+                         BoardPool* boardPool, ObjectPool<GameSession>& sessionPool):
+    m_options(options),
+    m_index(index),
+    m_replayLog(replayLog),
+    m_statistics(statistics),
+    m_boardPool(boardPool),
+    m_sessionPool(sessionPool),
+    m_epollFd(-1),
+    m_stopping(false),
+    m_connectionNo(0),
+    m_moveNo(0)
+{
+    m_wakeFds[0] = m_wakeFds[1] = -1;
+}
+
+//destructor
+GameServer::Shard::~Shard()
+{
+    stop();
+}
+
+//starts the thread of the loop
+//the wake pipe is registered with the key -1
+bool GameServer::Shard::start()
+{
+    m_epollFd = epoll_create1(0);
+    if (m_epollFd < 0 || pipe(m_wakeFds) != 0)
+        return false;
+    setNonBlocking(m_wakeFds[0]);
+    setNonBlocking(m_wakeFds[1]);
+
+    epoll_event event;
+    event.events = EPOLLIN;
+    event.data.u64 = static_cast<uint64_t>(-1);
+    if (epoll_ctl(m_epollFd, EPOLL_CTL_ADD, m_wakeFds[0], &event) != 0)
+        return false;
+
+    m_thread = std::thread(&GameServer::Shard::run, this);
+    return true;
+}
+
+//ends the loop and closes the connections
+void GameServer::Shard::stop()
+{
+    if (!m_thread.joinable())
+        return;
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+    char byte = 0;
+    if (write(m_wakeFds[1], &byte, 1) < 0) {
+        //the pipe is full, the loop is woken anyway
+    }
+    m_thread.join();
+
+    for (unsigned int i = 0; i < m_connections.size(); i++)
+        if (m_connections[i].m_fd >= 0)
+            close(m_connections[i].m_fd);
+    m_connections.clear();
+    for (unsigned int i = 0; i < m_sessions.size(); i++)
+        m_sessionPool.release(std::move(m_sessions[i]));
+    m_sessions.clear();
+    m_freeSlots.clear();
+    for (unsigned int i = 0; i < m_pendingFds.size(); i++)
+        close(m_pendingFds[i]);
+    m_pendingFds.clear();
+    close(m_wakeFds[0]);
+    close(m_wakeFds[1]);
+    close(m_epollFd);
+    m_wakeFds[0] = m_wakeFds[1] = m_epollFd = -1;
+    m_connectionNo = 0;
+}
+
+//hands an accepted connection to the loop
+void GameServer::Shard::addConnection(int fd)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_pendingFds.push_back(fd);
+    }
+    char byte = 0;
+    if (write(m_wakeFds[1], &byte, 1) < 0) {
+        //the pipe is full, the loop is woken anyway
+    }
+}
+
+//the event loop
+void GameServer::Shard::run()
+{
+    const int MaxEventNo = 256;
+    epoll_event events[MaxEventNo];
+
+    for (;;) {
+        int eventNo = epoll_wait(m_epollFd, events, MaxEventNo, -1);
+        if (eventNo < 0) {
+            if (errno == EINTR)
+                continue;
+            return;
+        }
+
+        for (int i = 0; i < eventNo; i++) {
+            if (events[i].data.u64 == static_cast<uint64_t>(-1)) {
+                {
+                    std::lock_guard<std::mutex> lock(m_mutex);
+                    if (m_stopping)
+                        return;
+                }
+                takePendingConnections();
+                continue;
+            }
+
+            //the connection may have been closed by an earlier event of the pass,
+            //and its slot given to a new connection
+            const uint64_t key = events[i].data.u64;
+            const int slot = static_cast<int>(key & 0xffffffffu);
+            if (m_connections[slot].m_fd < 0 || m_connections[slot].m_generation != static_cast<uint32_t>(key >> 32))
+                continue;
+            if (!serveConnection(slot, events[i].events))
+                closeConnection(slot);
+        }
+    }
+}
+
+//takes the connections handed by the accepting thread
+//a session is created only when no slot of a closed connection is free
+void GameServer::Shard::takePendingConnections()
+{
+    char buffer[64];
+    while (read(m_wakeFds[0], buffer, sizeof(buffer)) > 0) {
+    }
+
+    std::vector<int> fds;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        fds.swap(m_pendingFds);
+    }
+
+    for (unsigned int i = 0; i < fds.size(); i++) {
+        int slot;
+        if (m_freeSlots.empty()) {
+            slot = static_cast<int>(m_connections.size());
+            m_connections.push_back(Connection());
+            m_connections.back().m_generation = 0;
+            m_sessions.push_back(std::unique_ptr<GameSession>());
+        } else {
+            slot = m_freeSlots.back();
+            m_freeSlots.pop_back();
+        }
+
+        //a recycled session has the default strategies
+        m_sessions[slot] = m_sessionPool.acquire();
+        m_sessions[slot]->logic().strategies().selectOnly(m_options.m_strategy);
+        m_sessions[slot]->setBoardPool(m_boardPool);
+
+        Connection& connection = m_connections[slot];
+        connection.m_fd = fds[i];
+        connection.m_events = EPOLLIN;
+        connection.m_inputSize = 0;
+        connection.m_framePosition = 0;
+        connection.m_outputSize = 0;
+
+        epoll_event event;
+        event.events = connection.m_events;
+        event.data.u64 = eventKey(slot, connection.m_generation);
+        if (epoll_ctl(m_epollFd, EPOLL_CTL_ADD, connection.m_fd, &event) != 0) {
+            close(connection.m_fd);
+            connection.m_fd = -1;
+            m_freeSlots.push_back(slot);
+            continue;
+        }
+        m_connectionNo++;
+
+        WireWriter writer(connection.m_output, OutputCapacity);
+        writer.beginFrame();
+        writer.hello(WireProtocol::Version, m_index);
+        writer.endFrame();
+        connection.m_outputSize = writer.size();
+        if (!writeConnection(connection))
+            closeConnection(slot);
+        else
+            updateEvents(slot);
+    }
+}
+
+//reads, handles and answers the input of a connection
+//the answers are sent at once, the input left waiting for room in the
+//output is handled when the output is sent
+bool GameServer::Shard::serveConnection(int slot, uint32_t events)
+{
+    Connection& connection = m_connections[slot];
+    GameSession& session = *m_sessions[slot];
+
+    if ((events & (EPOLLIN | EPOLLHUP | EPOLLERR)) && !readConnection(connection))
+        return false;
+
+    for (;;) {
+        bool valid = handleInput(connection, session);
+        if (connection.m_outputSize > 0 && !writeConnection(connection))
+            return false;
+        //the error is sent before the connection is closed
+        if (!valid)
+            return false;
+        if (connection.m_outputSize > 0 || WireReader::frameSize(connection.m_input, connection.m_inputSize) == 0)
+            break;
+    }
+
+    updateEvents(slot);
+    return true;
+}
+
+//reads the available input of a connection
+bool GameServer::Shard::readConnection(Connection& connection)
+{
+    if (connection.m_inputSize >= InputCapacity)
+        return true;
+
+    ssize_t size = recv(connection.m_fd, connection.m_input + connection.m_inputSize,
+                        InputCapacity - connection.m_inputSize, 0);
+    if (size == 0)
+        return false;
+    if (size < 0)
+        return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+    connection.m_inputSize += static_cast<int>(size);
+    return true;
+}
+
+//handles the complete frames of the input
+//the messages are handled while the output has room for the answers of a step,
+//the rest of the input waits for the output to be sent; a frame stopped in the
+//middle is resumed from m_framePosition
+//returns false if the input is not valid
+bool GameServer::Shard::handleInput(Connection& connection, GameSession& session)
+{
+    int consumed = 0;
+    bool valid = true;
+    for (;;) {
+        const uint8_t* data = connection.m_input + consumed;
+        const int available = connection.m_inputSize - consumed;
+        const int frameSize = WireReader::frameSize(data, available);
+        if (frameSize == 0) {
+            //a frame larger than the input buffer can never be read
+            valid = available < 2 || 2 + (data[0] | (data[1] << 8)) <= InputCapacity;
+            break;
+        }
+
+        WireReader reader(data, frameSize, connection.m_framePosition > 0 ? connection.m_framePosition : WireProtocol::HeaderSize);
+        WireMessage message;
+        bool room = true;
+        while ((room = connection.m_outputSize + StepOutputSize <= OutputCapacity) && reader.next(message))
+            handleMessage(connection, session, message);
+        if (reader.hasError()) {
+            valid = false;
+            break;
+        }
+        if (!room && reader.position() < frameSize) {
+            connection.m_framePosition = reader.position();
+            break;
+        }
+        connection.m_framePosition = 0;
+        consumed += frameSize;
+    }
+
+    if (consumed > 0) {
+        connection.m_inputSize -= consumed;
+        std::memmove(connection.m_input, connection.m_input + consumed, connection.m_inputSize);
+    }
+    if (!valid && connection.m_outputSize + StepOutputSize <= OutputCapacity) {
+        WireWriter writer(connection.m_output, OutputCapacity, connection.m_outputSize);
+        writer.beginFrame();
+        writer.error(WireProtocol::InvalidFrame);
+        writer.endFrame();
+        connection.m_outputSize = writer.size();
+    }
+    return valid;
+}
+
+//sends the pending output
+bool GameServer::Shard::writeConnection(Connection& connection)
+{
+    ssize_t size = send(connection.m_fd, connection.m_output, connection.m_outputSize, MSG_NOSIGNAL);
+    if (size < 0)
+        return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+    connection.m_outputSize -= static_cast<int>(size);
+    std::memmove(connection.m_output, connection.m_output + size, connection.m_outputSize);
+    return true;
+}
+
+//handles one message, its answers are sent in one frame
+//the steps follow PlaneRound: when the computer is first the round is checked
+//after the player's guess, otherwise after the computer's move
+//at the end of the round the computer's planes and the statistics are sent
+void GameServer::Shard::handleMessage(Connection& connection, GameSession& session, const WireMessage& message)
+{
+    WireWriter writer(connection.m_output, OutputCapacity, connection.m_outputSize);
+    writer.beginFrame();
+
+    switch (message.m_type) {
+    case WireProtocol::NewRound:
+        session.start(message.m_args[0] != 0);
+        connection.m_roundStart = std::chrono::steady_clock::now();
+        writer.roundStarted(session.getRowNo(), session.getColNo(), session.getPlaneNo());
+        if (session.isComputerFirst())
+            playComputerMove(writer, session);
+        break;
+
+    case WireProtocol::PlayerGuess: {
+        if (session.isFinished()) {
+            writer.error(WireProtocol::NoRound);
+            break;
+        }
+        GuessPoint gp(0, 0);
+        if (!session.playPlayerGuess(message.m_guess.m_row, message.m_guess.m_col, gp)) {
+            writer.error(WireProtocol::InvalidGuess);
+            break;
+        }
+        m_moveNo++;
+        writer.guessResult(gp);
+
+        if (session.isComputerFirst()) {
+            if (!session.endStep())
+                playComputerMove(writer, session);
+        } else {
+            playComputerMove(writer, session);
+            session.endStep();
+        }
+
+        if (session.isFinished()) {
+            if (m_replayLog.isOpen())
+                m_replayLog.append(session);
+            if (m_statistics.isOpen()) {
+                const std::chrono::steady_clock::duration duration = std::chrono::steady_clock::now() - connection.m_roundStart;
+                m_statistics.append(StatisticsRow(session,
+                    static_cast<int>(std::chrono::duration_cast<std::chrono::milliseconds>(duration).count())));
+            }
+            writer.roundEnded(session.isComputerWinner());
+            Plane planes[MaxPlaneNo];
+            const PlaneGridCore& grid = session.computerGrid();
+            int planeNo = std::min(grid.getPlaneListSize(), static_cast<int>(MaxPlaneNo));
+            for (int i = 0; i < planeNo; i++)
+                grid.getPlane(i, planes[i]);
+            writer.planes(planes, planeNo);
+            writer.statistics(session.stats());
+        }
+        break;
+    }
+
+    default:
+        writer.error(WireProtocol::UnknownMessage);
+        break;
+    }
+
+    writer.endFrame();
+    connection.m_outputSize = writer.size();
+}
+
+//plays the computer's move
+//without a move the player goes on alone, as nothing is sent
+void GameServer::Shard::playComputerMove(WireWriter& writer, GameSession& session)
+{
+    GuessPoint gp(0, 0);
+    if (!session.playComputerMove(gp))
+        return;
+    m_moveNo++;
+    writer.computerMove(gp);
+}
+
+//changes the events the loop waits for on a connection
+void GameServer::Shard::updateEvents(int slot)
+{
+    Connection& connection = m_connections[slot];
+    uint32_t events = 0;
+    if (connection.m_inputSize < InputCapacity)
+        events |= EPOLLIN;
+    if (connection.m_outputSize > 0)
+        events |= EPOLLOUT;
+    if (events == connection.m_events)
+        return;
+
+    epoll_event event;
+    event.events = events;
+    event.data.u64 = eventKey(slot, connection.m_generation);
+    epoll_ctl(m_epollFd, EPOLL_CTL_MOD, connection.m_fd, &event);
+    connection.m_events = events;
+}
+
+//closes a connection and frees its slot
+//closing the descriptor removes it from the epoll set
+void GameServer::Shard::closeConnection(int slot)
+{
+    Connection& connection = m_connections[slot];
+    close(connection.m_fd);
+    connection.m_fd = -1;
+    connection.m_generation++;
+    m_sessionPool.release(std::move(m_sessions[slot]));
+    m_freeSlots.push_back(slot);
+    m_connectionNo--;
+}
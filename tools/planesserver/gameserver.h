@@ -0,0 +1,210 @@
+#ifndef GAMESERVER_H
+#define GAMESERVER_H
+
+#include "boardpool.h"
+#include "gamesession.h"
+#include "objectpool.h"
+#include "replaylog.h"
+#include "statisticsstore.h"
+#include "wireprotocol.h"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+//Hosts game sessions for remote players over TCP (Linux sockets and epoll).
+//One thread accepts the connections and hands them in turn to a fixed
+//number of shards; each shard runs an event loop with epoll over its
+//connections in its own thread and owns their sessions, so a session is
+//only touched by one thread and needs no locking.
+//Every connection plays its rounds in one GameSession with the messages
+//of wireprotocol.h. The finished rounds can be recorded in a replay log
+//and in a statistics store. The boards of the rounds are generated in
+//advance by a BoardPool, a burst of new rounds does not wait for them.
+class GameServer
+{
+public:
+    //the largest number of planes, they are sent at the end of a round
+    static const int MaxPlaneNo = 32;
+
+    struct Options
+    {
+        //the IPv4 address listened on, only the local machine by default;
+        //0.0.0.0 accepts the players of every network
+        std::string m_bindAddress;
+        int m_port;
+        int m_shardNo;
+        int m_rowNo;
+        int m_colNo;
+        int m_planeNo;
+        //the replay log of the finished rounds, none if empty
+        std::string m_replayPath;
+        //the directory of the statistics store, none if empty
+        std::string m_statisticsPath;
+        //the strategy of the computer, one of StrategyRegistry::names()
+        std::string m_strategy;
+        //the boards generated in advance for the rounds, no pool if 0
+        int m_boardPoolSize;
+        //the sessions of closed connections kept for the next ones
+        int m_idleSessionNo;
+
+        Options(): m_bindAddress("127.0.0.1"), m_port(7878), m_shardNo(1), m_rowNo(10), m_colNo(10), m_planeNo(3), m_strategy("classic"),
+            m_boardPoolSize(256), m_idleSessionNo(1024) {}
+    };
+
+private:
+    class Shard;
+
+    Options m_options;
+    int m_listenFd;
+    //the sessions of the connections, recycled when a connection closes
+    //and shared by the shards; it outlives them
+    ObjectPool<GameSession> m_sessionPool;
+    std::vector<std::unique_ptr<Shard> > m_shards;
+    std::thread m_acceptThread;
+    std::atomic<bool> m_stopping;
+    //the shard receiving the next connection
+    int m_nextShard;
+    //shared by the shards, it is open when a replay path is given
+    ReplayLogWriter m_replayLog;
+    //shared by the shards, it is open when a statistics path is given
+    StatisticsWriter m_statistics;
+    //shared by the shards, the sessions take their boards from it
+    std::unique_ptr<BoardPool> m_boardPool;
+
+public:
+    explicit GameServer(const Options& options);
+    //stops the threads and closes the connections
+    ~GameServer();
+
+    //listens on the address and the port of the options, opens the replay
+    //log and the statistics store and starts the threads
+    //returns false if the address, the port, the log or the store cannot be used
+    //or if the strategy is unknown
+    bool start();
+    //stops accepting connections and ends the event loops
+    void stop();
+
+    int shardNo() const { return static_cast<int>(m_shards.size()); }
+    //the number of open connections
+    int connectionNo() const;
+    //the number of moves played by the computer and the player
+    int64_t moveNo() const;
+    //the board pool, null if there is none
+    const BoardPool* boardPool() const { return m_boardPool.get(); }
+    ObjectPool<GameSession>::Metrics sessionPoolMetrics() const { return m_sessionPool.metrics(); }
+
+private:
+    //the loop of the accepting thread
+    void acceptLoop();
+
+    GameServer(const GameServer&) = delete;
+    GameServer& operator=(const GameServer&) = delete;
+};
+
+//an event loop and the connections and sessions that it serves
+class GameServer::Shard
+{
+public:
+    //the bytes kept for a connection; the frames of the client can have
+    //InputCapacity bytes, the answers of a message are at most StepOutputSize
+    //bytes and the input is only handled while there is room for them
+    static const int InputCapacity = 128;
+    static const int OutputCapacity = 512;
+    static const int StepOutputSize = 128;
+
+private:
+    //the state of a connection, all the data the loop reads for a message
+    //are in this structure and the structures are contiguous
+    struct Connection
+    {
+        //-1 when the slot is free
+        int m_fd;
+        //counts the connections closed in the slot, it is in the epoll key
+        //so that an event of a closed connection is not taken for its successor
+        uint32_t m_generation;
+        //the events the loop waits for
+        uint32_t m_events;
+        int m_inputSize;
+        //the position of the next message of the first frame of the input
+        //when the frame was stopped for lack of output room, otherwise 0
+        int m_framePosition;
+        int m_outputSize;
+        //when the current round started
+        std::chrono::steady_clock::time_point m_roundStart;
+        uint8_t m_input[InputCapacity];
+        uint8_t m_output[OutputCapacity];
+    };
+
+    const Options m_options;
+    const int m_index;
+    ReplayLogWriter& m_replayLog;
+    StatisticsWriter& m_statistics;
+    BoardPool* m_boardPool;
+    ObjectPool<GameSession>& m_sessionPool;
+    //the connections and their sessions, a free slot has no session: it is
+    //given back to the pool when its connection closes; the epoll key is the
+    //slot and its generation
+    std::vector<Connection> m_connections;
+    std::vector<std::unique_ptr<GameSession> > m_sessions;
+    std::vector<int> m_freeSlots;
+    int m_epollFd;
+    //written to wake the loop when a connection is added or the server stops
+    int m_wakeFds[2];
+
+    //the connections accepted but not yet added to the loop
+    std::mutex m_mutex;
+    std::vector<int> m_pendingFds;
+    bool m_stopping;
+
+    std::thread m_thread;
+    std::atomic<int> m_connectionNo;
+    std::atomic<int64_t> m_moveNo;
+
+public:
+    Shard(const Options& options, int index, ReplayLogWriter& replayLog, StatisticsWriter& statistics,
+          BoardPool* boardPool, ObjectPool<GameSession>& sessionPool);
+    ~Shard();
+
+    //starts the thread of the loop
+    bool start();
+    //ends the loop and closes the connections
+    void stop();
+    //hands an accepted connection to the loop
+    void addConnection(int fd);
+
+    int connectionNo() const { return m_connectionNo; }
+    int64_t moveNo() const { return m_moveNo; }
+
+private:
+    //the event loop
+    void run();
+    //takes the connections handed by the accepting thread
+    void takePendingConnections();
+    //reads, handles and answers the input of a connection
+    //returns false if the connection is closed
+    bool serveConnection(int slot, uint32_t events);
+    //reads the available input of a connection
+    //returns false if the connection is closed
+    bool readConnection(Connection& connection);
+    //handles the complete frames of the input
+    //returns false if the input is not valid
+    bool handleInput(Connection& connection, GameSession& session);
+    //sends the pending output, returns false if the connection is closed
+    bool writeConnection(Connection& connection);
+    //handles one message and writes the answers to the output
+    void handleMessage(Connection& connection, GameSession& session, const WireMessage& message);
+    //plays the computer's move and writes it to the answers
+    void playComputerMove(WireWriter& writer, GameSession& session);
+    //changes the events the loop waits for on a connection
+    //input is awaited while there is room for it, output while some is left to send
+    void updateEvents(int slot);
+    //closes a connection and frees its slot
+    void closeConnection(int slot);
+};
+
+#endif // GAMESERVER_H
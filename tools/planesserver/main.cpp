@@ -0,0 +1,109 @@
+#include "gameserver.h"
+#include "plane.h"
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+
+//Hosts games against the computer for remote players over TCP.
+//The sessions are shared among a fixed number of event loops, one thread
+//each; the server reports the connections and the moves per second until
+//it is interrupted. tools/planesloadclient measures it from the same machine.
+//Only the local machine can connect unless another address is given with -bind.
+//
+//usage: PlanesServer [-bind address] [-port n] [-shards n] [-grid rows cols planes] [-replay file]
+//                    [-statistics directory] [-strategy name] [-boardpool n]
+//                    [-idlesessions n]
+
+namespace {
+
+volatile std::sig_atomic_t stopRequested = 0;
+
+void requestStop(int)
+{
+    stopRequested = 1;
+}
+
+}
+
+int main(int argc, char* argv[])
+{
+    GameServer::Options options;
+    options.m_shardNo = static_cast<int>(std::thread::hardware_concurrency());
+    if (options.m_shardNo <= 0)
+        options.m_shardNo = 1;
+
+    for (int i = 1; i < argc; i++) {
+        if (!std::strcmp(argv[i], "-bind") && i + 1 < argc) {
+            options.m_bindAddress = argv[++i];
+        } else if (!std::strcmp(argv[i], "-port") && i + 1 < argc) {
+            options.m_port = std::atoi(argv[++i]);
+        } else if (!std::strcmp(argv[i], "-shards") && i + 1 < argc) {
+            options.m_shardNo = std::atoi(argv[++i]);
+        } else if (!std::strcmp(argv[i], "-grid") && i + 3 < argc) {
+            options.m_rowNo = std::atoi(argv[++i]);
+            options.m_colNo = std::atoi(argv[++i]);
+            options.m_planeNo = std::atoi(argv[++i]);
+        } else if (!std::strcmp(argv[i], "-replay") && i + 1 < argc) {
+            options.m_replayPath = argv[++i];
+        } else if (!std::strcmp(argv[i], "-statistics") && i + 1 < argc) {
+            options.m_statisticsPath = argv[++i];
+        } else if (!std::strcmp(argv[i], "-strategy") && i + 1 < argc) {
+            options.m_strategy = argv[++i];
+        } else if (!std::strcmp(argv[i], "-boardpool") && i + 1 < argc) {
+            options.m_boardPoolSize = std::atoi(argv[++i]);
+        } else if (!std::strcmp(argv[i], "-idlesessions") && i + 1 < argc) {
+            options.m_idleSessionNo = std::atoi(argv[++i]);
+        } else {
+            std::fprintf(stderr, "usage: %s [-bind address] [-port n] [-shards n] [-grid rows cols planes] [-replay file]"
+                         " [-statistics directory] [-strategy name] [-boardpool n] [-idlesessions n]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    //the points and the planes are packed with 7 bits per coordinate
+    if (options.m_shardNo <= 0 || options.m_boardPoolSize < 0 || options.m_idleSessionNo < 0 ||
+        options.m_rowNo <= 0 || options.m_colNo <= 0 || options.m_planeNo <= 0 ||
+        options.m_rowNo > WireProtocol::MaxDimension || options.m_colNo > WireProtocol::MaxDimension ||
+        options.m_planeNo > GameServer::MaxPlaneNo) {
+        std::fprintf(stderr, "invalid options\n");
+        return 1;
+    }
+
+    Plane::seedRandomGenerator();
+    GameServer server(options);
+    if (!server.start()) {
+        std::fprintf(stderr, "cannot listen on %s port %d, open the replay log or the statistics store, or use the strategy\n",
+                     options.m_bindAddress.c_str(), options.m_port);
+        return 1;
+    }
+    std::printf("listening on %s port %d with %d shards, grid %dx%d with %d planes\n",
+                options.m_bindAddress.c_str(), options.m_port, server.shardNo(), options.m_rowNo, options.m_colNo, options.m_planeNo);
+    std::fflush(stdout);
+
+    std::signal(SIGINT, requestStop);
+    std::signal(SIGTERM, requestStop);
+
+    int64_t lastMoveNo = 0;
+    while (!stopRequested) {
+        std::this_thread::sleep_for(std::chrono::seconds(1));
+        int64_t moveNo = server.moveNo();
+        std::printf("connections %d moves/s %lld", server.connectionNo(), static_cast<long long>(moveNo - lastMoveNo));
+        if (server.boardPool() != nullptr) {
+            BoardPool::Metrics pool = server.boardPool()->metrics();
+            std::printf(" boards %d/%d taken %llu missed %llu refills %llu", pool.m_occupancy, pool.m_capacity,
+                        static_cast<unsigned long long>(pool.m_taken), static_cast<unsigned long long>(pool.m_missed),
+                        static_cast<unsigned long long>(pool.m_refills));
+        }
+        ObjectPool<GameSession>::Metrics sessions = server.sessionPoolMetrics();
+        std::printf(" sessions created %llu reused %llu\n", static_cast<unsigned long long>(sessions.m_created),
+                    static_cast<unsigned long long>(sessions.m_reused));
+        std::fflush(stdout);
+        lastMoveNo = moveNo;
+    }
+
+    server.stop();
+    return 0;
+}
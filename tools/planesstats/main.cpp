@@ -0,0 +1,149 @@
+#include "computerlogic.h"
+#include "statisticsstore.h"
+#include "threadpool.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+//Answers aggregate queries over a statistics store written by the game
+//server: the number of rounds, the mean and optionally percentiles of a
+//column, by group, for the rows having a value in a column.
+//The strategies are shown by name.
+//
+//usage: PlanesStats directory [-mean column | -percentiles column ranks]
+//                   [-by column[,column...]] [-where column value] [-threads n]
+//e.g. the mean moves to win of the computer by strategy:
+//  PlanesStats stats -mean computerMoves -by strategy -where computerWinner 1
+//the quartiles of the moves of the computer by board size:
+//  PlanesStats stats -percentiles computerMoves 25,50,75 -by rowNo,colNo,planeNo
+
+namespace {
+
+//splits a list separated by commas
+std::vector<std::string> splitList(const std::string& list)
+{
+    std::vector<std::string> items;
+    std::stringstream stream(list);
+    std::string item;
+    while (std::getline(stream, item, ','))
+        items.push_back(item);
+    return items;
+}
+
+int usage(const char* program)
+{
+    std::fprintf(stderr, "usage: %s directory [-mean column | -percentiles column ranks]"
+                 " [-by column[,column...]] [-where column value] [-threads n]\n", program);
+    return 1;
+}
+
+}
+
+int main(int argc, char* argv[])
+{
+    if (argc < 2)
+        return usage(argv[0]);
+
+    std::string directory = argv[1];
+    std::string valueName = "computerMoves";
+    std::vector<double> ranks;
+    std::vector<std::string> groupNames;
+    std::string filterName;
+    int filterValue = 0;
+    int threadNo = 1;
+    for (int i = 2; i < argc; i++) {
+        if (!std::strcmp(argv[i], "-mean") && i + 1 < argc) {
+            valueName = argv[++i];
+        } else if (!std::strcmp(argv[i], "-percentiles") && i + 2 < argc) {
+            valueName = argv[++i];
+            std::vector<std::string> items = splitList(argv[++i]);
+            for (unsigned int k = 0; k < items.size(); k++)
+                ranks.push_back(std::atof(items[k].c_str()));
+        } else if (!std::strcmp(argv[i], "-by") && i + 1 < argc) {
+            groupNames = splitList(argv[++i]);
+        } else if (!std::strcmp(argv[i], "-where") && i + 2 < argc) {
+            filterName = argv[++i];
+            filterValue = std::atoi(argv[++i]);
+        } else if (!std::strcmp(argv[i], "-threads") && i + 1 < argc) {
+            threadNo = std::atoi(argv[++i]);
+        } else {
+            return usage(argv[0]);
+        }
+    }
+
+    StatisticsReader reader;
+    if (!reader.open(directory)) {
+        std::fprintf(stderr, "cannot read the statistics store %s\n", directory.c_str());
+        return 1;
+    }
+
+    StatisticsQuery query(reader);
+    const int valueColumn = StatisticsStore::findColumn(valueName);
+    std::vector<int> groupColumns;
+    for (unsigned int i = 0; i < groupNames.size(); i++) {
+        int column = StatisticsStore::findColumn(groupNames[i]);
+        if (column < 0 || !query.addGroupColumn(column)) {
+            std::fprintf(stderr, "unknown column %s or too many group columns\n", groupNames[i].c_str());
+            return 1;
+        }
+        groupColumns.push_back(column);
+    }
+    if (valueColumn < 0) {
+        std::fprintf(stderr, "unknown column %s\n", valueName.c_str());
+        return 1;
+    }
+    if (!filterName.empty()) {
+        int column = StatisticsStore::findColumn(filterName);
+        if (column < 0) {
+            std::fprintf(stderr, "unknown column %s\n", filterName.c_str());
+            return 1;
+        }
+        query.setFilter(column, filterValue);
+    }
+
+    std::unique_ptr<ThreadPool> pool;
+    if (threadNo > 1)
+        pool.reset(new ThreadPool(threadNo));
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    std::vector<StatisticsGroup> groups = ranks.empty() ? query.mean(valueColumn, pool.get()) :
+                                                          query.percentiles(valueColumn, ranks, pool.get());
+    double elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    //the strategies are numbered in the order the computer logic registers them
+    ComputerLogic logic(10, 10, 3);
+    std::vector<std::string> strategyNames = logic.strategies().names();
+
+    for (unsigned int i = 0; i < groupColumns.size(); i++)
+        std::printf("%-16s", StatisticsStore::columnName(groupColumns[i]));
+    std::printf("%12s %12s", "rounds", "mean");
+    for (unsigned int k = 0; k < ranks.size(); k++) {
+        char name[32];
+        std::snprintf(name, sizeof(name), "p%g", ranks[k]);
+        std::printf(" %12s", name);
+    }
+    std::printf("\n");
+
+    for (unsigned int g = 0; g < groups.size(); g++) {
+        const StatisticsGroup& group = groups[g];
+        for (unsigned int i = 0; i < groupColumns.size(); i++) {
+            int value = query.keyValue(group.m_key, i);
+            if (groupColumns[i] == StatisticsStore::Strategy && value >= 0 && value < static_cast<int>(strategyNames.size()))
+                std::printf("%-16s", strategyNames[value].c_str());
+            else
+                std::printf("%-16d", value);
+        }
+        std::printf("%12lld %12.3f", static_cast<long long>(group.m_count), group.mean());
+        for (unsigned int k = 0; k < group.m_percentiles.size(); k++)
+            std::printf(" %12d", group.m_percentiles[k]);
+        std::printf("\n");
+    }
+
+    std::printf("%lld rows of %s in %.1f ms\n", static_cast<long long>(reader.rowNo()), valueName.c_str(), elapsed);
+    return 0;
+}
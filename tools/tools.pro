@@ -0,0 +1,13 @@
+TEMPLATE = subdirs
+
+SUBDIRS = openingbookbuilder \
+    configurationdbbuilder \
+    wirebench \
+    batchbench \
+    planesstats \
+    planesengine \
+    planesanalyzer
+
+#the game server and its load client use Linux sockets and epoll
+linux: SUBDIRS += planesserver \
+    planesloadclient
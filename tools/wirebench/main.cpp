@@ -0,0 +1,569 @@
+#include "gamesession.h"
+#include "wireprotocol.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+//Compares the binary wire protocol with a JSON encoding of the same messages.
+//Rounds are played against the computer and the server's answers of every
+//step are recorded; the answers are then encoded and decoded with both
+//formats and the tool reports the bytes per move and the time per move.
+//The JSON side is a hand-written encoder and a minimal parser of the
+//messages, without a library.
+//
+//usage: WireBench [rounds [rows cols planes]]
+
+namespace {
+
+typedef std::chrono::steady_clock Clock;
+
+//the server's answers of one step
+struct Step
+{
+    GuessPoint m_playerGuess;
+    GuessPoint m_computerMove;
+    bool m_hasComputerMove;
+    bool m_isRoundEnded;
+    bool m_isComputerWinner;
+    std::vector<Plane> m_planes;
+    GameStatistics m_stats;
+
+    Step(): m_playerGuess(0, 0), m_computerMove(0, 0), m_hasComputerMove(false),
+        m_isRoundEnded(false), m_isComputerWinner(false) {}
+};
+
+//plays the rounds with the rules of the server, the player guesses the
+//points of the grid in a random order
+void recordSteps(int roundNo, int rowNo, int colNo, int planeNo, std::vector<Step>& steps, int& moveNo)
+{
+    GameSession session(rowNo, colNo, planeNo);
+    std::mt19937 random(7);
+    std::vector<int> points;
+    moveNo = 0;
+
+    for (int round = 0; round < roundNo; round++) {
+        session.start(round % 2 != 0);
+        points.resize(rowNo * colNo);
+        for (unsigned int i = 0; i < points.size(); i++)
+            points[i] = i;
+        std::shuffle(points.begin(), points.end(), random);
+
+        //the computer's first move goes with the start of the round,
+        //it is not part of the steps
+        if (session.isComputerFirst()) {
+            GuessPoint gp(0, 0);
+            session.playComputerMove(gp);
+        }
+
+        while (!session.isFinished() && !points.empty()) {
+            Step step;
+            const int point = points.back();
+            points.pop_back();
+            session.playPlayerGuess(point % rowNo, point / rowNo, step.m_playerGuess);
+            moveNo++;
+
+            if (session.isComputerFirst()) {
+                if (!session.endStep() && session.playComputerMove(step.m_computerMove)) {
+                    step.m_hasComputerMove = true;
+                    moveNo++;
+                }
+            } else {
+                if (session.playComputerMove(step.m_computerMove)) {
+                    step.m_hasComputerMove = true;
+                    moveNo++;
+                }
+                session.endStep();
+            }
+
+            if (session.isFinished()) {
+                step.m_isRoundEnded = true;
+                step.m_isComputerWinner = session.isComputerWinner();
+                const PlaneGridCore& grid = session.computerGrid();
+                step.m_planes.resize(grid.getPlaneListSize(), Plane(0, 0, Plane::NorthSouth));
+                for (int i = 0; i < grid.getPlaneListSize(); i++)
+                    grid.getPlane(i, step.m_planes[i]);
+                step.m_stats = session.stats();
+            }
+            steps.push_back(step);
+        }
+    }
+}
+
+//a value summed over the decoded messages, the same for both formats
+uint64_t checksumGuess(const GuessPoint& gp)
+{
+    return gp.m_row * 131 + gp.m_col * 17 + gp.m_type;
+}
+
+uint64_t checksumPlane(const Plane& pl)
+{
+    return pl.row() * 257 + pl.col() * 31 + pl.orientation();
+}
+
+uint64_t checksumStats(const GameStatistics& stats)
+{
+    return stats.m_playerMoves + stats.m_playerHits + stats.m_playerDead + stats.m_playerMisses +
+            stats.m_computerMoves + stats.m_computerHits + stats.m_computerDead + stats.m_computerMisses +
+            stats.m_playerWins * 3 + stats.m_computerWins * 5;
+}
+
+//the binary format: one frame per step
+int encodeBinary(const Step& step, uint8_t* buffer, int capacity)
+{
+    WireWriter writer(buffer, capacity);
+    writer.beginFrame();
+    writer.guessResult(step.m_playerGuess);
+    if (step.m_hasComputerMove)
+        writer.computerMove(step.m_computerMove);
+    if (step.m_isRoundEnded) {
+        writer.roundEnded(step.m_isComputerWinner);
+        writer.planes(step.m_planes.data(), static_cast<int>(step.m_planes.size()));
+        writer.statistics(step.m_stats);
+    }
+    writer.endFrame();
+    return writer.size();
+}
+
+uint64_t decodeBinary(const uint8_t* data, int size)
+{
+    uint64_t checksum = 0;
+    int position = 0;
+    int frameSize;
+    while ((frameSize = WireReader::frameSize(data + position, size - position)) > 0) {
+        WireReader reader(data + position, frameSize);
+        WireMessage message;
+        while (reader.next(message)) {
+            switch (message.m_type) {
+            case WireProtocol::GuessResult:
+            case WireProtocol::ComputerMove:
+                checksum += checksumGuess(message.m_guess);
+                break;
+            case WireProtocol::RoundEnded:
+                checksum += message.m_args[0];
+                break;
+            case WireProtocol::Planes:
+                for (int i = 0; i < message.m_planeNo; i++)
+                    checksum += checksumPlane(message.plane(i));
+                break;
+            case WireProtocol::Statistics:
+                checksum += checksumStats(message.m_stats);
+                break;
+            default:
+                break;
+            }
+        }
+        position += frameSize;
+    }
+    return checksum;
+}
+
+//the JSON format: one line per step with an array of messages, e.g.
+//[{"type":"guessResult","row":3,"col":4,"result":"hit"},...]
+const char* const resultNames[] = { "miss", "hit", "dead" };
+const char* const orientationNames[] = { "N", "S", "W", "E" };
+
+void appendText(std::string& out, const char* text)
+{
+    out.append(text);
+}
+
+void appendInt(std::string& out, int value)
+{
+    char digits[12];
+    int n = 0;
+    unsigned int rest = value < 0 ? 0u - static_cast<unsigned int>(value) : static_cast<unsigned int>(value);
+    do {
+        digits[n++] = static_cast<char>('0' + rest % 10);
+        rest /= 10;
+    } while (rest);
+    if (value < 0)
+        out.push_back('-');
+    while (n > 0)
+        out.push_back(digits[--n]);
+}
+
+void appendGuess(std::string& out, const char* type, const GuessPoint& gp)
+{
+    appendText(out, "{\"type\":\"");
+    appendText(out, type);
+    appendText(out, "\",\"row\":");
+    appendInt(out, gp.m_row);
+    appendText(out, ",\"col\":");
+    appendInt(out, gp.m_col);
+    appendText(out, ",\"result\":\"");
+    appendText(out, resultNames[gp.m_type]);
+    appendText(out, "\"}");
+}
+
+void encodeJson(const Step& step, std::string& out)
+{
+    out.push_back('[');
+    appendGuess(out, "guessResult", step.m_playerGuess);
+    if (step.m_hasComputerMove) {
+        out.push_back(',');
+        appendGuess(out, "computerMove", step.m_computerMove);
+    }
+    if (step.m_isRoundEnded) {
+        appendText(out, ",{\"type\":\"roundEnded\",\"computerWinner\":");
+        appendText(out, step.m_isComputerWinner ? "true" : "false");
+        appendText(out, "},{\"type\":\"planes\",\"planes\":[");
+        for (unsigned int i = 0; i < step.m_planes.size(); i++) {
+            const Plane& pl = step.m_planes[i];
+            appendText(out, i ? ",{\"row\":" : "{\"row\":");
+            appendInt(out, pl.row());
+            appendText(out, ",\"col\":");
+            appendInt(out, pl.col());
+            appendText(out, ",\"orientation\":\"");
+            appendText(out, orientationNames[pl.orientation()]);
+            appendText(out, "\"}");
+        }
+        const GameStatistics& stats = step.m_stats;
+        appendText(out, "]},{\"type\":\"statistics\",\"playerMoves\":");
+        appendInt(out, stats.m_playerMoves);
+        appendText(out, ",\"playerHits\":");
+        appendInt(out, stats.m_playerHits);
+        appendText(out, ",\"playerDead\":");
+        appendInt(out, stats.m_playerDead);
+        appendText(out, ",\"playerMisses\":");
+        appendInt(out, stats.m_playerMisses);
+        appendText(out, ",\"computerMoves\":");
+        appendInt(out, stats.m_computerMoves);
+        appendText(out, ",\"computerHits\":");
+        appendInt(out, stats.m_computerHits);
+        appendText(out, ",\"computerDead\":");
+        appendInt(out, stats.m_computerDead);
+        appendText(out, ",\"computerMisses\":");
+        appendInt(out, stats.m_computerMisses);
+        appendText(out, ",\"playerWins\":");
+        appendInt(out, stats.m_playerWins);
+        appendText(out, ",\"computerWins\":");
+        appendInt(out, stats.m_computerWins);
+        out.push_back('}');
+    }
+    appendText(out, "]\n");
+}
+
+//A minimal parser of the JSON messages: objects whose values are strings,
+//integers, booleans or arrays of such objects. The keys are compared as
+//they come, as a generic parser would do.
+class JsonParser
+{
+    const char* m_data;
+    const char* m_end;
+    bool m_error;
+
+public:
+    JsonParser(const char* data, int size): m_data(data), m_end(data + size), m_error(false) {}
+
+    bool hasError() const { return m_error; }
+
+    //parses all the lines
+    uint64_t parse()
+    {
+        uint64_t checksum = 0;
+        while (!m_error && skipSpace() && m_data < m_end) {
+            expect('[');
+            if (!peek(']')) {
+                do {
+                    checksum += parseMessage();
+                } while (!m_error && accept(','));
+            }
+            expect(']');
+        }
+        return checksum;
+    }
+
+private:
+    bool skipSpace()
+    {
+        while (m_data < m_end && (*m_data == ' ' || *m_data == '\n' || *m_data == '\r' || *m_data == '\t'))
+            m_data++;
+        return true;
+    }
+
+    bool peek(char c)
+    {
+        skipSpace();
+        return m_data < m_end && *m_data == c;
+    }
+
+    bool accept(char c)
+    {
+        if (!peek(c))
+            return false;
+        m_data++;
+        return true;
+    }
+
+    void expect(char c)
+    {
+        if (!accept(c))
+            fail();
+    }
+
+    void fail()
+    {
+        m_error = true;
+        m_data = m_end;
+    }
+
+    //a string without escapes, returned in place
+    bool parseString(const char*& text, int& length)
+    {
+        expect('"');
+        text = m_data;
+        while (m_data < m_end && *m_data != '"') {
+            if (*m_data == '\\') {
+                fail();
+                return false;
+            }
+            m_data++;
+        }
+        length = static_cast<int>(m_data - text);
+        expect('"');
+        return !m_error;
+    }
+
+    int parseInt()
+    {
+        skipSpace();
+        bool negative = m_data < m_end && *m_data == '-';
+        if (negative)
+            m_data++;
+        if (m_data >= m_end || *m_data < '0' || *m_data > '9') {
+            fail();
+            return 0;
+        }
+        int value = 0;
+        while (m_data < m_end && *m_data >= '0' && *m_data <= '9')
+            value = value * 10 + (*m_data++ - '0');
+        return negative ? -value : value;
+    }
+
+    bool parseBool()
+    {
+        skipSpace();
+        if (m_end - m_data >= 4 && !std::memcmp(m_data, "true", 4)) {
+            m_data += 4;
+            return true;
+        }
+        if (m_end - m_data >= 5 && !std::memcmp(m_data, "false", 5)) {
+            m_data += 5;
+            return false;
+        }
+        fail();
+        return false;
+    }
+
+    static bool equals(const char* text, int length, const char* name)
+    {
+        return static_cast<int>(std::strlen(name)) == length && !std::memcmp(text, name, length);
+    }
+
+    static int indexOf(const char* text, int length, const char* const* names, int nameNo)
+    {
+        for (int i = 0; i < nameNo; i++) {
+            if (equals(text, length, names[i]))
+                return i;
+        }
+        return -1;
+    }
+
+    //a plane of the planes message
+    uint64_t parsePlane()
+    {
+        int row = 0, col = 0, orientation = 0;
+        expect('{');
+        do {
+            const char* key;
+            int keyLength = 0;
+            if (!parseString(key, keyLength))
+                return 0;
+            expect(':');
+            if (equals(key, keyLength, "row")) {
+                row = parseInt();
+            } else if (equals(key, keyLength, "col")) {
+                col = parseInt();
+            } else if (equals(key, keyLength, "orientation")) {
+                const char* value;
+                int valueLength = 0;
+                parseString(value, valueLength);
+                orientation = indexOf(value, valueLength, orientationNames, 4);
+                if (orientation < 0)
+                    fail();
+            } else {
+                fail();
+            }
+        } while (!m_error && accept(','));
+        expect('}');
+        if (m_error)
+            return 0;
+        return checksumPlane(Plane(row, col, static_cast<Plane::Orientation>(orientation)));
+    }
+
+    //a message, the type and the fields in any order
+    uint64_t parseMessage()
+    {
+        GuessPoint gp(0, 0);
+        GameStatistics stats;
+        uint64_t checksum = 0;
+        bool isGuess = false;
+        bool isStats = false;
+
+        static const char* const statNames[] = { "playerMoves", "playerHits", "playerDead", "playerMisses",
+                                                 "computerMoves", "computerHits", "computerDead", "computerMisses",
+                                                 "playerWins", "computerWins" };
+        int* statFields[] = { &stats.m_playerMoves, &stats.m_playerHits, &stats.m_playerDead, &stats.m_playerMisses,
+                              &stats.m_computerMoves, &stats.m_computerHits, &stats.m_computerDead, &stats.m_computerMisses,
+                              &stats.m_playerWins, &stats.m_computerWins };
+
+        expect('{');
+        do {
+            const char* key;
+            int keyLength = 0;
+            if (!parseString(key, keyLength))
+                return 0;
+            expect(':');
+            if (equals(key, keyLength, "type")) {
+                const char* value;
+                int valueLength = 0;
+                parseString(value, valueLength);
+                isGuess = equals(value, valueLength, "guessResult") || equals(value, valueLength, "computerMove");
+                isStats = equals(value, valueLength, "statistics");
+            } else if (equals(key, keyLength, "row")) {
+                gp.m_row = parseInt();
+            } else if (equals(key, keyLength, "col")) {
+                gp.m_col = parseInt();
+            } else if (equals(key, keyLength, "result")) {
+                const char* value;
+                int valueLength = 0;
+                parseString(value, valueLength);
+                int type = indexOf(value, valueLength, resultNames, 3);
+                if (type < 0)
+                    fail();
+                else
+                    gp.m_type = static_cast<GuessPoint::Type>(type);
+            } else if (equals(key, keyLength, "computerWinner")) {
+                checksum += parseBool() ? 1 : 0;
+            } else if (equals(key, keyLength, "planes")) {
+                expect('[');
+                if (!peek(']')) {
+                    do {
+                        checksum += parsePlane();
+                    } while (!m_error && accept(','));
+                }
+                expect(']');
+            } else {
+                int field = indexOf(key, keyLength, statNames, 10);
+                if (field < 0)
+                    fail();
+                else
+                    *statFields[field] = parseInt();
+            }
+        } while (!m_error && accept(','));
+        expect('}');
+
+        if (isGuess)
+            checksum += checksumGuess(gp);
+        if (isStats)
+            checksum += checksumStats(stats);
+        return checksum;
+    }
+};
+
+double nanosecondsPerMove(Clock::duration duration, int repeatNo, int moveNo)
+{
+    return std::chrono::duration<double, std::nano>(duration).count() / (static_cast<double>(repeatNo) * moveNo);
+}
+
+}
+
+int main(int argc, char* argv[])
+{
+    int roundNo = 200;
+    int rowNo = 10, colNo = 10, planeNo = 3;
+    if (argc != 1 && argc != 2 && argc != 5) {
+        std::fprintf(stderr, "usage: %s [rounds [rows cols planes]]\n", argv[0]);
+        return 1;
+    }
+    if (argc >= 2)
+        roundNo = std::atoi(argv[1]);
+    if (argc == 5) {
+        rowNo = std::atoi(argv[2]);
+        colNo = std::atoi(argv[3]);
+        planeNo = std::atoi(argv[4]);
+    }
+    if (roundNo <= 0 || rowNo <= 0 || colNo <= 0 || planeNo <= 0 ||
+        rowNo > WireProtocol::MaxDimension || colNo > WireProtocol::MaxDimension || planeNo > 255) {
+        std::fprintf(stderr, "invalid arguments\n");
+        return 1;
+    }
+
+    Plane::seedRandomGenerator();
+    std::vector<Step> steps;
+    int moveNo = 0;
+    recordSteps(roundNo, rowNo, colNo, planeNo, steps, moveNo);
+    if (moveNo == 0) {
+        std::fprintf(stderr, "no moves were played\n");
+        return 1;
+    }
+
+    //the encodings are repeated until each takes a measurable time
+    const int repeatNo = std::max(1, 2000000 / moveNo);
+
+    //the binary frames of all the steps one after the other
+    std::vector<uint8_t> binary(steps.size() * 512);
+    int binarySize = 0;
+    Clock::time_point start = Clock::now();
+    for (int r = 0; r < repeatNo; r++) {
+        binarySize = 0;
+        for (unsigned int i = 0; i < steps.size(); i++)
+            binarySize += encodeBinary(steps[i], binary.data() + binarySize, static_cast<int>(binary.size()) - binarySize);
+    }
+    const Clock::duration binaryEncode = Clock::now() - start;
+
+    uint64_t binaryChecksum = 0;
+    start = Clock::now();
+    for (int r = 0; r < repeatNo; r++)
+        binaryChecksum += decodeBinary(binary.data(), binarySize);
+    const Clock::duration binaryDecode = Clock::now() - start;
+
+    std::string json;
+    json.reserve(steps.size() * 2048);
+    start = Clock::now();
+    for (int r = 0; r < repeatNo; r++) {
+        json.clear();
+        for (unsigned int i = 0; i < steps.size(); i++)
+            encodeJson(steps[i], json);
+    }
+    const Clock::duration jsonEncode = Clock::now() - start;
+
+    uint64_t jsonChecksum = 0;
+    bool jsonError = false;
+    start = Clock::now();
+    for (int r = 0; r < repeatNo; r++) {
+        JsonParser parser(json.data(), static_cast<int>(json.size()));
+        jsonChecksum += parser.parse();
+        jsonError = jsonError || parser.hasError();
+    }
+    const Clock::duration jsonDecode = Clock::now() - start;
+
+    std::printf("%d rounds, %d steps, %d moves, grid %dx%d with %d planes\n",
+                roundNo, static_cast<int>(steps.size()), moveNo, rowNo, colNo, planeNo);
+    std::printf("%-8s %10s %12s %12s\n", "format", "bytes/move", "encode ns", "decode ns");
+    std::printf("%-8s %10.2f %12.1f %12.1f\n", "binary", static_cast<double>(binarySize) / moveNo,
+                nanosecondsPerMove(binaryEncode, repeatNo, moveNo), nanosecondsPerMove(binaryDecode, repeatNo, moveNo));
+    std::printf("%-8s %10.2f %12.1f %12.1f\n", "json", static_cast<double>(json.size()) / moveNo,
+                nanosecondsPerMove(jsonEncode, repeatNo, moveNo), nanosecondsPerMove(jsonDecode, repeatNo, moveNo));
+
+    if (jsonError || binaryChecksum != jsonChecksum) {
+        std::fprintf(stderr, "the formats decoded different messages\n");
+        return 2;
+    }
+    return 0;
+}